@@ -63,7 +63,9 @@ http://www.txcorp.com
 // output a sparse spectral approximation based on other
 // given arguments.
 // Need in_file out_file value_type num_rows num_cols ...
-// sparsity_ratio sparsity_norm_p max_num_bins
+// sparsity_ratio sparsity_norm_p max_num_bins [out_format]
+// out_format is text (default), binary, or binary_delta.  Binary files can be
+// read back with ssa_csr_read.
 
 namespace {
 
@@ -103,7 +105,8 @@ int ssa_file_io(
     scalar_type sparsity_ratio,
     scalar_type sparsity_norm_p,
     std::size_t max_num_bins,
-    const char* out_file)
+    const char* out_file,
+    const char* out_format)
 {
     std::ifstream is(in_file);
     is.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -149,6 +152,24 @@ int ssa_file_io(
         return 1;
     }
 
+    if(strcmp(out_format, "text"))
+    {
+        const bool delta_encode_ids = !strcmp(out_format, "binary_delta");
+
+        ret = ssa_csr_write(out_file, num_rows, num_cols,
+            out_matrix.row_offsets, out_matrix.column_ids, out_matrix.values,
+            delta_encode_ids);
+
+        if(ret != 0)
+        {
+            std::cerr << "ssa_csr_write failed.\n";
+            ssa_error_clear();
+            return 1;
+        }
+
+        return 0;
+    }
+
     std::ofstream os(out_file);
     os.exceptions(std::ofstream::failbit | std::ofstream::badbit);
     os.precision(std::numeric_limits<scalar_type>::digits10);
@@ -172,7 +193,7 @@ int main(int argc, char* argv[])
     if(argc < 9)
     {
         std::cerr << argv[0] << ": Insufficient number of arguments." << std::endl;
-        std::cerr << "Need in_file out_file value_type num_rows num_cols sparsity_ratio sparsity_norm_p max_num_bins" << std::endl;
+        std::cerr << "Need in_file out_file value_type num_rows num_cols sparsity_ratio sparsity_norm_p max_num_bins [out_format]" << std::endl;
         exit(1);
     }
 
@@ -184,6 +205,15 @@ int main(int argc, char* argv[])
     const char* ratio_str    = argv[6];
     const char* norm_p_str   = argv[7];
     const char* nbins_str    = argv[8];
+    const char* out_format   = argc > 9 ? argv[9] : "text";
+
+    if(strcmp(out_format, "text") &&
+       strcmp(out_format, "binary") &&
+       strcmp(out_format, "binary_delta"))
+    {
+        std::cerr << "Bad argument for out_format." << std::endl;
+        exit(1);
+    }
 
     std::size_t num_rows = atoi(num_rows_str);
     std::size_t num_cols = atoi(num_cols_str);
@@ -198,22 +228,22 @@ int main(int argc, char* argv[])
         if(!strcmp(type_str, "double"))
         {
             ret = ssa_file_io<double, double>(in_file, num_rows, num_cols,
-                ratio, norm_p, nbins, out_file);
+                ratio, norm_p, nbins, out_file, out_format);
         }
         else if(!strcmp(type_str, "float"))
         {
             ret = ssa_file_io<float, float>(in_file, num_rows, num_cols,
-                static_cast<float>(ratio), static_cast<float>(norm_p), nbins, out_file);
+                static_cast<float>(ratio), static_cast<float>(norm_p), nbins, out_file, out_format);
         }
         else if(!strcmp(type_str, "complex_double"))
         {
             ret = ssa_file_io< std::complex<double>, double>(in_file, num_rows, num_cols,
-                ratio, norm_p, nbins, out_file);
+                ratio, norm_p, nbins, out_file, out_format);
         }
         else if(!strcmp(type_str, "complex_float"))
         {
             ret = ssa_file_io< std::complex<float>, float>(in_file, num_rows, num_cols,
-                static_cast<float>(ratio), static_cast<float>(norm_p), nbins, out_file);
+                static_cast<float>(ratio), static_cast<float>(norm_p), nbins, out_file, out_format);
         }
         else
         {
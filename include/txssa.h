@@ -59,6 +59,10 @@ http://www.txcorp.com
 
 /* -------------------------------------------------------------------------- */
 
+#include <stddef.h> /* ptrdiff_t */
+
+/* -------------------------------------------------------------------------- */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -223,6 +227,12 @@ TXSSA_API void ssa_c_csr_deallocate(struct ssa_c_csr* matrix);
 
 /* If type is unknown, use ssa_matrix_type_general.                           */
 
+/* For ssa_matrix_type_circulant, A(i,j) = c[(i - j) mod n] for the first
+   column c of A.  ssa_matrix_type_skew_circulant is the same but with the
+   strict upper triangle negated.  For these two types, pinv and the other
+   dense matrices are computed from the first column of A using the FFT in
+   O(n log n) instead of O(n^3), and the rest of A is not used for that.  */
+
 enum ssa_matrix_type
 {
     /* Do not change the order. */
@@ -234,11 +244,167 @@ enum ssa_matrix_type
     ssa_matrix_type_hermitian,
     ssa_matrix_type_skew_hermitian,
     ssa_matrix_type_complex_symmetric,
+    ssa_matrix_type_circulant,
+    ssa_matrix_type_skew_circulant,
     ssa_matrix_type_num_types
 };
 
 /* -------------------------------------------------------------------------- */
 
+/* Methods to divide matrix values into bins (see max_num_bins).  Negative
+   and positive values (of real and imaginary parts separately) are binned
+   separately, and zeros have their own bin.
+
+   ssa_binning_method_uniform:  Bins of equal width (default).
+   ssa_binning_method_quantile: Bins with nearly equal number of values.
+   ssa_binning_method_kmeans:   1-D k-means clusters of log|value|.
+
+   For skewed distributions of values, uniform binning leaves many bins empty
+   or nearly empty.  The other methods can reach the same accuracy with a
+   smaller max_num_bins, and hence a smaller least-squares system, at the cost
+   of sorting the values. */
+
+enum ssa_binning_method
+{
+    ssa_binning_method_uniform,
+    ssa_binning_method_quantile,
+    ssa_binning_method_kmeans,
+    ssa_binning_method_num_methods
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Methods for the pseudo-inverse of the input matrix.  Circulant and
+   skew-circulant types always use their FFT based pseudo-inverse.
+
+   ssa_pinv_method_qr:         Column pivoted QR.  Cost O(m n min(m, n)).
+   ssa_pinv_method_randomized: Truncated SVD from a randomized range finder.
+                               Cost O(m n k) for numerical rank k.  Matrices
+                               whose rank is not small compared to min(m, n)
+                               fall back to the pivoted QR. */
+
+enum ssa_pinv_method
+{
+    ssa_pinv_method_qr,
+    ssa_pinv_method_randomized,
+    ssa_pinv_method_num_methods
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Report of the automatic choice of the number of bins.  See
+   ssa_options::tune_num_bins.  The relative misfit is J(X)/J(0), before
+   imposing null spaces, where
+
+   J(X) = 0.5 * (norm((X - A) * pinv(A), 'fro')^2 + norm(pinv(A) * (X - A), 'fro')^2)
+
+   and J(0) = rank(A).  If more than SSA_TUNE_REPORT_MAX_TRIES numbers of bins
+   are tried, only the first ones are reported. */
+
+#define SSA_TUNE_REPORT_MAX_TRIES 32
+
+struct TXSSA_API ssa_tune_report
+{
+    int    chosen_num_bins;
+    int    num_tries;
+    int    num_bins[SSA_TUNE_REPORT_MAX_TRIES];
+    double relative_misfit[SSA_TUNE_REPORT_MAX_TRIES];
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Report of imposing the null spaces of the matrix on the approximation, over
+   all the blocks.  When the number of bins is tuned, the null spaces are
+   imposed only for the chosen number of bins.  For small nullities (up to 10
+   on each side) where num_rows * right nullity or num_cols * left nullity is
+   at most 100, the nearest matrix with the null spaces is found by a direct
+   solve if that is estimated to be cheaper.  Otherwise a scaled iteration is
+   used, stopped when the residuals X * V and U^H * X of the null spaces V and
+   U are below a tolerance, or after iteration_limit iterations.
+   num_not_converged counts the iterations that stopped at the limit.
+   max_residual_ratio is the largest ratio of the final residual norm to the
+   tolerance; values much larger than 1 mean that the approximation does not
+   have the null spaces to working accuracy. */
+
+struct TXSSA_API ssa_null_space_report
+{
+    int    num_imposed;
+    int    num_direct;
+    int    num_not_converged;
+    double total_iterations;
+    int    max_iterations;
+    int    iteration_limit;
+    double max_residual_ratio;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Options for the APIs with suffix _opt.  Always initialize an object with
+   ssa_options_default and then change the members of interest, since members
+   may be added in the future. */
+
+struct TXSSA_API ssa_options
+{
+    /* 0 => approximate the matrix as a whole (default).
+       1 => find independent diagonal blocks and approximate each separately
+       (in parallel if the library is built with OpenMP) with its own pinv,
+       pattern, and binning.  Blocks are the connected components of the rows
+       and columns linked by entries whose absolute value is larger than
+       block_tolerance times the largest absolute value in the matrix.  For
+       matrix types with symmetric pattern, blocks are principal submatrices.
+       Entries outside the blocks are not part of the approximation.  Without
+       binning and with block_tolerance 0, the result is the same as for the
+       whole matrix, but the cost is the sum of the costs of the blocks. */
+    int    decompose_blocks;
+    double block_tolerance;
+
+    /* One of enum ssa_binning_method.  Default is ssa_binning_method_uniform. */
+    int    binning_method;
+
+    /* 0 => use max_num_bins bins (default).
+       1 => choose the number of bins automatically, up to max_num_bins, which
+       must be at least 2.  Numbers of bins 2, 4, 8, ... are tried in turn,
+       reusing the pseudo-inverse, the pattern, and the Gram matrices.  Trying
+       stops at max_num_bins, when the relative misfit (see ssa_tune_report)
+       improves by at most tune_tolerance times its previous value, or when
+       more than tune_time_budget seconds of wall time have passed (if
+       tune_time_budget > 0).  The result with the least misfit is returned.
+       If tune_report is not null, it is filled, except with decompose_blocks,
+       in which case each block is tuned separately. */
+    int    tune_num_bins;
+    double tune_tolerance;
+    double tune_time_budget;
+    struct ssa_tune_report* tune_report;
+
+    /* If not null, filled when the null spaces are imposed.  See
+       ssa_null_space_report. */
+    struct ssa_null_space_report* null_space_report;
+
+    /* One of enum ssa_pinv_method.  Default is ssa_pinv_method_qr.  For
+       ssa_pinv_method_randomized, singular values at most pinv_rank_tolerance
+       times the largest one are treated as zero (0 => the default of the QR,
+       a small multiple of the machine precision), and the range finder uses
+       pinv_oversampling (default 10) columns beyond the rank. */
+    int    pinv_method;
+    double pinv_rank_tolerance;
+    int    pinv_oversampling;
+
+    /* If not null, an existing directory where the pseudo-inverse, the null
+       spaces, and the Gram matrices of the pseudo-inverse are kept, in one
+       file per matrix (per block with decompose_blocks).  Files are named by a
+       hash of the values of the matrix, its type, impose_null_spaces, and the
+       pinv options.  When the same matrix is approximated again, by this or
+       another process, the file is mapped into memory instead of recomputing
+       them.  Files are in the native byte order, and are ignored on a
+       platform with a different one.  Nothing is ever removed from the
+       directory. */
+    const char* cache_directory;
+};
+
+TXSSA_API int ssa_options_default(struct ssa_options* options);
+
+/* -------------------------------------------------------------------------- */
+
 /* Double precision real APIs. */
 
 /* User-given pattern */
@@ -415,6 +581,580 @@ TXSSA_API int ssa_c_ids(
 
 /* -------------------------------------------------------------------------- */
 
+/* Same as ssa_[dszc]_lpn, with additional options. */
+
+TXSSA_API int ssa_d_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_d_csr*         out_matrix);
+
+TXSSA_API int ssa_s_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_s_csr*         out_matrix);
+
+TXSSA_API int ssa_z_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_z_csr*         out_matrix);
+
+TXSSA_API int ssa_c_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_c_csr*         out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* User-given sparse matrix in CSR form, instead of a dense one, and parameters
+   for computing L_p norm based matrix.  Column ids must be sorted in each
+   row.  The output pattern is a subset of the input pattern.  Only the
+   pseudo-inverse computation uses a dense copy of the matrix.  For the complex
+   APIs, values has interleaved real and imaginary parts. */
+
+TXSSA_API int ssa_d_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const double*        values,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_d_csr*    out_matrix);
+
+TXSSA_API int ssa_s_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const float*         values,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_s_csr*    out_matrix);
+
+TXSSA_API int ssa_z_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const double*        values,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_z_csr*    out_matrix);
+
+TXSSA_API int ssa_c_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const float*         values,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_c_csr*    out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Binary file output and input of CSR data.                                  */
+
+/* Write row_offsets, column_ids, and values with a versioned binary header.
+   Much smaller and faster than text.  If delta_encode_ids is non-zero, column
+   ids are stored in a compressed form instead of as raw ints.  The matrix can
+   come from any API, for example ssa_d_lpn, or be filled by the user. */
+
+TXSSA_API int ssa_d_csr_write(const char* file_name, int num_rows, int num_cols, const struct ssa_d_csr* matrix, int delta_encode_ids);
+TXSSA_API int ssa_s_csr_write(const char* file_name, int num_rows, int num_cols, const struct ssa_s_csr* matrix, int delta_encode_ids);
+TXSSA_API int ssa_z_csr_write(const char* file_name, int num_rows, int num_cols, const struct ssa_z_csr* matrix, int delta_encode_ids);
+TXSSA_API int ssa_c_csr_write(const char* file_name, int num_rows, int num_cols, const struct ssa_c_csr* matrix, int delta_encode_ids);
+
+/* Read a file written by the corresponding write API.  The file is mapped
+   into memory and row_offsets and values (and column_ids if not delta
+   encoded) point into the mapping, without any copy.  Writing to the arrays
+   does not modify the file.  Call the deallocate API when done. */
+
+TXSSA_API int ssa_d_csr_read(const char* file_name, int* num_rows, int* num_cols, struct ssa_d_csr* out_matrix);
+TXSSA_API int ssa_s_csr_read(const char* file_name, int* num_rows, int* num_cols, struct ssa_s_csr* out_matrix);
+TXSSA_API int ssa_z_csr_read(const char* file_name, int* num_rows, int* num_cols, struct ssa_z_csr* out_matrix);
+TXSSA_API int ssa_c_csr_read(const char* file_name, int* num_rows, int* num_cols, struct ssa_c_csr* out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Plans for sequences of matrices that differ by low-rank corrections.       */
+
+/* A plan keeps a copy of the matrix, its pseudo-inverse, its null spaces, and
+   the Gram matrices of the pseudo-inverse.  ssa_*_plan_update changes the
+   matrix A of the plan to A + U * V^H, for U of size num_rows x rank and V of
+   size num_cols x rank, and updates the pseudo-inverse and the Gram matrices
+   with the Sherman-Morrison-Woodbury formula in O(num_rows * num_cols * rank)
+   time, instead of the O(num_rows * num_cols * min(num_rows, num_cols)) of a
+   new pivoted QR.  If the correction changes the rank or the null spaces of
+   A, everything is computed again from the new A.  That is also done for
+   circulant and skew-circulant types, and after a number of updates in a row,
+   so that rounding errors do not accumulate.  num_updates and num_recomputes
+   count the calls of ssa_*_plan_update by outcome.  The correction must keep A
+   of the matrix type given to ssa_*_plan_create.
+
+   The pinv options are taken from the options given to ssa_*_plan_create.
+   ssa_*_plan_lpn is the same as ssa_*_lpn_opt for the current A, except that
+   decompose_blocks and cache_directory are not used, and that the iterative
+   null space imposition starts from the Lagrange multipliers of the previous
+   ssa_*_plan_lpn call.  For nearby matrices that saves iterations, and the
+   result may differ from that of ssa_*_lpn_opt within the tolerance of the
+   iteration.  If ssa_*_plan_update
+   fails, only ssa_*_plan_deallocate may be called for the plan.  Call it when
+   done. */
+
+struct TXSSA_API ssa_d_plan
+{
+    int         num_rows;
+    int         num_cols;
+    int         num_updates;
+    int         num_recomputes;
+    const void* reserved;
+};
+
+struct TXSSA_API ssa_s_plan
+{
+    int         num_rows;
+    int         num_cols;
+    int         num_updates;
+    int         num_recomputes;
+    const void* reserved;
+};
+
+/*
+(real, imag) pairs, cast to a suitable complex scalar supported in the
+ calling language.
+*/
+struct TXSSA_API ssa_z_plan
+{
+    int         num_rows;
+    int         num_cols;
+    int         num_updates;
+    int         num_recomputes;
+    const void* reserved;
+};
+
+/*
+(real, imag) pairs, cast to a suitable complex scalar supported in the
+ calling language.
+*/
+struct TXSSA_API ssa_c_plan
+{
+    int         num_rows;
+    int         num_cols;
+    int         num_updates;
+    int         num_recomputes;
+    const void* reserved;
+};
+
+TXSSA_API int ssa_d_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_d_plan*        out_plan);
+
+TXSSA_API int ssa_d_plan_update(
+    struct ssa_d_plan* plan,
+    int                rank,
+    const double*      U_col_values,
+    int                U_col_leading_dim,
+    const double*      V_col_values,
+    int                V_col_leading_dim);
+
+TXSSA_API int ssa_d_plan_lpn(
+    struct ssa_d_plan*        plan,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_d_csr*         out_matrix);
+
+TXSSA_API void ssa_d_plan_deallocate(struct ssa_d_plan* plan);
+
+TXSSA_API int ssa_s_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_s_plan*        out_plan);
+
+TXSSA_API int ssa_s_plan_update(
+    struct ssa_s_plan* plan,
+    int                rank,
+    const float*       U_col_values,
+    int                U_col_leading_dim,
+    const float*       V_col_values,
+    int                V_col_leading_dim);
+
+TXSSA_API int ssa_s_plan_lpn(
+    struct ssa_s_plan*        plan,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_s_csr*         out_matrix);
+
+TXSSA_API void ssa_s_plan_deallocate(struct ssa_s_plan* plan);
+
+TXSSA_API int ssa_z_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_z_plan*        out_plan);
+
+TXSSA_API int ssa_z_plan_update(
+    struct ssa_z_plan* plan,
+    int                rank,
+    const double*      U_col_values,
+    int                U_col_leading_dim,
+    const double*      V_col_values,
+    int                V_col_leading_dim);
+
+TXSSA_API int ssa_z_plan_lpn(
+    struct ssa_z_plan*        plan,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_z_csr*         out_matrix);
+
+TXSSA_API void ssa_z_plan_deallocate(struct ssa_z_plan* plan);
+
+TXSSA_API int ssa_c_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_c_plan*        out_plan);
+
+TXSSA_API int ssa_c_plan_update(
+    struct ssa_c_plan* plan,
+    int                rank,
+    const float*       U_col_values,
+    int                U_col_leading_dim,
+    const float*       V_col_values,
+    int                V_col_leading_dim);
+
+TXSSA_API int ssa_c_plan_lpn(
+    struct ssa_c_plan*        plan,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_c_csr*         out_matrix);
+
+TXSSA_API void ssa_c_plan_deallocate(struct ssa_c_plan* plan);
+
+/* -------------------------------------------------------------------------- */
+
+/* 64-bit index APIs.                                                         */
+
+/* The APIs above use int for sizes, leading dimensions, row offsets, column
+   ids, and max_num_bins.  The APIs below, with suffix 64, are otherwise the
+   same but use ssa_index64 instead.  It is ptrdiff_t, which is 64 bits wide
+   on 64-bit platforms, so that more than 2^31 - 1 non-zeros or a larger
+   leading dimension can be used.  Output of ssa_*_lpn64, ssa_*_ids64, and
+   ssa_*_csr_read64 must be deallocated with ssa_*_csr_deallocate64. */
+
+typedef ptrdiff_t ssa_index64;
+
+struct TXSSA_API ssa_d_csr64
+{
+    ssa_index64* row_offsets;
+    ssa_index64* column_ids;
+    double*      values;
+    const void*  reserved;
+};
+
+struct TXSSA_API ssa_s_csr64
+{
+    ssa_index64* row_offsets;
+    ssa_index64* column_ids;
+    float*       values;
+    const void*  reserved;
+};
+
+/*
+(real, imag) pairs, cast to a suitable complex scalar supported in the
+ calling language.
+*/
+struct TXSSA_API ssa_z_csr64
+{
+    ssa_index64* row_offsets;
+    ssa_index64* column_ids;
+    double*      values;
+    const void*  reserved;
+};
+
+/*
+(real, imag) pairs, cast to a suitable complex scalar supported in the
+ calling language.
+*/
+struct TXSSA_API ssa_c_csr64
+{
+    ssa_index64* row_offsets;
+    ssa_index64* column_ids;
+    float*       values;
+    const void*  reserved;
+};
+
+/* -------------------------------------------------------------------------- */
+
+TXSSA_API void ssa_d_csr_deallocate64(struct ssa_d_csr64* matrix);
+TXSSA_API void ssa_s_csr_deallocate64(struct ssa_s_csr64* matrix);
+TXSSA_API void ssa_z_csr_deallocate64(struct ssa_z_csr64* matrix);
+TXSSA_API void ssa_c_csr_deallocate64(struct ssa_c_csr64* matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Double precision real 64-bit index APIs. */
+
+/* User-given pattern */
+TXSSA_API int ssa_d_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const double*        col_values,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    double*              out_row_values);
+
+/* User-given parameters for computing L_p norm based matrix. */
+TXSSA_API int ssa_d_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const double*        col_values,
+    ssa_index64          col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_d_csr64*  out_matrix);
+
+/* Compute the row-offsets and column-ids only, not the values. */
+/* The space for values is allocated with the appropriate size. */
+TXSSA_API int ssa_d_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const double*        col_values,
+    ssa_index64          col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_d_csr64*  out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Single precision real 64-bit index APIs. */
+
+/* User-given pattern */
+TXSSA_API int ssa_s_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const float*         col_values,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    float*               out_row_values);
+
+/* User-given parameters for computing L_p norm based matrix. */
+TXSSA_API int ssa_s_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const float*         col_values,
+    ssa_index64          col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_s_csr64*  out_matrix);
+
+/* Compute the row-offsets and column-ids only, not the values. */
+/* The space for values is allocated with the appropriate size. */
+TXSSA_API int ssa_s_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const float*         col_values,
+    ssa_index64          col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_s_csr64*  out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Double precision complex 64-bit index APIs. */
+
+/* User-given pattern */
+TXSSA_API int ssa_z_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const double*        col_values,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    double*              out_row_values);
+
+/* User-given parameters for computing L_p norm based matrix. */
+TXSSA_API int ssa_z_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const double*        col_values,
+    ssa_index64          col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_z_csr64*  out_matrix);
+
+/* Compute the row-offsets and column-ids only, not the values. */
+/* The space for values is allocated with the appropriate size. */
+TXSSA_API int ssa_z_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const double*        col_values,
+    ssa_index64          col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_z_csr64*  out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Single precision complex 64-bit index APIs. */
+
+/* User-given pattern */
+TXSSA_API int ssa_c_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const float*         col_values,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    float*               out_row_values);
+
+/* User-given parameters for computing L_p norm based matrix. */
+TXSSA_API int ssa_c_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const float*         col_values,
+    ssa_index64          col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    ssa_index64          max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_c_csr64*  out_matrix);
+
+/* Compute the row-offsets and column-ids only, not the values. */
+/* The space for values is allocated with the appropriate size. */
+TXSSA_API int ssa_c_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
+    const float*         col_values,
+    ssa_index64          col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_c_csr64*  out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
+/* Binary file output and input of CSR data with 64-bit indices.  Files
+   written with int and 64-bit indices are not interchangeable. */
+
+TXSSA_API int ssa_d_csr_write64(const char* file_name, ssa_index64 num_rows, ssa_index64 num_cols, const struct ssa_d_csr64* matrix, int delta_encode_ids);
+TXSSA_API int ssa_s_csr_write64(const char* file_name, ssa_index64 num_rows, ssa_index64 num_cols, const struct ssa_s_csr64* matrix, int delta_encode_ids);
+TXSSA_API int ssa_z_csr_write64(const char* file_name, ssa_index64 num_rows, ssa_index64 num_cols, const struct ssa_z_csr64* matrix, int delta_encode_ids);
+TXSSA_API int ssa_c_csr_write64(const char* file_name, ssa_index64 num_rows, ssa_index64 num_cols, const struct ssa_c_csr64* matrix, int delta_encode_ids);
+
+TXSSA_API int ssa_d_csr_read64(const char* file_name, ssa_index64* num_rows, ssa_index64* num_cols, struct ssa_d_csr64* out_matrix);
+TXSSA_API int ssa_s_csr_read64(const char* file_name, ssa_index64* num_rows, ssa_index64* num_cols, struct ssa_s_csr64* out_matrix);
+TXSSA_API int ssa_z_csr_read64(const char* file_name, ssa_index64* num_rows, ssa_index64* num_cols, struct ssa_z_csr64* out_matrix);
+TXSSA_API int ssa_c_csr_read64(const char* file_name, ssa_index64* num_rows, ssa_index64* num_cols, struct ssa_c_csr64* out_matrix);
+
+/* -------------------------------------------------------------------------- */
+
 /* Error API.  Provides pointers to C strings corresponding to errors.        */
 /* Each non ssa_error_* API clears the stack when called.                     */
 
@@ -591,6 +1331,123 @@ TXSSA_API int ssa_ids(
 
 // -----------------------------------------------------------------------------
 
+// Same as ssa_lpn, with additional options.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+TXSSA_API int ssa_lpn(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    value_type           sparsity_ratio,
+    value_type           sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    const ssa_options&   options,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix);
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+TXSSA_API int ssa_lpn(
+    index_type                       num_rows,
+    index_type                       num_cols,
+    const std::complex<scalar_type>* col_values,
+    index_type                       col_leading_dim,
+    scalar_type                      sparsity_ratio,
+    scalar_type                      sparsity_norm_p,
+    offset_type                      max_num_bins,
+    bool                             impose_null_spaces,
+    enum ssa_matrix_type             matrix_type,
+    const ssa_options&               options,
+    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix);
+
+// -----------------------------------------------------------------------------
+
+// User-given sparse matrix in CSR form.  See the C API for details.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+TXSSA_API int ssa_lpn_csr(
+    index_type           num_rows,
+    index_type           num_cols,
+    const offset_type*   row_offsets,
+    const index_type*    column_ids,
+    const value_type*    values,
+    value_type           sparsity_ratio,
+    value_type           sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix);
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+TXSSA_API int ssa_lpn_csr(
+    index_type                       num_rows,
+    index_type                       num_cols,
+    const offset_type*               row_offsets,
+    const index_type*                column_ids,
+    const std::complex<scalar_type>* values,
+    scalar_type                      sparsity_ratio,
+    scalar_type                      sparsity_norm_p,
+    offset_type                      max_num_bins,
+    bool                             impose_null_spaces,
+    enum ssa_matrix_type             matrix_type,
+    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix);
+
+// -----------------------------------------------------------------------------
+
+// Binary file output and input of CSR data.  value_type can be real or
+// complex.  See the C API for details.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+TXSSA_API int ssa_csr_write(
+    const char*          file_name,
+    index_type           num_rows,
+    index_type           num_cols,
+    const offset_type*   row_offsets,
+    const index_type*    column_ids,
+    const value_type*    values,
+    bool                 delta_encode_ids);
+
+// Previous data in out_matrix, if any, is released on success.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+TXSSA_API int ssa_csr_read(
+    const char*          file_name,
+    index_type&          num_rows,
+    index_type&          num_cols,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix);
+
+// -----------------------------------------------------------------------------
+
 #endif /* __cplusplus */
 
 /* -------------------------------------------------------------------------- */
@@ -213,6 +213,29 @@ struct std_utils_separated_min_max
         }
     }
 
+    // Combine with min/max of another sequence that has the same separated_at.
+    // The result is as if both sequences were seen by one object, which lets
+    // disjoint parts of a sequence be processed independently.
+    void merge(const std_utils_separated_min_max& other)
+    {
+        assert(other.separated_at == separated_at);
+
+        if(other.any_at_separation())
+            use(other.separated_at);
+
+        if(other.any_in_strict_left())
+        {
+            use(other.min_l);
+            use(other.max_l);
+        }
+
+        if(other.any_in_strict_right())
+        {
+            use(other.min_r);
+            use(other.max_r);
+        }
+    }
+
     // Was any value seen on the left side (including separated_at)
     bool any_in_left() const
     {
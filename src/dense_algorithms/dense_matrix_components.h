@@ -0,0 +1,223 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_MATRIX_COMPONENTS_H
+#define DENSE_MATRIX_COMPONENTS_H
+
+// -----------------------------------------------------------------------------
+
+#include "math/precision_traits.h"
+#include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <string>
+#include <cmath>       // std::abs
+#include <cstddef>
+#include <stdexcept>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Find independent blocks of a dense matrix.  These are the
+// connected components of the bipartite graph with a node for each row and
+// each column and an edge between row i and column j if |A(i,j)| > tolerance.
+// After permuting rows and columns by component, the matrix is block diagonal
+// except for entries not larger than tolerance.
+//
+// If symmetric is true (square matrices only), row i and column i are also
+// connected.  Then each block is a principal submatrix and keeps properties
+// like Hermitian-ness.
+//
+// A row or a column with no entry larger than tolerance is a component by
+// itself.
+// -----------------------------------------------------------------------------
+
+// Union-find with path halving.  Root is the smallest id in the set.
+
+template<typename index_type>
+index_type dense_matrix_components_find(
+    index_type* parent,
+    index_type i)
+{
+    while(parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+
+    return i;
+}
+
+template<typename index_type>
+void dense_matrix_components_union(
+    index_type* parent,
+    index_type i,
+    index_type j)
+{
+    i = dense_matrix_components_find(parent, i);
+    j = dense_matrix_components_find(parent, j);
+
+    if(i < j)
+        parent[j] = i;
+    else if(j < i)
+        parent[i] = j;
+}
+
+// -----------------------------------------------------------------------------
+
+// Components are numbered 0, 1, ... in the order in which they are first
+// seen, rows first.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_components(
+    index_type        num_rows,
+    index_type        num_cols,
+    const value_type* A_col_values,
+    index_type        A_col_leading_dim,
+    typename precision_traits<value_type>::scalar tolerance,
+    bool              symmetric,
+    index_type*       row_component,   // [out] num_rows
+    index_type*       col_component,   // [out] num_cols
+    index_type&       num_components)  // [out]
+{
+    bool success =
+        A_col_values &&
+        num_rows <= A_col_leading_dim &&
+        0 <= tolerance &&
+        (num_rows == num_cols || !symmetric) &&
+        (row_component || num_rows == 0) &&
+        (col_component || num_cols == 0);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_components: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    // Rows are nodes [0, num_rows) and columns are [num_rows, num_rows + num_cols).
+
+    std::vector<index_type> parent;
+
+    try
+    {
+        parent.resize(std::size_t(num_rows) + std::size_t(num_cols));
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_components: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    for(std::size_t i = 0; i < parent.size(); ++i)
+        parent[i] = index_type(i);
+
+    if(num_rows == 0 || num_cols == 0)
+    {
+        // Nothing to connect.
+    }
+    else
+    {
+        index_type* p = &parent.front();
+
+        const value_type* A_j = A_col_values; // beginning of jth column.
+
+        for(index_type j = 0; j < num_cols; ++j)
+        {
+            const index_type col_node = index_type(num_rows + j);
+
+            if(symmetric)
+                dense_matrix_components_union(p, j, col_node);
+
+            for(index_type i = 0; i < num_rows; ++i)
+            {
+                if(std::abs(A_j[i]) > tolerance)
+                    dense_matrix_components_union(p, i, col_node);
+            }
+
+            A_j += A_col_leading_dim;
+        }
+    }
+
+    // Roots are the smallest ids, so a root is always seen before the other
+    // members of its set and numbering in a single pass works.
+
+    num_components = 0;
+
+    for(std::size_t i = 0; i < parent.size(); ++i)
+    {
+        const index_type root = dense_matrix_components_find(&parent.front(), index_type(i));
+
+        index_type& component = (i < std::size_t(num_rows)) ?
+            row_component[i] : col_component[i - std::size_t(num_rows)];
+
+        if(root == index_type(i))
+        {
+            component = num_components++;
+        }
+        else
+        {
+            component = (std::size_t(root) < std::size_t(num_rows)) ?
+                row_component[root] : col_component[root - num_rows];
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_MATRIX_COMPONENTS_H
@@ -57,6 +57,10 @@ http://www.txcorp.com
 #include "blas_wrap/dense_vector_utils.h"
 #include "math/vector_utils.h"
 #include "internal_api_error/internal_api_error.h"
+#include <algorithm>   // std::{swap, swap_ranges}
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
 #include <cassert>
 
 // -----------------------------------------------------------------------------
@@ -214,6 +218,149 @@ bool dense_matrix_permute_cols(
 
 // -----------------------------------------------------------------------------
 
+// In-place versions of dense_matrix_permute_rows and dense_matrix_permute_cols.
+// Each cycle of the permutation is walked by swapping its rows (columns) with
+// the first one, so no second matrix is needed.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_permute_rows_in_place(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    const index_type* pivots,   // size num_rows
+    index_type  pivots_base)    // 1 if coming from LAPACK.
+{
+    bool success =
+        (A_col_values || num_rows == 0 || num_cols == 0) &&
+        (pivots || num_rows == 0) &&
+        num_rows <= A_col_leading_dim;
+
+    std::vector<bool> visited;
+
+    try
+    {
+        visited.resize(num_rows, false);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_permute_rows_in_place: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    if(success)
+    {
+        // pivots[j] = i + pivots_base iff P(i,j) = delta_ij
+
+        for(index_type start = 0; start < num_rows; ++start)
+        {
+            if(visited[start])
+                continue;
+
+            visited[start] = true;
+
+            for(index_type i = index_type(pivots[start] - pivots_base); i != start;
+                i = index_type(pivots[i] - pivots_base))
+            {
+                assert(i < num_rows && !visited[i]);
+
+                visited[i] = true;
+
+                value_type* start_it = A_col_values + start;
+                value_type* i_it     = A_col_values + i;
+
+                for(index_type col = 0; col < num_cols; ++col)
+                {
+                    std::swap(*start_it, *i_it);
+
+                    start_it += A_col_leading_dim;
+                    i_it     += A_col_leading_dim;
+                }
+            }
+        }
+    }
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_permute_rows_in_place: Error.");
+
+    return success;
+}
+
+template<typename index_type, typename value_type>
+bool dense_matrix_permute_cols_in_place(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    const index_type* pivots,   // size num_cols
+    index_type  pivots_base)    // 1 if coming from LAPACK.
+{
+    bool success =
+        (A_col_values || num_rows == 0 || num_cols == 0) &&
+        (pivots || num_cols == 0) &&
+        num_rows <= A_col_leading_dim;
+
+    std::vector<bool> visited;
+
+    try
+    {
+        visited.resize(num_cols, false);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_permute_cols_in_place: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    if(success)
+    {
+        // pivots[j] = i + pivots_base iff P(i,j) = delta_ij
+
+        for(index_type start = 0; start < num_cols; ++start)
+        {
+            if(visited[start])
+                continue;
+
+            visited[start] = true;
+
+            value_type* start_col = A_col_values + std::size_t(start) * std::size_t(A_col_leading_dim);
+
+            for(index_type j = index_type(pivots[start] - pivots_base); j != start;
+                j = index_type(pivots[j] - pivots_base))
+            {
+                assert(j < num_cols && !visited[j]);
+
+                visited[j] = true;
+
+                std::swap_ranges(
+                    start_col, start_col + num_rows,
+                    A_col_values + std::size_t(j) * std::size_t(A_col_leading_dim));
+            }
+        }
+    }
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_permute_cols_in_place: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
 // Overwrite a square A by its row and column permutation.  Use given
 // block size for row permutations.
 
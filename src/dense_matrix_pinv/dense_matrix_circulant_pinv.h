@@ -0,0 +1,511 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_MATRIX_CIRCULANT_PINV_H
+#define DENSE_MATRIX_CIRCULANT_PINV_H
+
+// -----------------------------------------------------------------------------
+
+#include "dense_vectors/dense_vectors.h"
+#include "math/fft.h"
+#include "math/precision_traits.h"
+#include "internal_api_error/internal_api_error.h"
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <limits>
+#include <algorithm> // std::max
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Pseudo-inverse, null spaces, and Gram matrix of circulant and
+// skew-circulant matrices in O(n log n) using the FFT.
+//
+// A circulant matrix C with first column c has C(i,j) = c[(i - j) mod n].  A
+// skew-circulant matrix has the same entries but negated in the strict upper
+// triangle.  A circulant matrix is diagonalized by the DFT and its eigenvalues
+// are the DFT of c.  A skew-circulant matrix S is D^-1 C D, where D is the
+// diagonal matrix with D(j,j) = exp(pi i j / n) and C is the circulant matrix
+// with first column D c.  So in both cases, a function of the matrix that
+// preserves the eigenvectors (pinv, A^H A) is a matrix of the same kind, and
+// only its first column needs to be computed.  Only the first column of the
+// input is used.
+// -----------------------------------------------------------------------------
+
+template<typename scalar_type>
+inline void dense_matrix_circulant_assign(
+    const std::complex<scalar_type>& a,
+    scalar_type& b)
+{
+    b = a.real();
+}
+
+template<typename scalar_type>
+inline void dense_matrix_circulant_assign(
+    const std::complex<scalar_type>& a,
+    std::complex<scalar_type>& b)
+{
+    b = a;
+}
+
+template<typename scalar_type>
+inline bool dense_matrix_circulant_is_real(scalar_type)
+{
+    return true;
+}
+
+template<typename scalar_type>
+inline bool dense_matrix_circulant_is_real(std::complex<scalar_type>)
+{
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+// eigenvalues is resized to size.
+template<typename index_type, typename value_type>
+bool dense_matrix_circulant_eigenvalues(
+    index_type        size,
+    const value_type* first_col,
+    bool              is_skew,
+    std::vector< std::complex<typename precision_traits<value_type>::scalar> >& eigenvalues)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const std::size_t n = std::size_t(size);
+
+    try
+    {
+        eigenvalues.resize(n);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_circulant_eigenvalues: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    for(std::size_t k = 0; k < n; ++k)
+    {
+        eigenvalues[k] = std::complex<scalar_type>(first_col[k]);
+
+        if(is_skew)
+            eigenvalues[k] *= fft_unit_root<scalar_type>(k, n, 1);
+    }
+
+    return fft_in_place(n, size ? &eigenvalues.front() : 0, false);
+}
+
+// Inverse of dense_matrix_circulant_eigenvalues.  eigenvalues is overwritten.
+// For real value_type, the imaginary part (which is zero up to rounding if the
+// eigenvalues come from a real matrix) is dropped.
+template<typename index_type, typename value_type>
+bool dense_matrix_circulant_first_col(
+    index_type  size,
+    std::vector< std::complex<typename precision_traits<value_type>::scalar> >& eigenvalues,
+    bool        is_skew,
+    value_type* first_col)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const std::size_t n = std::size_t(size);
+
+    bool success =
+        eigenvalues.size() == n &&
+        fft_in_place(n, size ? &eigenvalues.front() : 0, true);
+
+    if(success)
+    {
+        for(std::size_t k = 0; k < n; ++k)
+        {
+            std::complex<scalar_type> c = eigenvalues[k];
+
+            if(is_skew)
+                c *= fft_unit_root<scalar_type>(k, n, -1);
+
+            dense_matrix_circulant_assign(c, first_col[k]);
+        }
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "dense_matrix_circulant_first_col: Error.");
+    }
+
+    return success;
+}
+
+// Fill columns 1 to size-1 of A, given its first column.
+template<typename index_type, typename value_type>
+void dense_matrix_circulant_fill(
+    index_type  size,
+    bool        is_skew,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim)
+{
+    const std::size_t lda = std::size_t(A_col_leading_dim);
+
+    for(index_type j = 1; j < size; ++j)
+    {
+        const value_type* A_prev = A_col_values + lda * std::size_t(j - 1);
+        value_type* A_j = A_col_values + lda * std::size_t(j);
+
+        A_j[0] = is_skew ? value_type(-A_prev[size - 1]) : A_prev[size - 1];
+
+        for(index_type i = 1; i < size; ++i)
+            A_j[i] = A_prev[i - 1];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Decide which eigenvalues are treated as zero.  The threshold is the same
+// as the one used for the diagonal of R in the pivoted QR based pinv.  For
+// real matrices, eigenvalues come in conjugate pairs and both members of a
+// pair get the same decision so that real null space bases can be formed.
+template<typename scalar_type>
+std::size_t dense_matrix_circulant_zero_eigenvalues(
+    const std::vector< std::complex<scalar_type> >& eigenvalues,
+    bool is_skew,
+    bool is_real,
+    std::vector<char>& is_zero) // resized by caller
+{
+    const std::size_t n = eigenvalues.size();
+
+    scalar_type max_abs = 0;
+
+    for(std::size_t k = 0; k < n; ++k)
+        max_abs = std::max(max_abs, std::abs(eigenvalues[k]));
+
+    const scalar_type fuzz = 100; // MAGIC CONSTANT
+
+    const scalar_type threshold = fuzz * scalar_type(n) *
+        std::numeric_limits<scalar_type>::epsilon() * max_abs;
+
+    std::size_t num_zero = 0;
+
+    for(std::size_t k = 0; k < n; ++k)
+    {
+        scalar_type abs_val = std::abs(eigenvalues[k]);
+
+        if(is_real)
+        {
+            const std::size_t partner = (n - k + (is_skew ? 1 : 0)) % n;
+            abs_val = std::max(abs_val, std::abs(eigenvalues[partner]));
+        }
+
+        is_zero[k] = abs_val <= threshold;
+
+        if(is_zero[k])
+            ++num_zero;
+    }
+
+    return num_zero;
+}
+
+// Orthonormal basis of the null space, which for these normal matrices is
+// both the left and the right null space.  Eigenvector k is
+// u_k[j] = exp(pi i j (2k - s) / n) / sqrt(n), with s = 1 for skew-circulant
+// and 0 otherwise.  For real matrices, a conjugate pair (u_k, u_p) is replaced
+// by sqrt(2) times real and imaginary parts of u_k.
+template<typename index_type, typename value_type>
+bool dense_matrix_circulant_null_space(
+    index_type               size,
+    bool                     is_skew,
+    const std::vector<char>& is_zero,
+    std::size_t              num_zero,
+    dense_vectors<index_type, value_type>& null_space)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const std::size_t n = std::size_t(size);
+    const bool is_real = dense_matrix_circulant_is_real(value_type());
+
+    dense_vectors<index_type, value_type> tmp;
+
+    bool success = tmp.allocate(index_type(num_zero), size);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "dense_matrix_circulant_null_space: Error in allocation.");
+        return false;
+    }
+
+    const scalar_type inv_sqrt_n  = scalar_type(1) / std::sqrt(scalar_type(n));
+    const scalar_type sqrt_2      = std::sqrt(scalar_type(2));
+    const std::size_t skew_offset = is_skew ? 2 * n - 1 : 0;
+
+    index_type vec_id = 0;
+
+    for(std::size_t k = 0; k < n; ++k)
+    {
+        if(!is_zero[k])
+            continue;
+
+        const std::size_t partner = (n - k + (is_skew ? 1 : 0)) % n;
+
+        if(is_real && partner < k)
+            continue;
+
+        const std::size_t freq = 2 * k + skew_offset;
+
+        value_type* u = tmp.vec_values() + std::size_t(tmp.leading_dimension()) * std::size_t(vec_id);
+
+        if(!is_real || partner == k)
+        {
+            for(std::size_t j = 0; j < n; ++j)
+                dense_matrix_circulant_assign(
+                    fft_unit_root<scalar_type>(j * freq, n, 1) * inv_sqrt_n, u[j]);
+
+            ++vec_id;
+        }
+        else
+        {
+            value_type* v = u + tmp.leading_dimension();
+
+            for(std::size_t j = 0; j < n; ++j)
+            {
+                const std::complex<scalar_type> z =
+                    fft_unit_root<scalar_type>(j * freq, n, 1) * (sqrt_2 * inv_sqrt_n);
+
+                dense_matrix_circulant_assign(std::complex<scalar_type>(z.real()), u[j]);
+                dense_matrix_circulant_assign(std::complex<scalar_type>(z.imag()), v[j]);
+            }
+
+            vec_id += 2;
+        }
+    }
+
+    assert(std::size_t(vec_id) == num_zero);
+
+    null_space.swap(tmp);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+// Same interface as dense_matrix_qr_pinv_transpose.  A_col_values will be
+// overwritten with pinv(A)'.  Only the first column of A is read.
+template<typename index_type, typename value_type>
+bool dense_matrix_circulant_pinv_transpose(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    bool        is_skew,
+    dense_vectors<index_type, value_type>* lnull,
+    dense_vectors<index_type, value_type>* rnull)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    bool success =
+        num_rows == num_cols &&
+        (A_col_values || num_rows == 0) &&
+        num_rows <= A_col_leading_dim;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_circulant_pinv_transpose: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const index_type size = num_rows;
+
+    if(size == 0)
+    {
+        success =
+            (!rnull || rnull->use_memory(0, 0, index_type(1), 0)) &&
+            (!lnull || lnull->use_memory(0, 0, index_type(1), 0));
+
+        if(!success)
+            internal_api_error_set_last(
+                "dense_matrix_circulant_pinv_transpose: Error 1.");
+
+        assert(success);
+
+        return success;
+    }
+
+    std::vector< std::complex<scalar_type> > eigenvalues;
+    std::vector<char> is_zero;
+
+    success = dense_matrix_circulant_eigenvalues(
+        size, A_col_values, is_skew, eigenvalues);
+
+    if(success)
+    {
+        try
+        {
+            is_zero.resize(std::size_t(size));
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_matrix_circulant_pinv_transpose: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        const std::size_t num_zero = dense_matrix_circulant_zero_eigenvalues(
+            eigenvalues, is_skew, dense_matrix_circulant_is_real(value_type()), is_zero);
+
+        success =
+            (!rnull || dense_matrix_circulant_null_space(
+                size, is_skew, is_zero, num_zero, *rnull))
+            &&
+            (!lnull || dense_matrix_circulant_null_space(
+                size, is_skew, is_zero, num_zero, *lnull));
+
+        // pinv(A)' has eigenvalues conj(1/lambda) on the same eigenvectors.
+
+        for(std::size_t k = 0; k < eigenvalues.size(); ++k)
+        {
+            if(is_zero[k])
+                eigenvalues[k] = 0;
+            else
+                eigenvalues[k] = std::conj(scalar_type(1) / eigenvalues[k]);
+        }
+
+        success = success &&
+            dense_matrix_circulant_first_col(
+                size, eigenvalues, is_skew, A_col_values);
+
+        if(success)
+            dense_matrix_circulant_fill(
+                size, is_skew, A_col_values, A_col_leading_dim);
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "dense_matrix_circulant_pinv_transpose: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// ATA = A' * A, which is of the same kind as A.  Only the first column of A
+// is read.  Both halves of ATA are filled.
+template<typename index_type, typename value_type>
+bool dense_matrix_circulant_ATA(
+    index_type        size,
+    const value_type* A_col_values,
+    bool              is_skew,
+    value_type*       ATA_col_values,
+    index_type        ATA_col_leading_dim)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    bool success =
+        (size == 0 || (A_col_values && ATA_col_values)) &&
+        size <= ATA_col_leading_dim;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_circulant_ATA: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    std::vector< std::complex<scalar_type> > eigenvalues;
+
+    success = dense_matrix_circulant_eigenvalues(
+        size, A_col_values, is_skew, eigenvalues);
+
+    if(success)
+    {
+        for(std::size_t k = 0; k < eigenvalues.size(); ++k)
+            eigenvalues[k] = std::norm(eigenvalues[k]);
+
+        success = dense_matrix_circulant_first_col(
+            size, eigenvalues, is_skew, ATA_col_values);
+
+        if(success)
+            dense_matrix_circulant_fill(
+                size, is_skew, ATA_col_values, ATA_col_leading_dim);
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "dense_matrix_circulant_ATA: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_MATRIX_CIRCULANT_PINV_H
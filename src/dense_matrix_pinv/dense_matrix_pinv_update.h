@@ -0,0 +1,433 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_MATRIX_PINV_UPDATE_H
+#define DENSE_MATRIX_PINV_UPDATE_H
+
+// -----------------------------------------------------------------------------
+
+#include "dense_vectors/dense_vectors.h"
+#include "lapack_wrap/dense_matrix_SVD.h"
+#include "blas_wrap/dense_matrix_mult.h"
+#include "math/complex_types.h"
+#include "math/precision_traits.h"
+#include "internal_api_error/internal_api_error.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>   // std::{min, max}
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Update pinv(A)' and the Gram matrices of pinv(A) for the rank k
+// correction A + U * V^H in O(m n k) time, instead of a new pivoted QR.
+//
+// With P = pinv(A)', if U is in the range of A, V is in the range of A^H, and
+//
+//   C = I + V^H * pinv(A) * U
+//
+// is nonsingular, the Sherman-Morrison-Woodbury formula holds on the ranges,
+// the null spaces do not change, and
+//
+//   pinv(A + U * V^H)' = P - W * Z^H,  W = P * V * inv(C)^H,  Z = P^H * U.
+//
+// P^H * P and P * P^H get the corresponding corrections.  Otherwise the rank
+// or the null spaces change, and nothing is updated.
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename value_type>
+typename precision_traits<value_type>::scalar dense_matrix_pinv_update_norm_sq(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* A_col_values,
+    index_type A_col_leading_dim)
+{
+    typename precision_traits<value_type>::scalar norm_sq = 0;
+
+    for(index_type j = 0; j < num_cols; ++j)
+    {
+        const value_type* A_j = A_col_values + std::size_t(j) * std::size_t(A_col_leading_dim);
+
+        for(index_type i = 0; i < num_rows; ++i)
+            norm_sq += std::abs_square(A_j[i]);
+    }
+
+    return norm_sq;
+}
+
+// -----------------------------------------------------------------------------
+
+// A_norm is the Frobenius norm of A + U * V^H.  P_H_P (num_cols x num_cols)
+// and P_P_H (num_rows x num_rows) are updated if not null.  Returns false only
+// on errors.  updated is false if the rank or the null spaces change, and then
+// nothing is modified.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_pinv_update_transpose(
+    index_type  num_rows,
+    index_type  num_cols,
+    index_type  rank,
+    const value_type* U_col_values,
+    index_type  U_col_leading_dim,
+    const value_type* V_col_values,
+    index_type  V_col_leading_dim,
+    typename precision_traits<value_type>::scalar A_norm,
+    value_type* P_col_values,
+    index_type  P_col_leading_dim,
+    const dense_vectors<index_type, value_type>& lnull,
+    const dense_vectors<index_type, value_type>& rnull,
+    value_type* P_H_P_col_values,
+    index_type  P_H_P_col_leading_dim,
+    value_type* P_P_H_col_values,
+    index_type  P_P_H_col_leading_dim,
+    bool& updated)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    updated = false;
+
+    bool success =
+        0 < rank &&
+        U_col_values && num_rows <= U_col_leading_dim &&
+        V_col_values && num_cols <= V_col_leading_dim &&
+        P_col_values && num_rows <= P_col_leading_dim &&
+        (lnull.num_vecs() == 0 || lnull.vec_size() == num_rows) &&
+        (rnull.num_vecs() == 0 || rnull.vec_size() == num_cols) &&
+        (!P_H_P_col_values || num_cols <= P_H_P_col_leading_dim) &&
+        (!P_P_H_col_values || num_rows <= P_P_H_col_leading_dim);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_pinv_update_transpose: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const std::size_t m = std::size_t(num_rows);
+    const std::size_t n = std::size_t(num_cols);
+    const std::size_t k = std::size_t(rank);
+
+    const index_type num_lnull = lnull.num_vecs();
+    const index_type num_rnull = rnull.num_vecs();
+
+    const value_type one  = value_type(1);
+    const value_type zero = value_type(0);
+
+    const scalar_type fuzz = 100; // MAGIC CONSTANT, as in dense_matrix_qr_pinv_transpose
+    const scalar_type eps = std::numeric_limits<scalar_type>::epsilon();
+
+    std::vector<value_type> L_H_U, R_H_V, P_V, Z, C, C_U, C_VT, W, work;
+    std::vector<scalar_type> C_sing_vals, rwork;
+
+    try
+    {
+        L_H_U.resize(std::max(std::size_t(1), std::size_t(num_lnull) * k));
+        R_H_V.resize(std::max(std::size_t(1), std::size_t(num_rnull) * k));
+        P_V.resize(std::max(m, n) * k);
+        Z.resize(n * k);
+        C.resize(k * k);
+        C_U.resize(k * k);
+        C_VT.resize(k * k);
+        C_sing_vals.resize(k);
+        rwork.resize(dense_matrix_SVD_rwork_size(rank, rank));
+        work.resize(dense_matrix_SVD_lwork(rank, rank, rank, value_type()));
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_pinv_update_transpose: Exception 1. ") + exc.what()));
+
+        return false;
+    }
+
+    // The parts of U and V outside the ranges of A and A^H change the rank
+    // unless they are negligible like the singular values the pivoted QR
+    // treats as zero.
+
+    success =
+        (num_lnull == 0 || dense_matrix_mult(
+            'C', 'N', num_lnull, rank, num_rows,
+            one, lnull.vec_values(), lnull.leading_dimension(),
+            U_col_values, U_col_leading_dim,
+            zero, &L_H_U.front(), num_lnull))
+        &&
+        (num_rnull == 0 || dense_matrix_mult(
+            'C', 'N', num_rnull, rank, num_cols,
+            one, rnull.vec_values(), rnull.leading_dimension(),
+            V_col_values, V_col_leading_dim,
+            zero, &R_H_V.front(), num_rnull));
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_pinv_update_transpose: Error 1.");
+
+        return false;
+    }
+
+    const scalar_type U_norm = std::sqrt(dense_matrix_pinv_update_norm_sq(
+        num_rows, rank, U_col_values, U_col_leading_dim));
+    const scalar_type V_norm = std::sqrt(dense_matrix_pinv_update_norm_sq(
+        num_cols, rank, V_col_values, V_col_leading_dim));
+
+    const scalar_type out_of_range =
+        std::sqrt(dense_matrix_pinv_update_norm_sq(num_lnull, rank, &L_H_U.front(), std::max(num_lnull, index_type(1)))) * V_norm +
+        std::sqrt(dense_matrix_pinv_update_norm_sq(num_rnull, rank, &R_H_V.front(), std::max(num_rnull, index_type(1)))) * U_norm;
+
+    if(fuzz * scalar_type(std::min(m, n)) * eps * A_norm < out_of_range)
+        return true;
+
+    // P_V = P * V (it is reused for the Gram updates), Z = P^H * U, and C = I + V^H * Z.
+
+    success =
+        dense_matrix_mult(
+            'N', 'N', num_rows, rank, num_cols,
+            one, P_col_values, P_col_leading_dim,
+            V_col_values, V_col_leading_dim,
+            zero, &P_V.front(), num_rows)
+        &&
+        dense_matrix_mult(
+            'C', 'N', num_cols, rank, num_rows,
+            one, P_col_values, P_col_leading_dim,
+            U_col_values, U_col_leading_dim,
+            zero, &Z.front(), num_cols)
+        &&
+        dense_matrix_mult(
+            'C', 'N', rank, rank, num_cols,
+            one, V_col_values, V_col_leading_dim,
+            &Z.front(), num_cols,
+            zero, &C.front(), rank);
+
+    for(std::size_t i = 0; i < k; ++i)
+        C[i + i * k] += one;
+
+    success = success &&
+        dense_matrix_SVD(
+            rank, rank,
+            &C.front(), rank,
+            &C_sing_vals.front(),
+            &C_U.front(), rank,
+            &C_VT.front(), rank,
+            &work.front(), work.size(),
+            &rwork.front());
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_pinv_update_transpose: Error 2.");
+
+        return false;
+    }
+
+    // A nearly singular C means that the update cancels part of A.
+    if(C_sing_vals.back() <= fuzz * scalar_type(std::min(m, n)) * eps * C_sing_vals.front())
+        return true;
+
+    // W = P_V * inv(C)^H = P_V * C_U * inv(S) * C_VT.  C_U gets C_U * inv(S).
+
+    for(std::size_t j = 0; j < k; ++j)
+    {
+        const value_type inv_s = one / C_sing_vals[j];
+
+        for(std::size_t i = 0; i < k; ++i)
+            C_U[i + j * k] *= inv_s;
+    }
+
+    try
+    {
+        W.resize(m * k);
+        work.resize(std::max(m, n) * k);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_pinv_update_transpose: Exception 2. ") + exc.what()));
+
+        return false;
+    }
+
+    success =
+        dense_matrix_mult(
+            'N', 'N', num_rows, rank, rank,
+            one, &P_V.front(), num_rows,
+            &C_U.front(), rank,
+            zero, &work.front(), num_rows)
+        &&
+        dense_matrix_mult(
+            'N', 'N', num_rows, rank, rank,
+            one, &work.front(), num_rows,
+            &C_VT.front(), rank,
+            zero, &W.front(), num_rows);
+
+    // The Gram matrices use the old P, so they are updated first.  C is reused
+    // for the k x k products.
+    //
+    //   (P - W Z^H)^H (P - W Z^H) = P^H P + (Z * W^H W - P^H W) Z^H - Z (P^H W)^H
+    //   (P - W Z^H) (P - W Z^H)^H = P P^H + (W * Z^H Z - P Z) W^H - W (P Z)^H
+
+    if(success && P_H_P_col_values)
+    {
+        // work = P^H * W, and P_V gets Z * W^H W - work, n x k.
+        success =
+            dense_matrix_mult(
+                'C', 'N', num_cols, rank, num_rows,
+                one, P_col_values, P_col_leading_dim,
+                &W.front(), num_rows,
+                zero, &work.front(), num_cols)
+            &&
+            dense_matrix_mult(
+                'C', 'N', rank, rank, num_rows,
+                one, &W.front(), num_rows,
+                &W.front(), num_rows,
+                zero, &C.front(), rank)
+            &&
+            dense_matrix_mult(
+                'N', 'N', num_cols, rank, rank,
+                one, &Z.front(), num_cols,
+                &C.front(), rank,
+                zero, &P_V.front(), num_cols);
+
+        for(std::size_t i = 0; success && i < n * k; ++i)
+            P_V[i] -= work[i];
+
+        success = success &&
+            dense_matrix_mult(
+                'N', 'C', num_cols, num_cols, rank,
+                one, &P_V.front(), num_cols,
+                &Z.front(), num_cols,
+                one, P_H_P_col_values, P_H_P_col_leading_dim)
+            &&
+            dense_matrix_mult(
+                'N', 'C', num_cols, num_cols, rank,
+                -one, &Z.front(), num_cols,
+                &work.front(), num_cols,
+                one, P_H_P_col_values, P_H_P_col_leading_dim);
+    }
+
+    if(success && P_P_H_col_values)
+    {
+        // work = P * Z, and P_V gets W * Z^H Z - work, m x k.
+        success =
+            dense_matrix_mult(
+                'N', 'N', num_rows, rank, num_cols,
+                one, P_col_values, P_col_leading_dim,
+                &Z.front(), num_cols,
+                zero, &work.front(), num_rows)
+            &&
+            dense_matrix_mult(
+                'C', 'N', rank, rank, num_cols,
+                one, &Z.front(), num_cols,
+                &Z.front(), num_cols,
+                zero, &C.front(), rank)
+            &&
+            dense_matrix_mult(
+                'N', 'N', num_rows, rank, rank,
+                one, &W.front(), num_rows,
+                &C.front(), rank,
+                zero, &P_V.front(), num_rows);
+
+        for(std::size_t i = 0; success && i < m * k; ++i)
+            P_V[i] -= work[i];
+
+        success = success &&
+            dense_matrix_mult(
+                'N', 'C', num_rows, num_rows, rank,
+                one, &P_V.front(), num_rows,
+                &W.front(), num_rows,
+                one, P_P_H_col_values, P_P_H_col_leading_dim)
+            &&
+            dense_matrix_mult(
+                'N', 'C', num_rows, num_rows, rank,
+                -one, &W.front(), num_rows,
+                &work.front(), num_rows,
+                one, P_P_H_col_values, P_P_H_col_leading_dim);
+    }
+
+    // P -= W * Z^H
+    success = success &&
+        dense_matrix_mult(
+            'N', 'C', num_rows, num_cols, rank,
+            -one, &W.front(), num_rows,
+            &Z.front(), num_cols,
+            one, P_col_values, P_col_leading_dim);
+
+    assert(success);
+
+    if(!success)
+    {
+        internal_api_error_set_last(
+            "dense_matrix_pinv_update_transpose: Error 3.");
+
+        return false;
+    }
+
+    updated = true;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_MATRIX_PINV_UPDATE_H
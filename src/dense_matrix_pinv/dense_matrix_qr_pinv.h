@@ -68,6 +68,7 @@ http://www.txcorp.com
 #include "internal_api_error/internal_api_error.h"
 #include <stdexcept>
 #include <vector>
+#include <algorithm>   // std::{copy, min, max}
 #include <cstddef>
 #include <cassert>
 
@@ -322,8 +323,203 @@ bool dense_matrix_qr_pinv_horzcat_U_fullrank_B_auto(
 
 // -----------------------------------------------------------------------------
 
+// The pseudo-inverse below needs Q only for the first rank reflectors of the
+// QR factorization, but their storage in the strict lower part of A is
+// overwritten while computing it.  So they are kept packed, column c taking
+// the num_rows - c - 1 values below the diagonal, instead of in a full
+// num_rows x num_cols copy.
+
+inline std::size_t dense_matrix_qr_pinv_packed_offset(
+    std::size_t num_rows,
+    std::size_t col)
+{
+    return col * num_rows - (col * (col + 1)) / 2;
+}
+
+template<typename index_type, typename value_type>
+void dense_matrix_qr_pinv_pack_reflectors(
+    index_type  num_rows,
+    index_type  num_reflectors,
+    const value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    value_type* packed)  // dense_matrix_qr_pinv_packed_offset(num_rows, num_reflectors)
+{
+    for(index_type c = 0; c < num_reflectors; ++c)
+    {
+        const value_type* A_c = A_col_values + std::size_t(c) * std::size_t(A_col_leading_dim);
+
+        std::copy(
+            A_c + c + 1, A_c + num_rows,
+            packed + dense_matrix_qr_pinv_packed_offset(std::size_t(num_rows), std::size_t(c)));
+    }
+}
+
+// Reflectors taken together per block, the same as LAPACK does for compact
+// WY.  Each block is unpacked into block_work to apply it with OR/UNMQR.
+
+const std::size_t dense_matrix_qr_pinv_reflector_block_size = 64; // MAGIC CONSTANT
+
+// C = Q * C with Q = H(0) * ... * H(num_reflectors - 1) from packed reflectors.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_qr_pinv_packed_reflectors_mult(
+    index_type  num_rows,
+    index_type  num_cols,
+    index_type  num_reflectors,
+    const value_type* packed,
+    const value_type* tau_reflectors,
+    value_type* C_col_values,
+    index_type  C_col_leading_dim,
+    value_type* block_work,  // num_rows x dense_matrix_qr_pinv_reflector_block_size
+    value_type* work,
+    std::size_t work_size)
+{
+    const index_type block_size = index_type(std::min(
+        dense_matrix_qr_pinv_reflector_block_size, std::size_t(num_reflectors)));
+
+    bool success = true;
+
+    if(block_size == 0)
+        return success;
+
+    // Blocks from the last, since H(num_reflectors - 1) is applied first.
+
+    index_type block_begin = index_type(((num_reflectors - 1) / block_size) * block_size);
+
+    for(;;)
+    {
+        const index_type block_end = std::min(index_type(block_begin + block_size), num_reflectors);
+        const index_type block_num_rows = index_type(num_rows - block_begin);
+        const index_type block_num_reflectors = index_type(block_end - block_begin);
+
+        // Column c of the block holds reflector block_begin + c from its row
+        // c + 1 on.  OR/UNMQR does not read the rest.
+
+        for(index_type c = 0; c < block_num_reflectors; ++c)
+        {
+            const std::size_t col = std::size_t(block_begin + c);
+
+            const value_type* packed_c =
+                packed + dense_matrix_qr_pinv_packed_offset(std::size_t(num_rows), col);
+
+            std::copy(
+                packed_c, packed_c + (std::size_t(num_rows) - col - 1),
+                block_work + std::size_t(c) * std::size_t(block_num_rows) + std::size_t(c) + 1);
+        }
+
+        success = dense_matrix_reflectors_mult(
+            'L', 'N',
+            block_num_rows, num_cols, block_num_reflectors,
+            block_work, block_num_rows,
+            tau_reflectors + block_begin,
+            C_col_values + block_begin, C_col_leading_dim,
+            work, work_size);
+
+        if(!success || block_begin == 0)
+            break;
+
+        block_begin = index_type(block_begin - block_size);
+    }
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_qr_pinv_packed_reflectors_mult: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// complement gets an orthonormal basis of the orthogonal complement of the
+// span of the num_basis orthonormal columns of X, num_rows x num_basis.  It is
+// Q * [0; I] from the QR factorization of X.  X is over-written.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_qr_pinv_complement(
+    index_type  num_rows,
+    index_type  num_basis,
+    value_type* X_col_values,
+    index_type  X_col_leading_dim,
+    dense_vectors<index_type, value_type>& complement)
+{
+    assert(num_basis <= num_rows);
+
+    const index_type complement_size = index_type(num_rows - num_basis);
+
+    dense_vectors<index_type, value_type> complement_tmp;
+
+    bool success =
+        complement_tmp.allocate(complement_size, num_rows) &&
+        complement_tmp.fill(value_type(0)) &&
+        dense_matrix_utils_diagonal_add(
+            complement_size, complement_size,
+            complement_tmp.vec_values() + num_basis,
+            complement_tmp.leading_dimension(), value_type(1));
+
+    if(success && num_basis && complement_size)
+    {
+        const std::size_t work_size = std::max(
+            dense_matrix_QR_lwork(
+                num_rows, num_basis, X_col_leading_dim, value_type()),
+            dense_matrix_reflectors_mult_lwork<index_type, value_type>(
+                'L', 'N',
+                num_rows, complement_size, num_basis,
+                X_col_leading_dim, complement_tmp.leading_dimension()));
+
+        std::vector<value_type> tau_reflectors, work;
+
+        try
+        {
+            tau_reflectors.resize(num_basis);
+            work.resize(std::max(std::size_t(1), work_size));
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_matrix_qr_pinv_complement: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        success =
+            dense_matrix_QR(
+                num_rows, num_basis,
+                X_col_values, X_col_leading_dim,
+                &tau_reflectors.front(),
+                &work.front(), work.size())
+            &&
+            dense_matrix_reflectors_mult(
+                'L', 'N',
+                num_rows, complement_size, num_basis,
+                X_col_values, X_col_leading_dim,
+                &tau_reflectors.front(),
+                complement_tmp.vec_values(), complement_tmp.leading_dimension(),
+                &work.front(), work.size());
+    }
+
+    if(success)
+        complement.swap(complement_tmp);
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_qr_pinv_complement: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
 // If rnull is not null, it will contain right null-space as output.
 // Caller deallocates that.  A_col_values will be overwritten with pinv(A)'.
+// Apart from A, the memory used is that of the packed reflectors (about half
+// of A for square matrices), the null spaces, and O(max(num_rows, num_cols))
+// columns of workspace.
 
 template<typename index_type, typename value_type>
 bool dense_matrix_qr_pinv_transpose(
@@ -379,7 +575,6 @@ bool dense_matrix_qr_pinv_transpose(
     std::vector<value_type> tau_reflectors;
     std::vector<value_type> work;
     std::vector<precision_scalar> rwork;
-    std::vector<value_type> Q_work;
 
     try
     {
@@ -387,7 +582,6 @@ bool dense_matrix_qr_pinv_transpose(
         tau_reflectors.resize(min_rows_cols);
         work.resize(lwork);
         rwork.resize(rwork_size);
-        Q_work.resize(std::size_t(num_rows) * std::size_t(num_cols));
     }
     catch(const std::exception& exc)
     {
@@ -405,12 +599,7 @@ bool dense_matrix_qr_pinv_transpose(
         dense_matrix_QR_pivoted(
             num_rows, num_cols, A_col_values, A_col_leading_dim,
             &pivots.front(), &tau_reflectors.front(),
-            &work.front(), lwork, rwork_ptr)
-            &&
-        dense_matrix_utils_copy_strict_lower(
-            num_rows, num_cols,
-            A_col_values, A_col_leading_dim,
-            &Q_work.front(), num_rows);
+            &work.front(), lwork, rwork_ptr);
 
     if(!success)
     {
@@ -423,6 +612,10 @@ bool dense_matrix_qr_pinv_transpose(
         return false;
     }
 
+    // The QR workspace is not needed any more.
+    std::vector<value_type>().swap(work);
+    std::vector<precision_scalar>().swap(rwork);
+
     const precision_scalar fuzz = 100; // MAGIC CONSTANT
 
     const index_type right_null_size = dense_matrix_QR_pivoted_right_null_size(
@@ -433,6 +626,93 @@ bool dense_matrix_qr_pinv_transpose(
     const index_type U_size = index_type(num_cols - right_null_size);
     const index_type B_num_cols = right_null_size;
 
+    const char mqr_side  = 'L';
+    const char mqr_trans = 'N';
+
+    // Enough for applying all reflectors at once, and hence for a block too.
+    const std::size_t mqr_work_size = dense_matrix_reflectors_mult_lwork<index_type, value_type>(
+        mqr_side, mqr_trans,
+        num_rows, num_cols, min_rows_cols,
+        num_rows, A_col_leading_dim);
+
+    // H(c) for c >= U_size only changes rows from c on, which are zero in the
+    // matrix Q is applied to below.  So only the first U_size reflectors are
+    // kept.
+    const index_type num_pinv_reflectors = std::min(U_size, min_rows_cols);
+
+    const std::size_t block_work_cols =
+        std::min(dense_matrix_qr_pinv_reflector_block_size, std::size_t(num_pinv_reflectors));
+
+    std::vector<value_type> packed_reflectors;
+    std::vector<value_type> reflectors_block_work;
+    std::vector<value_type> reflectors_mult_work;
+
+    try
+    {
+        packed_reflectors.resize(dense_matrix_qr_pinv_packed_offset(
+            std::size_t(num_rows), std::size_t(num_pinv_reflectors)));
+        reflectors_block_work.resize(std::size_t(num_rows) * block_work_cols);
+        reflectors_mult_work.resize(mqr_work_size);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_qr_pinv_transpose: Exception 2. ") + exc.what()));
+
+        return false;
+    }
+
+    // Left null space, from the reflectors still in place in A.
+
+    if(lnull && right_null_size + num_rows >= num_cols)
+    {
+        dense_vectors<index_type, value_type> lnull_tmp;
+
+        const index_type left_null_size =
+            index_type(index_type(right_null_size + num_rows) - num_cols);
+
+        success =
+            lnull_tmp.allocate(
+                left_null_size, num_rows)
+            &&
+            lnull_tmp.fill(
+                value_type(0))
+            &&
+            dense_matrix_utils_diagonal_add(
+                num_rows, left_null_size,
+                lnull_tmp.vec_values() + index_type(num_rows - left_null_size),
+                lnull_tmp.leading_dimension(), value_type(1))
+            &&
+            dense_matrix_reflectors_mult(
+                mqr_side, mqr_trans,
+                num_rows, left_null_size, min_rows_cols,
+                A_col_values, A_col_leading_dim,
+                &tau_reflectors.front(),
+                lnull_tmp.vec_values(), lnull_tmp.leading_dimension(),
+                &reflectors_mult_work.front(), mqr_work_size);
+
+        if(!success)
+        {
+            assert(false);
+
+            if(!success)
+                internal_api_error_set_last(
+                    "dense_matrix_qr_pinv_transpose: Error 6.");
+
+            return false;
+        }
+
+        lnull->swap(lnull_tmp);
+    }
+
+    if(num_pinv_reflectors)
+        dense_matrix_qr_pinv_pack_reflectors(
+            num_rows, num_pinv_reflectors,
+            A_col_values, A_col_leading_dim,
+            &packed_reflectors.front());
+
     value_type* U_col_values = A_col_values;
     const index_type  U_col_leading_dim = A_col_leading_dim;
 
@@ -442,11 +722,9 @@ bool dense_matrix_qr_pinv_transpose(
 
     const index_type rnull_num_rows = num_cols;
 
-    dense_vectors<index_type, value_type> rnull_tmp, rnull_tmp_perm;
+    dense_vectors<index_type, value_type> rnull_tmp;
 
-    success =
-        rnull_tmp.allocate(right_null_size, rnull_num_rows) &&
-        rnull_tmp_perm.allocate(right_null_size, rnull_num_rows);
+    success = rnull_tmp.allocate(right_null_size, rnull_num_rows);
 
     if(!success)
     {
@@ -477,7 +755,7 @@ bool dense_matrix_qr_pinv_transpose(
         assert(false);
 
         internal_api_error_set_last(
-            (std::string("dense_matrix_qr_pinv_transpose: Exception 2. ") + exc.what()));
+            (std::string("dense_matrix_qr_pinv_transpose: Exception 3. ") + exc.what()));
 
         return false;
     }
@@ -490,6 +768,8 @@ bool dense_matrix_qr_pinv_transpose(
         rnull_tmp.leading_dimension(),
         B_num_cols ? &rect_pinv_work.front() : 0);
 
+    std::vector<value_type>().swap(rect_pinv_work);
+
     if(success && U_size < num_cols && rnull)
     {
         // Fill lower rnull_tmp space
@@ -513,22 +793,20 @@ bool dense_matrix_qr_pinv_transpose(
         if(rnull_tmp.num_vecs())
         {
             success =
-                dense_matrix_permute_rows(
+                dense_matrix_permute_rows_in_place(
                     rnull_tmp.vec_size(),
                     rnull_tmp.num_vecs(),
                     rnull_tmp.vec_values(),
                     rnull_tmp.leading_dimension(),
                     &pivots.front(),
-                    index_type(1), // 1 since coming from LAPACK.
-                    rnull_tmp_perm.vec_values(),
-                    rnull_tmp_perm.leading_dimension())
+                    index_type(1)) // 1 since coming from LAPACK.
                 &&
                 // Give an orthogonal basis for the null space.
                 dense_matrix_QR_orth_col_space_for_full_rank(
-                    rnull_tmp_perm.vec_size(),
-                    rnull_tmp_perm.num_vecs(),
-                    rnull_tmp_perm.vec_values(),
-                    rnull_tmp_perm.leading_dimension());
+                    rnull_tmp.vec_size(),
+                    rnull_tmp.num_vecs(),
+                    rnull_tmp.vec_values(),
+                    rnull_tmp.leading_dimension());
 
             if(!success)
             {
@@ -542,7 +820,7 @@ bool dense_matrix_qr_pinv_transpose(
             }
         }
 
-        rnull->swap(rnull_tmp_perm);
+        rnull->swap(rnull_tmp);
     }
 
     success =
@@ -567,112 +845,31 @@ bool dense_matrix_qr_pinv_transpose(
         return false;
     }
 
-    const char mqr_side  = 'L';
-    const char mqr_trans = 'N';
-
-    const std::size_t mqr_work_size = dense_matrix_reflectors_mult_lwork<index_type, value_type>(
-        mqr_side, mqr_trans,
-        num_rows, num_cols, min_rows_cols,
-        num_rows, A_col_leading_dim);
-
-    std::vector<value_type> reflectors_mult_work;
+    success =
+        dense_matrix_qr_pinv_packed_reflectors_mult(
+            num_rows, num_cols, num_pinv_reflectors,
+            packed_reflectors.empty() ? 0 : &packed_reflectors.front(),
+            &tau_reflectors.front(),
+            A_col_values, A_col_leading_dim,
+            reflectors_block_work.empty() ? 0 : &reflectors_block_work.front(),
+            &reflectors_mult_work.front(), mqr_work_size)
+        &&
+        dense_matrix_permute_cols_in_place(
+            num_rows, num_cols,
+            A_col_values, A_col_leading_dim,
+            &pivots.front(), index_type(1)); // 1 since coming from LAPACK.
 
-    try
-    {
-        reflectors_mult_work.resize(mqr_work_size);
-    }
-    catch(const std::exception& exc)
+    if(!success)
     {
         assert(false);
 
-        internal_api_error_set_last(
-            (std::string("dense_matrix_qr_pinv_transpose: Exception 3. ") + exc.what()));
-
-        return false;
-    }
-
-    success = dense_matrix_reflectors_mult(
-        mqr_side, mqr_trans,
-        num_rows, num_cols, min_rows_cols,
-        &Q_work.front(), num_rows,
-        &tau_reflectors.front(),
-        A_col_values, A_col_leading_dim,
-        &reflectors_mult_work.front(), mqr_work_size);
-
-    if(success)
-    {
-        if(lnull && right_null_size + num_rows >= num_cols)
-        {
-            dense_vectors<index_type, value_type> lnull_tmp;
-
-            const index_type left_null_size =
-                index_type(index_type(right_null_size + num_rows) - num_cols);
-
-            success =
-                lnull_tmp.allocate(
-                    left_null_size, num_rows)
-                &&
-                lnull_tmp.fill(
-                    value_type(0))
-                &&
-                dense_matrix_utils_diagonal_add(
-                    num_rows, left_null_size,
-                    lnull_tmp.vec_values() + index_type(num_rows - left_null_size),
-                    lnull_tmp.leading_dimension(), value_type(1))
-                &&
-                dense_matrix_reflectors_mult(
-                    mqr_side, mqr_trans,
-                    num_rows, left_null_size, min_rows_cols,
-                    &Q_work.front(), num_rows,
-                    &tau_reflectors.front(),
-                    lnull_tmp.vec_values(), lnull_tmp.leading_dimension(),
-                    &reflectors_mult_work.front(), mqr_work_size);
-
-            if(!success)
-            {
-                assert(false);
-
-                if(!success)
-                    internal_api_error_set_last(
-                        "dense_matrix_qr_pinv_transpose: Error 6.");
-
-                return false;
-            }
-
-            lnull->swap(lnull_tmp);
-        }
-
-        success =
-            dense_matrix_permute_cols(
-                num_rows, num_cols,
-                A_col_values, A_col_leading_dim,
-                &pivots.front(), index_type(1), // 1 since coming from LAPACK.
-                &Q_work.front(), num_rows)
-            &&
-            dense_vectors_utils_copy(
-                num_cols,
-                num_rows,
-                &Q_work.front(), num_rows,
-                A_col_values, A_col_leading_dim);
-
         if(!success)
-        {
-            assert(false);
-
-            if(!success)
-                internal_api_error_set_last(
-                    "dense_matrix_qr_pinv_transpose: Error 7.");
+            internal_api_error_set_last(
+                "dense_matrix_qr_pinv_transpose: Error 7.");
 
-            return false;
-        }
+        return false;
     }
 
-    assert(success);
-
-    if(!success)
-        internal_api_error_set_last(
-            "dense_matrix_qr_pinv_transpose: Error.");
-
     return success;
 }
 
@@ -0,0 +1,383 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_MATRIX_RANDOMIZED_PINV_H
+#define DENSE_MATRIX_RANDOMIZED_PINV_H
+
+// -----------------------------------------------------------------------------
+
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_tsqr_pinv.h"
+#include "dense_algorithms/dense_matrix_utils.h"
+#include "dense_vectors/dense_vectors.h"
+#include "dense_vectors/dense_vectors_utils.h"
+#include "lapack_wrap/dense_matrix_QR.h"
+#include "lapack_wrap/dense_matrix_SVD.h"
+#include "blas_wrap/dense_matrix_mult.h"
+#include "math/complex_types.h"
+#include "math/precision_traits.h"
+#include "internal_api_error/internal_api_error.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>   // std::{min, max}
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Pseudo-inverse and null spaces of a numerically low rank matrix
+// in O(m n k) time, where k is its numerical rank, instead of the O(m n
+// min(m, n)) of the pivoted QR in dense_matrix_qr_pinv_transpose.
+//
+// A randomized range finder gives Q with l = k + oversampling orthonormal
+// columns such that A ~= Q * Q^H * A.  The small l x n matrix Q^H * A has the
+// same singular values as A up to the tolerance, and its SVD U * S * V^H gives
+// the truncated SVD (Q * U) * S * V^H of A.  If l turns out to be too small for
+// the rank found, l is doubled.  If l would reach half of min(m, n), the
+// matrix is not low rank in any useful sense, and the pivoted QR (TSQR for
+// tall matrices) is used.
+// -----------------------------------------------------------------------------
+
+struct dense_matrix_randomized_pinv_params
+{
+    dense_matrix_randomized_pinv_params()
+        :
+        rank_tolerance(0),
+        oversampling(10) // MAGIC CONSTANT
+    {
+    }
+
+    // Singular values at most rank_tolerance times the largest one are
+    // treated as zero.  0 => same threshold as the pivoted QR.
+    double      rank_tolerance;
+
+    // Number of columns of the test matrix beyond the rank.
+    std::size_t oversampling;
+};
+
+// -----------------------------------------------------------------------------
+
+// Test matrix with entries +1 and -1 from a xorshift generator with a fixed
+// seed, so that results are reproducible.
+
+template<typename index_type, typename value_type>
+void dense_matrix_randomized_pinv_test_matrix(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* col_values,
+    index_type  col_leading_dim)
+{
+    unsigned long state = 2463534242UL; // MAGIC CONSTANT
+
+    for(index_type j = 0; j < num_cols; ++j)
+    {
+        value_type* col = col_values + std::size_t(j) * std::size_t(col_leading_dim);
+
+        for(index_type i = 0; i < num_rows; ++i)
+        {
+            state ^= (state << 13) & 0xFFFFFFFFUL;
+            state ^= state >> 17;
+            state ^= (state << 5) & 0xFFFFFFFFUL;
+
+            col[i] = (state & 0x10000UL) ? value_type(1) : value_type(-1);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Same interface as dense_matrix_qr_pinv_transpose.  A_col_values will be
+// overwritten with pinv(A)'.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_randomized_pinv_transpose(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    const dense_matrix_randomized_pinv_params& params,
+    dense_vectors<index_type, value_type>* lnull,
+    dense_vectors<index_type, value_type>* rnull)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    bool success =
+        (A_col_values || num_rows == 0 || num_cols == 0) &&
+        num_rows <= A_col_leading_dim &&
+        !(params.rank_tolerance < 0) &&
+        params.rank_tolerance < 1;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_randomized_pinv_transpose: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const std::size_t min_rows_cols = std::size_t(std::min(num_rows, num_cols));
+    const std::size_t oversampling = std::max(std::size_t(1), params.oversampling);
+
+    const scalar_type fuzz = 100; // MAGIC CONSTANT, as in dense_matrix_qr_pinv_transpose
+
+    const scalar_type rel_tol = 0 < params.rank_tolerance ?
+        scalar_type(params.rank_tolerance) :
+        fuzz * scalar_type(min_rows_cols) * std::numeric_limits<scalar_type>::epsilon();
+
+    const std::size_t m = std::size_t(num_rows);
+    const std::size_t n = std::size_t(num_cols);
+
+    const value_type one  = value_type(1);
+    const value_type zero = value_type(0);
+
+    std::vector<value_type> test, range, B, U, VT, work;
+    std::vector<scalar_type> sing_vals, rwork;
+
+    index_type rank = 0;
+    bool found = false;
+
+    for(std::size_t num_samples = 2 * oversampling;
+        success && 2 * num_samples <= min_rows_cols;
+        num_samples *= 2)
+    {
+        const index_type l = index_type(num_samples);
+
+        try
+        {
+            test.resize(n * num_samples);
+            range.resize(m * num_samples);
+            B.resize(num_samples * n);
+            U.resize(num_samples * num_samples);
+            VT.resize(num_samples * n);
+            sing_vals.resize(num_samples);
+            rwork.resize(dense_matrix_SVD_rwork_size(l, num_cols));
+            work.resize(dense_matrix_SVD_lwork(l, num_cols, l, value_type()));
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_matrix_randomized_pinv_transpose: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        dense_matrix_randomized_pinv_test_matrix(
+            num_cols, l, &test.front(), num_cols);
+
+        // range = orth(A * A^H * orth(A * test)).  The power iteration makes
+        // the range sharper when singular values decay slowly.
+
+        success =
+            dense_matrix_mult(
+                'N', 'N', num_rows, l, num_cols,
+                one, A_col_values, A_col_leading_dim,
+                &test.front(), num_cols,
+                zero, &range.front(), num_rows)
+            &&
+            dense_matrix_QR_orth_col_space_for_full_rank(
+                num_rows, l, &range.front(), num_rows)
+            &&
+            dense_matrix_mult(
+                'C', 'N', num_cols, l, num_rows,
+                one, A_col_values, A_col_leading_dim,
+                &range.front(), num_rows,
+                zero, &test.front(), num_cols)
+            &&
+            dense_matrix_mult(
+                'N', 'N', num_rows, l, num_cols,
+                one, A_col_values, A_col_leading_dim,
+                &test.front(), num_cols,
+                zero, &range.front(), num_rows)
+            &&
+            dense_matrix_QR_orth_col_space_for_full_rank(
+                num_rows, l, &range.front(), num_rows)
+            &&
+            // B = range^H * A, l x n
+            dense_matrix_mult(
+                'C', 'N', l, num_cols, num_rows,
+                one, &range.front(), num_rows,
+                A_col_values, A_col_leading_dim,
+                zero, &B.front(), l)
+            &&
+            dense_matrix_SVD(
+                l, num_cols,
+                &B.front(), l,
+                &sing_vals.front(),
+                &U.front(), l,
+                &VT.front(), l,
+                &work.front(), work.size(),
+                &rwork.front());
+
+        if(success)
+        {
+            const scalar_type tol = rel_tol * sing_vals.front();
+
+            rank = 0;
+
+            while(rank < l && tol < sing_vals[std::size_t(rank)])
+                ++rank;
+
+            if(std::size_t(rank) + oversampling <= num_samples)
+            {
+                found = true;
+                break;
+            }
+        }
+    }
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_randomized_pinv_transpose: Error 1.");
+
+        return false;
+    }
+
+    if(!found)
+    {
+        // Not low rank compared to its size.
+        return dense_matrix_tsqr_pinv_transpose(
+            num_rows, num_cols,
+            A_col_values, A_col_leading_dim,
+            lnull, rnull);
+    }
+
+    const index_type l = index_type(sing_vals.size());
+    const std::size_t k = std::size_t(rank);
+
+    // A ~= W * S * V^H with W = range * U(:, 1:k), and pinv(A)' = W * inv(S) * V^H.
+    // test is free, and holds W scaled by inv(S).  range gets V.
+
+    std::vector<value_type> W;
+
+    try
+    {
+        W.resize(std::max(std::size_t(1), m * k));
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_randomized_pinv_transpose: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    if(rank)
+    {
+        success = dense_matrix_mult(
+            'N', 'N', num_rows, rank, l,
+            one, &range.front(), num_rows,
+            &U.front(), l,
+            zero, &W.front(), num_rows);
+
+        if(success)
+        {
+            test.resize(m * k);
+
+            for(std::size_t j = 0; j < k; ++j)
+            {
+                const value_type inv_s = one / sing_vals[j];
+
+                for(std::size_t i = 0; i < m; ++i)
+                    test[i + j * m] = W[i + j * m] * inv_s;
+            }
+
+            success = dense_matrix_mult(
+                'N', 'N', num_rows, num_cols, rank,
+                one, &test.front(), num_rows,
+                &VT.front(), l,
+                zero, A_col_values, A_col_leading_dim);
+        }
+    }
+    else
+    {
+        success = dense_vectors_utils_fill(
+            num_cols, num_rows, A_col_values, A_col_leading_dim, zero);
+    }
+
+    if(success && lnull)
+        success = dense_matrix_qr_pinv_complement(
+            num_rows, rank, &W.front(), num_rows, *lnull);
+
+    if(success && rnull)
+    {
+        // V = VT(1:k, :)^H, n x k
+        range.resize(std::max(std::size_t(1), n * k));
+
+        for(std::size_t j = 0; j < k; ++j)
+            for(std::size_t i = 0; i < n; ++i)
+                range[i + j * n] = std::conj(VT[j + i * std::size_t(l)]);
+
+        success = dense_matrix_qr_pinv_complement(
+            num_cols, rank, &range.front(), num_cols, *rnull);
+    }
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_randomized_pinv_transpose: Error 2.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_MATRIX_RANDOMIZED_PINV_H
@@ -0,0 +1,647 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_MATRIX_TSQR_PINV_H
+#define DENSE_MATRIX_TSQR_PINV_H
+
+// -----------------------------------------------------------------------------
+
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "dense_vectors/dense_vectors.h"
+#include "lapack_wrap/dense_matrix_QR.h"
+#include "lapack_wrap/dense_matrix_reflectors_mult.h"
+#include "internal_api_error/internal_api_error.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>   // std::{copy, fill, min, max}
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Pseudo-inverse of a tall matrix with a tall-skinny QR (TSQR).
+//
+// The rows of A are split into leaves of at least
+// dense_matrix_tsqr_pinv_min_leaf_rows rows, which are QR factored
+// independently (in parallel with OpenMP).  Pairs of the n x n R factors are
+// stacked and factored again, level by level, up to a single R.  Then
+//
+//   A = Q * R,  pinv(A)' = Q * pinv(R)',
+//
+// and the rank revealing pivoted QR is only done on R, by
+// dense_matrix_qr_pinv_transpose.  The right null space of A is that of R.
+// -----------------------------------------------------------------------------
+
+const std::size_t dense_matrix_tsqr_pinv_min_aspect    = 4;    // MAGIC CONSTANT
+const std::size_t dense_matrix_tsqr_pinv_min_leaf_rows = 1024; // MAGIC CONSTANT
+
+// Number of leaves for an num_rows x num_cols matrix.  1 => TSQR is not used.
+
+template<typename index_type>
+std::size_t dense_matrix_tsqr_pinv_num_leaves(
+    index_type num_rows,
+    index_type num_cols)
+{
+    const std::size_t m = std::size_t(num_rows);
+    const std::size_t n = std::size_t(num_cols);
+
+    if(n == 0 || m < dense_matrix_tsqr_pinv_min_aspect * n)
+        return 1;
+
+    const std::size_t leaf_rows = std::max(
+        dense_matrix_tsqr_pinv_min_leaf_rows,
+        dense_matrix_tsqr_pinv_min_aspect * n);
+
+    return std::max(std::size_t(1), m / leaf_rows);
+}
+
+// -----------------------------------------------------------------------------
+
+// A node of the reduction tree.  values holds the reflectors below and R in
+// its top n x n upper triangle, with leading dimension num_rows.  A node with
+// one child copies its R and has no reflectors.
+
+template<typename value_type>
+struct dense_matrix_tsqr_pinv_node
+{
+    dense_matrix_tsqr_pinv_node()
+        :
+        num_rows(0)
+    {
+    }
+
+    std::size_t             num_rows;
+    std::vector<value_type> values;
+    std::vector<value_type> tau;
+};
+
+// -----------------------------------------------------------------------------
+
+// QR factorization of the num_rows x num_cols matrix in node.values, in place.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_tsqr_pinv_factor_node(
+    index_type num_cols,
+    dense_matrix_tsqr_pinv_node<value_type>& node)
+{
+    const index_type num_rows = index_type(node.num_rows);
+
+    std::vector<value_type> work;
+
+    try
+    {
+        node.tau.resize(std::size_t(num_cols));
+        work.resize(std::max(std::size_t(1),
+            dense_matrix_QR_lwork(num_rows, num_cols, num_rows, value_type())));
+    }
+    catch(const std::exception&)
+    {
+        return false;
+    }
+
+    return dense_matrix_QR(
+        num_rows, num_cols,
+        &node.values.front(), num_rows,
+        &node.tau.front(),
+        &work.front(), work.size());
+}
+
+// -----------------------------------------------------------------------------
+
+// C = H * C for the reflectors of node and the num_rows x num_cols matrix C.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_tsqr_pinv_node_mult(
+    index_type num_reflectors,
+    const dense_matrix_tsqr_pinv_node<value_type>& node,
+    index_type  num_cols,
+    value_type* C_col_values,
+    index_type  C_col_leading_dim)
+{
+    const index_type num_rows = index_type(node.num_rows);
+
+    std::vector<value_type> work;
+
+    try
+    {
+        work.resize(std::max(std::size_t(1),
+            dense_matrix_reflectors_mult_lwork<index_type, value_type>(
+                'L', 'N',
+                num_rows, num_cols, num_reflectors,
+                num_rows, C_col_leading_dim)));
+    }
+    catch(const std::exception&)
+    {
+        return false;
+    }
+
+    return dense_matrix_reflectors_mult(
+        'L', 'N',
+        num_rows, num_cols, num_reflectors,
+        &node.values.front(), num_rows,
+        &node.tau.front(),
+        C_col_values, C_col_leading_dim,
+        &work.front(), work.size());
+}
+
+// -----------------------------------------------------------------------------
+
+// Factors the leaves and reduces their R factors up to levels.back()[0].
+
+template<typename index_type, typename value_type>
+bool dense_matrix_tsqr_pinv_factor(
+    index_type  num_rows,
+    index_type  num_cols,
+    const value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    const std::vector<std::size_t>& leaf_offsets,
+    std::vector< std::vector< dense_matrix_tsqr_pinv_node<value_type> > >& levels)
+{
+    const std::size_t n = std::size_t(num_cols);
+    const std::size_t num_leaves = leaf_offsets.size() - 1;
+
+    assert(leaf_offsets.back() == std::size_t(num_rows));
+    (void) num_rows;
+
+    try
+    {
+        levels.resize(1);
+        levels[0].resize(num_leaves);
+
+        for(std::size_t num_nodes = num_leaves; 1 < num_nodes; )
+        {
+            num_nodes = (num_nodes + 1) / 2;
+            levels.push_back(std::vector< dense_matrix_tsqr_pinv_node<value_type> >(num_nodes));
+        }
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_tsqr_pinv_factor: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    int num_failed = 0;
+
+    const std::ptrdiff_t num_leaves_signed = std::ptrdiff_t(num_leaves);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_failed)
+#endif
+    for(std::ptrdiff_t bb = 0; bb < num_leaves_signed; ++bb)
+    {
+        const std::size_t b = std::size_t(bb);
+
+        dense_matrix_tsqr_pinv_node<value_type>& leaf = levels[0][b];
+
+        leaf.num_rows = leaf_offsets[b + 1] - leaf_offsets[b];
+
+        bool leaf_success = true;
+
+        try
+        {
+            leaf.values.resize(leaf.num_rows * n);
+        }
+        catch(const std::exception&)
+        {
+            leaf_success = false;
+        }
+
+        if(leaf_success)
+        {
+            for(std::size_t j = 0; j < n; ++j)
+            {
+                const value_type* A_j = A_col_values +
+                    j * std::size_t(A_col_leading_dim) + leaf_offsets[b];
+
+                std::copy(A_j, A_j + leaf.num_rows, leaf.values.begin() + j * leaf.num_rows);
+            }
+
+            leaf_success = dense_matrix_tsqr_pinv_factor_node(num_cols, leaf);
+        }
+
+        if(!leaf_success)
+            ++num_failed;
+    }
+
+    for(std::size_t level = 1; num_failed == 0 && level < levels.size(); ++level)
+    {
+        const std::vector< dense_matrix_tsqr_pinv_node<value_type> >& children = levels[level - 1];
+
+        const std::ptrdiff_t num_nodes_signed = std::ptrdiff_t(levels[level].size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_failed)
+#endif
+        for(std::ptrdiff_t ii = 0; ii < num_nodes_signed; ++ii)
+        {
+            const std::size_t i = std::size_t(ii);
+
+            dense_matrix_tsqr_pinv_node<value_type>& node = levels[level][i];
+
+            const std::size_t num_children = std::min(std::size_t(2), children.size() - 2 * i);
+
+            node.num_rows = num_children * n;
+
+            bool node_success = true;
+
+            try
+            {
+                node.values.assign(node.num_rows * n, value_type(0));
+            }
+            catch(const std::exception&)
+            {
+                node_success = false;
+            }
+
+            // Stack the R factors of the children.
+            for(std::size_t c = 0; node_success && c < num_children; ++c)
+            {
+                const dense_matrix_tsqr_pinv_node<value_type>& child = children[2 * i + c];
+
+                for(std::size_t j = 0; j < n; ++j)
+                {
+                    const value_type* R_j = &child.values.front() + j * child.num_rows;
+
+                    std::copy(R_j, R_j + j + 1, node.values.begin() + j * node.num_rows + c * n);
+                }
+            }
+
+            if(node_success && num_children == 2)
+                node_success = dense_matrix_tsqr_pinv_factor_node(num_cols, node);
+
+            if(!node_success)
+                ++num_failed;
+        }
+    }
+
+    assert(num_failed == 0);
+
+    if(num_failed)
+        internal_api_error_set_last(
+            "dense_matrix_tsqr_pinv_factor: Error.");
+
+    return num_failed == 0;
+}
+
+// -----------------------------------------------------------------------------
+
+// out = Q * [X; 0], for the num_cols x num_X_cols matrix X and the
+// num_rows x num_X_cols matrix out.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_tsqr_pinv_Q_mult(
+    index_type  num_cols,
+    const std::vector<std::size_t>& leaf_offsets,
+    const std::vector< std::vector< dense_matrix_tsqr_pinv_node<value_type> > >& levels,
+    index_type  num_X_cols,
+    const value_type* X_col_values,
+    index_type  X_col_leading_dim,
+    value_type* out_col_values,
+    index_type  out_col_leading_dim)
+{
+    const std::size_t n = std::size_t(num_cols);
+    const std::size_t c = std::size_t(num_X_cols);
+
+    // parts[i] is the n x c part of the product for node i of the level.
+    std::vector< std::vector<value_type> > parts, child_parts;
+
+    try
+    {
+        parts.resize(1);
+        parts[0].resize(n * c);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_tsqr_pinv_Q_mult: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    for(std::size_t j = 0; j < c; ++j)
+    {
+        const value_type* X_j = X_col_values + j * std::size_t(X_col_leading_dim);
+
+        std::copy(X_j, X_j + n, parts[0].begin() + j * n);
+    }
+
+    int num_failed = 0;
+
+    for(std::size_t level = levels.size() - 1; num_failed == 0 && 0 < level; --level)
+    {
+        const std::vector< dense_matrix_tsqr_pinv_node<value_type> >& nodes = levels[level];
+
+        try
+        {
+            child_parts.clear();
+            child_parts.resize(levels[level - 1].size());
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_matrix_tsqr_pinv_Q_mult: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        const std::ptrdiff_t num_nodes_signed = std::ptrdiff_t(nodes.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_failed)
+#endif
+        for(std::ptrdiff_t ii = 0; ii < num_nodes_signed; ++ii)
+        {
+            const std::size_t i = std::size_t(ii);
+
+            const dense_matrix_tsqr_pinv_node<value_type>& node = nodes[i];
+
+            if(node.num_rows == n)
+            {
+                child_parts[2 * i].swap(parts[i]);
+                continue;
+            }
+
+            bool node_success = true;
+
+            std::vector<value_type> C;
+
+            try
+            {
+                C.assign(2 * n * c, value_type(0));
+                child_parts[2 * i].resize(n * c);
+                child_parts[2 * i + 1].resize(n * c);
+            }
+            catch(const std::exception&)
+            {
+                node_success = false;
+            }
+
+            if(node_success)
+            {
+                for(std::size_t j = 0; j < c; ++j)
+                    std::copy(
+                        parts[i].begin() + j * n, parts[i].begin() + (j + 1) * n,
+                        C.begin() + j * 2 * n);
+
+                node_success = dense_matrix_tsqr_pinv_node_mult(
+                    num_cols, node,
+                    num_X_cols, &C.front(), index_type(2 * n));
+            }
+
+            if(node_success)
+            {
+                for(std::size_t j = 0; j < c; ++j)
+                {
+                    std::copy(
+                        C.begin() + j * 2 * n, C.begin() + j * 2 * n + n,
+                        child_parts[2 * i].begin() + j * n);
+                    std::copy(
+                        C.begin() + j * 2 * n + n, C.begin() + (j + 1) * 2 * n,
+                        child_parts[2 * i + 1].begin() + j * n);
+                }
+            }
+
+            if(!node_success)
+                ++num_failed;
+        }
+
+        parts.swap(child_parts);
+    }
+
+    const std::ptrdiff_t num_leaves_signed = std::ptrdiff_t(levels[0].size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_failed)
+#endif
+    for(std::ptrdiff_t bb = 0; bb < num_leaves_signed; ++bb)
+    {
+        if(num_failed)
+            continue;
+
+        const std::size_t b = std::size_t(bb);
+
+        const dense_matrix_tsqr_pinv_node<value_type>& leaf = levels[0][b];
+
+        value_type* out_b = out_col_values + leaf_offsets[b];
+
+        for(std::size_t j = 0; j < c; ++j)
+        {
+            value_type* out_bj = out_b + j * std::size_t(out_col_leading_dim);
+
+            std::copy(parts[b].begin() + j * n, parts[b].begin() + (j + 1) * n, out_bj);
+            std::fill(out_bj + n, out_bj + leaf.num_rows, value_type(0));
+        }
+
+        if(!dense_matrix_tsqr_pinv_node_mult(
+            num_cols, leaf,
+            num_X_cols, out_b, out_col_leading_dim))
+        {
+            ++num_failed;
+        }
+    }
+
+    assert(num_failed == 0);
+
+    if(num_failed)
+        internal_api_error_set_last(
+            "dense_matrix_tsqr_pinv_Q_mult: Error.");
+
+    return num_failed == 0;
+}
+
+// -----------------------------------------------------------------------------
+
+// Same interface as dense_matrix_qr_pinv_transpose, which is used for matrices
+// that are not tall enough for more than one leaf.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_tsqr_pinv_transpose(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    dense_vectors<index_type, value_type>* lnull,
+    dense_vectors<index_type, value_type>* rnull)
+{
+    const std::size_t num_leaves = dense_matrix_tsqr_pinv_num_leaves(num_rows, num_cols);
+
+    if(num_leaves < 2)
+    {
+        return dense_matrix_qr_pinv_transpose(
+            num_rows, num_cols,
+            A_col_values, A_col_leading_dim,
+            lnull, rnull);
+    }
+
+    bool success =
+        A_col_values &&
+        num_rows <= A_col_leading_dim;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_tsqr_pinv_transpose: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const std::size_t m = std::size_t(num_rows);
+    const std::size_t n = std::size_t(num_cols);
+
+    std::vector<std::size_t> leaf_offsets;
+    std::vector< std::vector< dense_matrix_tsqr_pinv_node<value_type> > > levels;
+    std::vector<value_type> R;
+
+    try
+    {
+        leaf_offsets.resize(num_leaves + 1);
+        R.assign(n * n, value_type(0));
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_matrix_tsqr_pinv_transpose: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    // The last leaf takes the remainder rows.
+    for(std::size_t b = 0; b < num_leaves; ++b)
+        leaf_offsets[b] = b * (m / num_leaves);
+
+    leaf_offsets[num_leaves] = m;
+
+    success = dense_matrix_tsqr_pinv_factor(
+        num_rows, num_cols,
+        A_col_values, A_col_leading_dim,
+        leaf_offsets, levels);
+
+    if(success)
+    {
+        const dense_matrix_tsqr_pinv_node<value_type>& root = levels.back()[0];
+
+        for(std::size_t j = 0; j < n; ++j)
+            std::copy(
+                root.values.begin() + j * root.num_rows,
+                root.values.begin() + j * root.num_rows + j + 1,
+                R.begin() + j * n);
+    }
+
+    // R gets pinv(R)'.
+
+    dense_vectors<index_type, value_type> lnull_R;
+
+    success = success &&
+        dense_matrix_qr_pinv_transpose(
+            num_cols, num_cols,
+            &R.front(), num_cols,
+            lnull ? &lnull_R : 0, rnull)
+        &&
+        dense_matrix_tsqr_pinv_Q_mult(
+            num_cols, leaf_offsets, levels,
+            num_cols, &R.front(), num_cols,
+            A_col_values, A_col_leading_dim);
+
+    if(success && lnull)
+    {
+        // The left null space of A is the complement of Q times the range of
+        // R, which in turn is the complement of the left null space of R.
+
+        const index_type rank = index_type(num_cols - lnull_R.num_vecs());
+
+        dense_vectors<index_type, value_type> range_R, range_A;
+
+        success =
+            dense_matrix_qr_pinv_complement(
+                num_cols, lnull_R.num_vecs(),
+                lnull_R.vec_values(), lnull_R.leading_dimension(),
+                range_R)
+            &&
+            range_A.allocate(
+                rank, num_rows);
+
+        if(success && rank)
+            success = dense_matrix_tsqr_pinv_Q_mult(
+                num_cols, leaf_offsets, levels,
+                rank, range_R.vec_values(), range_R.leading_dimension(),
+                range_A.vec_values(), range_A.leading_dimension());
+
+        success = success &&
+            dense_matrix_qr_pinv_complement(
+                num_rows, rank,
+                range_A.vec_values(), range_A.leading_dimension(),
+                *lnull);
+    }
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_tsqr_pinv_transpose: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_MATRIX_TSQR_PINV_H
@@ -277,6 +277,12 @@ public:
         {
             delete[] values;
         }
+
+        n_vecs = 0;
+        each_vec_size = 0;
+        leading_dim = 0;
+        values = 0;
+        self_allocated = false;
     }
 
     bool allocate(
@@ -0,0 +1,377 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_VECTORS_FILE_H
+#define DENSE_VECTORS_FILE_H
+
+// -----------------------------------------------------------------------------
+
+#include "dense_vectors/dense_vectors.h"
+#include "sparse_vectors/sparse_vectors_file.h"
+#include "platform/file_mapping.h"
+#include "math/precision_traits.h"
+#include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstdio>     // std::{FILE, fopen, fclose}
+#include <cstring>    // std::{memcmp, memcpy}
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Write a fixed number of dense matrices (dense_vectors) to one
+// binary file, and map such a file back without copying the data.
+//
+// File layout.  Each section begins at a multiple of
+// sparse_vectors_file_alignment bytes from the beginning of the file.
+//
+//   header   dense_vectors_file_header
+//   sizes    num_matrices pairs (n_vecs, vec_size), unsigned long long
+//   values   for each matrix, n_vecs * vec_size values of value_type, with
+//            leading dimension vec_size
+//
+// The header has a key of two numbers chosen by the writer, which the reader
+// must give too.  As for sparse_vectors_file.h, numbers are stored in the
+// native representation of the writer.
+// -----------------------------------------------------------------------------
+
+struct dense_vectors_file_header
+{
+    char               magic[8];
+    unsigned long long version;
+    unsigned long long byte_order;
+    unsigned long long key[2];
+    unsigned long long index_size;
+    unsigned long long scalar_size;
+    unsigned long long is_complex;
+    unsigned long long num_matrices;
+};
+
+const char dense_vectors_file_magic[8] = {'T','X','S','S','A','D','N','S'};
+
+const unsigned long long dense_vectors_file_version = 1;
+
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename value_type>
+bool dense_vectors_file_write(
+    const char* file_name,
+    const unsigned long long key[2],
+    std::size_t num_matrices,
+    const dense_vectors<index_type, value_type>* const* matrices)
+{
+    bool success =
+        file_name &&
+        key &&
+        (matrices || num_matrices == 0);
+
+    for(std::size_t i = 0; success && i < num_matrices; ++i)
+        success = matrices[i] &&
+            (matrices[i]->vec_values() ||
+             matrices[i]->num_vecs() == 0 || matrices[i]->vec_size() == 0);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_vectors_file_write: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    dense_vectors_file_header header;
+
+    std::memcpy(header.magic, dense_vectors_file_magic, sizeof(header.magic));
+
+    header.version      = dense_vectors_file_version;
+    header.byte_order   = sparse_vectors_file_byte_order;
+    header.key[0]       = key[0];
+    header.key[1]       = key[1];
+    header.index_size   = sizeof(index_type);
+    header.scalar_size  = sizeof(scalar_type);
+    header.is_complex   = sizeof(value_type) == sizeof(scalar_type) ? 0 : 1;
+    header.num_matrices = num_matrices;
+
+    std::vector<unsigned long long> sizes;
+
+    try
+    {
+        sizes.resize(2 * num_matrices + 1);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("dense_vectors_file_write: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    for(std::size_t i = 0; i < num_matrices; ++i)
+    {
+        sizes[2 * i]     = static_cast<unsigned long long>(matrices[i]->num_vecs());
+        sizes[2 * i + 1] = static_cast<unsigned long long>(matrices[i]->vec_size());
+    }
+
+    std::FILE* file = std::fopen(file_name, "wb");
+
+    if(!file)
+    {
+        internal_api_error_set_last(
+            std::string("dense_vectors_file_write: Could not open file ") + file_name);
+
+        return false;
+    }
+
+    unsigned long long pos = 0;
+
+    success =
+        sparse_vectors_file_write_bytes(
+            file, &header, sizeof(header), pos) &&
+        sparse_vectors_file_write_padding(file, pos) &&
+        sparse_vectors_file_write_bytes(
+            file, &sizes.front(), 2 * num_matrices * sizeof(unsigned long long), pos);
+
+    for(std::size_t i = 0; success && i < num_matrices; ++i)
+    {
+        const dense_vectors<index_type, value_type>& A = *matrices[i];
+
+        success = sparse_vectors_file_write_padding(file, pos);
+
+        for(index_type j = 0; success && j < A.num_vecs(); ++j)
+            success = sparse_vectors_file_write_bytes(
+                file, A.vec_values() + std::size_t(j) * std::size_t(A.leading_dimension()),
+                std::size_t(A.vec_size()) * sizeof(value_type), pos);
+    }
+
+    // fclose also flushes, so it can fail too.
+    success = (std::fclose(file) == 0) && success;
+
+    if(!success)
+    {
+        internal_api_error_set_last(
+            std::string("dense_vectors_file_write: Could not write file ") + file_name);
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Keeps a file written by dense_vectors_file_write mapped, and points
+// dense_vectors to the matrices in it.  Those must not be used after the view
+// is destroyed or mapped again.  Modifications are private to the process
+// and do not change the file.
+
+template<typename index_type, typename value_type>
+class dense_vectors_file_view
+{
+public:
+
+    dense_vectors_file_view()
+    {
+    }
+
+    ~dense_vectors_file_view()
+    {
+    }
+
+    // Returns false, and leaves matrices unchanged, if the file does not
+    // exist, or was not written with the same key, number of matrices, and
+    // types.  Only a corrupt file sets an error.
+    bool map(
+        const char* file_name,
+        const unsigned long long key[2],
+        std::size_t num_matrices,
+        dense_vectors<index_type, value_type>* const* matrices)
+    {
+        typedef typename precision_traits<value_type>::scalar scalar_type;
+
+        if(!file_name || !key || (!matrices && num_matrices))
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                "dense_vectors_file_view::map: Unacceptable input argument(s).");
+
+            return false;
+        }
+
+        // A missing file is the common case, and not an error.
+        std::FILE* file = std::fopen(file_name, "rb");
+
+        if(!file)
+            return false;
+
+        std::fclose(file);
+
+        // C++ Idiom: Create temporary and swap
+
+        file_mapping tmp_mapping;
+
+        if(!tmp_mapping.map(file_name))
+            return false;
+
+        const unsigned long long file_size = tmp_mapping.size();
+
+        dense_vectors_file_header header;
+
+        bool success = sizeof(header) <= file_size;
+
+        if(success)
+        {
+            std::memcpy(&header, tmp_mapping.data(), sizeof(header));
+
+            success =
+                std::memcmp(header.magic, dense_vectors_file_magic, sizeof(header.magic)) == 0 &&
+                header.version      == dense_vectors_file_version &&
+                header.byte_order   == sparse_vectors_file_byte_order &&
+                header.key[0]       == key[0] &&
+                header.key[1]       == key[1] &&
+                header.index_size   == sizeof(index_type) &&
+                header.scalar_size  == sizeof(scalar_type) &&
+                header.is_complex   == (sizeof(value_type) == sizeof(scalar_type) ? 0U : 1U) &&
+                header.num_matrices == num_matrices;
+        }
+
+        if(!success)
+            return false;
+
+        unsigned long long pos = sizeof(header);
+        unsigned long long sizes_begin = 0;
+
+        success = sparse_vectors_file_section(pos,
+            2 * header.num_matrices, sizeof(unsigned long long), file_size, sizes_begin);
+
+        std::vector<unsigned long long> sizes, values_begin;
+
+        try
+        {
+            sizes.resize(2 * num_matrices + 1);
+            values_begin.resize(num_matrices + 1);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_vectors_file_view::map: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        if(success)
+            std::memcpy(&sizes.front(), tmp_mapping.data() + sizes_begin,
+                2 * num_matrices * sizeof(unsigned long long));
+
+        const unsigned long long max_index =
+            static_cast<unsigned long long>(std::numeric_limits<index_type>::max());
+
+        for(std::size_t i = 0; success && i < num_matrices; ++i)
+        {
+            const unsigned long long n_vecs   = sizes[2 * i];
+            const unsigned long long vec_size = sizes[2 * i + 1];
+
+            success =
+                n_vecs <= max_index &&
+                vec_size <= max_index &&
+                (vec_size == 0 || n_vecs <= file_size / vec_size) &&
+                sparse_vectors_file_section(pos,
+                    n_vecs * vec_size, sizeof(value_type), file_size, values_begin[i]);
+        }
+
+        if(!success)
+        {
+            internal_api_error_set_last(
+                std::string("dense_vectors_file_view::map: Corrupt file ") + file_name);
+
+            return false;
+        }
+
+        // Pointers stay valid after swap.
+
+        mapping.swap(tmp_mapping);
+
+        for(std::size_t i = 0; i < num_matrices; ++i)
+        {
+            const index_type n_vecs   = index_type(sizes[2 * i]);
+            const index_type vec_size = index_type(sizes[2 * i + 1]);
+
+            // Not null for empty matrices either, as for allocated ones.
+            value_type* values = reinterpret_cast<value_type*>(
+                mapping.data() + values_begin[i]);
+
+            matrices[i]->use_memory(
+                n_vecs, vec_size,
+                vec_size ? vec_size : index_type(1),
+                values);
+        }
+
+        return true;
+    }
+
+private:
+
+    file_mapping mapping;
+
+    // Not yet.
+    dense_vectors_file_view(const dense_vectors_file_view&);
+    dense_vectors_file_view& operator=(const dense_vectors_file_view&);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_VECTORS_FILE_H
@@ -80,23 +80,30 @@ extern "C"
 
 void internal_api_error_set_last(const char* str)
 {
-    try
-    {
-        errors.push_back(str);
-    }
-    catch(const std::exception& exc)
-    {
-        std::cerr
-            << "internal_api_error_set_last: Exception. "
-            << exc.what()
-            << std::endl;
-    }
-    catch(...)
+    // Errors may be set from within parallel regions (e.g., independent
+    // blocks of a matrix), so serialize access to the error stack.
+#ifdef _OPENMP
+#pragma omp critical(internal_api_error)
+#endif
     {
-        std::cerr
-            << "internal_api_error_set_last: Exception. "
-            << "Unknown"
-            << std::endl;
+        try
+        {
+            errors.push_back(str);
+        }
+        catch(const std::exception& exc)
+        {
+            std::cerr
+                << "internal_api_error_set_last: Exception. "
+                << exc.what()
+                << std::endl;
+        }
+        catch(...)
+        {
+            std::cerr
+                << "internal_api_error_set_last: Exception. "
+                << "Unknown"
+                << std::endl;
+        }
     }
 }
 
@@ -145,6 +145,30 @@ FORT_WRAP_FUNC_NOTYPE(LAPACK, gesvd)(LAPACK_gesvd_ARG_2(float,  float))
 
 // -----------------------------------------------------------------------------
 
+// The real versions of [ZC]HEEVD are [DS]SYEVD, which take no rwork.  As for
+// geqp3, LAPACK_heevd for real types takes and ignores the extra arguments.
+
+FORT_WRAP_CPP_FUNC_DEF_real(LAPACK, syevd)
+FORT_WRAP_CPP_FUNC_DEF_ARG_2_complex(LAPACK, heevd)
+
+inline FORT_RET
+FORT_WRAP_FUNC_NOTYPE(LAPACK, heevd)(LAPACK_heevd_ARG_2(double, double))
+{
+    (void) rwork;
+    (void) lrwork;
+    FORT_WRAP_FUNC(LAPACK, double, syevd)(LAPACK_syevd_ARG_VAL);
+}
+
+inline FORT_RET
+FORT_WRAP_FUNC_NOTYPE(LAPACK, heevd)(LAPACK_heevd_ARG_2(float,  float))
+{
+    (void) rwork;
+    (void) lrwork;
+    FORT_WRAP_FUNC(LAPACK, float,  syevd)(LAPACK_syevd_ARG_VAL);
+}
+
+// -----------------------------------------------------------------------------
+
 #endif // __cplusplus
 
 // -----------------------------------------------------------------------------
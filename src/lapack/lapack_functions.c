@@ -64,3 +64,5 @@ FORT_WRAP_FUNC_DEF_real(     LAPACK, geqp3, GEQP3)
 FORT_WRAP_FUNC_DEF_2_complex(LAPACK, geqp3, GEQP3)
 FORT_WRAP_FUNC_DEF_real(     LAPACK, gesvd, GESVD)
 FORT_WRAP_FUNC_DEF_2_complex(LAPACK, gesvd, GESVD)
+FORT_WRAP_FUNC_DEF_real(     LAPACK, syevd, SYEVD)
+FORT_WRAP_FUNC_DEF_2_complex(LAPACK, heevd, HEEVD)
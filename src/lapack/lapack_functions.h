@@ -91,6 +91,9 @@ typedef int LAPACK_int;
 #define LAPACK_gesvd_ARG(T)           char* jobu, char* jobvt, LAPACK_int* m, LAPACK_int* n, T* a, LAPACK_int* lda, T* s, T* u, LAPACK_int* ldu, T* vt, LAPACK_int* ldvt, T* work, LAPACK_int* lwork, int* info
 #define LAPACK_gesvd_ARG_2(T, T_REAL) char* jobu, char* jobvt, LAPACK_int* m, LAPACK_int* n, T* a, LAPACK_int* lda, T_REAL* s, T* u, LAPACK_int* ldu, T* vt, LAPACK_int* ldvt, T* work, LAPACK_int* lwork, T_REAL* rwork, int* info
 
+#define LAPACK_syevd_ARG(T)           char* jobz, char* uplo, LAPACK_int* n, T* a, LAPACK_int* lda, T* w, T* work, LAPACK_int* lwork, LAPACK_int* iwork, LAPACK_int* liwork, int* info
+#define LAPACK_heevd_ARG_2(T, T_REAL) char* jobz, char* uplo, LAPACK_int* n, T* a, LAPACK_int* lda, T_REAL* w, T* work, LAPACK_int* lwork, T_REAL* rwork, LAPACK_int* lrwork, LAPACK_int* iwork, LAPACK_int* liwork, int* info
+
 
 /* -------------------------------------------------------------------------- */
 
@@ -111,6 +114,9 @@ typedef int LAPACK_int;
 #define LAPACK_gesvd_ARG_VAL    jobu, jobvt, m, n, a, lda, s, u, ldu, vt, ldvt, work, lwork, info
 #define LAPACK_gesvd_ARG_2_VAL  jobu, jobvt, m, n, a, lda, s, u, ldu, vt, ldvt, work, lwork, rwork, info
 
+#define LAPACK_syevd_ARG_VAL    jobz, uplo, n, a, lda, w, work, lwork, iwork, liwork, info
+#define LAPACK_heevd_ARG_2_VAL  jobz, uplo, n, a, lda, w, work, lwork, rwork, lrwork, iwork, liwork, info
+
 /* -------------------------------------------------------------------------- */
 
 #ifdef __cplusplus
@@ -131,6 +137,8 @@ FORT_WRAP_FUNC_DECL_real(         LAPACK, geqp3);
 FORT_WRAP_FUNC_DECL_ARG_2_complex(LAPACK, geqp3);
 FORT_WRAP_FUNC_DECL_real(         LAPACK, gesvd);
 FORT_WRAP_FUNC_DECL_ARG_2_complex(LAPACK, gesvd);
+FORT_WRAP_FUNC_DECL_real(         LAPACK, syevd);
+FORT_WRAP_FUNC_DECL_ARG_2_complex(LAPACK, heevd);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -0,0 +1,222 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef DENSE_MATRIX_SVD_H
+#define DENSE_MATRIX_SVD_H
+
+// -----------------------------------------------------------------------------
+
+#include "lapack/lapack_cpp_functions.h"
+#include "math/precision_traits.h"
+#include "platform/integral_type_range.h"
+#include "internal_api_error/internal_api_error.h"
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <cmath>      // std::real
+#include <algorithm>  // std::{min, max}
+
+// -----------------------------------------------------------------------------
+// Thin singular value decomposition A = U * diag(S) * VT with GESVD, where U
+// is num_rows x min(num_rows, num_cols) and VT is min(num_rows, num_cols) x
+// num_cols.  Singular values are in decreasing order.
+// -----------------------------------------------------------------------------
+
+// Size of rwork.  Only complex GESVD uses it, but it is always passed.
+
+template<typename index_type>
+std::size_t dense_matrix_SVD_rwork_size(
+    index_type num_rows,
+    index_type num_cols)
+{
+    return 5 * std::max(std::size_t(1), std::size_t(std::min(num_rows, num_cols)));
+}
+
+// Call this function to get lwork for GESVD.
+
+template<typename index_type, typename value_type>
+std::size_t dense_matrix_SVD_lwork(
+    index_type num_rows,
+    index_type num_cols,
+    index_type A_col_leading_dim,
+    value_type /**/)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const index_type min_rows_cols = std::min(num_rows, num_cols);
+
+    bool success =
+        num_rows <= A_col_leading_dim &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(num_rows) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(num_cols) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(A_col_leading_dim);
+
+    assert(success);
+
+    value_type work = value_type();
+
+    if(success)
+    {
+        char job = 'S';
+
+        LAPACK_int LAPACK_m    = LAPACK_int(num_rows);
+        LAPACK_int LAPACK_n    = LAPACK_int(num_cols);
+        LAPACK_int LAPACK_lda  = LAPACK_int(std::max(index_type(1), A_col_leading_dim));
+        LAPACK_int LAPACK_ldu  = LAPACK_int(std::max(index_type(1), num_rows));
+        LAPACK_int LAPACK_ldvt = LAPACK_int(std::max(index_type(1), min_rows_cols));
+        LAPACK_int LAPACK_wsz  = LAPACK_int(-1);
+
+        int info = 0;
+        LAPACK_gesvd(
+            &job, &job,
+            &LAPACK_m, &LAPACK_n,
+            reinterpret_cast<value_type*>(0), &LAPACK_lda,
+            reinterpret_cast<scalar_type*>(0),
+            reinterpret_cast<value_type*>(0), &LAPACK_ldu,
+            reinterpret_cast<value_type*>(0), &LAPACK_ldvt,
+            &work, &LAPACK_wsz,
+            reinterpret_cast<scalar_type*>(0),
+            &info);
+
+        success =
+            (scalar_type(std::size_t(std::real(work))) == std::real(work)) &&
+            info == 0;
+
+        assert(success);
+    }
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_SVD_lwork: Error.");
+
+    return success ?
+        std::max(std::size_t(1), std::size_t(std::real(work))) :
+        std::numeric_limits<std::size_t>::max();
+}
+
+// -----------------------------------------------------------------------------
+
+// This function exists solely to wrap LAPACK GESVD and do some common checks.
+// A is destroyed.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_SVD(
+    index_type  num_rows,
+    index_type  num_cols,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    typename precision_traits<value_type>::scalar* sing_vals,  // min(num_rows, num_cols)
+    value_type* U_col_values,
+    index_type  U_col_leading_dim,
+    value_type* VT_col_values,
+    index_type  VT_col_leading_dim,
+    value_type* work,
+    std::size_t work_size,
+    typename precision_traits<value_type>::scalar* rwork)  // dense_matrix_SVD_rwork_size
+{
+    const index_type min_rows_cols = std::min(num_rows, num_cols);
+
+    bool success =
+        A_col_values &&
+        sing_vals &&
+        U_col_values &&
+        VT_col_values &&
+        work &&
+        rwork &&
+        num_rows <= A_col_leading_dim &&
+        num_rows <= U_col_leading_dim &&
+        min_rows_cols <= VT_col_leading_dim &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(num_rows) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(num_cols) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(A_col_leading_dim) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(U_col_leading_dim) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(VT_col_leading_dim) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(work_size);
+
+    assert(success);
+
+    if(success && min_rows_cols)
+    {
+        char job = 'S';
+
+        LAPACK_int LAPACK_m    = LAPACK_int(num_rows);
+        LAPACK_int LAPACK_n    = LAPACK_int(num_cols);
+        LAPACK_int LAPACK_lda  = LAPACK_int(A_col_leading_dim);
+        LAPACK_int LAPACK_ldu  = LAPACK_int(U_col_leading_dim);
+        LAPACK_int LAPACK_ldvt = LAPACK_int(VT_col_leading_dim);
+        LAPACK_int LAPACK_wsz  = LAPACK_int(work_size);
+
+        int info = 0;
+        LAPACK_gesvd(
+            &job, &job,
+            &LAPACK_m, &LAPACK_n,
+            A_col_values, &LAPACK_lda,
+            sing_vals,
+            U_col_values, &LAPACK_ldu,
+            VT_col_values, &LAPACK_ldvt,
+            work, &LAPACK_wsz,
+            rwork,
+            &info);
+
+        success = (info == 0);
+        assert(success);
+    }
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_SVD: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // DENSE_MATRIX_SVD_H
@@ -55,10 +55,22 @@ http://www.txcorp.com
 // -----------------------------------------------------------------------------
 
 #include "blas_wrap/dense_matrix_tri_solve.h"
+#include "blas_wrap/dense_matrix_mult.h"
+#include "dense_algorithms/dense_matrix_utils.h"
 #include "lapack/lapack_cpp_functions.h"
 #include "blas/blas_char_check.h"
+#include "math/precision_traits.h"
+#include "math/complex_types.h"
 #include "platform/integral_type_range.h"
 #include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <limits>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
 #include <cassert>
 
 // -----------------------------------------------------------------------------
@@ -227,4 +239,374 @@ bool dense_matrix_linear_hpd_solve_flip(
 
 // -----------------------------------------------------------------------------
 
+// Solve A * X = B when A is hermitian positive semi-definite, possibly
+// singular.  Uses the eigen-decomposition of A and treats eigenvalues below
+// rel_tol times the largest one as zero.  So X is the minimum norm least
+// squares solution of the truncated system.  Only the uplo triangle of A is
+// used.  A is over-written by the eigenvectors.  rank is the number of
+// eigenvalues kept.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_linear_hpd_solve_truncated(
+    char uplo,
+    index_type  matrix_size,
+    index_type  num_rhs,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    value_type* B_col_values,
+    index_type  B_col_leading_dim,
+    typename precision_traits<value_type>::scalar rel_tol,
+    index_type& rank)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    bool success =
+        BLAS_char_check_uplo(uplo) &&
+        A_col_values &&
+        B_col_values &&
+        matrix_size <= A_col_leading_dim &&
+        matrix_size <= B_col_leading_dim &&
+        !(rel_tol < 0) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(matrix_size) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(num_rhs) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(A_col_leading_dim) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(B_col_leading_dim);
+
+    assert(success);
+
+    rank = 0;
+
+    if(success && matrix_size)
+    {
+        const std::size_t n = std::size_t(matrix_size);
+        const std::size_t lda = std::size_t(A_col_leading_dim);
+
+        LAPACK_int LAPACK_n     = LAPACK_int(matrix_size);
+        LAPACK_int LAPACK_lda   = LAPACK_int(A_col_leading_dim);
+        LAPACK_int LAPACK_wsz   = LAPACK_int(-1);
+        LAPACK_int LAPACK_rwsz  = LAPACK_int(-1);
+        LAPACK_int LAPACK_iwsz  = LAPACK_int(-1);
+
+        char job = 'V';
+
+        std::vector<scalar_type> eig_vals, rwork;
+        std::vector<value_type> work, QTB;
+        std::vector<LAPACK_int> iwork;
+
+        try
+        {
+            eig_vals.resize(n);
+            rwork.resize(1);
+            iwork.resize(1);
+            work.resize(1);
+            QTB.resize(n * std::size_t(num_rhs));
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_matrix_linear_hpd_solve_truncated: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        int info = 0;
+
+        // Workspace query.
+        LAPACK_heevd(
+            &job, &uplo, &LAPACK_n,
+            A_col_values, &LAPACK_lda,
+            &eig_vals.front(),
+            &work.front(), &LAPACK_wsz,
+            &rwork.front(), &LAPACK_rwsz,
+            &iwork.front(), &LAPACK_iwsz,
+            &info);
+
+        success = info == 0;
+
+        if(success)
+        {
+            try
+            {
+                work.resize(std::max(std::size_t(1), std::size_t(std::real(work.front()))));
+                rwork.resize(std::max(std::size_t(1), std::size_t(rwork.front())));
+                iwork.resize(std::max(std::size_t(1), std::size_t(iwork.front())));
+            }
+            catch(const std::exception& exc)
+            {
+                assert(false);
+
+                internal_api_error_set_last(
+                    (std::string("dense_matrix_linear_hpd_solve_truncated: Exception. ") + exc.what()));
+
+                return false;
+            }
+
+            LAPACK_wsz  = LAPACK_int(work.size());
+            LAPACK_rwsz = LAPACK_int(rwork.size());
+            LAPACK_iwsz = LAPACK_int(iwork.size());
+
+            LAPACK_heevd(
+                &job, &uplo, &LAPACK_n,
+                A_col_values, &LAPACK_lda,
+                &eig_vals.front(),
+                &work.front(), &LAPACK_wsz,
+                &rwork.front(), &LAPACK_rwsz,
+                &iwork.front(), &LAPACK_iwsz,
+                &info);
+
+            success = info == 0;
+        }
+
+        if(success)
+        {
+            // Eigenvalues are in increasing order, so the kept ones are the
+            // last rank ones.  Negative ones are rounding errors.
+
+            const scalar_type tol = rel_tol * std::max(scalar_type(0), eig_vals.back());
+
+            while(rank < matrix_size && tol < eig_vals[n - 1 - std::size_t(rank)])
+                ++rank;
+
+            const std::size_t first = n - std::size_t(rank);
+            const value_type* Q_kept = A_col_values + first * lda;
+
+            // X = Q(:, kept) * inv(L(kept)) * Q(:, kept)' * B
+
+            success = !rank ||
+                dense_matrix_mult(
+                    'C', 'N',
+                    rank, num_rhs, matrix_size,
+                    value_type(1), Q_kept, A_col_leading_dim,
+                    B_col_values, B_col_leading_dim,
+                    value_type(0), &QTB.front(), matrix_size);
+
+            if(success)
+            {
+                for(index_type j = 0; j < num_rhs; ++j)
+                    for(index_type i = 0; i < rank; ++i)
+                        QTB[std::size_t(j) * n + std::size_t(i)] /= eig_vals[first + std::size_t(i)];
+
+                if(rank)
+                    success =
+                        dense_matrix_mult(
+                            'N', 'N',
+                            matrix_size, num_rhs, rank,
+                            value_type(1), Q_kept, A_col_leading_dim,
+                            &QTB.front(), matrix_size,
+                            value_type(0), B_col_values, B_col_leading_dim);
+                else
+                    for(index_type j = 0; j < num_rhs; ++j)
+                        std::fill(
+                            B_col_values + std::size_t(j) * std::size_t(B_col_leading_dim),
+                            B_col_values + std::size_t(j) * std::size_t(B_col_leading_dim) + n,
+                            value_type(0));
+            }
+        }
+
+        assert(success);
+    }
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_linear_hpd_solve_truncated: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Solve A * X = B when A is hermitian positive semi-definite.  Cholesky is
+// tried first.  If it fails, or if the condition number estimated from the
+// diagonal of the Cholesky factor is above max_condition, A is restored and
+// the system is solved with dense_matrix_linear_hpd_solve_truncated.  So a
+// singular or nearly singular A gives a usable solution instead of an error.
+// The eigen-decomposition costs several times the Cholesky factorization, so
+// it is only used up to max_truncated_size.  Above that, a failed Cholesky is
+// an error and an ill-conditioned one is used as is.
+//
+// Only the uplo triangle of A is used, but the whole of A is over-written.
+// To restore A without a copy, its uplo triangle is first mirrored into the
+// other triangle, which POTRF does not touch.  used_truncated, if not 0,
+// tells if the truncated solve was used.
+
+template<typename index_type, typename value_type>
+bool dense_matrix_linear_hpd_solve_robust(
+    char uplo,
+    index_type  matrix_size,
+    index_type  num_rhs,
+    value_type* A_col_values,
+    index_type  A_col_leading_dim,
+    value_type* B_col_values,
+    index_type  B_col_leading_dim,
+    typename precision_traits<value_type>::scalar max_condition,
+    index_type max_truncated_size,
+    bool* used_truncated = 0)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    bool success =
+        BLAS_char_check_uplo(uplo) &&
+        A_col_values &&
+        B_col_values &&
+        matrix_size <= A_col_leading_dim &&
+        matrix_size <= B_col_leading_dim &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(matrix_size) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(num_rhs) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(A_col_leading_dim) &&
+        integral_type_range_check_val<LAPACK_int>::in_non_negative_range(B_col_leading_dim);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "dense_matrix_linear_hpd_solve_robust: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    if(used_truncated)
+        *used_truncated = false;
+
+    if(!matrix_size)
+        return success;
+
+    const std::size_t n = std::size_t(matrix_size);
+    const std::size_t lda = std::size_t(A_col_leading_dim);
+
+    const bool may_truncate = matrix_size <= max_truncated_size;
+    const int uplo_is_up = BLAS_char_uplo_is_up(uplo);
+
+    value_type (*complex_conjugate)(const value_type&) = std::conj;
+
+    std::vector<value_type> A_diag;
+
+    if(may_truncate)
+    {
+        try
+        {
+            A_diag.resize(n);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("dense_matrix_linear_hpd_solve_robust: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        for(std::size_t i = 0; i < n; ++i)
+            A_diag[i] = A_col_values[i * lda + i];
+
+        success = uplo_is_up ?
+            dense_matrix_utils_copy_upper_to_lower_func(
+                matrix_size, A_col_values, A_col_leading_dim, complex_conjugate) :
+            dense_matrix_utils_copy_lower_to_upper_func(
+                matrix_size, A_col_values, A_col_leading_dim, complex_conjugate);
+    }
+
+    LAPACK_int LAPACK_n   = LAPACK_int(matrix_size);
+    LAPACK_int LAPACK_lda = LAPACK_int(A_col_leading_dim);
+
+    // Not dense_matrix_linear_hpd_factor because failure is expected here.
+
+    int info = 0;
+
+    if(success)
+        LAPACK_potrf(
+            &uplo, &LAPACK_n,
+            A_col_values, &LAPACK_lda,
+            &info);
+
+    bool truncate = success && info != 0;
+
+    if(success && !truncate && may_truncate)
+    {
+        // cond(A) >= (max |R_ii| / min |R_ii|)^2 for A = R' * R.
+
+        scalar_type min_diag = std::numeric_limits<scalar_type>::max();
+        scalar_type max_diag = 0;
+
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const scalar_type d = std::abs(A_col_values[i * lda + i]);
+
+            min_diag = std::min(min_diag, d);
+            max_diag = std::max(max_diag, d);
+        }
+
+        const scalar_type ratio = max_diag / min_diag;
+
+        // Written so that NaN also truncates.
+        truncate = !(ratio * ratio <= max_condition);
+    }
+
+    if(truncate && !may_truncate)
+    {
+        success = false;
+    }
+    else if(success && !truncate)
+    {
+        const char trans_1 = uplo_is_up ? 'C' : 'N';
+        const char trans_2 = uplo_is_up ? 'N' : 'C';
+        const char unit_diag = 'N';
+
+        success =
+            dense_matrix_tri_solve(
+                'L', uplo, trans_1, unit_diag,
+                matrix_size, num_rhs, value_type(1),
+                A_col_values, A_col_leading_dim,
+                B_col_values, B_col_leading_dim)
+            &&
+            dense_matrix_tri_solve(
+                'L', uplo, trans_2, unit_diag,
+                matrix_size, num_rhs, value_type(1),
+                A_col_values, A_col_leading_dim,
+                B_col_values, B_col_leading_dim);
+    }
+    else if(success)
+    {
+        // B is untouched so far.  Restore the uplo triangle of A.
+
+        success = uplo_is_up ?
+            dense_matrix_utils_copy_lower_to_upper_func(
+                matrix_size, A_col_values, A_col_leading_dim, complex_conjugate) :
+            dense_matrix_utils_copy_upper_to_lower_func(
+                matrix_size, A_col_values, A_col_leading_dim, complex_conjugate);
+
+        for(std::size_t i = 0; i < n; ++i)
+            A_col_values[i * lda + i] = A_diag[i];
+
+        // Same relative tolerance as the default of MATLAB pinv.
+        const scalar_type rel_tol =
+            scalar_type(matrix_size) * std::numeric_limits<scalar_type>::epsilon(); // MAGIC CONSTANT
+
+        index_type rank = 0;
+
+        success = success &&
+            dense_matrix_linear_hpd_solve_truncated(
+                uplo, matrix_size, num_rhs,
+                A_col_values, A_col_leading_dim,
+                B_col_values, B_col_leading_dim,
+                rel_tol, rank);
+
+        if(used_truncated)
+            *used_truncated = true;
+    }
+
+    assert(success);
+
+    if(!success)
+        internal_api_error_set_last(
+            "dense_matrix_linear_hpd_solve_robust: Error.");
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
 #endif // DENSE_MATRIX_LINEAR_HPD_H
@@ -0,0 +1,302 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef ABS_POW_SUM_H
+#define ABS_POW_SUM_H
+
+// -----------------------------------------------------------------------------
+
+#include "math/abs_pow_sum_dispatch.h"
+#include <complex>
+#include <cmath>       // std::{pow, fabs}
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Kernels for |v_i|^p based reductions over a contiguous array of
+// real or complex numbers, one for each p case used in p-norm computation.
+//
+// p = 0       =>  abs_pow_count_non_zero
+// p = 1       =>  abs_pow_sum_abs
+// p = 2       =>  abs_pow_sum_abs_square
+// other p     =>  abs_pow_sum_abs_pow
+// p = inf     =>  abs_pow_max_abs
+//
+// The real versions keep four independent partial results so that the loop
+// body has no dependency on the previous iteration and the compiler can keep
+// them in one vector register.  The complex versions for p = 0 and p = 2 read
+// the data as interleaved (real, imag) scalars, which is allowed for
+// std::complex, and reuse the real loops.  For p = 1 and p = inf, the complex
+// versions use std::abs to avoid overflow in |v|^2 for large |v|.
+//
+// The real loops are the *_scalars functions.  The public functions reach them
+// through abs_pow_sum_dispatch, which has copies compiled for wider vector
+// instruction sets and picks one on first use.  Its vector copies of
+// abs_pow_max_abs_scalars are written with intrinsics.
+//
+// The summation order differs from a plain left to right loop, so results may
+// differ in the last bits.
+// -----------------------------------------------------------------------------
+
+template<typename scalar_type>
+std::size_t abs_pow_count_non_zero_interleaved(
+    std::size_t n,
+    const scalar_type* vals,
+    std::size_t stride)
+{
+    std::size_t count = 0;
+
+    if(stride == 1)
+    {
+        for(std::size_t i = 0; i < n; ++i)
+            count += vals[i] != scalar_type(0);
+    }
+    else
+    {
+        assert(stride == 2);
+
+        for(std::size_t i = 0; i < n; ++i)
+            count += (vals[2*i] != scalar_type(0)) | (vals[2*i + 1] != scalar_type(0));
+    }
+
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename scalar_type>
+inline scalar_type abs_pow_sum_square_scalars(
+    std::size_t n,
+    const scalar_type* vals)
+{
+    scalar_type s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+    const std::size_t n4 = n - n % 4;
+
+    for(std::size_t i = 0; i < n4; i += 4)
+    {
+        s0 += vals[i    ] * vals[i    ];
+        s1 += vals[i + 1] * vals[i + 1];
+        s2 += vals[i + 2] * vals[i + 2];
+        s3 += vals[i + 3] * vals[i + 3];
+    }
+
+    for(std::size_t i = n4; i < n; ++i)
+        s0 += vals[i] * vals[i];
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+template<typename scalar_type>
+inline scalar_type abs_pow_sum_abs_scalars(
+    std::size_t n,
+    const scalar_type* vals)
+{
+    scalar_type s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+    const std::size_t n4 = n - n % 4;
+
+    for(std::size_t i = 0; i < n4; i += 4)
+    {
+        s0 += std::fabs(vals[i    ]);
+        s1 += std::fabs(vals[i + 1]);
+        s2 += std::fabs(vals[i + 2]);
+        s3 += std::fabs(vals[i + 3]);
+    }
+
+    for(std::size_t i = n4; i < n; ++i)
+        s0 += std::fabs(vals[i]);
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+template<typename scalar_type>
+inline scalar_type abs_pow_max_abs_scalars(
+    std::size_t n,
+    const scalar_type* vals)
+{
+    scalar_type m0 = 0, m1 = 0, m2 = 0, m3 = 0;
+
+    const std::size_t n4 = n - n % 4;
+
+    for(std::size_t i = 0; i < n4; i += 4)
+    {
+        const scalar_type a0 = std::fabs(vals[i    ]);
+        const scalar_type a1 = std::fabs(vals[i + 1]);
+        const scalar_type a2 = std::fabs(vals[i + 2]);
+        const scalar_type a3 = std::fabs(vals[i + 3]);
+
+        m0 = m0 < a0 ? a0 : m0;
+        m1 = m1 < a1 ? a1 : m1;
+        m2 = m2 < a2 ? a2 : m2;
+        m3 = m3 < a3 ? a3 : m3;
+    }
+
+    for(std::size_t i = n4; i < n; ++i)
+    {
+        const scalar_type a0 = std::fabs(vals[i]);
+        m0 = m0 < a0 ? a0 : m0;
+    }
+
+    m0 = m0 < m1 ? m1 : m0;
+    m2 = m2 < m3 ? m3 : m2;
+
+    return m0 < m2 ? m2 : m0;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_count_non_zero(
+    index_type n,
+    const scalar_type* vals)
+{
+    return scalar_type(abs_pow_count_non_zero_interleaved(std::size_t(n), vals, 1));
+}
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_count_non_zero(
+    index_type n,
+    const std::complex<scalar_type>* vals)
+{
+    return scalar_type(abs_pow_count_non_zero_interleaved(
+        std::size_t(n), reinterpret_cast<const scalar_type*>(vals), 2));
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_sum_abs(
+    index_type n,
+    const scalar_type* vals)
+{
+    return abs_pow_sum_dispatch(scalar_type()).sum_abs(std::size_t(n), vals);
+}
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_sum_abs(
+    index_type n,
+    const std::complex<scalar_type>* vals)
+{
+    scalar_type sum = 0;
+
+    for(index_type i = 0; i < n; ++i)
+        sum += std::abs(vals[i]);
+
+    return sum;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_sum_abs_square(
+    index_type n,
+    const scalar_type* vals)
+{
+    return abs_pow_sum_dispatch(scalar_type()).sum_square(std::size_t(n), vals);
+}
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_sum_abs_square(
+    index_type n,
+    const std::complex<scalar_type>* vals)
+{
+    return abs_pow_sum_dispatch(scalar_type()).sum_square(
+        2 * std::size_t(n), reinterpret_cast<const scalar_type*>(vals));
+}
+
+// -----------------------------------------------------------------------------
+
+// std::pow does not vectorize, so there is nothing to gain from interleaving.
+
+template<typename index_type, typename value_type, typename scalar_type>
+scalar_type abs_pow_sum_abs_pow(
+    index_type n,
+    const value_type* vals,
+    scalar_type p)
+{
+    scalar_type sum = 0;
+
+    for(index_type i = 0; i < n; ++i)
+        sum += std::pow(std::abs(vals[i]), p);
+
+    return sum;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_max_abs(
+    index_type n,
+    const scalar_type* vals)
+{
+    return abs_pow_sum_dispatch(scalar_type()).max_abs(std::size_t(n), vals);
+}
+
+template<typename index_type, typename scalar_type>
+scalar_type abs_pow_max_abs(
+    index_type n,
+    const std::complex<scalar_type>* vals)
+{
+    scalar_type m = 0;
+
+    for(index_type i = 0; i < n; ++i)
+    {
+        const scalar_type a = std::abs(vals[i]);
+        m = m < a ? a : m;
+    }
+
+    return m;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // ABS_POW_SUM_H
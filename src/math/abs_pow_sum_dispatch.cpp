@@ -0,0 +1,278 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+// -----------------------------------------------------------------------------
+
+#include "math/abs_pow_sum_dispatch.h"
+#include "math/abs_pow_sum.h"
+#include "platform/cpu_features.h"
+
+// -----------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4514 ) // unreferenced inline function has been removed
+#pragma warning( disable : 4710 ) // function not inlined
+#endif
+
+// -----------------------------------------------------------------------------
+
+// The ISA specific copies use function attributes instead of compiling this
+// file with -mavx2 etc.  With such flags, out-of-line template instances
+// emitted here could be picked by the linker for callers in other files and
+// run on CPUs without the extension.  flatten inlines the *_scalars loops so
+// they are compiled for the attribute's target.
+
+#define ABS_POW_SUM_DISPATCH_NO_TARGET
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ABS_POW_SUM_DISPATCH_X86
+#define ABS_POW_SUM_DISPATCH_TARGET(isa) __attribute__((target(isa), flatten))
+#include <immintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+
+// The table of a copy.  abs_pow_max_abs_##suffix must already exist.
+
+#define ABS_POW_SUM_DISPATCH_KERNELS(suffix, attr, scalar_type)          \
+                                                                        \
+attr scalar_type abs_pow_sum_abs_##suffix(                              \
+    std::size_t n, const scalar_type* vals)                             \
+{                                                                       \
+    return abs_pow_sum_abs_scalars(n, vals);                            \
+}                                                                       \
+                                                                        \
+attr scalar_type abs_pow_sum_square_##suffix(                           \
+    std::size_t n, const scalar_type* vals)                             \
+{                                                                       \
+    return abs_pow_sum_square_scalars(n, vals);                         \
+}                                                                       \
+                                                                        \
+const abs_pow_sum_kernels<scalar_type> abs_pow_sum_kernels_##suffix =   \
+{                                                                       \
+    abs_pow_sum_abs_##suffix,                                           \
+    abs_pow_sum_square_##suffix,                                        \
+    abs_pow_max_abs_##suffix                                            \
+};
+
+// Compilers vectorize the sums, but not the max loop of
+// abs_pow_max_abs_scalars unless NaN and signed zeros may be ignored.  So the
+// vector copies of max_abs are written with intrinsics.  max(|x|, m) gives m
+// when x is NaN, as the scalar loop does.  The four accumulators are as in
+// the scalar loop, and the remainder goes to it.
+
+#define ABS_POW_SUM_DISPATCH_MAX_ABS(suffix, attr, scalar_type,                     \
+    vec_type, width, setzero, loadu, storeu, max, abs)                              \
+                                                                                    \
+attr scalar_type abs_pow_max_abs_##suffix(                                          \
+    std::size_t n, const scalar_type* vals)                                         \
+{                                                                                   \
+    vec_type m0 = setzero(), m1 = setzero(), m2 = setzero(), m3 = setzero();        \
+                                                                                    \
+    const std::size_t n4 = n - n % (4 * width);                                     \
+                                                                                    \
+    for(std::size_t i = 0; i < n4; i += 4 * width)                                  \
+    {                                                                               \
+        m0 = max(abs(loadu(vals + i            )), m0);                             \
+        m1 = max(abs(loadu(vals + i +     width)), m1);                             \
+        m2 = max(abs(loadu(vals + i + 2 * width)), m2);                             \
+        m3 = max(abs(loadu(vals + i + 3 * width)), m3);                             \
+    }                                                                               \
+                                                                                    \
+    scalar_type lanes[2 * width];                                                   \
+                                                                                    \
+    storeu(lanes,         max(m0, m1));                                             \
+    storeu(lanes + width, max(m2, m3));                                             \
+                                                                                    \
+    const scalar_type m_lanes = abs_pow_max_abs_scalars(2 * width, lanes);          \
+    const scalar_type m_rest  = abs_pow_max_abs_scalars(n - n4, vals + n4);         \
+                                                                                    \
+    return m_lanes < m_rest ? m_rest : m_lanes;                                     \
+}
+
+#define ABS_POW_SUM_DISPATCH_MAX_ABS_SCALARS(suffix, attr, scalar_type)  \
+                                                                        \
+attr scalar_type abs_pow_max_abs_##suffix(                              \
+    std::size_t n, const scalar_type* vals)                             \
+{                                                                       \
+    return abs_pow_max_abs_scalars(n, vals);                            \
+}
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+
+ABS_POW_SUM_DISPATCH_MAX_ABS_SCALARS(generic_float,  ABS_POW_SUM_DISPATCH_NO_TARGET, float)
+ABS_POW_SUM_DISPATCH_MAX_ABS_SCALARS(generic_double, ABS_POW_SUM_DISPATCH_NO_TARGET, double)
+
+ABS_POW_SUM_DISPATCH_KERNELS(generic_float,  ABS_POW_SUM_DISPATCH_NO_TARGET, float)
+ABS_POW_SUM_DISPATCH_KERNELS(generic_double, ABS_POW_SUM_DISPATCH_NO_TARGET, double)
+
+#ifdef ABS_POW_SUM_DISPATCH_X86
+
+// AVX2 has no abs, so clear the sign bit.
+
+ABS_POW_SUM_DISPATCH_TARGET("avx2,fma") inline __m256 abs_pow_sum_avx2_abs_ps(__m256 x)
+{
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+ABS_POW_SUM_DISPATCH_TARGET("avx2,fma") inline __m256d abs_pow_sum_avx2_abs_pd(__m256d x)
+{
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+// _mm512_max_* start from _mm512_undefined_*, which GCC 12 warns about.  The
+// zero-masked forms with a full mask are the same instruction.
+
+ABS_POW_SUM_DISPATCH_TARGET("avx512f,avx2,fma") inline __m512 abs_pow_sum_avx512_max_ps(__m512 x, __m512 y)
+{
+    return _mm512_maskz_max_ps(__mmask16(0xFFFF), x, y);
+}
+
+ABS_POW_SUM_DISPATCH_TARGET("avx512f,avx2,fma") inline __m512d abs_pow_sum_avx512_max_pd(__m512d x, __m512d y)
+{
+    return _mm512_maskz_max_pd(__mmask8(0xFF), x, y);
+}
+
+ABS_POW_SUM_DISPATCH_MAX_ABS(avx2_float, ABS_POW_SUM_DISPATCH_TARGET("avx2,fma"), float,
+    __m256, 8, _mm256_setzero_ps, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_max_ps,
+    abs_pow_sum_avx2_abs_ps)
+
+ABS_POW_SUM_DISPATCH_MAX_ABS(avx2_double, ABS_POW_SUM_DISPATCH_TARGET("avx2,fma"), double,
+    __m256d, 4, _mm256_setzero_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_max_pd,
+    abs_pow_sum_avx2_abs_pd)
+
+ABS_POW_SUM_DISPATCH_MAX_ABS(avx512_float, ABS_POW_SUM_DISPATCH_TARGET("avx512f,avx2,fma"), float,
+    __m512, 16, _mm512_setzero_ps, _mm512_loadu_ps, _mm512_storeu_ps, abs_pow_sum_avx512_max_ps,
+    _mm512_abs_ps)
+
+ABS_POW_SUM_DISPATCH_MAX_ABS(avx512_double, ABS_POW_SUM_DISPATCH_TARGET("avx512f,avx2,fma"), double,
+    __m512d, 8, _mm512_setzero_pd, _mm512_loadu_pd, _mm512_storeu_pd, abs_pow_sum_avx512_max_pd,
+    _mm512_abs_pd)
+
+ABS_POW_SUM_DISPATCH_KERNELS(avx2_float,    ABS_POW_SUM_DISPATCH_TARGET("avx2,fma"), float)
+ABS_POW_SUM_DISPATCH_KERNELS(avx2_double,   ABS_POW_SUM_DISPATCH_TARGET("avx2,fma"), double)
+ABS_POW_SUM_DISPATCH_KERNELS(avx512_float,  ABS_POW_SUM_DISPATCH_TARGET("avx512f,avx2,fma"), float)
+ABS_POW_SUM_DISPATCH_KERNELS(avx512_double, ABS_POW_SUM_DISPATCH_TARGET("avx512f,avx2,fma"), double)
+
+#endif
+
+template<typename scalar_type>
+const abs_pow_sum_kernels<scalar_type>& abs_pow_sum_dispatch_select(
+    cpu_features_isa isa,
+    const abs_pow_sum_kernels<scalar_type>& generic_kernels,
+    const abs_pow_sum_kernels<scalar_type>& avx2_kernels,
+    const abs_pow_sum_kernels<scalar_type>& avx512_kernels)
+{
+    switch(isa)
+    {
+    case cpu_features_avx512: return avx512_kernels;
+    case cpu_features_avx2:   return avx2_kernels;
+    default:                  return generic_kernels;
+    }
+}
+
+}
+
+// -----------------------------------------------------------------------------
+
+const abs_pow_sum_kernels<float>& abs_pow_sum_dispatch_isa(cpu_features_isa isa, float)
+{
+#ifdef ABS_POW_SUM_DISPATCH_X86
+    return abs_pow_sum_dispatch_select(
+        isa,
+        abs_pow_sum_kernels_generic_float,
+        abs_pow_sum_kernels_avx2_float,
+        abs_pow_sum_kernels_avx512_float);
+#else
+    (void) isa;
+
+    return abs_pow_sum_kernels_generic_float;
+#endif
+}
+
+const abs_pow_sum_kernels<double>& abs_pow_sum_dispatch_isa(cpu_features_isa isa, double)
+{
+#ifdef ABS_POW_SUM_DISPATCH_X86
+    return abs_pow_sum_dispatch_select(
+        isa,
+        abs_pow_sum_kernels_generic_double,
+        abs_pow_sum_kernels_avx2_double,
+        abs_pow_sum_kernels_avx512_double);
+#else
+    (void) isa;
+
+    return abs_pow_sum_kernels_generic_double;
+#endif
+}
+
+// The tables above are constant initialized.  The choice among them is made
+// on first use, not by a dynamic initializer, so that callers from other
+// static initializers see it.
+
+const abs_pow_sum_kernels<float>& abs_pow_sum_dispatch(float)
+{
+    static const abs_pow_sum_kernels<float>* const table =
+        &abs_pow_sum_dispatch_isa(cpu_features_best_isa(), float());
+
+    return *table;
+}
+
+const abs_pow_sum_kernels<double>& abs_pow_sum_dispatch(double)
+{
+    static const abs_pow_sum_kernels<double>* const table =
+        &abs_pow_sum_dispatch_isa(cpu_features_best_isa(), double());
+
+    return *table;
+}
+
+// -----------------------------------------------------------------------------
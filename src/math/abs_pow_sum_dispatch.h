@@ -0,0 +1,86 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+#ifndef ABS_POW_SUM_DISPATCH_H
+#define ABS_POW_SUM_DISPATCH_H
+
+// -----------------------------------------------------------------------------
+
+#include "platform/cpu_features.h"
+#include <cstddef>  // std::size_t
+
+// -----------------------------------------------------------------------------
+// Objective: Run time choice among copies of the real kernels in
+// math/abs_pow_sum.h compiled for different x86 vector instruction sets.  The
+// copies are in abs_pow_sum_dispatch.cpp.  The table is chosen once, on the
+// first call, using platform/cpu_features.h.  With compilers other than
+// GCC and Clang, or on other CPUs, only the generic copy exists.
+// -----------------------------------------------------------------------------
+
+template<typename scalar_type>
+struct abs_pow_sum_kernels
+{
+    scalar_type (*sum_abs)   (std::size_t n, const scalar_type* vals);
+    scalar_type (*sum_square)(std::size_t n, const scalar_type* vals);
+    scalar_type (*max_abs)   (std::size_t n, const scalar_type* vals);
+};
+
+// The argument only selects the overload.
+const abs_pow_sum_kernels<float>&  abs_pow_sum_dispatch(float);
+const abs_pow_sum_kernels<double>& abs_pow_sum_dispatch(double);
+
+// The table compiled for isa, or the generic one if there is no such copy.
+// The CPU is not checked, so callers other than tests should use the above.
+const abs_pow_sum_kernels<float>&  abs_pow_sum_dispatch_isa(cpu_features_isa isa, float);
+const abs_pow_sum_kernels<double>& abs_pow_sum_dispatch_isa(cpu_features_isa isa, double);
+
+// -----------------------------------------------------------------------------
+
+#endif // ABS_POW_SUM_DISPATCH_H
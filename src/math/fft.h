@@ -0,0 +1,254 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef FFT_H
+#define FFT_H
+
+// -----------------------------------------------------------------------------
+
+#include "internal_api_error/internal_api_error.h"
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <algorithm> // std::swap
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Discrete Fourier transform of a complex vector of any length in
+// O(n log n).  Lengths that are powers of two use an iterative radix-2
+// transform.  Other lengths use Bluestein's algorithm, which writes the
+// transform as a convolution and computes that with radix-2 transforms of
+// length at least 2n - 1.
+//
+// Forward: X[k] = sum_j x[j] exp(-2 pi i j k / n)
+// Inverse: x[j] = (1/n) sum_k X[k] exp(+2 pi i j k / n)
+// -----------------------------------------------------------------------------
+
+template<typename scalar_type>
+scalar_type fft_pi()
+{
+    return scalar_type(3.14159265358979323846264338327950288); // MAGIC CONSTANT
+}
+
+// exp(sign * pi * i * num / den), with num reduced modulo 2 den so that the
+// angle stays in [0, 2 pi) for accuracy.
+template<typename scalar_type>
+std::complex<scalar_type> fft_unit_root(
+    std::size_t num,
+    std::size_t den,
+    int sign)
+{
+    const std::size_t num_reduced = num % (2 * den);
+
+    const double angle =
+        double(sign) * fft_pi<double>() * double(num_reduced) / double(den);
+
+    return std::complex<scalar_type>(
+        scalar_type(std::cos(angle)), scalar_type(std::sin(angle)));
+}
+
+// -----------------------------------------------------------------------------
+
+// Unnormalized radix-2 transform.  n must be a power of two.  twiddles has
+// n/2 entries, twiddles[j] = exp(sign * 2 pi i j / n), with sign = -1 for the
+// forward transform and +1 for the inverse.
+template<typename scalar_type>
+void fft_radix2_in_place(
+    std::size_t n,
+    std::complex<scalar_type>* x,
+    const std::complex<scalar_type>* twiddles)
+{
+    // Bit reversal permutation.
+    for(std::size_t i = 1, j = 0; i < n; ++i)
+    {
+        std::size_t bit = n >> 1;
+
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+
+        j ^= bit;
+
+        if(i < j)
+            std::swap(x[i], x[j]);
+    }
+
+    for(std::size_t len = 2; len <= n; len <<= 1)
+    {
+        const std::size_t half = len >> 1;
+        const std::size_t stride = n / len;
+
+        for(std::size_t start = 0; start < n; start += len)
+        {
+            std::complex<scalar_type>* lo = x + start;
+            std::complex<scalar_type>* hi = lo + half;
+
+            for(std::size_t j = 0; j < half; ++j)
+            {
+                const std::complex<scalar_type> t = hi[j] * twiddles[j * stride];
+                hi[j] = lo[j] - t;
+                lo[j] += t;
+            }
+        }
+    }
+}
+
+template<typename scalar_type>
+void fft_radix2_twiddles(
+    std::size_t n,
+    int sign,
+    std::vector< std::complex<scalar_type> >& twiddles) // resized by caller to n/2
+{
+    for(std::size_t j = 0; j < n / 2; ++j)
+        twiddles[j] = fft_unit_root<scalar_type>(2 * j, n, sign);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename scalar_type>
+bool fft_in_place(
+    std::size_t n,
+    std::complex<scalar_type>* x,
+    bool inverse)
+{
+    bool success = x || n == 0;
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last("fft_in_place: Unacceptable input argument(s).");
+        return false;
+    }
+
+    if(n <= 1)
+        return true;
+
+    const int sign = inverse ? 1 : -1;
+
+    const bool is_power_of_two = (n & (n - 1)) == 0;
+
+    try
+    {
+        if(is_power_of_two)
+        {
+            std::vector< std::complex<scalar_type> > twiddles(n / 2);
+
+            fft_radix2_twiddles(n, sign, twiddles);
+            fft_radix2_in_place(n, x, &twiddles.front());
+        }
+        else
+        {
+            // Bluestein: with w[j] = exp(sign pi i j^2 / n),
+            // X[k] = w[k] sum_j (x[j] w[j]) conj(w[k - j]).
+
+            std::size_t m = 1;
+
+            while(m < 2 * n - 1)
+                m <<= 1;
+
+            std::vector< std::complex<scalar_type> > chirp(n);
+            std::vector< std::complex<scalar_type> > a(m), b(m);
+            std::vector< std::complex<scalar_type> > twiddles_fwd(m / 2), twiddles_inv(m / 2);
+
+            for(std::size_t j = 0; j < n; ++j)
+                chirp[j] = fft_unit_root<scalar_type>(j * j, n, sign);
+
+            for(std::size_t j = 0; j < n; ++j)
+                a[j] = x[j] * chirp[j];
+
+            b[0] = std::conj(chirp[0]);
+
+            for(std::size_t j = 1; j < n; ++j)
+                b[j] = b[m - j] = std::conj(chirp[j]);
+
+            fft_radix2_twiddles(m, -1, twiddles_fwd);
+            fft_radix2_twiddles(m,  1, twiddles_inv);
+
+            fft_radix2_in_place(m, &a.front(), &twiddles_fwd.front());
+            fft_radix2_in_place(m, &b.front(), &twiddles_fwd.front());
+
+            for(std::size_t j = 0; j < m; ++j)
+                a[j] *= b[j];
+
+            fft_radix2_in_place(m, &a.front(), &twiddles_inv.front());
+
+            const scalar_type inv_m = scalar_type(1) / scalar_type(m);
+
+            for(std::size_t k = 0; k < n; ++k)
+                x[k] = a[k] * chirp[k] * inv_m;
+        }
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("fft_in_place: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    if(inverse)
+    {
+        const scalar_type inv_n = scalar_type(1) / scalar_type(n);
+
+        for(std::size_t j = 0; j < n; ++j)
+            x[j] *= inv_n;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // FFT_H
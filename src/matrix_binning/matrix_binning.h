@@ -58,17 +58,115 @@ http://www.txcorp.com
 #include "cpp/const_modifications.h"
 #include "math/precision_traits.h"
 #include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <limits>
+#include <cstddef>
+#include <cmath>
 #include <cassert>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // -----------------------------------------------------------------------------
 // Objective: Create a binned pattern depending on matrix values.
 // -----------------------------------------------------------------------------
 
+// How the values on each side of the separation are divided into bins.
+enum matrix_binning_method
+{
+    matrix_binning_method_uniform,   // Bins of equal width.
+    matrix_binning_method_quantile,  // Bins with (nearly) equal number of values.
+    matrix_binning_method_kmeans,    // 1-D k-means of log of distance from separation.
+    matrix_binning_method_num_methods
+};
+
+// Divide sorted positive values d[0, n) into n_bins contiguous groups
+// [splits[c], splits[c + 1]), with splits[0] = 0 and splits[n_bins] = n.
+// Quantile groups have nearly equal number of values.  k-means groups
+// locally minimize the sum of squared distances of log(d) to their means.
+// These are found by Lloyd iterations starting from quantile groups.  In 1-D,
+// an iteration only moves each split to the midpoint of the adjacent means,
+// which is a binary search with prefix sums of log(d).  May throw.
+
+template<typename value_type>
+void matrix_binning_sorted_splits(
+    const value_type* d,
+    std::size_t n,
+    std::size_t n_bins,
+    matrix_binning_method method,
+    std::vector<std::size_t>& splits)
+{
+    assert(0 < n_bins && n_bins <= n);
+
+    splits.resize(n_bins + 1);
+
+    for(std::size_t c = 0; c <= n_bins; ++c)
+        splits[c] = (c * n) / n_bins;
+
+    if(method == matrix_binning_method_kmeans && 1 < n_bins)
+    {
+        std::vector<value_type> log_d(n);
+        std::vector<value_type> sums(n + 1);
+        std::vector<value_type> means(n_bins);
+
+        sums[0] = 0;
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+            log_d[k] = std::log(d[k]);
+            sums[k + 1] = sums[k] + log_d[k];
+        }
+
+        const std::size_t max_num_iters = 100; // MAGIC CONSTANT
+
+        for(std::size_t iter = 0; iter < max_num_iters; ++iter)
+        {
+            for(std::size_t c = 0; c < n_bins; ++c)
+            {
+                const std::size_t b = splits[c];
+                const std::size_t e = splits[c + 1];
+
+                // Empty groups keep the means non-decreasing.
+                means[c] = b < e ?
+                    (sums[e] - sums[b]) / value_type(e - b) :
+                    (c ? means[c - 1] : log_d[0]);
+            }
+
+            bool changed = false;
+
+            for(std::size_t c = 1; c < n_bins; ++c)
+            {
+                const value_type mid = (means[c - 1] + means[c]) / 2;
+
+                const std::size_t split = std::size_t(
+                    std::lower_bound(log_d.begin(), log_d.end(), mid) - log_d.begin());
+
+                if(split != splits[c])
+                {
+                    splits[c] = split;
+                    changed = true;
+                }
+            }
+
+            if(!changed)
+                break;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename bin_index_type, typename value_type>
 struct matrix_binning_worker
 {
     matrix_binning_worker()
         :
+        method(matrix_binning_method_uniform),
         max_n_left_bins(0),
         max_n_right_bins(0),
         inv_h_l(0),
@@ -125,10 +223,127 @@ struct matrix_binning_worker
         right_tol = 100 * std::numeric_limits<value_type>::epsilon() * right_dist;  // MAGIC CONSTANT
     }
 
+    // Same as above, but for methods other than matrix_binning_method_uniform.
+    // The values are not perturbed.  Each side gets a share of max_num_bins
+    // proportional to its number of values.  vals must have all the values
+    // seen by sep_min_max, and it is overwritten.  Returns false on exception.
+    bool use(
+        const std_utils_separated_min_max<value_type>& sep_min_max,
+        bin_index_type max_num_bins,
+        matrix_binning_method in_method,
+        std::vector<value_type>& vals)
+    {
+        assert(in_method != matrix_binning_method_uniform);
+
+        method = in_method;
+        separated_at = sep_min_max.separation();
+        min_left  = sep_min_max.min_left();
+        max_right = sep_min_max.max_right();
+        left_tol  = 0;
+        right_tol = 0;
+
+        bool success = true;
+
+        try
+        {
+            std::sort(vals.begin(), vals.end());
+
+            const std::size_t n = vals.size();
+
+            const std::size_t n_left = std::size_t(
+                std::lower_bound(vals.begin(), vals.end(), separated_at) - vals.begin());
+
+            const std::size_t right_begin = std::size_t(
+                std::upper_bound(vals.begin(), vals.end(), separated_at) - vals.begin());
+
+            const std::size_t n_right = n - right_begin;
+
+            // Distances from separated_at, in increasing order on each side.
+            for(std::size_t k = 0; k < n_left; ++k)
+                vals[k] = separated_at - vals[k];
+
+            std::reverse(vals.begin(), vals.begin() + std::ptrdiff_t(n_left));
+
+            for(std::size_t k = right_begin; k < n; ++k)
+                vals[k] = vals[k] - separated_at;
+
+            const std::size_t loc_max_num_left_right_bins =
+                std::size_t(max_num_bins) - (sep_min_max.any_at_separation() ? 1 : 0);
+
+            std::size_t n_left_bins  = 0;
+            std::size_t n_right_bins = 0;
+
+            if(n_left && n_right)
+            {
+                // If only one bin, right values go to the separation bin.
+                n_left_bins = 1;
+
+                if(1 < loc_max_num_left_right_bins)
+                {
+                    const std::size_t share = std::size_t(
+                        (double(loc_max_num_left_right_bins) * double(n_left)) /
+                        double(n_left + n_right) + 0.5);
+
+                    n_left_bins = std::min(std::max(share, std::size_t(1)), loc_max_num_left_right_bins - 1);
+                    n_right_bins = loc_max_num_left_right_bins - n_left_bins;
+                }
+            }
+            else if(n_left)
+                n_left_bins = loc_max_num_left_right_bins;
+            else if(n_right)
+                n_right_bins = loc_max_num_left_right_bins;
+
+            n_left_bins  = std::min(n_left_bins, n_left);
+            n_right_bins = std::min(n_right_bins, n_right);
+
+            max_n_left_bins  = bin_index_type(n_left_bins);
+            max_n_right_bins = bin_index_type(n_right_bins);
+
+            std::vector<std::size_t> splits;
+
+            left_splits.clear();
+            right_splits.clear();
+
+            if(n_left_bins)
+            {
+                matrix_binning_sorted_splits(&vals.front(), n_left, n_left_bins, method, splits);
+
+                for(std::size_t c = 1; c < n_left_bins; ++c)
+                    left_splits.push_back(splits[c] < n_left ?
+                        vals[splits[c]] : std::numeric_limits<value_type>::max());
+            }
+
+            if(n_right_bins)
+            {
+                matrix_binning_sorted_splits(&vals[right_begin], n_right, n_right_bins, method, splits);
+
+                for(std::size_t c = 1; c < n_right_bins; ++c)
+                    right_splits.push_back(splits[c] < n_right ?
+                        vals[right_begin + splits[c]] : std::numeric_limits<value_type>::max());
+            }
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            success = false;
+
+            internal_api_error_set_last(
+                (std::string("matrix_binning_worker: Exception. ") + exc.what()));
+        }
+
+        return success;
+    }
+
     bin_index_type bin_of(const value_type& v) const
     {
-        assert(!(v < min_left));
-        assert(!(max_right < v));
+        if(method != matrix_binning_method_uniform)
+            return sorted_bin_of(v);
+
+        // min_left (max_right) is meaningful only if there were values on the
+        // left (right) side.
+        assert(!(v < separated_at) || !(v < min_left));
+        assert(!(separated_at < v) || !(max_right < v));
         assert(!(left_tol < 0));
         assert(!(right_tol < 0));
 
@@ -158,6 +373,32 @@ struct matrix_binning_worker
 
 private:
 
+    bin_index_type sorted_bin_of(const value_type& v) const
+    {
+        bin_index_type ans;
+
+        if(v == separated_at)
+        {
+            ans = max_n_left_bins + max_n_right_bins;
+        }
+        else if(v < separated_at)
+        {
+            ans = bin_index_type(
+                std::upper_bound(left_splits.begin(), left_splits.end(), separated_at - v) -
+                left_splits.begin());
+        }
+        else // if(separated_at < v)
+        {
+            ans = max_n_left_bins + bin_index_type(
+                std::upper_bound(right_splits.begin(), right_splits.end(), v - separated_at) -
+                right_splits.begin());
+        }
+
+        return ans;
+    }
+
+    matrix_binning_method method;
+
     bin_index_type max_n_left_bins;
     bin_index_type max_n_right_bins;
 
@@ -170,8 +411,163 @@ private:
 
     value_type left_tol;
     value_type right_tol;
+
+    // Smallest distance from separated_at of each bin but the first, used
+    // only for methods other than matrix_binning_method_uniform.
+    std::vector<value_type> left_splits;
+    std::vector<value_type> right_splits;
 };
 
+// -----------------------------------------------------------------------------
+// Objective: Helpers to run matrix_binning on multiple threads.  Vectors are
+// statically divided among threads.  Each thread reduces its own min/max and
+// these are merged.  Bin ids of a vector are written at the position of its
+// first entry.  The final mapping of bin ids keeps the first occurrence order
+// of std_utils_bin_mapping.  So, the result does not depend on the number of
+// threads.  Without OpenMP, or for small patterns, all of it is serial.
+// -----------------------------------------------------------------------------
+
+// Below this many entries, starting threads costs more than the binning.
+const std::ptrdiff_t matrix_binning_min_parallel_entries = 32768; // MAGIC CONSTANT
+
+inline bool matrix_binning_use_threads(std::ptrdiff_t num_entries)
+{
+#ifdef _OPENMP
+    return
+        !(num_entries < matrix_binning_min_parallel_entries) &&
+        1 < omp_get_max_threads() &&
+        !omp_in_parallel();
+#else
+    (void) num_entries;
+    return false;
+#endif
+}
+
+// Copy the values of vecs at sparse_pat to out, in the order of entries.
+
+template
+<
+    typename ids_collection_type,
+    typename vals_inc_collection_type,
+    typename out_value_type
+>
+void matrix_binning_gather(
+    const ids_collection_type& sparse_pat,
+    const vals_inc_collection_type& vecs,
+    out_value_type* out,  // size = number of entries in sparse_pat.
+    bool use_threads)
+{
+    typedef typename remove_const<typename vals_inc_collection_type::index_type>::type index_type;
+    typedef typename remove_const<typename vals_inc_collection_type::value_type>::type value_type;
+
+    const std::ptrdiff_t num_vecs_signed = std::ptrdiff_t(vecs.num_vecs());
+
+    (void) use_threads;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(use_threads)
+#endif
+    for(std::ptrdiff_t ii = 0; ii < num_vecs_signed; ++ii)
+    {
+        const index_type i = index_type(ii);
+        const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
+        const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
+        const value_type* vals = vecs.vec_values_begin(i);
+        const index_type inc = vecs.inc(i);
+
+        out_value_type* out_it = out + (sparsity_ids - sparse_pat.vec_ids_begin(0));
+
+        for(index_type j = 0; j < num_sparse_entries; ++j)
+            *out_it++ = vals[inc * sparsity_ids[j]];
+    }
+}
+
+// Same as std_utils_bin_mapping on [bin_ids, bin_ids + num_entries), but
+// possibly using multiple threads.
+
+template<typename bin_index_type>
+bool matrix_binning_bin_mapping(
+    bin_index_type max_num_bins,
+    bin_index_type* bin_ids,        // size = num_entries
+    std::ptrdiff_t num_entries,
+    bin_index_type& actual_num_bins,
+    bin_index_type* work_array)     // size = max_num_bins
+{
+    bool success = true;
+
+#ifdef _OPENMP
+    if(matrix_binning_use_threads(num_entries))
+    {
+        try
+        {
+            const int num_threads = omp_get_max_threads();
+            const std::size_t num_bins = std::size_t(max_num_bins);
+
+            // first_seen[t * num_bins + b] is the smallest position of bin b
+            // among the entries visited by thread t, or num_entries if none.
+            std::vector<std::ptrdiff_t> first_seen(std::size_t(num_threads) * num_bins, num_entries);
+
+#pragma omp parallel num_threads(num_threads)
+            {
+                std::ptrdiff_t* loc_first_seen = &first_seen[std::size_t(omp_get_thread_num()) * num_bins];
+
+#pragma omp for schedule(static)
+                for(std::ptrdiff_t k = 0; k < num_entries; ++k)
+                {
+                    assert(bin_ids[k] < max_num_bins);
+
+                    std::ptrdiff_t& first = loc_first_seen[std::size_t(bin_ids[k])];
+
+                    if(k < first)
+                        first = k;
+                }
+            }
+
+            // Order bins that are present by their first occurrence.
+            std::vector<std::pair<std::ptrdiff_t, bin_index_type> > order;
+
+            for(std::size_t b = 0; b < num_bins; ++b)
+            {
+                std::ptrdiff_t first = num_entries;
+
+                for(std::size_t t = 0; t < std::size_t(num_threads); ++t)
+                    first = std::min(first, first_seen[t * num_bins + b]);
+
+                if(first < num_entries)
+                    order.push_back(std::make_pair(first, bin_index_type(b)));
+            }
+
+            std::sort(order.begin(), order.end());
+
+            for(std::size_t r = 0; r < order.size(); ++r)
+                work_array[order[r].second] = bin_index_type(r);
+
+            actual_num_bins = bin_index_type(order.size());
+
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+            for(std::ptrdiff_t k = 0; k < num_entries; ++k)
+                bin_ids[k] = work_array[bin_ids[k]];
+        }
+        catch(std::exception& exc)
+        {
+            success = false;
+            internal_api_error_set_last(
+                std::string("matrix_binning_bin_mapping: Exception. ") + exc.what());
+        }
+
+        return success;
+    }
+#endif
+
+    std_utils_bin_mapping(
+        max_num_bins,
+        bin_ids, bin_ids + num_entries,
+        actual_num_bins,
+        work_array);
+
+    return success;
+}
+
 // -----------------------------------------------------------------------------
 
 template
@@ -184,11 +580,12 @@ bool matrix_binning(
     const ids_collection_type& sparse_pat,
     const vals_inc_collection_type& vecs,
     bin_index_type max_num_bins,
+    matrix_binning_method binning_method,
     bin_index_type* bin_ids,    // size = number of entries in sparse_pat.
     bin_index_type& actual_num_bins,
     bin_index_type* work_array) // size = max_num_bins, used only if max_num_bins > 1
 {
-    typedef typename vals_inc_collection_type::index_type index_type;
+    typedef typename remove_const<typename vals_inc_collection_type::index_type>::type index_type;
 
     const index_type num_vecs = vecs.num_vecs();
 
@@ -232,23 +629,45 @@ bool matrix_binning(
 
             std_utils_separated_min_max<value_type> sep_min_max(separated_at);
 
-            for(index_type i = 0; i < num_vecs; ++i)
-            {
-                const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
-                const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
-                const value_type* vals = vecs.vec_values_begin(i);
-                const index_type inc = vecs.inc(i);
+            const std::ptrdiff_t num_entries = std::ptrdiff_t(sparse_pat.num_entries());
+            const std::ptrdiff_t num_vecs_signed = std::ptrdiff_t(num_vecs);
 
-                assert(sparsity_ids);
-                assert(num_sparse_entries <= vecs.num_vec_entries(i));
-                assert(vals);
+            const bool use_threads = matrix_binning_use_threads(num_entries);
+            (void) use_threads;
 
-                for(index_type j = 0; j < num_sparse_entries; ++j)
+#ifdef _OPENMP
+#pragma omp parallel if(use_threads)
+#endif
+            {
+                std_utils_separated_min_max<value_type> loc_sep_min_max(separated_at);
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+                for(std::ptrdiff_t ii = 0; ii < num_vecs_signed; ++ii)
                 {
-                    const value_type v = vals[inc * sparsity_ids[j]];
+                    const index_type i = index_type(ii);
+                    const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
+                    const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
+                    const value_type* vals = vecs.vec_values_begin(i);
+                    const index_type inc = vecs.inc(i);
+
+                    assert(sparsity_ids);
+                    assert(num_sparse_entries <= vecs.num_vec_entries(i));
+                    assert(vals);
+
+                    for(index_type j = 0; j < num_sparse_entries; ++j)
+                    {
+                        const value_type v = vals[inc * sparsity_ids[j]];
 
-                    sep_min_max.use(v);
+                        loc_sep_min_max.use(v);
+                    }
                 }
+
+#ifdef _OPENMP
+#pragma omp critical(matrix_binning)
+#endif
+                sep_min_max.merge(loc_sep_min_max);
             }
 
             actual_num_bins = 0;
@@ -256,35 +675,69 @@ bool matrix_binning(
             // If something to do
             if(sep_min_max.any_in_left() || sep_min_max.any_in_right())
             {
-                sep_min_max.perturb();
-
                 matrix_binning_worker<bin_index_type, value_type> worker;
-                worker.use(sep_min_max, max_num_bins);
 
-                bin_index_type* bin_ids_it = bin_ids;
+                if(binning_method == matrix_binning_method_uniform)
+                {
+                    sep_min_max.perturb();
+                    worker.use(sep_min_max, max_num_bins);
+                }
+                else
+                {
+                    std::vector<value_type> sorted_vals;
+
+                    try
+                    {
+                        sorted_vals.resize(std::size_t(num_entries));
+                    }
+                    catch(const std::exception& exc)
+                    {
+                        assert(false);
+
+                        internal_api_error_set_last(
+                            (std::string("matrix_binning: Exception. ") + exc.what()));
+
+                        return false;
+                    }
+
+                    matrix_binning_gather(
+                        sparse_pat, vecs,
+                        sorted_vals.size() ? &sorted_vals.front() : 0,
+                        use_threads);
+
+                    if(!worker.use(sep_min_max, max_num_bins, binning_method, sorted_vals))
+                        return false;
+                }
 
                 // Go through the values again.
-                for(index_type i = 0; i < num_vecs; ++i)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(use_threads)
+#endif
+                for(std::ptrdiff_t ii = 0; ii < num_vecs_signed; ++ii)
                 {
+                    const index_type i = index_type(ii);
                     const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
                     const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
                     const value_type* vals = vecs.vec_values_begin(i);
                     const index_type inc = vecs.inc(i);
 
+                    bin_index_type* bin_ids_it =
+                        bin_ids + (sparsity_ids - sparse_pat.vec_ids_begin(0));
+
                     for(index_type j = 0; j < num_sparse_entries; ++j)
                     {
                         *bin_ids_it++ = worker.bin_of(vals[inc * sparsity_ids[j]]);
                     }
                 }
 
-                std_utils_bin_mapping(
+                success = matrix_binning_bin_mapping(
                     max_num_bins,
-                    bin_ids, bin_ids_it,
+                    bin_ids, num_entries,
                     actual_num_bins,
                     work_array);
             }
-
-            success = true;
+            else
+                success = true;
         }
     }
 
@@ -309,13 +762,14 @@ bool matrix_binning(
     const ids_collection_type& sparse_pat,
     const vals_inc_collection_type& vecs,
     bin_index_type max_num_bins,  // individual max in real and imag.
+    matrix_binning_method binning_method,
     bin_index_type* real_bin_ids, // size = number of entries in sparse_pat.
     bin_index_type* imag_bin_ids, // size = number of entries in sparse_pat.
     bin_index_type& real_actual_num_bins,
     bin_index_type& imag_actual_num_bins,
     bin_index_type* work_array) // size = max_num_bins, used only if max_num_bins > 1
 {
-    typedef typename vals_inc_collection_type::index_type index_type;
+    typedef typename remove_const<typename vals_inc_collection_type::index_type>::type index_type;
 
     const index_type num_vecs = vecs.num_vecs();
 
@@ -371,23 +825,49 @@ bool matrix_binning(
             std_utils_separated_min_max<scalar_type> real_sep_min_max(separated_at);
             std_utils_separated_min_max<scalar_type> imag_sep_min_max(separated_at);
 
-            for(index_type i = 0; i < num_vecs; ++i)
-            {
-                const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
-                const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
-                const value_type* vals = vecs.vec_values_begin(i);
-                const index_type inc = vecs.inc(i);
+            const std::ptrdiff_t num_entries = std::ptrdiff_t(sparse_pat.num_entries());
+            const std::ptrdiff_t num_vecs_signed = std::ptrdiff_t(num_vecs);
 
-                assert(sparsity_ids);
-                assert(num_sparse_entries <= vecs.num_vec_entries(i));
-                assert(vals);
+            const bool use_threads = matrix_binning_use_threads(num_entries);
+            (void) use_threads;
 
-                for(index_type j = 0; j < num_sparse_entries; ++j)
+#ifdef _OPENMP
+#pragma omp parallel if(use_threads)
+#endif
+            {
+                std_utils_separated_min_max<scalar_type> loc_real_sep_min_max(separated_at);
+                std_utils_separated_min_max<scalar_type> loc_imag_sep_min_max(separated_at);
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+                for(std::ptrdiff_t ii = 0; ii < num_vecs_signed; ++ii)
                 {
-                    const value_type v = vals[inc * sparsity_ids[j]];
+                    const index_type i = index_type(ii);
+                    const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
+                    const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
+                    const value_type* vals = vecs.vec_values_begin(i);
+                    const index_type inc = vecs.inc(i);
 
-                    real_sep_min_max.use(v.real());
-                    imag_sep_min_max.use(v.imag());
+                    assert(sparsity_ids);
+                    assert(num_sparse_entries <= vecs.num_vec_entries(i));
+                    assert(vals);
+
+                    for(index_type j = 0; j < num_sparse_entries; ++j)
+                    {
+                        const value_type v = vals[inc * sparsity_ids[j]];
+
+                        loc_real_sep_min_max.use(v.real());
+                        loc_imag_sep_min_max.use(v.imag());
+                    }
+                }
+
+#ifdef _OPENMP
+#pragma omp critical(matrix_binning)
+#endif
+                {
+                    real_sep_min_max.merge(loc_real_sep_min_max);
+                    imag_sep_min_max.merge(loc_imag_sep_min_max);
                 }
             }
 
@@ -398,24 +878,70 @@ bool matrix_binning(
             if(real_sep_min_max.any_in_left() || real_sep_min_max.any_in_right() ||
                imag_sep_min_max.any_in_left() || imag_sep_min_max.any_in_right())
             {
-                real_sep_min_max.perturb();
-                imag_sep_min_max.perturb();
-
                 matrix_binning_worker<bin_index_type, scalar_type> rworker, iworker;
-                rworker.use(real_sep_min_max, max_num_bins);
-                iworker.use(imag_sep_min_max, max_num_bins);
 
-                bin_index_type* real_bin_ids_it = real_bin_ids;
-                bin_index_type* imag_bin_ids_it = imag_bin_ids;
+                if(binning_method == matrix_binning_method_uniform)
+                {
+                    real_sep_min_max.perturb();
+                    imag_sep_min_max.perturb();
+
+                    rworker.use(real_sep_min_max, max_num_bins);
+                    iworker.use(imag_sep_min_max, max_num_bins);
+                }
+                else
+                {
+                    std::vector<value_type> pattern_vals;
+                    std::vector<scalar_type> real_sorted_vals, imag_sorted_vals;
+
+                    try
+                    {
+                        pattern_vals.resize(std::size_t(num_entries));
+                        real_sorted_vals.resize(std::size_t(num_entries));
+                        imag_sorted_vals.resize(std::size_t(num_entries));
+                    }
+                    catch(const std::exception& exc)
+                    {
+                        assert(false);
+
+                        internal_api_error_set_last(
+                            (std::string("matrix_binning: Exception. ") + exc.what()));
+
+                        return false;
+                    }
+
+                    matrix_binning_gather(
+                        sparse_pat, vecs,
+                        pattern_vals.size() ? &pattern_vals.front() : 0,
+                        use_threads);
+
+                    for(std::size_t k = 0; k < pattern_vals.size(); ++k)
+                    {
+                        real_sorted_vals[k] = pattern_vals[k].real();
+                        imag_sorted_vals[k] = pattern_vals[k].imag();
+                    }
+
+                    if(!rworker.use(real_sep_min_max, max_num_bins, binning_method, real_sorted_vals) ||
+                       !iworker.use(imag_sep_min_max, max_num_bins, binning_method, imag_sorted_vals))
+                        return false;
+                }
 
                 // Go through the values again.
-                for(index_type i = 0; i < num_vecs; ++i)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(use_threads)
+#endif
+                for(std::ptrdiff_t ii = 0; ii < num_vecs_signed; ++ii)
                 {
+                    const index_type i = index_type(ii);
                     const index_type num_sparse_entries = sparse_pat.num_vec_entries(i);
                     const index_type* sparsity_ids = sparse_pat.vec_ids_begin(i);
                     const value_type* vals = vecs.vec_values_begin(i);
                     const index_type inc = vecs.inc(i);
 
+                    const std::ptrdiff_t first_entry = sparsity_ids - sparse_pat.vec_ids_begin(0);
+
+                    bin_index_type* real_bin_ids_it = real_bin_ids + first_entry;
+                    bin_index_type* imag_bin_ids_it = imag_bin_ids + first_entry;
+
                     for(index_type j = 0; j < num_sparse_entries; ++j)
                     {
                         const value_type v = vals[inc * sparsity_ids[j]];
@@ -425,23 +951,20 @@ bool matrix_binning(
                     }
                 }
 
-                bin_index_type* real_bin_ids_end = real_bin_ids_it;
-                bin_index_type* imag_bin_ids_end = imag_bin_ids_it;
-
-                std_utils_bin_mapping(
-                    max_num_bins,
-                    real_bin_ids, real_bin_ids_end,
-                    real_actual_num_bins,
-                    work_array);
-
-                std_utils_bin_mapping(
-                    max_num_bins,
-                    imag_bin_ids, imag_bin_ids_end,
-                    imag_actual_num_bins,
-                    work_array);
+                success =
+                    matrix_binning_bin_mapping(
+                        max_num_bins,
+                        real_bin_ids, num_entries,
+                        real_actual_num_bins,
+                        work_array) &&
+                    matrix_binning_bin_mapping(
+                        max_num_bins,
+                        imag_bin_ids, num_entries,
+                        imag_actual_num_bins,
+                        work_array);
             }
-
-            success = true;
+            else
+                success = true;
         }
     }
 
@@ -0,0 +1,784 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef SPLIT_PATTERN_H
+#define SPLIT_PATTERN_H
+
+// -----------------------------------------------------------------------------
+
+#include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm> // std::swap
+#include <limits>
+#include <cstddef>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Store a sparsity pattern split into bins, with all bins in one
+// contiguous bin-major CSR-like structure: bin -> segments -> ids.  A segment
+// is the part of one vector that falls in one bin.  Only the (bin, vector)
+// pairs that have some entries are stored, so memory is O(num_bins +
+// num_entries) and not O(num_bins * num_vecs), and there are only two
+// allocations.
+// -----------------------------------------------------------------------------
+
+// Bin b has segments [bin_segments_begin(b), bin_segments_end(b)).  Segments
+// of a bin are sorted by increasing vector id.  Segment s has the ids
+// [segment_ids_begin(s), segment_ids_begin(s) + segment_num_entries(s)) of
+// vector segment_vec(s).
+
+template<typename index_t, typename offset_type>
+class split_pattern
+{
+public:
+
+    typedef index_t index_type;
+
+    split_pattern()
+        :
+        n_bins(0),
+        n_vecs(0),
+        max_vec_size(0),
+        n_entries(0),
+        offsets(0),
+        ids(0)
+    {
+    }
+
+    ~split_pattern()
+    {
+        deallocate();
+    }
+
+    offset_type num_bins() const
+    {
+        return n_bins;
+    }
+
+    index_type num_vecs() const
+    {
+        return n_vecs;
+    }
+
+    index_type max_size() const
+    {
+        return max_vec_size;
+    }
+
+    offset_type num_entries() const
+    {
+        return n_entries;
+    }
+
+    offset_type num_segments() const
+    {
+        assert(offsets);
+
+        return offsets[n_bins];
+    }
+
+    offset_type bin_segments_begin(offset_type bin) const
+    {
+        assert(bin < n_bins);
+
+        return offsets[bin];
+    }
+
+    offset_type bin_segments_end(offset_type bin) const
+    {
+        assert(bin < n_bins);
+
+        return offsets[bin + 1];
+    }
+
+    index_type segment_vec(offset_type segment) const
+    {
+        assert(segment < num_segments());
+
+        return ids[n_entries + segment];
+    }
+
+    index_type segment_num_entries(offset_type segment) const
+    {
+        assert(segment < num_segments());
+
+        const offset_type* seg_offsets = segment_offsets();
+
+        return index_type(seg_offsets[segment + 1] - seg_offsets[segment]);
+    }
+
+    const index_type* segment_ids_begin(offset_type segment) const
+    {
+        assert(segment < num_segments());
+
+        return ids + segment_offsets()[segment];
+    }
+
+    // Raw arrays for filling the structure, see split_pattern_to_bins.
+
+    // Size num_bins() + 1, offsets into segments.
+    offset_type* bin_offsets()
+    {
+        return offsets;
+    }
+
+    // Size num_entries() + 1, offsets into ids.
+    offset_type* segment_offsets()
+    {
+        return offsets + std::size_t(n_bins) + 1;
+    }
+
+    const offset_type* segment_offsets() const
+    {
+        return offsets + std::size_t(n_bins) + 1;
+    }
+
+    // Size num_entries(), vector id of each segment.
+    index_type* segment_vecs()
+    {
+        return ids + n_entries;
+    }
+
+    // Size num_entries().
+    index_type* entry_ids()
+    {
+        return ids;
+    }
+
+    void swap(split_pattern& other)
+    {
+        std::swap(n_bins, other.n_bins);
+        std::swap(n_vecs, other.n_vecs);
+        std::swap(max_vec_size, other.max_vec_size);
+        std::swap(n_entries, other.n_entries);
+        std::swap(offsets, other.offsets);
+        std::swap(ids, other.ids);
+    }
+
+    void deallocate()
+    {
+        delete[] offsets;
+        delete[] ids;
+
+        offsets = 0;
+        ids = 0;
+    }
+
+    // Number of segments is not known before filling, but it is at most
+    // in_num_entries, which is used as the capacity.
+    bool allocate(
+        offset_type in_n_bins,
+        index_type in_n_vecs,
+        index_type in_max_vec_size,
+        offset_type in_num_entries)
+    {
+        // C++ Idiom: Create temporary and swap
+
+        split_pattern tmp;
+
+        tmp.n_bins       = in_n_bins;
+        tmp.n_vecs       = in_n_vecs;
+        tmp.max_vec_size = in_max_vec_size;
+        tmp.n_entries    = in_num_entries;
+
+        try
+        {
+            tmp.offsets = new offset_type[
+                std::size_t(in_n_bins) + std::size_t(in_num_entries) + 2];
+
+            tmp.ids = new index_type[2 * std::size_t(in_num_entries)];
+
+            deallocate();
+
+            swap(tmp);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("split_pattern<index_t, offset_t>::allocate: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+
+    offset_type  n_bins;
+    index_type   n_vecs;
+    index_type   max_vec_size;
+    offset_type  n_entries;
+
+    // [bin offsets (n_bins + 1), segment offsets (up to n_entries + 1)]
+    offset_type* offsets;
+
+    // [entry ids (n_entries), segment vector ids (up to n_entries)]
+    index_type*  ids;
+
+    // Not yet.
+    split_pattern(const split_pattern&);
+    split_pattern& operator=(const split_pattern&);
+};
+
+// -----------------------------------------------------------------------------
+// Objective: Vector-major incidence index of the first num_bins bins of a
+// split_pattern, i.e., the transpose of bin -> segments.  For each vector, it
+// lists the (bin, segment) pairs in which that vector has entries, sorted by
+// increasing bin.  It lets a kernel that pairs up two bins visit only the bins
+// that share a vector instead of all pairs of bins.
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename offset_type>
+class split_pattern_vec_index
+{
+public:
+
+    // Vector v has entries [vec_begin(v), vec_end(v)).
+    offset_type vec_begin(index_type vec) const
+    {
+        assert(std::size_t(vec) + 1 < offsets.size());
+
+        return offsets[vec];
+    }
+
+    offset_type vec_end(index_type vec) const
+    {
+        assert(std::size_t(vec) + 1 < offsets.size());
+
+        return offsets[std::size_t(vec) + 1];
+    }
+
+    offset_type entry_bin(offset_type entry) const
+    {
+        return bins[entry];
+    }
+
+    offset_type entry_segment(offset_type entry) const
+    {
+        return segments[entry];
+    }
+
+    bool create(
+        const split_pattern<index_type, offset_type>& split_pat,
+        offset_type num_bins)
+    {
+        bool success = num_bins <= split_pat.num_bins();
+
+        if(!success)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                "split_pattern_vec_index::create: Unacceptable input argument(s).");
+
+            return false;
+        }
+
+        const std::size_t num_vecs = std::size_t(split_pat.num_vecs());
+
+        const offset_type num_segments =
+            num_bins ? split_pat.bin_segments_end(num_bins - 1) : 0;
+
+        try
+        {
+            offsets.assign(num_vecs + 1, 0);
+            bins.resize(std::size_t(num_segments));
+            segments.resize(std::size_t(num_segments));
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("split_pattern_vec_index::create: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        // Counting sort of segments by vector.  Bins are visited in increasing
+        // order, so the pairs of each vector end up sorted by bin.
+
+        for(offset_type seg = 0; seg < num_segments; ++seg)
+            ++offsets[std::size_t(split_pat.segment_vec(seg)) + 1];
+
+        for(std::size_t v = 0; v < num_vecs; ++v)
+            offsets[v + 1] += offsets[v];
+
+        for(offset_type bin = 0; bin < num_bins; ++bin)
+        {
+            const offset_type seg_end = split_pat.bin_segments_end(bin);
+
+            for(offset_type seg = split_pat.bin_segments_begin(bin); seg < seg_end; ++seg)
+            {
+                const offset_type pos = offsets[split_pat.segment_vec(seg)]++;
+
+                bins[pos] = bin;
+                segments[pos] = seg;
+            }
+        }
+
+        // Shift back the offsets that were advanced while filling.
+
+        for(std::size_t v = num_vecs; 0 < v; --v)
+            offsets[v] = offsets[v - 1];
+
+        offsets[0] = 0;
+
+        return success;
+    }
+
+private:
+
+    std::vector<offset_type> offsets;   // num_vecs + 1
+    std::vector<offset_type> bins;      // num_segments
+    std::vector<offset_type> segments;  // num_segments
+};
+
+// -----------------------------------------------------------------------------
+// Objective: Vector-major index of two split_patterns that split the same
+// entries into different bins, e.g., real and imaginary parts of a complex
+// matrix.  For each vector, it lists its entries with their id and bin in
+// both patterns, so that a kernel can read a matrix entry once for both.
+// Entries of a vector are sorted by their bin in the first pattern.
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename offset_type>
+class split_pattern_pair_index
+{
+public:
+
+    // Vector v has entries [vec_begin(v), vec_end(v)).
+    offset_type vec_begin(index_type vec) const
+    {
+        assert(std::size_t(vec) + 1 < offsets.size());
+
+        return offsets[vec];
+    }
+
+    offset_type vec_end(index_type vec) const
+    {
+        assert(std::size_t(vec) + 1 < offsets.size());
+
+        return offsets[std::size_t(vec) + 1];
+    }
+
+    const index_type* entry_ids() const
+    {
+        return ids.empty() ? 0 : &ids.front();
+    }
+
+    const offset_type* entry_bins_1() const
+    {
+        return bins_1.empty() ? 0 : &bins_1.front();
+    }
+
+    const offset_type* entry_bins_2() const
+    {
+        return bins_2.empty() ? 0 : &bins_2.front();
+    }
+
+    bool create(
+        const split_pattern<index_type, offset_type>& split_pat_1,
+        const split_pattern<index_type, offset_type>& split_pat_2)
+    {
+        bool success =
+            split_pat_1.num_vecs() == split_pat_2.num_vecs() &&
+            split_pat_1.max_size() == split_pat_2.max_size() &&
+            split_pat_1.num_entries() == split_pat_2.num_entries();
+
+        const std::size_t num_vecs = std::size_t(split_pat_1.num_vecs());
+        const std::size_t num_entries = std::size_t(split_pat_1.num_entries());
+
+        std::vector<offset_type> offsets_2;
+        std::vector<index_type> ids_2;
+        std::vector<offset_type> work;
+
+        if(success)
+        {
+            try
+            {
+                offsets.assign(num_vecs + 1, 0);
+                offsets_2.assign(num_vecs + 1, 0);
+                ids.resize(num_entries);
+                bins_1.resize(num_entries);
+                bins_2.resize(num_entries);
+                ids_2.resize(num_entries);
+                work.assign(std::size_t(split_pat_1.max_size()), impossible_bin());
+            }
+            catch(const std::exception& exc)
+            {
+                assert(false);
+
+                internal_api_error_set_last(
+                    (std::string("split_pattern_pair_index::create: Exception. ") + exc.what()));
+
+                return false;
+            }
+
+            count(split_pat_1, offsets);
+            count(split_pat_2, offsets_2);
+
+            success = offsets == offsets_2;
+        }
+
+        if(success)
+        {
+            // Pattern 2 is filled in its own order and then matched to
+            // pattern 1 by id within each vector.
+
+            fill(split_pat_1, offsets, ids, bins_1);
+            fill(split_pat_2, offsets_2, ids_2, bins_2);
+
+            for(std::size_t v = 0; v < num_vecs && success; ++v)
+            {
+                const offset_type begin = offsets[v];
+                const offset_type end = offsets[v + 1];
+
+                for(offset_type e = begin; e < end; ++e)
+                    work[ids_2[e]] = bins_2[e];
+
+                for(offset_type e = begin; e < end; ++e)
+                {
+                    bins_2[e] = work[ids[e]];
+                    success = success && bins_2[e] != impossible_bin();
+                }
+
+                for(offset_type e = begin; e < end; ++e)
+                    work[ids_2[e]] = impossible_bin();
+            }
+        }
+
+        if(!success)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                "split_pattern_pair_index::create: Unacceptable input argument(s).");
+        }
+
+        return success;
+    }
+
+private:
+
+    static offset_type impossible_bin()
+    {
+        return std::numeric_limits<offset_type>::max();
+    }
+
+    // Prefix sum of entry counts per vector.
+    static void count(
+        const split_pattern<index_type, offset_type>& split_pat,
+        std::vector<offset_type>& vec_offsets)
+    {
+        const offset_type num_segments = split_pat.num_segments();
+
+        for(offset_type seg = 0; seg < num_segments; ++seg)
+            vec_offsets[std::size_t(split_pat.segment_vec(seg)) + 1] +=
+                offset_type(split_pat.segment_num_entries(seg));
+
+        for(std::size_t v = 0; v + 1 < vec_offsets.size(); ++v)
+            vec_offsets[v + 1] += vec_offsets[v];
+    }
+
+    // vec_offsets is used as a cursor and restored at the end.
+    static void fill(
+        const split_pattern<index_type, offset_type>& split_pat,
+        std::vector<offset_type>& vec_offsets,
+        std::vector<index_type>& entry_ids,
+        std::vector<offset_type>& entry_bins)
+    {
+        const offset_type num_bins = split_pat.num_bins();
+
+        for(offset_type bin = 0; bin < num_bins; ++bin)
+        {
+            const offset_type seg_end = split_pat.bin_segments_end(bin);
+
+            for(offset_type seg = split_pat.bin_segments_begin(bin); seg < seg_end; ++seg)
+            {
+                offset_type& pos = vec_offsets[split_pat.segment_vec(seg)];
+
+                const index_type sz = split_pat.segment_num_entries(seg);
+                const index_type* seg_ids = split_pat.segment_ids_begin(seg);
+
+                for(index_type i = 0; i < sz; ++i, ++pos)
+                {
+                    entry_ids[pos] = seg_ids[i];
+                    entry_bins[pos] = bin;
+                }
+            }
+        }
+
+        for(std::size_t v = vec_offsets.size() - 1; 0 < v; --v)
+            vec_offsets[v] = vec_offsets[v - 1];
+
+        vec_offsets[0] = 0;
+    }
+
+    std::vector<offset_type> offsets;   // num_vecs + 1
+    std::vector<index_type>  ids;       // num_entries
+    std::vector<offset_type> bins_1;    // num_entries
+    std::vector<offset_type> bins_2;    // num_entries
+};
+
+// -----------------------------------------------------------------------------
+// Objective: Groups of the entries of a split_pattern_pair_index by the pair
+// of blocks of block_size bins that their two bins fall in, arranged in rounds
+// so that no two groups of a round share a block of the first or of the second
+// pattern.  A kernel that adds each entry to the column of its first bin in one
+// matrix and to the column of its second bin in another can run the groups of
+// a round in parallel, each group owning the columns of both of its blocks,
+// and still read each entry only once.  With num_blocks = ceil(max(num_bins_1,
+// num_bins_2) / block_size), group (block_1, block_2) is in round (block_2 -
+// block_1) mod num_blocks, which is a matching of the blocks for each round.
+// Entries of a group are sorted by their second bin, and then as in the pair
+// index.  Nothing depends on the number of threads.
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename offset_type>
+class split_pattern_pair_rounds
+{
+public:
+
+    offset_type num_rounds() const
+    {
+        return offset_type(round_offsets.size() - 1);
+    }
+
+    // Round r has groups [round_begin(r), round_end(r)).
+    offset_type round_begin(offset_type round) const
+    {
+        return round_offsets[round];
+    }
+
+    offset_type round_end(offset_type round) const
+    {
+        return round_offsets[std::size_t(round) + 1];
+    }
+
+    // Group g has entries [group_begin(g), group_end(g)) of entries() and
+    // entry_vecs().
+    offset_type group_begin(offset_type group) const
+    {
+        return group_offsets[group];
+    }
+
+    offset_type group_end(offset_type group) const
+    {
+        return group_offsets[std::size_t(group) + 1];
+    }
+
+    // Positions in the pair index.
+    const offset_type* entries() const
+    {
+        return group_entries.empty() ? 0 : &group_entries.front();
+    }
+
+    const index_type* entry_vecs() const
+    {
+        return group_entry_vecs.empty() ? 0 : &group_entry_vecs.front();
+    }
+
+    bool create(
+        const split_pattern_pair_index<index_type, offset_type>& pair_index,
+        index_type num_vecs,
+        offset_type num_bins_1,
+        offset_type num_bins_2,
+        offset_type block_size)
+    {
+        if(!(0 < block_size))
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                "split_pattern_pair_rounds::create: Unacceptable input argument(s).");
+
+            return false;
+        }
+
+        const offset_type num_entries = num_vecs ? pair_index.vec_end(num_vecs - 1) : 0;
+
+        const offset_type num_blocks =
+            (std::max(num_bins_1, num_bins_2) + block_size - 1) / block_size;
+
+        const offset_type* entry_bins_1 = pair_index.entry_bins_1();
+        const offset_type* entry_bins_2 = pair_index.entry_bins_2();
+
+        std::vector<offset_type> by_bin_2;
+        std::vector<offset_type> counts;
+
+        try
+        {
+            round_offsets.assign(std::size_t(num_blocks) + 1, 0);
+            group_entries.resize(std::size_t(num_entries));
+            group_entry_vecs.resize(std::size_t(num_entries));
+            by_bin_2.resize(std::size_t(num_entries));
+            counts.assign(std::size_t(num_bins_2) + 1, 0);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("split_pattern_pair_rounds::create: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        // Two stable counting sorts, by bin_2 and then by round, leave the
+        // entries of a group next to each other and sorted by bin_2.
+
+        for(offset_type e = 0; e < num_entries; ++e)
+        {
+            assert(entry_bins_1[e] < num_bins_1 && entry_bins_2[e] < num_bins_2);
+
+            ++counts[std::size_t(entry_bins_2[e]) + 1];
+        }
+
+        for(std::size_t b = 0; b < std::size_t(num_bins_2); ++b)
+            counts[b + 1] += counts[b];
+
+        for(offset_type e = 0; e < num_entries; ++e)
+            by_bin_2[counts[entry_bins_2[e]]++] = e;
+
+        for(offset_type e = 0; e < num_entries; ++e)
+            ++round_offsets[std::size_t(round_of(e, entry_bins_1, entry_bins_2, block_size, num_blocks)) + 1];
+
+        for(std::size_t r = 0; r < std::size_t(num_blocks); ++r)
+            round_offsets[r + 1] += round_offsets[r];
+
+        for(offset_type k = 0; k < num_entries; ++k)
+        {
+            const offset_type e = by_bin_2[k];
+
+            group_entries[round_offsets[round_of(e, entry_bins_1, entry_bins_2, block_size, num_blocks)]++] = e;
+        }
+
+        // Entries of a vector are contiguous in the pair index.
+
+        for(index_type v = 0; v < num_vecs; ++v)
+            for(offset_type e = pair_index.vec_begin(v); e < pair_index.vec_end(v); ++e)
+                by_bin_2[e] = offset_type(v);
+
+        for(offset_type k = 0; k < num_entries; ++k)
+            group_entry_vecs[k] = index_type(by_bin_2[group_entries[k]]);
+
+        // Split each round into groups by block_2, which also fixes block_1,
+        // and turn round_offsets from entry offsets into group offsets.
+
+        try
+        {
+            group_offsets.clear();
+
+            offset_type begin = 0;
+
+            for(std::size_t r = 0; r < std::size_t(num_blocks); ++r)
+            {
+                const offset_type end = round_offsets[r];
+
+                round_offsets[r] = offset_type(group_offsets.size());
+
+                for(offset_type k = begin; k < end; ++k)
+                {
+                    if(k == begin ||
+                       entry_bins_2[group_entries[k]] / block_size !=
+                       entry_bins_2[group_entries[k - 1]] / block_size)
+                        group_offsets.push_back(k);
+                }
+
+                begin = end;
+            }
+
+            round_offsets[std::size_t(num_blocks)] = offset_type(group_offsets.size());
+            group_offsets.push_back(num_entries);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("split_pattern_pair_rounds::create: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+
+    static offset_type round_of(
+        offset_type entry,
+        const offset_type* entry_bins_1,
+        const offset_type* entry_bins_2,
+        offset_type block_size,
+        offset_type num_blocks)
+    {
+        const offset_type block_1 = entry_bins_1[entry] / block_size;
+        const offset_type block_2 = entry_bins_2[entry] / block_size;
+
+        return block_1 <= block_2 ? block_2 - block_1 : num_blocks - (block_1 - block_2);
+    }
+
+    std::vector<offset_type> round_offsets;    // num_rounds + 1
+    std::vector<offset_type> group_offsets;    // num_groups + 1
+    std::vector<offset_type> group_entries;    // num_entries
+    std::vector<index_type>  group_entry_vecs; // num_entries
+};
+
+// -----------------------------------------------------------------------------
+
+#endif // SPLIT_PATTERN_H
@@ -54,10 +54,8 @@ http://www.txcorp.com
 
 // -----------------------------------------------------------------------------
 
-#include "sparse_vectors/sparse_vectors.h"
+#include "matrix_binning/split_pattern.h"
 #include "internal_api_error/internal_api_error.h"
-#include <vector>
-#include <stdexcept>
 #include <algorithm> // std::fill
 #include <cassert>
 
@@ -66,6 +64,11 @@ http://www.txcorp.com
 // based on the values.
 // -----------------------------------------------------------------------------
 
+// A stable counting sort of the entries over (bin, vec) keys.  Since the
+// input is traversed vector by vector, sorting by bin keeps the entries of
+// each bin sorted by vector, and then consecutive entries with the same
+// vector are made into one segment.
+
 template<typename index_type, typename offset_type>
 bool split_pattern_to_bins(
     index_type   n_vecs,
@@ -74,12 +77,11 @@ bool split_pattern_to_bins(
     const index_type*  ids,
     const offset_type* values,
     offset_type  num_bins,
-    sparse_vectors_ids<index_type, offset_type>* split) // num_bins size
+    split_pattern<index_type, offset_type>& split)
 {
     bool success =
         offsets &&
-        ((!n_vecs || !max_vec_size) || values) &&
-        split;
+        (!offsets[n_vecs] || (ids && values));
 
     if(!success)
     {
@@ -91,74 +93,88 @@ bool split_pattern_to_bins(
         return false;
     }
 
-    std::vector< std::vector<index_type> > counts_per_bin_per_vec;
+    const offset_type num_entries = offsets[n_vecs];
 
-    try
-    {
-        counts_per_bin_per_vec.resize(num_bins, std::vector<index_type>(n_vecs));
-    }
-    catch(const std::exception& exc)
-    {
-        assert(false);
-        internal_api_error_set_last(
-            (std::string("split_pattern_to_bins: Exception. ") + exc.what()));
-        return false;
-    }
+    split_pattern<index_type, offset_type> tmp;
 
-    // Go through the pattern to compute counts_per_bin_per_vec
+    success = tmp.allocate(num_bins, n_vecs, max_vec_size, num_entries);
 
-    for(index_type i = 0; i < n_vecs; ++i)
+    if(success)
     {
-        for(offset_type j = offsets[i]; j < offsets[i+1]; ++j)
-        {
-            const offset_type bin_id = values[j];
-            assert(bin_id < num_bins);
+        offset_type* bin_offsets = tmp.bin_offsets();
+        offset_type* seg_offsets = tmp.segment_offsets();
+        index_type*  seg_vecs    = tmp.segment_vecs();
+        index_type*  split_ids   = tmp.entry_ids();
 
-            ++counts_per_bin_per_vec[bin_id][i];
-        }
-    }
+        // Count entries per bin, shifted by one.
 
-    success = true;
+        std::fill(bin_offsets, bin_offsets + std::size_t(num_bins) + 1, offset_type(0));
 
-    for(offset_type k = 0; (k < num_bins) && success; ++k)
-    {
-        success = split[k].allocate(n_vecs, max_vec_size,
-            &counts_per_bin_per_vec[k].front());
-        assert(success);
-    }
+        for(offset_type j = 0; j < num_entries; ++j)
+        {
+            assert(values[j] < num_bins);
 
-    if(success)
-    {
-        // Reuse the counts_per_bin_per_vec space.
-        // First fill with 0 and then use it to track the "next" location
-        // to be filled in the loop below.
+            ++bin_offsets[values[j] + 1];
+        }
 
         for(offset_type bin_id = 0; bin_id < num_bins; ++bin_id)
-        {
-            std::fill(
-                counts_per_bin_per_vec[bin_id].begin(),
-                counts_per_bin_per_vec[bin_id].end(),
-                0);
-        }
+            bin_offsets[bin_id + 1] += bin_offsets[bin_id];
 
-        // Go through the pattern again, and fill the
-        // offsets in each vec and each bin.
+        // Scatter.  bin_offsets[bin_id] is the next location to be filled for
+        // bin_id, and ends up as the start of bin_id + 1.  seg_vecs holds the
+        // vector of each entry for now.
 
         for(index_type i = 0; i < n_vecs; ++i)
         {
             for(offset_type j = offsets[i]; j < offsets[i+1]; ++j)
             {
-                const offset_type bin_id = values[j];
+                assert(ids[j] < max_vec_size);
 
-                index_type& next_for_this_bin = counts_per_bin_per_vec[bin_id][i];
+                const offset_type next = bin_offsets[values[j]]++;
 
-                assert(next_for_this_bin < split[bin_id].num_vec_entries(i));
+                split_ids[next] = ids[j];
+                seg_vecs[next]  = i;
+            }
+        }
 
-                assert(ids[j] < max_vec_size);
+        for(offset_type bin_id = num_bins; bin_id > 0; --bin_id)
+            bin_offsets[bin_id] = bin_offsets[bin_id - 1];
+
+        bin_offsets[0] = 0;
+
+        // Compress runs of the same vector in each bin into segments, in
+        // place.  A segment is written at or before the entry being read.
+        // bin_offsets change from offsets into entries to offsets into
+        // segments.
+
+        offset_type num_segments = 0;
+        offset_type bin_begin = 0;
 
-                split[bin_id].vec_ids_begin(i)[next_for_this_bin++] = ids[j];
+        for(offset_type bin_id = 0; bin_id < num_bins; ++bin_id)
+        {
+            const offset_type bin_end = bin_offsets[bin_id + 1];
+
+            bin_offsets[bin_id] = num_segments;
+
+            for(offset_type j = bin_begin; j < bin_end; ++j)
+            {
+                const index_type vec = seg_vecs[j];
+
+                if(j == bin_begin || vec != seg_vecs[num_segments - 1])
+                {
+                    seg_vecs[num_segments] = vec;
+                    seg_offsets[num_segments] = j;
+                    ++num_segments;
+                }
             }
+
+            bin_begin = bin_end;
         }
+
+        bin_offsets[num_bins] = num_segments;
+        seg_offsets[num_segments] = num_entries;
+
+        split.swap(tmp);
     }
 
     if(!success)
@@ -56,8 +56,9 @@ http://www.txcorp.com
 
 #include "math/precision_traits.h"
 #include "math/vector_utils.h"
+#include "math/abs_pow_sum.h"
 #include "cpp/const_modifications.h"
-#include <cmath>       // std::{pow, fabs}
+#include <cmath>       // std::{pow, fabs, sqrt}
 #include <limits>
 #include <algorithm>   // std::fill
 #include <cassert>
@@ -81,8 +82,13 @@ http://www.txcorp.com
 // p = 0       =>  0
 // 0 < p < 1   =>  -1
 // p = 1       =>  1
-// 1 < p < inf =>  2
+// 1 < p < inf =>  2 (except p = 2)
 // p = inf     =>  3
+// p = 2       =>  4
+//
+// Each helper processes one whole vector at a time with a kernel from
+// math/abs_pow_sum.h.  The sum is kept in a local variable in the kernel and
+// not in vec_norms[i], so the kernel loop does not have to reload and store it.
 
 template
 <
@@ -110,9 +116,9 @@ public:
     {
     }
 
-    void process(index_type i, const value_type& v)
+    void process(index_type i, const value_type* vals, index_type n)
     {
-        vec_norms[i] += std::pow(std::abs(v), p);
+        vec_norms[i] += abs_pow_sum_abs_pow(n, vals, p);
     }
 
 private:
@@ -137,12 +143,9 @@ public:
     {
     }
 
-    void process(index_type i, const value_type& v)
+    void process(index_type i, const value_type* vals, index_type n)
     {
-        if(v != value_type())
-        {
-            ++vec_norms[i];
-        }
+        vec_norms[i] += abs_pow_count_non_zero(n, vals);
     }
 
 private:
@@ -166,9 +169,9 @@ public:
     {
     }
 
-    void process(index_type i, const value_type& v)
+    void process(index_type i, const value_type* vals, index_type n)
     {
-        vec_norms[i] += std::abs(v);
+        vec_norms[i] += abs_pow_sum_abs(n, vals);
     }
 
 private:
@@ -194,9 +197,9 @@ public:
     {
     }
 
-    void process(index_type i, const value_type& v)
+    void process(index_type i, const value_type* vals, index_type n)
     {
-        vec_norms[i] += std::pow(std::abs(v), p);
+        vec_norms[i] += abs_pow_sum_abs_pow(n, vals, p);
     }
 
 private:
@@ -221,9 +224,9 @@ public:
     {
     }
 
-    void process(index_type i, const value_type& v)
+    void process(index_type i, const value_type* vals, index_type n)
     {
-        const scalar_type to_use = std::abs(v);
+        const scalar_type to_use = abs_pow_max_abs(n, vals);
 
         if( vec_norms[i] < to_use)
             vec_norms[i] = to_use;
@@ -236,6 +239,32 @@ private:
 
 // -----------------------------------------------------------------------------
 
+template<typename index_type, typename value_type>
+class p_norm_of_vectors_helper<index_type, value_type, 4>
+{
+public:
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    p_norm_of_vectors_helper(
+        scalar_type* in_vec_norms)
+        :
+        vec_norms(in_vec_norms)
+    {
+    }
+
+    void process(index_type i, const value_type* vals, index_type n)
+    {
+        vec_norms[i] += abs_pow_sum_abs_square(n, vals);
+    }
+
+private:
+
+    scalar_type* vec_norms;
+};
+
+// -----------------------------------------------------------------------------
+
 template
 <
     typename index_type,
@@ -255,10 +284,7 @@ void p_norm_of_vectors_accumulate(
 
         const value_type* vals = vecs.vec_values_begin(i);
 
-        for(index_type j = 0; j < num_vec_entries; ++j)
-        {
-            helper.process(i, vals[j]);
-        }
+        helper.process(i, vals, num_vec_entries);
     }
 }
 
@@ -321,6 +347,17 @@ void p_norm_of_vectors(
             <index_type, value_type, vals_collection_type, helper_type>
                 (vecs, helper);
     }
+    else if(p == 2)
+    {
+        typedef p_norm_of_vectors_helper<index_type, value_type, 4>
+            helper_type;
+
+        helper_type helper(func_vec_norms);
+
+        p_norm_of_vectors_accumulate
+            <index_type, value_type, vals_collection_type, helper_type>
+                (vecs, helper);
+    }
     else if(p < 1)
     {
         typedef p_norm_of_vectors_helper<index_type, value_type, -1>
@@ -346,7 +383,12 @@ void p_norm_of_vectors(
 
     // Compute the correct norm from the accumulated values.
 
-    if(1 < p && p < inf)
+    if(p == 2)
+    {
+        for(index_type i = 0; i < num_vecs; ++i)
+            func_vec_norms[i] = std::sqrt(func_vec_norms[i]);
+    }
+    else if(1 < p && p < inf)
     {
         vector_utils_replace_with_pow(num_vecs, func_vec_norms, 1/p);
     }
@@ -56,8 +56,9 @@ http://www.txcorp.com
 
 #include "math/precision_traits.h"
 #include "math/vector_utils.h"
+#include "math/complex_types.h"
 #include "cpp/const_modifications.h"
-#include <cmath>       // std::{pow, fabs}
+#include <cmath>       // std::{pow, fabs, sqrt}
 #include <limits>
 #include <algorithm>   // std::fill
 #include <cassert>
@@ -76,8 +77,9 @@ http://www.txcorp.com
 // p = 0       =>  0
 // 0 < p < 1   =>  -1
 // p = 1       =>  1
-// 1 < p < inf =>  2
+// 1 < p < inf =>  2 (except p = 2)
 // p = inf     =>  3
+// p = 2       =>  4
 
 template
 <
@@ -256,6 +258,37 @@ private:
 
 // -----------------------------------------------------------------------------
 
+template<typename index_type, typename value_type>
+class p_norm_of_vectors_and_trans_helper<index_type, value_type, 4>
+{
+public:
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    p_norm_of_vectors_and_trans_helper(
+        scalar_type* in_vec_norms,
+        scalar_type* in_vec_trans_norms)
+        :
+        vec_norms(in_vec_norms),
+        vec_trans_norms(in_vec_trans_norms)
+    {
+    }
+
+    void process(index_type i, index_type j, const value_type& v)
+    {
+        const scalar_type to_add = std::abs_square(v);
+        vec_norms[i]       += to_add;
+        vec_trans_norms[j] += to_add;
+    }
+
+private:
+
+    scalar_type* vec_norms;
+    scalar_type* vec_trans_norms;
+};
+
+// -----------------------------------------------------------------------------
+
 template
 <
     typename index_type,
@@ -350,6 +383,17 @@ void p_norm_of_vectors_and_trans(
             <index_type, value_type, vals_id_func_collection_type, helper_type>
                 (vecs, helper);
     }
+    else if(p == 2)
+    {
+        typedef p_norm_of_vectors_and_trans_helper<index_type, value_type, 4>
+            helper_type;
+        
+        helper_type helper(func_vec_norms, func_vec_trans_norms);
+
+        p_norm_of_vectors_and_trans_accumulate
+            <index_type, value_type, vals_id_func_collection_type, helper_type>
+                (vecs, helper);
+    }
     else if(p < 1)
     {
         typedef p_norm_of_vectors_and_trans_helper<index_type, value_type, -1>
@@ -375,7 +419,15 @@ void p_norm_of_vectors_and_trans(
 
     // Compute the correct norm from the accumulated values.
 
-    if(1 < p && p < inf)
+    if(p == 2)
+    {
+        for(index_type i = 0; i < num_vecs; ++i)
+            func_vec_norms[i] = std::sqrt(func_vec_norms[i]);
+
+        for(index_type j = 0; j < trans_size; ++j)
+            func_vec_trans_norms[j] = std::sqrt(func_vec_trans_norms[j]);
+    }
+    else if(1 < p && p < inf)
     {
         const scalar_type inv_p = 1/p;
 
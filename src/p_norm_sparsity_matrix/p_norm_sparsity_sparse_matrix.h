@@ -61,7 +61,10 @@ http://www.txcorp.com
 #include "cpp/vector_vector_id.h"
 #include "internal_api_error/internal_api_error.h"
 #include <sstream>
+#include <string>
+#include <stdexcept>
 #include <vector>
+#include <cstddef>
 #include <cassert>
 
 // -----------------------------------------------------------------------------
@@ -76,6 +79,28 @@ http://www.txcorp.com
 //    transpose first.
 // -----------------------------------------------------------------------------
 
+// p_norm_sparsity_sparse_vectors gives ids relative to the ids of each
+// vector.  Convert them to actual component ids, which is what is needed
+// before taking a transpose.
+
+template<typename index_type, typename offset_type>
+void p_norm_sparsity_sparse_matrix_to_actual_ids(
+    const offset_type* offsets,
+    const index_type* ids,
+    std::vector< std::vector<index_type> >& sparse_pat)
+{
+    for(std::size_t i = 0; i < sparse_pat.size(); ++i)
+    {
+        const index_type* vec_ids = ids + offsets[i];
+        std::vector<index_type>& pat = sparse_pat[i];
+
+        for(std::size_t j = 0; j < pat.size(); ++j)
+            pat[j] = vec_ids[pat[j]];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 // Output ids will be sorted, unique, and relative to row ids.
 
 template
@@ -152,6 +177,9 @@ bool p_norm_sparsity_sparse_matrix(
 
     if(success)
     {
+        p_norm_sparsity_sparse_matrix_to_actual_ids(
+            col_offsets, col_ids, tmp_col_pat);
+
         sparse_vectors_ids<const index_type, const offset_type>
             row_id_vecs(num_rows, num_cols, row_offsets, row_ids);
 
@@ -175,7 +203,8 @@ bool p_norm_sparsity_sparse_matrix(
 
 // If matrix is actually abs_sym, this will work for both row- and column-
 // oriented data.  Output ids will be sorted, unique, and relative to row ids.
-// "abs_sym" means its element-wise absolute value is symmetric.
+// "abs_sym" means its element-wise absolute value is symmetric.  The sparsity
+// pattern of the input must be symmetric too.
 
 template
 <
@@ -223,13 +252,31 @@ bool p_norm_sparsity_sparse_matrix_abs_sym(
 
     if(success)
     {
-        sparse_vectors_ids<const index_type, const offset_type>
-            id_vecs(matrix_size, matrix_size, offsets, ids);
+        try
+        {
+            std::vector< std::vector<index_type> > tmp_pat_actual(tmp_pat);
 
-        success = sparse_vectors_union_w_self_trans(
-            vector_vector_id<index_type>(tmp_pat),
-            id_vecs,
-            row_oriented_sparse_pat);
+            p_norm_sparsity_sparse_matrix_to_actual_ids(
+                offsets, ids, tmp_pat_actual);
+
+            sparse_vectors_ids<const index_type, const offset_type>
+                id_vecs(matrix_size, matrix_size, offsets, ids);
+
+            success = sparse_vectors_union_w_trans(
+                vector_vector_id<index_type>(tmp_pat),
+                id_vecs,
+                vector_vector_id<index_type>(tmp_pat_actual),
+                row_oriented_sparse_pat);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("p_norm_sparsity_sparse_matrix_abs_sym: Exception. ") + exc.what()));
+
+            return false;
+        }
     }
 
    assert(success);
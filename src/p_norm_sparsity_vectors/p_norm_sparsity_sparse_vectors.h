@@ -111,7 +111,7 @@ bool p_norm_sparsity_sparse_vectors(
         num_vecs,
         max_vec_size,
         vec_offsets,
-        (const index_type*) 0, // Note: no need for ids
+        static_cast<const index_type*>(0), // Note: no need for ids
         vec_values);
 
     bool success = p_norm_sparsity_vectors(
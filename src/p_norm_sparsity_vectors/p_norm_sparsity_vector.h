@@ -206,6 +206,36 @@ scalar_type p_norm_sparsity_vector_sum_p_scale_update(
     return sum;
 }
 
+// Same as p_norm_sparsity_vector_sum_p_scale_update with p = 2 but without
+// std::pow, which is much slower than a multiplication.
+
+template<typename index_type, typename scalar_type>
+scalar_type p_norm_sparsity_vector_sum_square_scale_update(
+    scalar_type scale,
+    scalar_type* work_val,
+    const index_type* work_ids,
+    index_type start,
+    index_type end)
+{
+    scalar_type sum = 0;
+
+    for(index_type k = start; k < end; ++k)
+    {
+        const index_type k_id = work_ids[k];
+
+        const scalar_type scaled = work_val[k_id] * scale;
+
+        work_val[k_id] = scaled * scaled;
+
+        sum += work_val[k_id];
+
+        assert(sum != std::numeric_limits<scalar_type>::infinity());
+        assert(sum != std::numeric_limits<scalar_type>::quiet_NaN());
+    }
+
+    return sum;
+}
+
 // -----------------------------------------------------------------------------
 
 // For the ordering of index "i" < index "j" if work_val[i] < work_val[j]
@@ -436,6 +466,16 @@ void p_norm_sparsity_vector_internal(
                     val_2 = p_norm_sparsity_vector_sum(
                         work_val, out_ids, mid, num_non_zero);
                 }
+                else if(p == 2)
+                {
+                    const scalar_type scale = 1/max_abs_val;
+
+                    val_1 = p_norm_sparsity_vector_sum_square_scale_update(
+                        scale, work_val, out_ids, index_type(0), mid);
+
+                    val_2 = p_norm_sparsity_vector_sum_square_scale_update(
+                        scale, work_val, out_ids, mid, num_non_zero);
+                }
                 else if(1 < p)
                 {
                     const scalar_type scale = 1/max_abs_val;
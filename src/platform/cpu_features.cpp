@@ -0,0 +1,174 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+// -----------------------------------------------------------------------------
+
+#include "platform/cpu_features.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CPU_FEATURES_X86_MSVC
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_FEATURES_X86_GNUC
+#include <cpuid.h>
+#endif
+
+// -----------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4514 ) // unreferenced inline function has been removed
+#pragma warning( disable : 4710 ) // function not inlined
+#endif
+
+// -----------------------------------------------------------------------------
+
+#if defined(CPU_FEATURES_X86_MSVC) || defined(CPU_FEATURES_X86_GNUC)
+
+namespace
+{
+
+// regs = {eax, ebx, ecx, edx}.  Returns false if leaf is not supported.
+
+bool cpu_features_cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+#ifdef CPU_FEATURES_X86_MSVC
+
+    int max_regs[4];
+    __cpuid(max_regs, 0);
+
+    if(unsigned(max_regs[0]) < leaf)
+        return false;
+
+    int int_regs[4];
+    __cpuidex(int_regs, int(leaf), int(subleaf));
+
+    for(int i = 0; i < 4; ++i)
+        regs[i] = unsigned(int_regs[i]);
+
+#else
+
+    if(__get_cpuid_max(0, 0) < leaf)
+        return false;
+
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+
+#endif
+
+    return true;
+}
+
+// Low 32 bits of XCR0, the register states the operating system saves on a
+// context switch.  Call only if OSXSAVE is set.
+
+unsigned int cpu_features_xcr0()
+{
+#ifdef CPU_FEATURES_X86_MSVC
+    return unsigned(_xgetbv(0));
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax;
+#endif
+}
+
+cpu_features_isa cpu_features_detect()
+{
+    unsigned int regs_1[4], regs_7[4];
+
+    if(!cpu_features_cpuid(1, 0, regs_1) || !cpu_features_cpuid(7, 0, regs_7))
+        return cpu_features_generic;
+
+    const bool fma     = (regs_1[2] & (1u << 12)) != 0;
+    const bool osxsave = (regs_1[2] & (1u << 27)) != 0;
+    const bool avx     = (regs_1[2] & (1u << 28)) != 0;
+    const bool avx2    = (regs_7[1] & (1u <<  5)) != 0;
+    const bool avx512f = (regs_7[1] & (1u << 16)) != 0;
+
+    if(!(osxsave && avx && avx2 && fma))
+        return cpu_features_generic;
+
+    const unsigned int xcr0 = cpu_features_xcr0();
+
+    // SSE and AVX state.
+    if((xcr0 & 0x6u) != 0x6u)
+        return cpu_features_generic;
+
+    // Opmask and upper ZMM state.
+    if(avx512f && (xcr0 & 0xE0u) == 0xE0u)
+        return cpu_features_avx512;
+
+    return cpu_features_avx2;
+}
+
+}
+
+#else
+
+namespace
+{
+
+cpu_features_isa cpu_features_detect()
+{
+    return cpu_features_generic;
+}
+
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+
+cpu_features_isa cpu_features_best_isa()
+{
+    static const cpu_features_isa isa = cpu_features_detect();
+    return isa;
+}
+
+// -----------------------------------------------------------------------------
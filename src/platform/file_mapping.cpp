@@ -0,0 +1,208 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// -----------------------------------------------------------------------------
+
+#include "platform/file_mapping.h"
+#include "internal_api_error/internal_api_error.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>  // std::swap
+#include <string>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4514 ) // unreferenced inline function has been removed
+#pragma warning( disable : 4710 ) // function not inlined
+#endif
+
+// -----------------------------------------------------------------------------
+
+file_mapping::file_mapping()
+    :
+        ptr(0),
+        map_size(0)
+{
+}
+
+file_mapping::~file_mapping()
+{
+    unmap();
+}
+
+// -----------------------------------------------------------------------------
+
+void file_mapping::swap(file_mapping& other)
+{
+    std::swap(ptr, other.ptr);
+    std::swap(map_size, other.map_size);
+}
+
+// -----------------------------------------------------------------------------
+
+void file_mapping::unmap()
+{
+    if(ptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(ptr);
+#else
+        munmap(ptr, map_size);
+#endif
+        ptr = 0;
+        map_size = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool file_mapping::map(const char* file_name)
+{
+    if(!file_name)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "file_mapping::map: Unacceptable input argument(s).");
+        return false;
+    }
+
+    char* tmp_ptr = 0;
+    std::size_t tmp_size = 0;
+
+#ifdef _WIN32
+
+    HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, 0,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+    if(file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER file_size;
+
+        if(GetFileSizeEx(file, &file_size) && 0 < file_size.QuadPart &&
+            static_cast<unsigned long long>(file_size.QuadPart) <=
+            static_cast<unsigned long long>(static_cast<std::size_t>(-1)))
+        {
+            // Both handles can be closed once the view exists.
+
+            HANDLE mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+
+            if(mapping)
+            {
+                tmp_ptr = static_cast<char*>(
+                    MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+                tmp_size = static_cast<std::size_t>(file_size.QuadPart);
+
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(file);
+    }
+
+#else
+
+    const int fd = open(file_name, O_RDONLY);
+
+    if(fd != -1)
+    {
+        struct stat file_stat;
+
+        if(fstat(fd, &file_stat) == 0 && 0 < file_stat.st_size &&
+            static_cast<unsigned long long>(file_stat.st_size) <=
+            static_cast<unsigned long long>(static_cast<std::size_t>(-1)))
+        {
+            tmp_size = static_cast<std::size_t>(file_stat.st_size);
+
+            // The descriptor can be closed once the mapping exists.
+
+            void* addr = mmap(0, tmp_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE, fd, 0);
+
+            if(addr != MAP_FAILED)
+            {
+                tmp_ptr = static_cast<char*>(addr);
+            }
+        }
+
+        close(fd);
+    }
+
+#endif
+
+    if(!tmp_ptr)
+    {
+        internal_api_error_set_last(
+            std::string("file_mapping::map: Could not map file ") + file_name);
+        return false;
+    }
+
+    unmap();
+
+    ptr = tmp_ptr;
+    map_size = tmp_size;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef FILE_MAPPING_H
+#define FILE_MAPPING_H
+
+// -----------------------------------------------------------------------------
+
+#include <cstddef>  // std::size_t
+
+// -----------------------------------------------------------------------------
+// Objective: Map an existing file into memory so that its contents can be used
+// without reading them into separately allocated memory.  The mapping is
+// private (copy-on-write).  Pages are readable and writable but writes are
+// never carried to the file and are not visible to other processes.
+// -----------------------------------------------------------------------------
+
+class file_mapping
+{
+public:
+
+    file_mapping();
+    ~file_mapping();
+
+    // Returns false on failure, and then the object is unchanged.
+    bool map(const char* file_name);
+
+    void unmap();
+
+    char* data()
+    {
+        return ptr;
+    }
+
+    const char* data() const
+    {
+        return ptr;
+    }
+
+    std::size_t size() const
+    {
+        return map_size;
+    }
+
+    void swap(file_mapping& other);
+
+private:
+
+    char*       ptr;
+    std::size_t map_size;
+
+    // Not yet.
+    file_mapping(const file_mapping&);
+    file_mapping& operator=(const file_mapping&);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif // FILE_MAPPING_H
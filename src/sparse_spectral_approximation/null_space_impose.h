@@ -59,16 +59,73 @@ http://www.txcorp.com
 #include "math/vector_utils.h"
 #include "math/precision_traits.h"
 #include "math/complex_types.h"
+#include "lapack_wrap/dense_matrix_linear_hpd.h"
+#include "blas_wrap/dense_matrix_mult.h"
 #include "internal_api_error/internal_api_error.h"
 #include <vector>
+#include <utility>     // std::pair
+#include <algorithm>   // std::{sort, lower_bound}
 #include <cstddef>
 #include <limits>
 #include <stdexcept>
 #include <cassert>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// -----------------------------------------------------------------------------
+
+// The projection below needs, for each stored entry (i, col), the dot product
+// of row i (or col) of basis with row col (or i) of resid over the nullity
+// columns.  In the column major layout of basis and resid, such a row is
+// strided by the leading dimension, and so every entry touches nullity cache
+// lines.  So both are first copied to a packed layout with the nullity values
+// of a row next to each other.  basis is packed once per null_space_impose
+// call, resid once per iteration.
+
+template<typename index_type, typename value_type>
+void null_space_impose_pack(
+    index_type num_vals,
+    index_type nullity,
+    const value_type* vals,  // num_vals x nullity, column major
+    index_type vals_LD,
+    value_type* packed)      // num_vals rows of nullity values each
+{
+    const std::size_t stride = std::size_t(nullity);
+
+    for(index_type i_null = 0; i_null < nullity; ++i_null)
+    {
+        const value_type* col = vals + std::size_t(i_null) * std::size_t(vals_LD);
+        value_type* packed_it = packed + std::size_t(i_null);
+
+        for(index_type k = 0; k < num_vals; ++k, packed_it += stride)
+            *packed_it = col[k];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Below this many multiply-adds, starting threads costs more than the work.
+const std::ptrdiff_t null_space_impose_min_parallel_work = 16384; // MAGIC CONSTANT
+
+inline bool null_space_impose_use_threads(std::ptrdiff_t work)
+{
+#ifdef _OPENMP
+    return
+        !(work < null_space_impose_min_parallel_work) &&
+        1 < omp_get_max_threads() &&
+        !omp_in_parallel();
+#else
+    (void) work;
+    return false;
+#endif
+}
+
 // -----------------------------------------------------------------------------
 
-// sparsity structure of projected storage should already exist.
+// sparsity structure of projected storage should already exist.  basis and
+// resid are packed as in null_space_impose_pack.
 
 template
 <
@@ -82,20 +139,15 @@ bool null_space_impose_project_residual(
     index_type num_rows,
     index_type num_cols,
     index_type nullity,
-    const value_type* basis,  // (left ? num_rows : num_cols) x nullity
-    index_type basis_LD,
-    const value_type* resid,  // (left ? num_cols : num_rows) x nullity
-    index_type resid_LD,
+    const value_type* basis_packed,  // (left ? num_rows : num_cols) rows
+    const value_type* resid_packed,  // (left ? num_cols : num_rows) rows
     sparse_vectors<index_type_2, offset_type_2, value_type>& projected) // row based vectors
 {
     bool success =
         num_rows == projected.num_vecs() &&
         num_cols == projected.max_size() &&
         nullity <= (left ? num_rows : num_cols) &&
-        (left ? num_rows : num_cols) <= basis_LD &&
-        (left ? num_cols : num_rows) <= resid_LD &&
-        basis &&
-        resid;
+        ((basis_packed && resid_packed) || !nullity);
 
     if(!success)
     {
@@ -107,8 +159,21 @@ bool null_space_impose_project_residual(
         return false;
     }
 
-    for(index_type i = 0; i < num_rows; ++i)
+    const std::size_t stride = std::size_t(nullity);
+
+    const bool use_threads = null_space_impose_use_threads(
+        std::ptrdiff_t(projected.num_entries()) * std::ptrdiff_t(nullity));
+    (void) use_threads;
+
+    const std::ptrdiff_t num_rows_signed = std::ptrdiff_t(num_rows);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if(use_threads)
+#endif
+    for(std::ptrdiff_t ii = 0; ii < num_rows_signed; ++ii)
     {
+        const index_type i = index_type(ii);
+
         value_type* row_vals                = projected.vec_values_begin(i);
         const index_type_2* col_ids         = projected.vec_ids_begin(i);
         const index_type_2  num_vec_entries = projected.num_vec_entries(i);
@@ -117,21 +182,21 @@ bool null_space_impose_project_residual(
         assert(col_ids);
         assert(num_vec_entries <= num_cols);
 
+        // Same row of the packed array for all entries of this row.
+        const value_type* row_packed =
+            (left ? basis_packed : resid_packed) + std::size_t(i) * stride;
+
         for(index_type j = 0; j < num_vec_entries; ++j)
         {
-            const index_type col = col_ids[j];
+            const std::size_t col = std::size_t(col_ids[j]);
 
-            value_type tmp = 0;
-            const value_type* basis_it = basis + (left ? i : col);
-            const value_type* resid_it = resid + (left ? col : i);
+            const value_type* basis_it = left ? row_packed : basis_packed + col * stride;
+            const value_type* resid_it = left ? resid_packed + col * stride : row_packed;
 
-            for(index_type i_null = 0; i_null < nullity; ++i_null)
-            {
-                tmp += std::conj(*basis_it) * (*resid_it);
+            value_type tmp = 0;
 
-                basis_it += basis_LD;
-                resid_it += resid_LD;
-            }
+            for(std::size_t i_null = 0; i_null < stride; ++i_null)
+                tmp += std::conj(basis_it[i_null]) * resid_it[i_null];
 
             if(left)
                 row_vals[j] = std::conj(tmp);
@@ -145,11 +210,179 @@ bool null_space_impose_project_residual(
 
 // -----------------------------------------------------------------------------
 
-// FIXME: One could improve this method to be more efficient when working with
-// Hermitian/skew-Hermitian/complex-symmetric matrices because the left and
-// right null-spaces are related there.  However, this is not the most time
-// consuming part of our main objective, so we let it be general and somewhat
-// slower.
+// Jacobi preconditioner of the Uzawa CG iteration.  The iteration is CG on
+// B * B^* lambda = B(A), where B(X) holds the residuals X * V and U^H * X of
+// the constraints.  The diagonal of B * B^* for the right constraint (i, k) is
+// the squared norm of column k of V restricted to the pattern of row i, and
+// for the left constraint (k, j) that of column k of U restricted to the
+// pattern of column j.  For a unit basis vector spread over all the columns
+// (or rows), that is about the number of entries of row i over num_cols (or
+// of column j over num_rows), and this estimate is used.  When row or column
+// counts of the pattern vary a lot, scaling by its inverse cuts the number of
+// iterations.
+//
+// The exact diagonal is not used.  A basis vector confined to some rows or
+// columns, as for a matrix with independent blocks, has entries of the size
+// of rounding errors elsewhere.  Scaling the constraints made of those up to
+// unit size makes the iteration chase rounding errors, and it then returns a
+// matrix with the null spaces that is far from the nearest one.
+//
+// inv_diag is column major like the residuals, with leading dimension
+// num_rows (right) or num_cols (left).
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+void null_space_impose_jacobi(
+    bool left,
+    index_type nullity,
+    const sparse_vectors<index_type, offset_type, value_type>& A,
+    std::vector<typename precision_traits<value_type>::scalar>& inv_diag)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const index_type num_rows = A.num_vecs();
+    const std::size_t num_resid = std::size_t(left ? A.max_size() : num_rows);
+    const scalar_type basis_size = scalar_type(left ? num_rows : A.max_size());
+
+    assert(inv_diag.size() == num_resid * std::size_t(nullity));
+
+    if(nullity == 0)
+        return;
+
+    // Counts of entries in the first column, then the same for all k.
+
+    std::fill(inv_diag.begin(), inv_diag.begin() + num_resid, scalar_type(0));
+
+    for(index_type i = 0; i < num_rows; ++i)
+    {
+        const index_type* col_ids = A.vec_ids_begin(i);
+        const index_type  num_vec_entries = A.num_vec_entries(i);
+
+        if(left)
+        {
+            for(index_type e = 0; e < num_vec_entries; ++e)
+                inv_diag[std::size_t(col_ids[e])] += scalar_type(1);
+        }
+        else
+        {
+            inv_diag[std::size_t(i)] = scalar_type(num_vec_entries);
+        }
+    }
+
+    // A zero count means empty constraints, with zero residuals.
+    for(std::size_t r = 0; r < num_resid; ++r)
+        inv_diag[r] = 0 < inv_diag[r] ? basis_size / inv_diag[r] : scalar_type(1);
+
+    for(index_type k = 1; k < nullity; ++k)
+        std::copy(
+            inv_diag.begin(), inv_diag.begin() + num_resid,
+            inv_diag.begin() + std::size_t(k) * num_resid);
+}
+
+// z = inv_diag .* r, and returns the real inner product of r and z.
+
+template<typename index_type, typename value_type>
+typename precision_traits<value_type>::scalar null_space_impose_precondition(
+    const std::vector<typename precision_traits<value_type>::scalar>& inv_diag,
+    const dense_vectors<index_type, value_type>& r,
+    dense_vectors<index_type, value_type>& z)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const std::size_t num_resid = std::size_t(r.vec_size());
+
+    assert(z.vec_size() == r.vec_size() && z.num_vecs() == r.num_vecs());
+    assert(inv_diag.size() == num_resid * std::size_t(r.num_vecs()));
+
+    scalar_type r_dot_z = 0;
+
+    for(index_type k = 0; k < r.num_vecs(); ++k)
+    {
+        const value_type*  r_k = r.vec_values_begin(k);
+        value_type*        z_k = z.vec_values_begin(k);
+        const scalar_type* d_k = inv_diag.empty() ? 0 : &inv_diag.front() + std::size_t(k) * num_resid;
+
+        for(std::size_t i = 0; i < num_resid; ++i)
+        {
+            z_k[i] = d_k[i] * r_k[i];
+            r_dot_z += d_k[i] * std::abs_square(r_k[i]);
+        }
+    }
+
+    return r_dot_z;
+}
+
+// -----------------------------------------------------------------------------
+
+// Uzawa CG iteration limit and the squared tolerance on residual norms.
+
+const std::size_t null_space_impose_max_iters = 1000; // MAGIC CONSTANT
+
+// What one null_space_impose call did.  num_iters is 0 for the direct solve.
+// resid_norm_sq is the sum of the squared Frobenius norms of the final right
+// and left residuals, X * V and U^H * X.  The iteration has converged when
+// each of them is at most sqtol, see null_space_impose_sqtol.  The direct
+// solve always counts as converged.
+
+struct null_space_impose_stats
+{
+    null_space_impose_stats()
+        :
+        direct(false),
+        converged(false),
+        num_iters(0),
+        resid_norm_sq(0),
+        sqtol(0)
+    {
+    }
+
+    bool        direct;
+    bool        converged;
+    std::size_t num_iters;
+    double      resid_norm_sq;
+    double      sqtol;
+};
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+typename precision_traits<value_type>::scalar null_space_impose_sqtol(
+    const sparse_vectors<index_type, offset_type, value_type>& A)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const index_type num_rows = A.num_vecs();
+    const index_type num_cols = A.max_size();
+    const offset_type n_entries = A.num_entries();
+
+    const value_type* A_values = A.vec_values();
+
+    scalar_type A_frob_norm_square = 0;
+
+    for(offset_type i = 0; i < n_entries; ++i)
+        A_frob_norm_square += std::abs_square(A_values[i]);
+
+    const scalar_type fuzz = 1;         // MAGIC CONSTANT
+
+    return fuzz *
+        A_frob_norm_square *
+        std::numeric_limits<scalar_type>::epsilon() *
+        std::numeric_limits<scalar_type>::epsilon() *
+        scalar_type(std::max(num_rows, num_cols)) *
+        scalar_type(std::max(num_rows, num_cols));
+}
+
+// -----------------------------------------------------------------------------
+
+// General version.  For Hermitian, skew-Hermitian and complex-symmetric
+// matrices, see null_space_impose_structured below.
 
 template
 <
@@ -167,12 +400,24 @@ bool null_space_impose(
     index_type right_basis_LD,
 
 // Input/Output:
-    sparse_vectors<index_type, offset_type, value_type>& A) // row based
+    sparse_vectors<index_type, offset_type, value_type>& A, // row based
+
+// Output:
+    null_space_impose_stats* stats = 0,
+
+// Input/Output:
+    dense_vectors<index_type, value_type>* lag_mult_left = 0,   // left_nullity x num_cols
+    dense_vectors<index_type, value_type>* lag_mult_right = 0)  // right_nullity x num_rows
 {
     // A will be overwritten with the matrix closest to A in Frobenius
     // norm that also has the given left and right null-spaces.
     // We assume that basis for left and right null spaces are either
     // orthonormal or empty.
+    //
+    // The result is A - B^*(lambda) for the Lagrange multipliers lambda of the
+    // constraints, shaped like the residuals.  If lag_mult_left and
+    // lag_mult_right are not null, they are the initial multipliers (a warm
+    // start) if they have that shape, and they are set to the final ones.
 
     const index_type num_rows = A.num_vecs();
     const index_type num_cols = A.max_size();
@@ -180,29 +425,32 @@ bool null_space_impose(
 
     typedef typename precision_traits<value_type>::scalar scalar_type;
 
-    const value_type* A_values = A.vec_values();
-
-    scalar_type A_frob_norm_square = 0;
+    const std::size_t max_iters = null_space_impose_max_iters;
 
-    for(offset_type i = 0; i < n_entries; ++i)
-        A_frob_norm_square += std::abs_square(A_values[i]);
+    const scalar_type sqtol = null_space_impose_sqtol(A);
 
-    const std::size_t max_iters = 1000; // MAGIC CONSTANT
-    const scalar_type fuzz = 1;         // MAGIC CONSTANT
+    std::vector<value_type> left_projected_store, right_projected_store;
 
-    const scalar_type sqtol = fuzz *
-        A_frob_norm_square *
-        std::numeric_limits<scalar_type>::epsilon() *
-        std::numeric_limits<scalar_type>::epsilon() *
-        scalar_type(std::max(num_rows, num_cols)) *
-        scalar_type(std::max(num_rows, num_cols));
+    // See null_space_impose_jacobi.
+    std::vector<scalar_type> left_inv_diag, right_inv_diag;
 
-    std::vector<value_type> left_projected_store, right_projected_store;
+    // Packed copies, see null_space_impose_pack.
+    std::vector<value_type>
+        left_basis_packed,  right_basis_packed,
+        left_resid_packed,  right_resid_packed;
 
     try
     {
         left_projected_store.resize(n_entries);
         right_projected_store.resize(n_entries);
+
+        left_inv_diag.resize (std::size_t(num_cols) * std::size_t(left_nullity));
+        right_inv_diag.resize(std::size_t(num_rows) * std::size_t(right_nullity));
+
+        left_basis_packed.resize (std::size_t(num_rows) * std::size_t(left_nullity));
+        right_basis_packed.resize(std::size_t(num_cols) * std::size_t(right_nullity));
+        left_resid_packed.resize (std::size_t(num_cols) * std::size_t(left_nullity));
+        right_resid_packed.resize(std::size_t(num_rows) * std::size_t(right_nullity));
     }
     catch(const std::exception& exc)
     {
@@ -214,6 +462,11 @@ bool null_space_impose(
         return false;
     }
 
+    value_type* left_basis_packed_ptr  = left_basis_packed.empty()  ? 0 : &left_basis_packed.front();
+    value_type* right_basis_packed_ptr = right_basis_packed.empty() ? 0 : &right_basis_packed.front();
+    value_type* left_resid_packed_ptr  = left_resid_packed.empty()  ? 0 : &left_resid_packed.front();
+    value_type* right_resid_packed_ptr = right_resid_packed.empty() ? 0 : &right_resid_packed.front();
+
     sparse_vectors<index_type, offset_type, value_type>
         left_projected(
             num_rows,
@@ -231,19 +484,34 @@ bool null_space_impose(
     dense_vectors<index_type, value_type>
         left_lambda,  right_lambda,
         left_resid_1, right_resid_1,
-        left_resid_2, right_resid_2;
+        left_resid_2, right_resid_2,
+        left_z,       right_z;  // Preconditioned residuals
 
     // Allocate local space for a specialized Uzawa CG iteration for this problem.
 
-    const bool compute_lag_mult = false; // Lagrange multipliers.
+    const bool compute_lag_mult = lag_mult_left && lag_mult_right;
+
+    const bool warm_start =
+        compute_lag_mult &&
+        lag_mult_left->num_vecs()  == left_nullity  && lag_mult_left->vec_size()  == num_cols &&
+        lag_mult_right->num_vecs() == right_nullity && lag_mult_right->vec_size() == num_rows &&
+        lag_mult_left->vec_values() && lag_mult_right->vec_values();
+
+    if(warm_start)
+    {
+        left_lambda.swap(*lag_mult_left);
+        right_lambda.swap(*lag_mult_right);
+    }
 
     bool success =
-        (compute_lag_mult ? left_lambda.allocate(left_nullity, num_cols) : true) &&
+        (compute_lag_mult && !warm_start ? left_lambda.allocate(left_nullity, num_cols) : true) &&
         left_resid_1.allocate (left_nullity, num_cols) &&
         left_resid_2.allocate (left_nullity, num_cols) &&
-        (compute_lag_mult ? right_lambda.allocate(right_nullity, num_rows) : true) &&
+        (compute_lag_mult && !warm_start ? right_lambda.allocate(right_nullity, num_rows) : true) &&
         right_resid_1.allocate(right_nullity, num_rows) &&
-        right_resid_2.allocate(right_nullity, num_rows);
+        right_resid_2.allocate(right_nullity, num_rows) &&
+        left_z.allocate (left_nullity, num_cols) &&
+        right_z.allocate(right_nullity, num_rows);
 
     if(!success)
     {
@@ -258,17 +526,9 @@ bool null_space_impose(
     if(success)
     {
         const value_type zero      = value_type(0);
-        const value_type one       = value_type(1);
         const value_type minus_one = value_type(-1);
 
-#ifdef _MSC_VER
-#pragma warning( push )
-#pragma warning( disable : 4127 ) // conditional expression is constant
-#endif
-        if(compute_lag_mult)
-#ifdef _MSC_VER
-#pragma warning( pop )
-#endif
+        if(compute_lag_mult && !warm_start)
         {
             left_lambda.fill(zero);
             right_lambda.fill(zero);
@@ -286,37 +546,119 @@ bool null_space_impose(
             right_basis_LD,
             right_basis);
 
-        success =
-            sparse_matrix_mult_trans(A, left_basis_dv, left_resid_1,  one) &&
-            sparse_matrix_mult(A, right_basis_dv, right_resid_1, one) &&
-            right_resid_2.axpby(right_resid_1, minus_one, zero) &&
-            left_resid_2.axpby(left_resid_1, minus_one, zero);
+        null_space_impose_pack(
+            num_rows, left_nullity, left_basis, left_basis_LD,
+            left_basis_packed_ptr);
+
+        null_space_impose_pack(
+            num_cols, right_nullity, right_basis, right_basis_LD,
+            right_basis_packed_ptr);
+
+        null_space_impose_jacobi(true,  left_nullity,  A, left_inv_diag);
+        null_space_impose_jacobi(false, right_nullity, A, right_inv_diag);
+
+        // A -= B^*(lambda) for the initial multipliers.
+
+        if(warm_start)
+        {
+            null_space_impose_pack(
+                num_cols, left_nullity, left_lambda.vec_values(),
+                left_lambda.leading_dimension(),
+                left_resid_packed_ptr);
+
+            null_space_impose_pack(
+                num_rows, right_nullity, right_lambda.vec_values(),
+                right_lambda.leading_dimension(),
+                right_resid_packed_ptr);
+
+            success =
+                null_space_impose_project_residual(
+                    true, num_rows, num_cols, left_nullity,
+                    left_basis_packed_ptr,
+                    left_resid_packed_ptr,
+                    left_projected)
+                &&
+                null_space_impose_project_residual(
+                    false, num_rows, num_cols, right_nullity,
+                    right_basis_packed_ptr,
+                    right_resid_packed_ptr,
+                    right_projected);
+
+            assert(success);
+
+            vector_utils_add(
+                n_entries,
+                left_projected.vec_values(),
+                right_projected.vec_values(),
+                offset_type(1),
+                offset_type(1));
+
+            vector_utils_axpby(
+                n_entries,
+                right_projected.vec_values(),
+                A.vec_values(),
+                minus_one,
+                value_type(1),
+                offset_type(1),
+                offset_type(1));
+        }
+
+        // resid_2 is minus the residual B(A), z is inv(M) * resid_2, and
+        // resid_1 is the search direction, initially -z.
+
+        success = success &&
+            sparse_matrix_mult_trans(A, left_basis_dv, left_resid_2,  minus_one) &&
+            sparse_matrix_mult(A, right_basis_dv, right_resid_2, minus_one);
 
         assert(success);
 
+        scalar_type r_dot_z = 0;
+
+        if(success)
+        {
+            r_dot_z =
+                null_space_impose_precondition(left_inv_diag,  left_resid_2,  left_z) +
+                null_space_impose_precondition(right_inv_diag, right_resid_2, right_z);
+
+            success =
+                left_resid_1.axpby(left_z, minus_one, zero) &&
+                right_resid_1.axpby(right_z, minus_one, zero);
+
+            assert(success);
+        }
+
         std::size_t i_iter = 0;
 
+        scalar_type R_norm_sq = right_resid_2.frobenius_norm_squared();
+        scalar_type L_norm_sq = left_resid_2.frobenius_norm_squared();
+
         while(success && i_iter < max_iters)
         {
-            const scalar_type R_norm_sq = right_resid_2.frobenius_norm_squared();
-            const scalar_type L_norm_sq = left_resid_2.frobenius_norm_squared();
-
             if(R_norm_sq <= sqtol && L_norm_sq <= sqtol)
-            {
-                success = true;
                 break;
-            }
+
+            null_space_impose_pack(
+                num_cols, left_nullity, left_resid_1.vec_values(),
+                left_resid_1.leading_dimension(),
+                left_resid_packed_ptr);
+
+            null_space_impose_pack(
+                num_rows, right_nullity, right_resid_1.vec_values(),
+                right_resid_1.leading_dimension(),
+                right_resid_packed_ptr);
 
             success =
                 null_space_impose_project_residual(
-                    true, num_rows, num_cols,
-                    left_nullity, left_basis, left_basis_LD, left_resid_1.vec_values(),
-                    left_resid_1.leading_dimension(), left_projected)
+                    true, num_rows, num_cols, left_nullity,
+                    left_basis_packed_ptr,
+                    left_resid_packed_ptr,
+                    left_projected)
                 &&
                 null_space_impose_project_residual(
-                    false, num_rows, num_cols,
-                    right_nullity, right_basis, right_basis_LD, right_resid_1.vec_values(),
-                    right_resid_1.leading_dimension(), right_projected);
+                    false, num_rows, num_cols, right_nullity,
+                    right_basis_packed_ptr,
+                    right_resid_packed_ptr,
+                    right_projected);
 
             assert(success);
 
@@ -335,7 +677,7 @@ bool null_space_impose(
 
                 const scalar_type proj_norm_sq = total_projected.frobenius_norm_squared();
 
-                const value_type alpha = (R_norm_sq + L_norm_sq) / proj_norm_sq;
+                const value_type alpha = r_dot_z / proj_norm_sq;
 
                 vector_utils_axpby(
                     n_entries,
@@ -356,14 +698,20 @@ bool null_space_impose(
 
                 if(success)
                 {
-                    const scalar_type L_2_norm_sq = left_resid_2.frobenius_norm_squared();
-                    const scalar_type R_2_norm_sq = right_resid_2.frobenius_norm_squared();
+                    L_norm_sq = left_resid_2.frobenius_norm_squared();
+                    R_norm_sq = right_resid_2.frobenius_norm_squared();
+
+                    const scalar_type r_dot_z_2 =
+                        null_space_impose_precondition(left_inv_diag,  left_resid_2,  left_z) +
+                        null_space_impose_precondition(right_inv_diag, right_resid_2, right_z);
 
-                    const value_type beta = (R_2_norm_sq + L_2_norm_sq)/(R_norm_sq + L_norm_sq);
+                    const value_type beta = r_dot_z_2 / r_dot_z;
+
+                    r_dot_z = r_dot_z_2;
 
                     success =
-                        left_resid_1.axpby(left_resid_2, minus_one, beta) &&
-                        right_resid_1.axpby(right_resid_2, minus_one, beta);
+                        left_resid_1.axpby(left_z, minus_one, beta) &&
+                        right_resid_1.axpby(right_z, minus_one, beta);
 
                     assert(success);
                 }
@@ -371,6 +719,21 @@ bool null_space_impose(
 
             ++i_iter;
         }
+
+        if(success && compute_lag_mult)
+        {
+            lag_mult_left->swap(left_lambda);
+            lag_mult_right->swap(right_lambda);
+        }
+
+        if(stats)
+        {
+            stats->direct        = false;
+            stats->converged     = R_norm_sq <= sqtol && L_norm_sq <= sqtol;
+            stats->num_iters     = i_iter;
+            stats->resid_norm_sq = double(R_norm_sq + L_norm_sq);
+            stats->sqtol         = double(sqtol);
+        }
     }
 
     if(!success)
@@ -386,28 +749,1115 @@ bool null_space_impose(
 
 // -----------------------------------------------------------------------------
 
+// Relation between the left and the right null spaces implied by the matrix
+// type.  With A^H = A or A^H = -A, the left null space is the right null
+// space.  With A^T = A, it is the conjugate of the right null space.
+
+enum null_space_impose_structure
+{
+    null_space_impose_general,
+    null_space_impose_hermitian,       // A^H =  A
+    null_space_impose_skew_hermitian,  // A^H = -A
+    null_space_impose_symmetric        // A^T =  A
+};
+
+// -----------------------------------------------------------------------------
+
+// For each stored entry (i, j) of A, finds the position of the entry (j, i).
+// Returns false if A is not square or its pattern is not symmetric.
+
 template
 <
     typename index_type,
     typename offset_type,
     typename value_type
 >
-bool null_space_impose(
-    const dense_vectors<index_type, value_type>& left_null_space,
-    const dense_vectors<index_type, value_type>& right_null_space,
-    sparse_vectors<index_type, offset_type, value_type>& A) // row based
+bool null_space_impose_transpose_positions(
+    const sparse_vectors<index_type, offset_type, value_type>& A,
+    std::vector<offset_type>& trans_pos)
 {
-    bool success =
-        left_null_space.vec_size() == A.num_vecs() &&
-        right_null_space.vec_size() == A.max_size() &&
-        null_space_impose(
-            left_null_space.num_vecs(),
-            left_null_space.vec_values(),
-            left_null_space.leading_dimension(),
-            right_null_space.num_vecs(),
-            right_null_space.vec_values(),
-            right_null_space.leading_dimension(),
-            A);
+    const index_type num_rows = A.num_vecs();
+
+    if(num_rows != A.max_size())
+        return false;
+
+    const offset_type* offsets = A.vec_offsets();
+    const index_type* ids = A.vec_ids();
+    const offset_type n_entries = A.num_entries();
+
+    // Entries of each row sorted by column id, to search in.
+    std::vector< std::pair<index_type, offset_type> > sorted_ids;
+
+    try
+    {
+        trans_pos.resize(n_entries);
+        sorted_ids.resize(n_entries);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("null_space_impose_transpose_positions: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    for(offset_type e = 0; e < n_entries; ++e)
+        sorted_ids[e] = std::make_pair(ids[e], e);
+
+    for(index_type i = 0; i < num_rows; ++i)
+        std::sort(
+            sorted_ids.begin() + std::ptrdiff_t(offsets[i]),
+            sorted_ids.begin() + std::ptrdiff_t(offsets[i + 1]));
+
+    for(index_type i = 0; i < num_rows; ++i)
+    {
+        for(offset_type e = offsets[i]; e < offsets[i + 1]; ++e)
+        {
+            const index_type j = ids[e];
+
+            typename std::vector< std::pair<index_type, offset_type> >::const_iterator it =
+                std::lower_bound(
+                    sorted_ids.begin() + std::ptrdiff_t(offsets[j]),
+                    sorted_ids.begin() + std::ptrdiff_t(offsets[j + 1]),
+                    std::make_pair(i, offset_type(0)));
+
+            if(it == sorted_ids.begin() + std::ptrdiff_t(offsets[j + 1]) || it->first != i)
+                return false;
+
+            trans_pos[e] = it->second;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+// sign * conj(val) or sign * val, i.e., the value at (j, i) that structure
+// implies from the value at (i, j).
+
+template<typename value_type>
+value_type null_space_impose_mirror(
+    null_space_impose_structure structure,
+    const value_type& val)
+{
+    switch(structure)
+    {
+    case null_space_impose_hermitian:      return   std::conj(val);
+    case null_space_impose_skew_hermitian: return - std::conj(val);
+    default:                               return   val;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Replaces A with the nearest matrix (in Frobenius norm) that has the
+// structure, i.e., with the average of A and its mirror image.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+void null_space_impose_make_structured(
+    null_space_impose_structure structure,
+    const std::vector<offset_type>& trans_pos,
+    sparse_vectors<index_type, offset_type, value_type>& A)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    value_type* A_values = A.vec_values();
+    const offset_type n_entries = A.num_entries();
+
+    assert(offset_type(trans_pos.size()) == n_entries);
+
+    for(offset_type e = 0; e < n_entries; ++e)
+    {
+        const offset_type t = trans_pos[e];
+
+        if(e <= t)
+        {
+            const value_type avg =
+                (A_values[e] + null_space_impose_mirror(structure, A_values[t])) / scalar_type(2);
+
+            A_values[e] = avg;
+            A_values[t] = null_space_impose_mirror(structure, avg);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Same result as the general null_space_impose, with the left basis implied
+// by structure, but only the right residual is computed and projected.  The
+// left residual and projection follow from the right ones.  For Hermitian A,
+// the left residual A^H V equals A V and the left projection is the conjugate
+// transpose of the right projection.  Similarly for the other structures.  A
+// is first replaced by its nearest matrix with the structure, and each update
+// keeps the structure, so the output has it exactly.  trans_pos is from
+// null_space_impose_transpose_positions.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool null_space_impose_structured(
+// Input:
+    null_space_impose_structure structure,
+    index_type nullity,
+    const value_type* basis,   // A.max_size() x nullity, right null space
+    index_type basis_LD,
+    const std::vector<offset_type>& trans_pos,
+
+// Input/Output:
+    sparse_vectors<index_type, offset_type, value_type>& A, // row based
+
+// Output:
+    null_space_impose_stats* stats = 0,
+
+// Input/Output:
+    dense_vectors<index_type, value_type>* lag_mult = 0)  // nullity x num_rows
+{
+    const index_type num_rows = A.num_vecs();
+    const index_type num_cols = A.max_size();
+    const offset_type n_entries = A.num_entries();
+
+    bool success =
+        structure != null_space_impose_general &&
+        num_rows == num_cols &&
+        nullity <= num_cols &&
+        num_cols <= basis_LD &&
+        (basis || !nullity) &&
+        offset_type(trans_pos.size()) == n_entries;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "null_space_impose_structured: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    value_type* A_values = A.vec_values();
+
+    null_space_impose_make_structured(structure, trans_pos, A);
+
+    const std::size_t max_iters = null_space_impose_max_iters;
+
+    const scalar_type sqtol = null_space_impose_sqtol(A);
+
+    std::vector<value_type> projected_store, total_store, basis_packed, resid_packed;
+
+    std::vector<scalar_type> inv_diag;
+
+    try
+    {
+        projected_store.resize(n_entries);
+        total_store.resize(n_entries);
+        inv_diag.resize(std::size_t(num_rows) * std::size_t(nullity));
+        basis_packed.resize(std::size_t(num_cols) * std::size_t(nullity));
+        resid_packed.resize(std::size_t(num_rows) * std::size_t(nullity));
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("null_space_impose_structured: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    value_type* projected_vals   = projected_store.empty() ? 0 : &projected_store.front();
+    value_type* total_vals       = total_store.empty()     ? 0 : &total_store.front();
+    value_type* basis_packed_ptr = basis_packed.empty()    ? 0 : &basis_packed.front();
+    value_type* resid_packed_ptr = resid_packed.empty()    ? 0 : &resid_packed.front();
+
+    sparse_vectors<index_type, offset_type, value_type>
+        projected(
+            num_rows,
+            num_cols,
+            A.vec_offsets(),
+            A.vec_ids(),
+            projected_vals),
+        total_projected(
+            num_rows,
+            num_cols,
+            A.vec_offsets(),
+            A.vec_ids(),
+            total_vals);
+
+    dense_vectors<index_type, value_type> lambda, resid_1, resid_2, z;
+
+    // As in the general version, with only the multipliers of the right
+    // constraints.  B^*(lambda) is the projection plus its mirror image.
+
+    const bool warm_start =
+        lag_mult &&
+        lag_mult->num_vecs() == nullity && lag_mult->vec_size() == num_rows &&
+        lag_mult->vec_values();
+
+    if(warm_start)
+        lambda.swap(*lag_mult);
+
+    success =
+        (lag_mult && !warm_start ? lambda.allocate(nullity, num_rows) && lambda.fill(value_type(0)) : true) &&
+        resid_1.allocate(nullity, num_rows) &&
+        resid_2.allocate(nullity, num_rows) &&
+        z.allocate(nullity, num_rows);
+
+    if(success)
+    {
+        const value_type zero      = value_type(0);
+        const value_type minus_one = value_type(-1);
+
+        const dense_vectors<index_type, const value_type> basis_dv(
+            nullity,
+            num_cols,
+            basis_LD,
+            basis);
+
+        null_space_impose_pack(
+            num_cols, nullity, basis, basis_LD, basis_packed_ptr);
+
+        // The left diagonal is the mirror of the right one.
+        null_space_impose_jacobi(false, nullity, A, inv_diag);
+
+        if(warm_start)
+        {
+            null_space_impose_pack(
+                num_rows, nullity, lambda.vec_values(),
+                lambda.leading_dimension(), resid_packed_ptr);
+
+            success =
+                null_space_impose_project_residual(
+                    false, num_rows, num_cols, nullity,
+                    basis_packed_ptr, resid_packed_ptr,
+                    projected);
+
+            assert(success);
+
+            for(offset_type e = 0; e < n_entries; ++e)
+                A_values[e] -=
+                    projected_vals[e] +
+                    null_space_impose_mirror(structure, projected_vals[trans_pos[e]]);
+        }
+
+        success = success && sparse_matrix_mult(A, basis_dv, resid_2, minus_one);
+
+        assert(success);
+
+        scalar_type r_dot_z = 0;
+
+        if(success)
+        {
+            r_dot_z = null_space_impose_precondition(inv_diag, resid_2, z);
+
+            success = resid_1.axpby(z, minus_one, zero);
+
+            assert(success);
+        }
+
+        std::size_t i_iter = 0;
+
+        // The left residual has the same norm.
+        scalar_type R_norm_sq = resid_2.frobenius_norm_squared();
+
+        while(success && i_iter < max_iters)
+        {
+            if(R_norm_sq <= sqtol)
+                break;
+
+            null_space_impose_pack(
+                num_rows, nullity, resid_1.vec_values(),
+                resid_1.leading_dimension(), resid_packed_ptr);
+
+            success =
+                null_space_impose_project_residual(
+                    false, num_rows, num_cols, nullity,
+                    basis_packed_ptr, resid_packed_ptr,
+                    projected);
+
+            assert(success);
+
+            if(success)
+            {
+                for(offset_type e = 0; e < n_entries; ++e)
+                    total_vals[e] =
+                        projected_vals[e] +
+                        null_space_impose_mirror(structure, projected_vals[trans_pos[e]]);
+
+                const scalar_type proj_norm_sq = total_projected.frobenius_norm_squared();
+
+                const value_type alpha = (2 * r_dot_z) / proj_norm_sq;
+
+                vector_utils_axpby(
+                    n_entries,
+                    total_vals,
+                    A_values,
+                    -alpha,
+                    value_type(1),
+                    offset_type(1),
+                    offset_type(1));
+
+                success =
+                    (lag_mult ? lambda.axpby(resid_1, alpha, value_type(1)) : true) &&
+                    sparse_matrix_mult(A, basis_dv, resid_2, minus_one);
+
+                assert(success);
+
+                if(success)
+                {
+                    R_norm_sq = resid_2.frobenius_norm_squared();
+
+                    const scalar_type r_dot_z_2 = null_space_impose_precondition(inv_diag, resid_2, z);
+
+                    const value_type beta = r_dot_z_2 / r_dot_z;
+
+                    r_dot_z = r_dot_z_2;
+
+                    success = resid_1.axpby(z, minus_one, beta);
+
+                    assert(success);
+                }
+            }
+
+            ++i_iter;
+        }
+
+        if(success && lag_mult)
+            lag_mult->swap(lambda);
+
+        if(stats)
+        {
+            stats->direct        = false;
+            stats->converged     = R_norm_sq <= sqtol;
+            stats->num_iters     = i_iter;
+            stats->resid_norm_sq = double(2 * R_norm_sq);
+            stats->sqtol         = double(sqtol);
+        }
+    }
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "null_space_impose_structured: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Direct alternative to the Uzawa CG iteration.  With V the right and U the
+// left basis, the constraints X * V = 0 and U^H * X = 0 are B(X) = 0 for a
+// linear map B from the pattern entries to the values of the right
+// constraints (i, k), one group of right_nullity per row i, and of the left
+// constraints (k, j), one group of left_nullity per column j.  The nearest X to
+// A is A - B^*(lambda), where
+//
+// (B * B^*) lambda = B(A).
+//
+// For constraint c, B(X)_c = sum_e w_c(e) X_e over pattern entries e = (i, j),
+// with w = V(j, k) for right constraint (i, k) and w = conj(U(i, k)) for left
+// constraint (k, j).  So the right constraints of different rows do not
+// couple, and neither do the left ones of different columns.  B * B^* is
+//
+// [ D_R      S_RL ]
+// [ S_RL^H   D_L  ]
+//
+// with D_R block diagonal with a right_nullity sized block per row, D_L block
+// diagonal with a left_nullity sized block per column, and S_RL non-zero only
+// between row i and column j for a pattern entry (i, j).  The groups of the
+// larger side, the eliminated side, are eliminated one at a time with their
+// small blocks, which leaves a dense Schur complement system for the smaller,
+// kept side.  B * B^* is singular because U^H * (X * V) = (U^H * X) * V, but
+// B(A) is in its range, so any solution gives the same X.  The blocks and the
+// Schur complement are solved with dense_matrix_linear_hpd_solve_robust, which
+// handles singular ones.
+
+// Use the direct solve only when it is expected to be cheaper than the
+// iteration.  The direct solve costs about K^3 for K kept constraints, at most
+// null_space_impose_direct_max_kept_size, plus a fixed amount per eliminated
+// group for its small factorization.  An iteration costs about the number of
+// entries times the sum of the nullities, and typically a few tens of them are
+// needed.  The constants are in units of that work per entry.
+
+const std::size_t null_space_impose_direct_max_nullity   = 10;   // MAGIC CONSTANT
+const std::size_t null_space_impose_direct_max_kept_size = 100;  // MAGIC CONSTANT
+const std::size_t null_space_impose_direct_group_work    = 1000; // MAGIC CONSTANT
+const std::size_t null_space_impose_direct_iters         = 30;   // MAGIC CONSTANT
+
+inline bool null_space_impose_use_direct(
+    std::size_t num_rows,
+    std::size_t num_cols,
+    std::size_t num_entries,
+    std::size_t left_nullity,
+    std::size_t right_nullity)
+{
+    if(left_nullity  > null_space_impose_direct_max_nullity ||
+       right_nullity > null_space_impose_direct_max_nullity)
+        return false;
+
+    // Same choice of kept side as in null_space_impose_direct.
+    const bool keep_left = num_cols * left_nullity <= num_rows * right_nullity;
+
+    const std::size_t num_kept   = keep_left ? num_cols * left_nullity : num_rows * right_nullity;
+    const std::size_t num_groups = keep_left ? num_rows : num_cols;
+
+    if(num_kept > null_space_impose_direct_max_kept_size)
+        return false;
+
+    const std::size_t direct_work =
+        num_kept * num_kept * num_kept +
+        num_groups * null_space_impose_direct_group_work;
+
+    const std::size_t iter_work =
+        null_space_impose_direct_iters * num_entries * (left_nullity + right_nullity);
+
+    return direct_work <= iter_work;
+}
+
+// One side of the constraints in null_space_impose_direct.  A group is a row
+// (right side) or a column (left side).  For entry (i, j), the weight of
+// constraint k of its group is basis(other, k), conjugated for the left side,
+// where other is j for a row and i for a column.
+
+template<typename value_type>
+struct null_space_impose_direct_side
+{
+    const value_type* basis;
+    std::size_t       LD;
+    std::size_t       nullity;
+    std::size_t       num_groups;
+    bool              conjugate;
+
+    value_type weight(std::size_t other, std::size_t k) const
+    {
+        const value_type w = basis[other + k * LD];
+        return conjugate ? std::conj(w) : w;
+    }
+};
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool null_space_impose_direct(
+// Input:
+    index_type left_nullity,
+    const value_type* left_basis,   // A.num_vecs() x left_nullity
+    index_type left_basis_LD,
+    index_type right_nullity,
+    const value_type* right_basis,  // A.max_size() x right_nullity
+    index_type right_basis_LD,
+
+// Input/Output:
+    sparse_vectors<index_type, offset_type, value_type>& A, // row based
+
+// Output:
+    null_space_impose_stats* stats = 0)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const index_type num_rows = A.num_vecs();
+    const index_type num_cols = A.max_size();
+
+    bool success =
+        left_nullity <= num_rows &&
+        right_nullity <= num_cols &&
+        (left_basis || !left_nullity) &&
+        (right_basis || !right_nullity) &&
+        num_rows <= left_basis_LD &&
+        num_cols <= right_basis_LD;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "null_space_impose_direct: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const std::size_t m = std::size_t(num_rows);
+    const std::size_t n = std::size_t(num_cols);
+
+    null_space_impose_direct_side<value_type> right_side =
+        { right_basis, std::size_t(right_basis_LD), std::size_t(right_nullity), m, false };
+
+    null_space_impose_direct_side<value_type> left_side =
+        { left_basis, std::size_t(left_basis_LD), std::size_t(left_nullity), n, true };
+
+    if(stats)
+    {
+        stats->direct    = true;
+        stats->converged = true;
+        stats->num_iters = 0;
+        stats->sqtol     = double(null_space_impose_sqtol(A));
+    }
+
+    const bool keep_left =
+        n * left_side.nullity <= m * right_side.nullity;
+
+    const null_space_impose_direct_side<value_type>& elim = keep_left ? right_side : left_side;
+    const null_space_impose_direct_side<value_type>& kept = keep_left ? left_side : right_side;
+
+    const std::size_t kE = elim.nullity;
+    const std::size_t kK = kept.nullity;
+    const std::size_t NE = elim.num_groups * kE;
+    const std::size_t NK = kept.num_groups * kK;
+
+    if(!NE && !NK)
+        return success;
+
+    const offset_type* offsets = A.vec_offsets();
+    const index_type*  ids     = A.vec_ids();
+    value_type*        vals    = A.vec_values();
+
+    const std::size_t nnz = std::size_t(offsets[num_rows]);
+
+    // Entries by eliminated group: entry id and the other index, which is the
+    // kept group.  Rows are already in this order, columns are sorted to it.
+
+    std::vector<offset_type> group_offsets, group_entries;
+    std::vector<index_type>  group_others;
+
+    // Per eliminated group g with p_g entries: the kE x kE block G_g, and
+    // Y_g = G_g^+ * [b_g, M_g] in kE x (1 + p_g * kK), where M_g is the
+    // coupling of g to the kept constraints of its entries, in entry order.
+
+    std::vector<std::size_t> Y_offsets;
+    std::vector<value_type>  G, Y, M_col;
+
+    // Kept side: Schur complement C, right hand side and lambda.
+    std::vector<value_type> C, lambda_kept, lambda_elim;
+
+    try
+    {
+        group_offsets.resize(elim.num_groups + 1);
+        group_entries.resize(nnz);
+        group_others.resize(nnz);
+        Y_offsets.resize(elim.num_groups + 1);
+        G.resize(kE * kE);
+        C.resize(NK * NK);
+        lambda_kept.resize(NK);
+        lambda_elim.resize(NE);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("null_space_impose_direct: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    if(keep_left)
+    {
+        for(std::size_t i = 0; i <= m; ++i)
+            group_offsets[i] = offsets[i];
+
+        for(std::size_t e = 0; e < nnz; ++e)
+        {
+            group_entries[e] = offset_type(e);
+            group_others[e] = ids[e];
+        }
+    }
+    else
+    {
+        for(std::size_t e = 0; e < nnz; ++e)
+            ++group_offsets[std::size_t(ids[e]) + 1];
+
+        for(std::size_t j = 0; j < n; ++j)
+            group_offsets[j + 1] += group_offsets[j];
+
+        std::vector<offset_type> next(group_offsets.begin(), group_offsets.end() - 1);
+
+        for(std::size_t i = 0; i < m; ++i)
+        {
+            for(offset_type e = offsets[i]; e < offsets[i + 1]; ++e)
+            {
+                const offset_type pos = next[std::size_t(ids[e])]++;
+
+                group_entries[std::size_t(pos)] = e;
+                group_others[std::size_t(pos)] = index_type(i);
+            }
+        }
+    }
+
+    Y_offsets[0] = 0;
+
+    for(std::size_t g = 0; g < elim.num_groups; ++g)
+    {
+        const std::size_t p_g = std::size_t(group_offsets[g + 1] - group_offsets[g]);
+        Y_offsets[g + 1] = Y_offsets[g] + kE * (1 + p_g * kK);
+    }
+
+    try
+    {
+        Y.resize(Y_offsets.back());
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("null_space_impose_direct: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    const scalar_type max_condition =
+        scalar_type(1) / (std::numeric_limits<scalar_type>::epsilon() * scalar_type(1E2)); // MAGIC CONSTANT
+
+    // D_K and b_K, in C and lambda_kept.  Kept constraint (h, k) is h * kK + k.
+
+    for(std::size_t g = 0; g < elim.num_groups; ++g)
+    {
+        for(offset_type pos = group_offsets[g]; pos < group_offsets[g + 1]; ++pos)
+        {
+            const std::size_t h = std::size_t(group_others[std::size_t(pos)]);
+            const value_type  a = vals[group_entries[std::size_t(pos)]];
+
+            for(std::size_t k = 0; k < kK; ++k)
+            {
+                const value_type w = kept.weight(g, k);
+
+                lambda_kept[h * kK + k] += w * a;
+
+                for(std::size_t k2 = 0; k2 < kK; ++k2)
+                    C[h * kK + k + (h * kK + k2) * NK] += w * std::conj(kept.weight(g, k2));
+            }
+        }
+    }
+
+    // Eliminate each group: C -= M_g^H * G_g^+ * M_g, b_K -= M_g^H * G_g^+ * b_g.
+
+    for(std::size_t g = 0; success && kE && g < elim.num_groups; ++g)
+    {
+        const offset_type begin = group_offsets[g];
+        const std::size_t p_g = std::size_t(group_offsets[g + 1] - begin);
+        const std::size_t num_Y_cols = 1 + p_g * kK;
+
+        value_type* Y_g = &Y[Y_offsets[g]];
+
+        std::fill(G.begin(), G.end(), value_type(0));
+        std::fill(Y_g, Y_g + kE * num_Y_cols, value_type(0));
+
+        for(std::size_t p = 0; p < p_g; ++p)
+        {
+            const std::size_t other = std::size_t(group_others[std::size_t(begin) + p]);
+            const value_type  a = vals[group_entries[std::size_t(begin) + p]];
+
+            for(std::size_t k = 0; k < kE; ++k)
+            {
+                const value_type w = elim.weight(other, k);
+
+                Y_g[k] += w * a;
+
+                for(std::size_t k2 = 0; k2 <= k; ++k2)
+                    G[k2 + k * kE] += elim.weight(other, k2) * std::conj(w);
+
+                for(std::size_t k2 = 0; k2 < kK; ++k2)
+                    Y_g[k + (1 + p * kK + k2) * kE] = w * std::conj(kept.weight(g, k2));
+            }
+        }
+
+        // Keep M_g for the update of C, since the solve over-writes Y_g.
+
+        if(kK)
+            M_col.assign(Y_g + kE, Y_g + kE * num_Y_cols);
+
+        success =
+            dense_matrix_linear_hpd_solve_robust(
+                'U', kE, num_Y_cols,
+                &G.front(), kE,
+                Y_g, kE,
+                max_condition, kE);
+
+        if(!success || !kK)
+            continue;
+
+        for(std::size_t q = 0; q < p_g; ++q)
+        {
+            const std::size_t h_q = std::size_t(group_others[std::size_t(begin) + q]);
+
+            for(std::size_t k3 = 0; k3 < kK; ++k3)
+            {
+                const value_type* Y_col = Y_g + (1 + q * kK + k3) * kE;
+                const std::size_t c_col = h_q * kK + k3;
+
+                for(std::size_t p = 0; p < p_g; ++p)
+                {
+                    const std::size_t h_p = std::size_t(group_others[std::size_t(begin) + p]);
+
+                    for(std::size_t k2 = 0; k2 < kK; ++k2)
+                    {
+                        const value_type* M_c = &M_col[(p * kK + k2) * kE];
+
+                        value_type dot = 0;
+
+                        for(std::size_t k = 0; k < kE; ++k)
+                            dot += std::conj(M_c[k]) * Y_col[k];
+
+                        C[h_p * kK + k2 + c_col * NK] -= dot;
+                    }
+                }
+            }
+        }
+
+        for(std::size_t p = 0; p < p_g; ++p)
+        {
+            const std::size_t h_p = std::size_t(group_others[std::size_t(begin) + p]);
+
+            for(std::size_t k2 = 0; k2 < kK; ++k2)
+            {
+                const value_type* M_c = &M_col[(p * kK + k2) * kE];
+
+                value_type dot = 0;
+
+                for(std::size_t k = 0; k < kE; ++k)
+                    dot += std::conj(M_c[k]) * Y_g[k];
+
+                lambda_kept[h_p * kK + k2] -= dot;
+            }
+        }
+    }
+
+    if(success && NK)
+        success =
+            dense_matrix_linear_hpd_solve_robust(
+                'U', NK, std::size_t(1),
+                &C.front(), NK,
+                &lambda_kept.front(), NK,
+                max_condition, NK);
+
+    if(success)
+    {
+        // lambda_g = G_g^+ * (b_g - M_g * lambda_K(entries of g))
+
+        for(std::size_t g = 0; kE && g < elim.num_groups; ++g)
+        {
+            const offset_type begin = group_offsets[g];
+            const std::size_t p_g = std::size_t(group_offsets[g + 1] - begin);
+            const value_type* Y_g = &Y[Y_offsets[g]];
+
+            for(std::size_t k = 0; k < kE; ++k)
+            {
+                value_type l = Y_g[k];
+
+                for(std::size_t p = 0; p < p_g; ++p)
+                {
+                    const std::size_t h_p = std::size_t(group_others[std::size_t(begin) + p]);
+
+                    for(std::size_t k2 = 0; k2 < kK; ++k2)
+                        l -= Y_g[k + (1 + p * kK + k2) * kE] * lambda_kept[h_p * kK + k2];
+                }
+
+                lambda_elim[g * kE + k] = l;
+            }
+        }
+
+        // X = A - B^*(lambda)
+
+        for(std::size_t g = 0; g < elim.num_groups; ++g)
+        {
+            for(offset_type pos = group_offsets[g]; pos < group_offsets[g + 1]; ++pos)
+            {
+                const std::size_t h = std::size_t(group_others[std::size_t(pos)]);
+
+                value_type correction = 0;
+
+                for(std::size_t k = 0; k < kE; ++k)
+                    correction += std::conj(elim.weight(h, k)) * lambda_elim[g * kE + k];
+
+                for(std::size_t k = 0; k < kK; ++k)
+                    correction += std::conj(kept.weight(g, k)) * lambda_kept[h * kK + k];
+
+                vals[group_entries[std::size_t(pos)]] -= correction;
+            }
+        }
+
+        if(stats)
+        {
+            const dense_vectors<index_type, const value_type> left_basis_dv(
+                left_nullity, num_rows, left_basis_LD, left_basis);
+
+            const dense_vectors<index_type, const value_type> right_basis_dv(
+                right_nullity, num_cols, right_basis_LD, right_basis);
+
+            dense_vectors<index_type, value_type> left_resid, right_resid;
+
+            success =
+                left_resid.allocate (left_nullity, num_cols) &&
+                right_resid.allocate(right_nullity, num_rows) &&
+                sparse_matrix_mult_trans(A, left_basis_dv, left_resid, value_type(1)) &&
+                sparse_matrix_mult(A, right_basis_dv, right_resid, value_type(1));
+
+            stats->resid_norm_sq = double(
+                left_resid.frobenius_norm_squared() +
+                right_resid.frobenius_norm_squared());
+        }
+    }
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "null_space_impose_direct: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Lagrange multipliers of a previous iterative null_space_impose call, and the
+// bases they are for.  For a sequence of nearby matrices, starting from them
+// instead of from zero leaves only the change to the iteration.  With
+// B^*(lambda) = L * lambda_left^H for the left basis L, the multipliers for
+// another basis L' of the same space are lambda_left * (L'^H L)^H, and
+// similarly on the right.  So the bases may change between calls.  For nearby
+// but different spaces that is only an approximation, still a good start.
+
+template<typename index_type, typename value_type>
+struct null_space_impose_warm_start
+{
+    null_space_impose_warm_start()
+        :
+        valid(false),
+        structured(false)
+    {
+    }
+
+    bool valid;
+    bool structured;  // Only right multipliers then.
+
+    dense_vectors<index_type, value_type> left_basis;
+    dense_vectors<index_type, value_type> right_basis;
+    dense_vectors<index_type, value_type> left_lambda;   // nullity x num_cols
+    dense_vectors<index_type, value_type> right_lambda;  // nullity x num_rows
+};
+
+// lambda for new_basis from old_lambda for old_basis, both with vectors of
+// size resid_size.
+
+template<typename index_type, typename value_type>
+bool null_space_impose_warm_start_lambda(
+    const dense_vectors<index_type, value_type>& old_basis,
+    const dense_vectors<index_type, value_type>& old_lambda,
+    const dense_vectors<index_type, value_type>& new_basis,
+    index_type resid_size,
+    dense_vectors<index_type, value_type>& lambda)
+{
+    const index_type old_nullity = old_basis.num_vecs();
+    const index_type new_nullity = new_basis.num_vecs();
+
+    dense_vectors<index_type, value_type> change;  // new_nullity x old_nullity
+
+    bool success =
+        old_basis.vec_size() == new_basis.vec_size() &&
+        old_lambda.num_vecs() == old_nullity &&
+        old_lambda.vec_size() == resid_size &&
+        lambda.allocate(new_nullity, resid_size) &&
+        lambda.fill(value_type(0));
+
+    if(success && old_nullity && new_nullity && resid_size)
+    {
+        success =
+            change.allocate(old_nullity, new_nullity)
+            &&
+            dense_matrix_mult(
+                'C', 'N', new_nullity, old_nullity, new_basis.vec_size(),
+                value_type(1),
+                new_basis.vec_values(), new_basis.leading_dimension(),
+                old_basis.vec_values(), old_basis.leading_dimension(),
+                value_type(0),
+                change.vec_values(), change.leading_dimension())
+            &&
+            dense_matrix_mult(
+                'N', 'C', resid_size, new_nullity, old_nullity,
+                value_type(1),
+                old_lambda.vec_values(), old_lambda.leading_dimension(),
+                change.vec_values(), change.leading_dimension(),
+                value_type(0),
+                lambda.vec_values(), lambda.leading_dimension());
+    }
+
+    return success;
+}
+
+template<typename index_type, typename value_type>
+bool null_space_impose_warm_start_copy(
+    const dense_vectors<index_type, value_type>& basis,
+    dense_vectors<index_type, value_type>& copy)
+{
+    bool success = copy.allocate(basis.num_vecs(), basis.vec_size());
+
+    if(success && basis.num_vecs() && basis.vec_size())
+        success = copy.fill(value_type(0)) && copy.add(basis);
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// With warm_start, the iterative versions start from its multipliers if they
+// are for the same version, and then keep the final ones in it.  The direct
+// version has no multipliers and invalidates it.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool null_space_impose(
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    sparse_vectors<index_type, offset_type, value_type>& A, // row based
+    null_space_impose_structure structure = null_space_impose_general,
+    null_space_impose_stats* stats = 0,
+    null_space_impose_warm_start<index_type, value_type>* warm_start = 0)
+{
+    bool success =
+        left_null_space.vec_size() == A.num_vecs() &&
+        right_null_space.vec_size() == A.max_size();
+
+    // The structured version needs equal nullities and a symmetric pattern.
+    // Otherwise use the general one.
+
+    std::vector<offset_type> trans_pos;
+
+    const bool use_structured =
+        success &&
+        structure != null_space_impose_general &&
+        left_null_space.num_vecs() == right_null_space.num_vecs() &&
+        null_space_impose_transpose_positions(A, trans_pos);
+
+    const bool use_direct =
+        null_space_impose_use_direct(
+            std::size_t(A.num_vecs()),
+            std::size_t(A.max_size()),
+            std::size_t(A.num_entries()),
+            std::size_t(left_null_space.num_vecs()),
+            std::size_t(right_null_space.num_vecs()));
+
+    if(success && use_direct)
+    {
+        // The nearest matrix to a structured A has the structure too, but
+        // only up to rounding after the direct solve.  So make it exact.
+
+        if(use_structured)
+            null_space_impose_make_structured(structure, trans_pos, A);
+
+        success =
+            null_space_impose_direct(
+                left_null_space.num_vecs(),
+                left_null_space.vec_values(),
+                left_null_space.leading_dimension(),
+                right_null_space.num_vecs(),
+                right_null_space.vec_values(),
+                right_null_space.leading_dimension(),
+                A,
+                stats);
+
+        if(success && use_structured)
+            null_space_impose_make_structured(structure, trans_pos, A);
+
+        if(warm_start)
+            warm_start->valid = false;
+    }
+    else
+    {
+        // Without a usable warm start the multipliers start from zero, but
+        // are still computed to be kept.
+
+        dense_vectors<index_type, value_type> left_lambda, right_lambda;
+
+        if(success &&
+           warm_start &&
+           warm_start->valid &&
+           warm_start->structured == use_structured)
+        {
+            const bool transformed =
+                (use_structured ||
+                 null_space_impose_warm_start_lambda(
+                    warm_start->left_basis,
+                    warm_start->left_lambda,
+                    left_null_space,
+                    A.max_size(),
+                    left_lambda))
+                &&
+                null_space_impose_warm_start_lambda(
+                    warm_start->right_basis,
+                    warm_start->right_lambda,
+                    right_null_space,
+                    A.num_vecs(),
+                    right_lambda);
+
+            if(!transformed)
+            {
+                dense_vectors<index_type, value_type>().swap(left_lambda);
+                dense_vectors<index_type, value_type>().swap(right_lambda);
+            }
+        }
+
+        success = success &&
+            (use_structured ?
+                null_space_impose_structured(
+                    structure,
+                    right_null_space.num_vecs(),
+                    right_null_space.vec_values(),
+                    right_null_space.leading_dimension(),
+                    trans_pos,
+                    A,
+                    stats,
+                    warm_start ? &right_lambda : 0)
+                :
+                null_space_impose(
+                    left_null_space.num_vecs(),
+                    left_null_space.vec_values(),
+                    left_null_space.leading_dimension(),
+                    right_null_space.num_vecs(),
+                    right_null_space.vec_values(),
+                    right_null_space.leading_dimension(),
+                    A,
+                    stats,
+                    warm_start ? &left_lambda : 0,
+                    warm_start ? &right_lambda : 0));
+
+        if(warm_start)
+        {
+            warm_start->valid =
+                success &&
+                null_space_impose_warm_start_copy(
+                    left_null_space, warm_start->left_basis) &&
+                null_space_impose_warm_start_copy(
+                    right_null_space, warm_start->right_basis);
+
+            warm_start->structured = use_structured;
+            warm_start->left_lambda.swap(left_lambda);
+            warm_start->right_lambda.swap(right_lambda);
+        }
+    }
 
     if(!success)
     {
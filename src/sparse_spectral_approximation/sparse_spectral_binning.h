@@ -70,42 +70,29 @@ http://www.txcorp.com
 // and binning parameter.
 // -----------------------------------------------------------------------------
 
-// For real matrices.
+// For real matrices.  vals has the values of the matrix rows, and bin_pattern
+// has the ids to access them for each entry of the pattern (row_offsets,
+// column_ids), in the same order.
 template
 <
     typename index_type,
     typename offset_type,
-    typename value_type
+    typename ids_collection_type,
+    typename vals_inc_collection_type
 >
-bool sparse_spectral_binning_row(
+bool sparse_spectral_binning_row_values(
     index_type num_rows,
     index_type num_cols,
-    const value_type* A_col_values,    // num_rows x num_cols
-    index_type A_col_leading_dim,
+    const ids_collection_type& bin_pattern,
+    const vals_inc_collection_type& vals,
     const offset_type* row_offsets,    // Size num_rows + 1
     const index_type* column_ids,      // Size row_offsets[num_rows]
     offset_type max_num_bins,
+    matrix_binning_method binning_method,
     offset_type& actual_num_bins,
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >& row_split_pattern,
+    split_pattern<index_type, offset_type>& row_split_pattern,
     offset_type* row_bin_ids) // Size row_offsets[num_rows]
 {
-    bool success =
-        A_col_values &&
-        num_rows <= A_col_leading_dim &&
-        row_offsets &&
-        column_ids &&
-        (row_bin_ids || !num_rows);
-
-    if(!success)
-    {
-        assert(false);
-
-        internal_api_error_set_last(
-            "sparse_spectral_binning_row: Unacceptable input argument(s).");
-
-        return false;
-    }
-
     std::vector<offset_type> bin_work_array;
 
     try
@@ -122,39 +109,25 @@ bool sparse_spectral_binning_row(
         return false;
     }
 
-    const dense_vectors<index_type, const value_type> col_matrix(
-        num_cols,
-        num_rows,
-        A_col_leading_dim,
-        A_col_values);
-
-    const dense_vectors_transpose_view<index_type, const value_type> row_matrix(
-        col_matrix);
-
-    sparse_vectors_ids<const index_type, const offset_type> in_row_pattern(
-        num_rows, num_cols, row_offsets, column_ids);
-
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >
+    split_pattern<index_type, offset_type>
         tmp_row_split_pattern;
 
-    success =
+    bool success =
         matrix_binning(
-            in_row_pattern,
-            row_matrix,
+            bin_pattern,
+            vals,
             max_num_bins,
+            binning_method,
             row_bin_ids,
             actual_num_bins,
             bin_work_array.size() ? &bin_work_array.front() : 0)
         &&
-        tmp_row_split_pattern.allocate(
-            actual_num_bins, offset_type(1))
-        &&
         split_pattern_to_bins(
             num_rows, num_cols,
             row_offsets, column_ids,
             row_bin_ids,
-            tmp_row_split_pattern.num_vecs(),
-            tmp_row_split_pattern.vec_values());
+            actual_num_bins,
+            tmp_row_split_pattern);
 
     if(success)
     {
@@ -176,48 +149,30 @@ bool sparse_spectral_binning_row(
     return success;
 }
 
-// -----------------------------------------------------------------------------
-
 // For complex matrices.
 template
 <
     typename index_type,
     typename offset_type,
-    typename scalar_type
+    typename ids_collection_type,
+    typename vals_inc_collection_type
 >
-bool sparse_spectral_binning_row(
+bool sparse_spectral_binning_row_values(
     index_type num_rows,
     index_type num_cols,
-    const std::complex<scalar_type>* A_col_values,    // num_rows x num_cols
-    index_type A_col_leading_dim,
+    const ids_collection_type& bin_pattern,
+    const vals_inc_collection_type& vals,
     const offset_type* row_offsets,    // Size num_rows + 1
     const index_type* column_ids,      // Size row_offsets[num_rows]
     offset_type max_num_bins,
+    matrix_binning_method binning_method,
     offset_type& real_actual_num_bins,
     offset_type& imag_actual_num_bins,
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >& real_row_split_pattern,
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >& imag_row_split_pattern,
+    split_pattern<index_type, offset_type>& real_row_split_pattern,
+    split_pattern<index_type, offset_type>& imag_row_split_pattern,
     offset_type* real_row_bin_ids, // Size row_offsets[num_rows]
     offset_type* imag_row_bin_ids) // Size row_offsets[num_rows]
 {
-    bool success =
-        A_col_values &&
-        num_rows <= A_col_leading_dim &&
-        row_offsets &&
-        column_ids &&
-        real_row_bin_ids &&
-        imag_row_bin_ids;
-
-    if(!success)
-    {
-        assert(false);
-
-        internal_api_error_set_last(
-            "sparse_spectral_binning_row: Unacceptable input argument(s).");
-
-        return false;
-    }
-
     std::vector<offset_type> bin_work_array;
 
     try
@@ -234,52 +189,35 @@ bool sparse_spectral_binning_row(
         return false;
     }
 
-    const dense_vectors<index_type, const std::complex<scalar_type> > col_matrix(
-        num_cols,
-        num_rows,
-        A_col_leading_dim,
-        A_col_values);
-
-    const dense_vectors_transpose_view<index_type, const std::complex<scalar_type> > row_matrix(
-        col_matrix);
-
-    sparse_vectors_ids<const index_type, const offset_type> in_row_pattern(
-        num_rows, num_cols, row_offsets, column_ids);
-
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >
+    split_pattern<index_type, offset_type>
         tmp_real_row_split_pattern,
         tmp_imag_row_split_pattern;
 
-    success =
+    bool success =
         matrix_binning(
-            in_row_pattern,
-            row_matrix,
+            bin_pattern,
+            vals,
             max_num_bins,
+            binning_method,
             real_row_bin_ids, imag_row_bin_ids,
             real_actual_num_bins, imag_actual_num_bins,
             bin_work_array.size() ? &bin_work_array.front() : 0)
         &&
-        tmp_real_row_split_pattern.allocate(
-            real_actual_num_bins, offset_type(1))
-        &&
-        tmp_imag_row_split_pattern.allocate(
-            imag_actual_num_bins, offset_type(1))
-        &&
         split_pattern_to_bins(
             num_rows, num_cols,
             row_offsets,
             column_ids,
             real_row_bin_ids,
-            tmp_real_row_split_pattern.num_vecs(),
-            tmp_real_row_split_pattern.vec_values())
+            real_actual_num_bins,
+            tmp_real_row_split_pattern)
         &&
         split_pattern_to_bins(
             num_rows, num_cols,
             row_offsets,
             column_ids,
             imag_row_bin_ids,
-            tmp_imag_row_split_pattern.num_vecs(),
-            tmp_imag_row_split_pattern.vec_values());
+            imag_actual_num_bins,
+            tmp_imag_row_split_pattern);
 
     if(success)
     {
@@ -305,6 +243,304 @@ bool sparse_spectral_binning_row(
 
 // -----------------------------------------------------------------------------
 
+// For real matrices.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool sparse_spectral_binning_row(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* A_col_values,    // num_rows x num_cols
+    index_type A_col_leading_dim,
+    const offset_type* row_offsets,    // Size num_rows + 1
+    const index_type* column_ids,      // Size row_offsets[num_rows]
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    offset_type& actual_num_bins,
+    split_pattern<index_type, offset_type>& row_split_pattern,
+    offset_type* row_bin_ids) // Size row_offsets[num_rows]
+{
+    bool success =
+        A_col_values &&
+        num_rows <= A_col_leading_dim &&
+        row_offsets &&
+        column_ids &&
+        (row_bin_ids || !num_rows);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_binning_row: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const dense_vectors<index_type, const value_type> col_matrix(
+        num_cols,
+        num_rows,
+        A_col_leading_dim,
+        A_col_values);
+
+    const dense_vectors_transpose_view<index_type, const value_type> row_matrix(
+        col_matrix);
+
+    sparse_vectors_ids<const index_type, const offset_type> in_row_pattern(
+        num_rows, num_cols, row_offsets, column_ids);
+
+    return sparse_spectral_binning_row_values(
+        num_rows, num_cols,
+        in_row_pattern,
+        row_matrix,
+        row_offsets, column_ids,
+        max_num_bins,
+        binning_method,
+        actual_num_bins,
+        row_split_pattern,
+        row_bin_ids);
+}
+
+// -----------------------------------------------------------------------------
+
+// For complex matrices.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+bool sparse_spectral_binning_row(
+    index_type num_rows,
+    index_type num_cols,
+    const std::complex<scalar_type>* A_col_values,    // num_rows x num_cols
+    index_type A_col_leading_dim,
+    const offset_type* row_offsets,    // Size num_rows + 1
+    const index_type* column_ids,      // Size row_offsets[num_rows]
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    offset_type& real_actual_num_bins,
+    offset_type& imag_actual_num_bins,
+    split_pattern<index_type, offset_type>& real_row_split_pattern,
+    split_pattern<index_type, offset_type>& imag_row_split_pattern,
+    offset_type* real_row_bin_ids, // Size row_offsets[num_rows]
+    offset_type* imag_row_bin_ids) // Size row_offsets[num_rows]
+{
+    bool success =
+        A_col_values &&
+        num_rows <= A_col_leading_dim &&
+        row_offsets &&
+        column_ids &&
+        real_row_bin_ids &&
+        imag_row_bin_ids;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_binning_row: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const dense_vectors<index_type, const std::complex<scalar_type> > col_matrix(
+        num_cols,
+        num_rows,
+        A_col_leading_dim,
+        A_col_values);
+
+    const dense_vectors_transpose_view<index_type, const std::complex<scalar_type> > row_matrix(
+        col_matrix);
+
+    sparse_vectors_ids<const index_type, const offset_type> in_row_pattern(
+        num_rows, num_cols, row_offsets, column_ids);
+
+    return sparse_spectral_binning_row_values(
+        num_rows, num_cols,
+        in_row_pattern,
+        row_matrix,
+        row_offsets, column_ids,
+        max_num_bins,
+        binning_method,
+        real_actual_num_bins, imag_actual_num_bins,
+        real_row_split_pattern, imag_row_split_pattern,
+        real_row_bin_ids, imag_row_bin_ids);
+}
+
+// -----------------------------------------------------------------------------
+
+// Ids of the pattern entries relative to each row.  With these, values given
+// at the pattern in the same order as column ids can be used like values of
+// dense rows, with the same ids as the sparsity pattern too.
+template<typename index_type, typename offset_type>
+bool sparse_spectral_binning_local_ids(
+    index_type num_rows,
+    const offset_type* row_offsets,     // Size num_rows + 1
+    std::vector<index_type>& local_ids) // Resized to row_offsets[num_rows]
+{
+    try
+    {
+        local_ids.resize(row_offsets[num_rows]);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("sparse_spectral_binning_local_ids: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    for(index_type i = 0; i < num_rows; ++i)
+        for(offset_type j = row_offsets[i]; j < row_offsets[i + 1]; ++j)
+            local_ids[j] = index_type(j - row_offsets[i]);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+// Same as sparse_spectral_binning_row, but the matrix values are given only
+// at the pattern, in the same order as column_ids.  This is for a matrix
+// given in sparse form, so that it does not have to be made dense.
+
+// For real matrices.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool sparse_spectral_binning_row_at_pattern(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* pattern_values,  // Size row_offsets[num_rows]
+    const offset_type* row_offsets,    // Size num_rows + 1
+    const index_type* column_ids,      // Size row_offsets[num_rows]
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    offset_type& actual_num_bins,
+    split_pattern<index_type, offset_type>& row_split_pattern,
+    offset_type* row_bin_ids) // Size row_offsets[num_rows]
+{
+    bool success =
+        row_offsets &&
+        column_ids &&
+        (pattern_values || !row_offsets[num_rows]) &&
+        (row_bin_ids || !row_offsets[num_rows]);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_binning_row_at_pattern: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    std::vector<index_type> local_ids;
+
+    if(!sparse_spectral_binning_local_ids(num_rows, row_offsets, local_ids))
+        return false;
+
+    // sparse_vectors does not accept null values, even if empty.
+    const value_type empty_value = value_type();
+
+    const sparse_vectors<const index_type, const offset_type, const value_type> vals(
+        num_rows, num_cols,
+        row_offsets,
+        local_ids.size() ? &local_ids.front() : 0,
+        local_ids.size() ? pattern_values : &empty_value);
+
+    return
+        sparse_spectral_binning_row_values(
+            num_rows, num_cols,
+            vals,
+            vals,
+            row_offsets, column_ids,
+            max_num_bins,
+            binning_method,
+            actual_num_bins,
+            row_split_pattern,
+            row_bin_ids);
+}
+
+// -----------------------------------------------------------------------------
+
+// For complex matrices.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+bool sparse_spectral_binning_row_at_pattern(
+    index_type num_rows,
+    index_type num_cols,
+    const std::complex<scalar_type>* pattern_values,  // Size row_offsets[num_rows]
+    const offset_type* row_offsets,    // Size num_rows + 1
+    const index_type* column_ids,      // Size row_offsets[num_rows]
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    offset_type& real_actual_num_bins,
+    offset_type& imag_actual_num_bins,
+    split_pattern<index_type, offset_type>& real_row_split_pattern,
+    split_pattern<index_type, offset_type>& imag_row_split_pattern,
+    offset_type* real_row_bin_ids, // Size row_offsets[num_rows]
+    offset_type* imag_row_bin_ids) // Size row_offsets[num_rows]
+{
+    bool success =
+        row_offsets &&
+        column_ids &&
+        (pattern_values || !row_offsets[num_rows]) &&
+        real_row_bin_ids &&
+        imag_row_bin_ids;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_binning_row_at_pattern: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    std::vector<index_type> local_ids;
+
+    if(!sparse_spectral_binning_local_ids(num_rows, row_offsets, local_ids))
+        return false;
+
+    // sparse_vectors does not accept null values, even if empty.
+    const std::complex<scalar_type> empty_value = std::complex<scalar_type>();
+
+    const sparse_vectors<const index_type, const offset_type, const std::complex<scalar_type> > vals(
+        num_rows, num_cols,
+        row_offsets,
+        local_ids.size() ? &local_ids.front() : 0,
+        local_ids.size() ? pattern_values : &empty_value);
+
+    return
+        sparse_spectral_binning_row_values(
+            num_rows, num_cols,
+            vals,
+            vals,
+            row_offsets, column_ids,
+            max_num_bins,
+            binning_method,
+            real_actual_num_bins, imag_actual_num_bins,
+            real_row_split_pattern, imag_row_split_pattern,
+            real_row_bin_ids, imag_row_bin_ids);
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename index_type, typename offset_type>
 bool sparse_spectral_binning_to_col(
     index_type num_rows,
@@ -313,7 +549,7 @@ bool sparse_spectral_binning_to_col(
     const index_type* column_ids,      // Size row_offsets[num_rows]
     const offset_type* row_bin_ids,
     offset_type actual_num_bins,
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >& col_split_pattern)
+    split_pattern<index_type, offset_type>& col_split_pattern)
 {
     bool success =
         row_offsets &&
@@ -337,23 +573,20 @@ bool sparse_spectral_binning_to_col(
         row_offsets, column_ids,
         row_bin_ids);
 
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >
+    split_pattern<index_type, offset_type>
         tmp_col_split_pattern;
 
     success =
         row_bins.get_transpose(
             col_bins)
         &&
-        tmp_col_split_pattern.allocate(
-            actual_num_bins, offset_type(1))
-        &&
         split_pattern_to_bins(
             num_cols, num_rows,
             col_bins.vec_offsets(),
             col_bins.vec_ids(),
             col_bins.vec_values(),
-            tmp_col_split_pattern.num_vecs(),
-            tmp_col_split_pattern.vec_values());
+            actual_num_bins,
+            tmp_col_split_pattern);
 
     if(success)
     {
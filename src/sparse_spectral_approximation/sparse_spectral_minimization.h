@@ -54,8 +54,7 @@ http://www.txcorp.com
 
 // -----------------------------------------------------------------------------
 
-#include "sparse_spectral_approximation/sparse_spectral_misfit_lhs.h"
-#include "sparse_spectral_approximation/sparse_spectral_misfit_rhs.h"
+#include "sparse_spectral_approximation/sparse_spectral_misfit_lhs_rhs.h"
 #include "sparse_spectral_approximation/null_space_impose.h"
 #include "sparse_vectors/sparse_vectors.h"
 #include "lapack_wrap/dense_matrix_linear_hpd.h"
@@ -63,6 +62,7 @@ http://www.txcorp.com
 #include "math/vector_utils.h"
 #include "internal_api_error/internal_api_error.h"
 #include <complex>
+#include <limits>
 #include <cassert>
 
 // -----------------------------------------------------------------------------
@@ -74,6 +74,34 @@ http://www.txcorp.com
 // it allows us to not have to multiply RHS_col_values, which is a matrix and
 // the resulting product will consume extra space.
 
+// If misfit_decrease is not null, it is set to J(0) - J(X) for the solution X
+// before imposing null spaces.  Since the Hessian H and gradient g (at 0) of
+// the quadratic J in the DOFs satisfy H x = g at the minimum, this is
+// 0.5 * g' * x = LS_b' * x with LS_b the RHS before the solve, once the
+// solution is scaled by mult_factor.  See sparse_spectral_misfit_lhs_rhs.h.
+
+// Some bins can make LS_A singular or so ill-conditioned that its Cholesky
+// solution is mostly noise.  In that case the solve falls back to a truncated
+// eigen solve of the (bins x bins) system, so the earlier phases need not be
+// redone with different bins.  These are the condition number above which the
+// fallback is used, and the number of DOFs above which it is too expensive and
+// a failed Cholesky factorization is an error instead, as without fallback.
+// Without binning, the number of DOFs is the number of non-zeros.
+
+template<typename scalar_type>
+scalar_type sparse_spectral_minimization_max_condition()
+{
+    return scalar_type(1) / (std::numeric_limits<scalar_type>::epsilon() * scalar_type(1E2)); // MAGIC CONSTANT
+}
+
+template<typename offset_type>
+offset_type sparse_spectral_minimization_max_truncated_size()
+{
+    return offset_type(2000); // MAGIC CONSTANT
+}
+
+// -----------------------------------------------------------------------------
+
 // For real matrices.
 template
 <
@@ -88,8 +116,8 @@ bool sparse_spectral_minimization(
     const index_type* column_ids,      // Size row_offsets[num_rows]
     offset_type actual_num_bins,
     const offset_type* row_bin_values,   // Size row_offsets[num_rows]
-    const sparse_vectors_ids<index_type, offset_type>* row_split_pattern, // actual_num_bins
-    const sparse_vectors_ids<index_type, offset_type>* col_split_pattern, // actual_num_bins
+    const split_pattern<index_type, offset_type>& row_split_pattern, // actual_num_bins bins
+    const split_pattern<index_type, offset_type>& col_split_pattern, // actual_num_bins bins
     bool impose_null_spaces,
     const value_type* B2TB2_col_values,  // num_rows x num_rows
     index_type  B2TB2_col_leading_dim,
@@ -100,7 +128,11 @@ bool sparse_spectral_minimization(
     const dense_vectors<index_type, value_type>& left_null_space,
     const dense_vectors<index_type, value_type>& right_null_space,
     value_type* out_row_values,  // Size row_offsets[num_rows]
-    value_type mult_factor)
+    value_type mult_factor,
+    value_type* misfit_decrease = 0,
+    null_space_impose_structure null_space_structure = null_space_impose_general,
+    null_space_impose_stats* null_space_stats = 0,
+    null_space_impose_warm_start<index_type, value_type>* null_space_warm_start = 0)
 {
     bool success = out_row_values && (!num_rows || row_bin_values);
 
@@ -115,6 +147,7 @@ bool sparse_spectral_minimization(
     }
 
     dense_vectors<offset_type, value_type> LS_A, LS_b; // LS = Least squares
+    dense_vectors<offset_type, value_type> LS_b_copy;  // Only if misfit_decrease
 
     success =
         LS_A.allocate(
@@ -123,36 +156,50 @@ bool sparse_spectral_minimization(
         LS_b.allocate(
             index_type(1), actual_num_bins)
         &&
-        sparse_spectral_misfit_lhs(
+        sparse_spectral_misfit_lhs_rhs(
             num_rows, num_cols,
             B2TB2_col_values, B2TB2_col_leading_dim,
             B1B1T_col_values, B1B1T_col_leading_dim,
+            RHS_col_values, RHS_col_leading_dim,
             actual_num_bins,
             row_split_pattern,
             col_split_pattern,
             LS_A.vec_values(),
-            LS_A.leading_dimension())
-        &&
-        sparse_spectral_misfit_rhs(
-            num_rows, num_cols,
-            RHS_col_values, RHS_col_leading_dim,
-            actual_num_bins,
-            col_split_pattern,
+            LS_A.leading_dimension(),
             LS_b.vec_values())
         &&
-        dense_matrix_linear_hpd_solve(
+        (!misfit_decrease || (
+            LS_b_copy.allocate(index_type(1), actual_num_bins) &&
+            LS_b_copy.fill(0) &&
+            LS_b_copy.add(LS_b)))
+        &&
+        dense_matrix_linear_hpd_solve_robust(
             'U',
             actual_num_bins,
             offset_type(1),
             LS_A.vec_values(),
             LS_A.leading_dimension(),
             LS_b.vec_values(),
-            actual_num_bins);
+            actual_num_bins,
+            sparse_spectral_minimization_max_condition<value_type>(),
+            sparse_spectral_minimization_max_truncated_size<offset_type>());
 
     if(success)
     {
         value_type* LS_b_vals = LS_b.vec_values();
 
+        if(misfit_decrease)
+        {
+            const value_type* LS_b_copy_vals = LS_b_copy.vec_values();
+
+            value_type dot = 0;
+
+            for(offset_type i = 0; i < actual_num_bins; ++i)
+                dot += LS_b_copy_vals[i] * LS_b_vals[i];
+
+            *misfit_decrease = mult_factor * dot;
+        }
+
         if(mult_factor != 1)
             vector_utils_axpby(
                 LS_b.max_size(),
@@ -177,7 +224,10 @@ bool sparse_spectral_minimization(
             success = null_space_impose(
                 left_null_space,
                 right_null_space,
-                approximation);
+                approximation,
+                null_space_structure,
+                null_space_stats,
+                null_space_warm_start);
         }
     }
 
@@ -210,10 +260,10 @@ bool sparse_spectral_minimization(
     offset_type imag_actual_num_bins,
     const offset_type* real_row_bin_values,   // Size row_offsets[num_rows]
     const offset_type* imag_row_bin_values,   // Size row_offsets[num_rows]
-    const sparse_vectors_ids<index_type, offset_type>* real_row_split_pattern, // real_actual_num_bins
-    const sparse_vectors_ids<index_type, offset_type>* imag_row_split_pattern, // imag_actual_num_bins
-    const sparse_vectors_ids<index_type, offset_type>* real_col_split_pattern, // real_actual_num_bins
-    const sparse_vectors_ids<index_type, offset_type>* imag_col_split_pattern, // imag_actual_num_bins
+    const split_pattern<index_type, offset_type>& real_row_split_pattern, // real_actual_num_bins bins
+    const split_pattern<index_type, offset_type>& imag_row_split_pattern, // imag_actual_num_bins bins
+    const split_pattern<index_type, offset_type>& real_col_split_pattern, // real_actual_num_bins bins
+    const split_pattern<index_type, offset_type>& imag_col_split_pattern, // imag_actual_num_bins bins
     bool impose_null_spaces,
     const std::complex<scalar_type>* B2TB2_col_values,  // num_rows x num_rows
     index_type  B2TB2_col_leading_dim,
@@ -224,7 +274,11 @@ bool sparse_spectral_minimization(
     const dense_vectors<index_type, std::complex<scalar_type> >& left_null_space,
     const dense_vectors<index_type, std::complex<scalar_type> >& right_null_space,
     std::complex<scalar_type>* out_row_values,  // Size row_offsets[num_rows]
-    scalar_type mult_factor)
+    scalar_type mult_factor,
+    scalar_type* misfit_decrease = 0,
+    null_space_impose_structure null_space_structure = null_space_impose_general,
+    null_space_impose_stats* null_space_stats = 0,
+    null_space_impose_warm_start<index_type, std::complex<scalar_type> >* null_space_warm_start = 0)
 {
     bool success =
         out_row_values &&
@@ -242,6 +296,7 @@ bool sparse_spectral_minimization(
     }
 
     dense_vectors<offset_type, scalar_type> LS_A, LS_b; // LS = Least squares
+    dense_vectors<offset_type, scalar_type> LS_b_copy;  // Only if misfit_decrease
 
     const offset_type actual_num_bins =
         real_actual_num_bins + imag_actual_num_bins;
@@ -253,39 +308,52 @@ bool sparse_spectral_minimization(
         LS_b.allocate(
             index_type(1), actual_num_bins)
         &&
-        sparse_spectral_misfit_lhs(
+        sparse_spectral_misfit_lhs_rhs(
             num_rows, num_cols,
             B2TB2_col_values, B2TB2_col_leading_dim,
             B1B1T_col_values, B1B1T_col_leading_dim,
+            RHS_col_values, RHS_col_leading_dim,
             real_actual_num_bins, imag_actual_num_bins,
             real_row_split_pattern,
             imag_row_split_pattern,
             real_col_split_pattern,
             imag_col_split_pattern,
             LS_A.vec_values(),
-            LS_A.leading_dimension())
-        &&
-        sparse_spectral_misfit_rhs(
-            num_rows, num_cols,
-            RHS_col_values, RHS_col_leading_dim,
-            real_actual_num_bins, imag_actual_num_bins,
-            real_col_split_pattern,
-            imag_col_split_pattern,
+            LS_A.leading_dimension(),
             LS_b.vec_values())
         &&
-        dense_matrix_linear_hpd_solve(
+        (!misfit_decrease || (
+            LS_b_copy.allocate(index_type(1), actual_num_bins) &&
+            LS_b_copy.fill(0) &&
+            LS_b_copy.add(LS_b)))
+        &&
+        dense_matrix_linear_hpd_solve_robust(
             'U',
             actual_num_bins,
             offset_type(1),
             LS_A.vec_values(),
             LS_A.leading_dimension(),
             LS_b.vec_values(),
-            LS_b.leading_dimension());
+            LS_b.leading_dimension(),
+            sparse_spectral_minimization_max_condition<scalar_type>(),
+            sparse_spectral_minimization_max_truncated_size<offset_type>());
 
     if(success)
     {
         scalar_type* LS_b_vals = LS_b.vec_values();
 
+        if(misfit_decrease)
+        {
+            const scalar_type* LS_b_copy_vals = LS_b_copy.vec_values();
+
+            scalar_type dot = 0;
+
+            for(offset_type i = 0; i < actual_num_bins; ++i)
+                dot += LS_b_copy_vals[i] * LS_b_vals[i];
+
+            *misfit_decrease = mult_factor * dot;
+        }
+
         if(mult_factor != 1)
             vector_utils_axpby(
                 LS_b.max_size(),
@@ -314,7 +382,10 @@ bool sparse_spectral_minimization(
             success = null_space_impose(
                 left_null_space,
                 right_null_space,
-                approximation);
+                approximation,
+                null_space_structure,
+                null_space_stats,
+                null_space_warm_start);
         }
     }
 
@@ -0,0 +1,731 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef SPARSE_SPECTRAL_MISFIT_LHS_RHS_H
+#define SPARSE_SPECTRAL_MISFIT_LHS_RHS_H
+
+// -----------------------------------------------------------------------------
+
+#include "matrix_binning/split_pattern.h"
+#include "dense_algorithms/dense_matrix_utils.h"
+#include "math/precision_traits.h"
+#include "math/complex_types.h"
+#include "cpp/std_extensions.h"
+#include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <complex>
+#include <string>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+#include <cassert>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Objective: Compute the Hessian (LS_A) and the RHS (LS_b) of the quadratic
+// form in misfit function J together.
+// -----------------------------------------------------------------------------
+
+// J = 0.5 * ( norm((X-A)*B1, 'fro')^2 + norm(B2*(X-A), 'fro')^2 )
+// If X, A = m x n, B1 = n x q1, B2 = q2 x m, B2' * B2 = m x m, B1 * B1' = n x n.
+
+// d2J = kron(pinv_ATA, eye(m)) + kron(eye(n), pinv_AAT)  (if B1 = B2 = pinv(A))
+// pinv_ATA = pinv(A'A) = pinv(A)pinv(A') = B1B1T
+// pinv_AAT = pinv(AA') = pinv(A')pinv(A) = B2TB2
+// d2J = kron(B1B1T, eye(m)) + kron(eye(n), B2TB2)  --> term-order is same as J
+
+// d1J(for X = 0) = (A * B1B1T + B2TB2 * A)      --> term-order is same as in J
+// The above is true for any B1 and B2.  If B1 = B2 = pinv(A), then
+// d1J(for X = 0) = 2 * pinv(A)', which is a special case.
+
+// The code asks for the RHS matrix and fills the RHS vector for optimization.
+// The caller needs to take care of the special cases and multiplying factors.
+// The code works for a column matrix and column pattern.
+// -----------------------------------------------------------------------------
+
+// The B2TB2 part of LS_A and all of LS_b come from the column pattern, so both
+// are assembled in the same traversal of each bin's segments and id lists.
+// The B1B1T part comes from the row pattern and is a separate traversal.
+// Work is parallel over columns of LS_A, i.e., over bins, or for complex
+// matrices over pairs of a real and an imag column.  Each column (and the
+// matching entry of LS_b) is computed by one thread at a time in a fixed
+// order, so the result does not depend on the number of threads.
+
+// Below this many pattern entries, starting threads costs more than the work.
+const std::ptrdiff_t sparse_spectral_misfit_min_parallel_entries = 4096; // MAGIC CONSTANT
+
+inline bool sparse_spectral_misfit_use_threads(std::ptrdiff_t num_entries)
+{
+#ifdef _OPENMP
+    return
+        !(num_entries < sparse_spectral_misfit_min_parallel_entries) &&
+        1 < omp_get_max_threads() &&
+        !omp_in_parallel();
+#else
+    (void) num_entries;
+    return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+// Workspace to gather the sums of one column of LS_A over the bins it touches.
+
+template<typename scalar_type, typename offset_type>
+struct sparse_spectral_misfit_lhs_workspace
+{
+    std::vector<scalar_type> column_sums;
+    std::vector<offset_type> touched_dofs;
+    std::vector<offset_type> touched_in_column; // stores j_dof + 1
+
+    bool allocate(offset_type num_dofs_1)
+    {
+        try
+        {
+            column_sums.assign(std::size_t(num_dofs_1), scalar_type(0));
+            touched_dofs.reserve(std::size_t(num_dofs_1));
+            touched_in_column.assign(std::size_t(num_dofs_1), 0);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("sparse_spectral_misfit_lhs_workspace::allocate: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        return true;
+    }
+};
+
+// -----------------------------------------------------------------------------
+
+// Add the contribution to column j_dof of LS_A, rows [0, i_dof_end).  Only
+// pairs of bins that share a vector contribute.  With many bins, most pairs
+// share none, so instead of visiting all pairs, go through the vectors of bin
+// j_dof and, via a vector -> bins index of split_pat_1, only the i_dof bins
+// present in the same vector.  Sums are gathered in the workspace and only
+// touched entries are added to LS_A, keeping the work proportional to the
+// actual overlap.  Columns are independent of each other.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type,
+    typename extractor_type
+>
+void sparse_spectral_misfit_lhs_column(
+    const value_type* quad_col_values,
+    index_type quad_col_leading_dim,
+    offset_type j_dof,
+    offset_type i_dof_end,
+    const split_pattern<index_type, offset_type>& split_pat_1,
+    const split_pattern_vec_index<index_type, offset_type>& vec_index_1,
+    const split_pattern<index_type, offset_type>& split_pat_2,
+    typename precision_traits<value_type>::scalar* LS_A_col, // column j_dof
+    const extractor_type& extractor,
+    sparse_spectral_misfit_lhs_workspace<typename precision_traits<value_type>::scalar, offset_type>& work)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const offset_type j_seg_end = split_pat_2.bin_segments_end(j_dof);
+
+    work.touched_dofs.clear();
+
+    for(offset_type j_seg = split_pat_2.bin_segments_begin(j_dof); j_seg < j_seg_end; ++j_seg)
+    {
+        const index_type vec = split_pat_2.segment_vec(j_seg);
+        const index_type j_sz = split_pat_2.segment_num_entries(j_seg);
+        const index_type* j_ids = split_pat_2.segment_ids_begin(j_seg);
+
+        const offset_type entry_end = vec_index_1.vec_end(vec);
+
+        // Entries of a vector are sorted by bin, so stop at i_dof_end.
+
+        for(offset_type entry = vec_index_1.vec_begin(vec); entry < entry_end; ++entry)
+        {
+            const offset_type i_dof = vec_index_1.entry_bin(entry);
+
+            if(!(i_dof < i_dof_end))
+                break;
+
+            const offset_type i_seg = vec_index_1.entry_segment(entry);
+            const index_type i_sz = split_pat_1.segment_num_entries(i_seg);
+            const index_type* i_ids = split_pat_1.segment_ids_begin(i_seg);
+
+            if(work.touched_in_column[i_dof] != j_dof + 1)
+            {
+                work.touched_in_column[i_dof] = j_dof + 1;
+                work.touched_dofs.push_back(i_dof);
+            }
+
+            scalar_type& tmp = work.column_sums[i_dof];
+
+            for(index_type j_id = 0; j_id < j_sz; ++j_id)
+            {
+                const value_type* quad_off = quad_col_values +
+                    std::size_t(j_ids[j_id]) * std::size_t(quad_col_leading_dim);
+
+                for(index_type i_id = 0; i_id < i_sz; ++i_id)
+                {
+                    tmp += extractor(quad_off[i_ids[i_id]]);
+                }
+            }
+        }
+    }
+
+    for(std::size_t t = 0; t < work.touched_dofs.size(); ++t)
+    {
+        const offset_type i_dof = work.touched_dofs[t];
+
+        LS_A_col[i_dof] += work.column_sums[i_dof];
+        work.column_sums[i_dof] = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Sum of RHS entries in bin j_dof of a column pattern.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type,
+    typename extractor_type
+>
+typename precision_traits<value_type>::scalar sparse_spectral_misfit_rhs_bin(
+    const value_type* RHS_col_values,
+    index_type RHS_col_leading_dim,
+    offset_type j_dof,
+    const split_pattern<index_type, offset_type>& col_split_pattern,
+    const extractor_type& extractor)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    scalar_type tmp = 0;
+
+    const offset_type seg_end = col_split_pattern.bin_segments_end(j_dof);
+
+    for(offset_type seg = col_split_pattern.bin_segments_begin(j_dof); seg < seg_end; ++seg)
+    {
+        const index_type vec = col_split_pattern.segment_vec(seg);
+        const index_type j_sz = col_split_pattern.segment_num_entries(seg);
+        const index_type* j_ids = col_split_pattern.segment_ids_begin(seg);
+
+        assert(vec < col_split_pattern.num_vecs());
+        assert(j_sz <= col_split_pattern.max_size());
+
+        const value_type* A_off = RHS_col_values +
+            std::size_t(vec) * std::size_t(RHS_col_leading_dim);
+
+        for(index_type j_id = 0; j_id < j_sz; ++j_id)
+        {
+            tmp += extractor(A_off[j_ids[j_id]]);
+        }
+    }
+
+    return tmp;
+}
+
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+
+// For real matrices.  Adds to the upper half of LS_A (if quad_col_values is not
+// 0) and to b_values (if RHS_col_values is not 0).  split_pat has num_vecs
+// vectors, each of max_size size.  RHS is max_size x num_vecs.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool sparse_spectral_misfit_lhs_rhs_internal(
+    index_type num_vecs,
+    index_type max_size,
+    const value_type* quad_col_values,  // max_size x max_size, must be full.
+    index_type quad_col_leading_dim,
+    const value_type* RHS_col_values,   // max_size x num_vecs
+    index_type RHS_col_leading_dim,
+    offset_type num_dofs,
+    const split_pattern<index_type, offset_type>& split_pat, // num_dofs bins
+    value_type* LS_A_col_values,        // num_dofs x num_dofs
+    offset_type LS_A_col_leading_dim,
+    value_type* b_values)               // num_dofs
+{
+    bool success =
+        (quad_col_values || RHS_col_values) &&
+        (!quad_col_values || (LS_A_col_values && max_size <= quad_col_leading_dim && num_dofs <= LS_A_col_leading_dim)) &&
+        (!RHS_col_values || (b_values && max_size <= RHS_col_leading_dim)) &&
+        num_dofs <= split_pat.num_bins();
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_misfit_lhs_rhs_internal: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    (void) num_vecs;
+    assert(split_pat.num_vecs() == num_vecs);
+    assert(split_pat.max_size() == max_size);
+
+    split_pattern_vec_index<index_type, offset_type> vec_index;
+
+    if(quad_col_values && !vec_index.create(split_pat, num_dofs))
+        return false;
+
+    const std::ptrdiff_t num_dofs_signed = std::ptrdiff_t(num_dofs);
+
+    const bool use_threads =
+        sparse_spectral_misfit_use_threads(std::ptrdiff_t(split_pat.num_entries()));
+    (void) use_threads;
+
+#ifdef _OPENMP
+#pragma omp parallel if(use_threads)
+#endif
+    {
+        sparse_spectral_misfit_lhs_workspace<value_type, offset_type> work;
+
+        const bool loc_success = !quad_col_values || work.allocate(num_dofs);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for(std::ptrdiff_t jj = 0; jj < num_dofs_signed; ++jj)
+        {
+            const offset_type j_dof = offset_type(jj);
+
+            if(!loc_success)
+                continue;
+
+            if(quad_col_values)
+                sparse_spectral_misfit_lhs_column(
+                    quad_col_values, quad_col_leading_dim,
+                    j_dof, j_dof + 1, // upper half
+                    split_pat, vec_index, split_pat,
+                    LS_A_col_values + std::size_t(j_dof) * std::size_t(LS_A_col_leading_dim),
+                    std_extensions_identity<value_type>(), work);
+
+            if(RHS_col_values)
+                b_values[j_dof] += sparse_spectral_misfit_rhs_bin(
+                    RHS_col_values, RHS_col_leading_dim,
+                    j_dof, split_pat,
+                    std_extensions_identity<value_type>());
+        }
+
+        if(!loc_success)
+        {
+#ifdef _OPENMP
+#pragma omp critical(sparse_spectral_misfit)
+#endif
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// For complex matrices with real and imaginary parts in separate bins, imag
+// DOFs after real DOFs.  Adds to the upper halves of the real <-> real and
+// imag <-> imag blocks and to the full real <-> imag block of LS_A (if
+// quad_col_values is not 0), and to b_values (if RHS_col_values is not 0).
+// imag_sign is -1 if the real <-> imag block uses the conjugate of quad.
+
+// An entry with real bin j_real and imag bin j_imag adds to column j_real of
+// the real <-> real block and to column j_imag of the other two blocks, so its
+// column of quad is read once for all three.  Entries are grouped by the
+// blocks of DOFs their two bins fall in, and the groups of a round share no
+// block, so a thread owns the real and the imag columns of its group.  Entries
+// of a group are sorted by imag bin, so the imag column, which gets two of the
+// three blocks, stays the same from one entry to the next.  Blocks of a few
+// DOFs, instead of single DOFs, keep the real columns being added to in cache
+// when there are many bins.  See split_pattern_pair_rounds.
+
+// Blocks are as large as possible while leaving min_blocks groups per round
+// to share among threads.
+const std::ptrdiff_t sparse_spectral_misfit_min_blocks = 64;     // MAGIC CONSTANT
+const std::ptrdiff_t sparse_spectral_misfit_max_block_size = 16; // MAGIC CONSTANT
+
+inline std::ptrdiff_t sparse_spectral_misfit_block_size(std::ptrdiff_t num_bins)
+{
+    return std::max(
+        std::ptrdiff_t(1),
+        std::min(sparse_spectral_misfit_max_block_size, num_bins / sparse_spectral_misfit_min_blocks));
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+bool sparse_spectral_misfit_lhs_rhs_internal(
+    index_type num_vecs,
+    index_type max_size,
+    const std::complex<scalar_type>* quad_col_values,  // max_size x max_size, must be full.
+    index_type quad_col_leading_dim,
+    scalar_type imag_sign,
+    const std::complex<scalar_type>* RHS_col_values,   // max_size x num_vecs
+    index_type RHS_col_leading_dim,
+    offset_type real_num_dofs,
+    offset_type imag_num_dofs,
+    const split_pattern<index_type, offset_type>& real_split_pat, // real_num_dofs bins
+    const split_pattern<index_type, offset_type>& imag_split_pat, // imag_num_dofs bins
+    scalar_type* LS_A_col_values,       // (real_num_dofs + imag_num_dofs)^2
+    offset_type LS_A_col_leading_dim,
+    scalar_type* b_values)              // real_num_dofs + imag_num_dofs
+{
+    const offset_type num_dofs = real_num_dofs + imag_num_dofs;
+
+    bool success =
+        (quad_col_values || RHS_col_values) &&
+        (!quad_col_values || (LS_A_col_values && max_size <= quad_col_leading_dim && num_dofs <= LS_A_col_leading_dim)) &&
+        (!RHS_col_values || (b_values && max_size <= RHS_col_leading_dim)) &&
+        real_num_dofs == real_split_pat.num_bins() &&
+        imag_num_dofs == imag_split_pat.num_bins();
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_misfit_lhs_rhs_internal: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    typedef std::complex<scalar_type> value_type;
+
+    (void) num_vecs;
+    assert(real_split_pat.num_vecs() == num_vecs);
+    assert(real_split_pat.max_size() == max_size);
+
+    split_pattern_pair_index<index_type, offset_type> pair_index;
+    split_pattern_pair_rounds<index_type, offset_type> rounds;
+
+    if(quad_col_values &&
+       !(pair_index.create(real_split_pat, imag_split_pat) &&
+         rounds.create(
+             pair_index, num_vecs, real_num_dofs, imag_num_dofs,
+             offset_type(sparse_spectral_misfit_block_size(
+                 std::ptrdiff_t(std::max(real_num_dofs, imag_num_dofs)))))))
+        return false;
+
+    const index_type* ids = pair_index.entry_ids();
+    const offset_type* real_bins = pair_index.entry_bins_1();
+    const offset_type* imag_bins = pair_index.entry_bins_2();
+
+    const offset_type* group_entries = rounds.entries();
+    const index_type* group_entry_vecs = rounds.entry_vecs();
+
+    const offset_type num_rounds = quad_col_values ? rounds.num_rounds() : 0;
+
+    const std::ptrdiff_t num_dofs_signed = std::ptrdiff_t(num_dofs);
+
+    const bool use_threads =
+        sparse_spectral_misfit_use_threads(std::ptrdiff_t(real_split_pat.num_entries()));
+    (void) use_threads;
+
+#ifdef _OPENMP
+#pragma omp parallel if(use_threads)
+#endif
+    {
+        if(RHS_col_values)
+        {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+            for(std::ptrdiff_t jj = 0; jj < num_dofs_signed; ++jj)
+            {
+                const offset_type j_dof = offset_type(jj);
+
+                b_values[j_dof] += j_dof < real_num_dofs ?
+                    sparse_spectral_misfit_rhs_bin(
+                        RHS_col_values, RHS_col_leading_dim,
+                        j_dof, real_split_pat,
+                        real_extractor<scalar_type>()) :
+                    sparse_spectral_misfit_rhs_bin(
+                        RHS_col_values, RHS_col_leading_dim,
+                        j_dof - real_num_dofs, imag_split_pat,
+                        imag_extractor<scalar_type>());
+            }
+        }
+
+        for(offset_type round = 0; round < num_rounds; ++round)
+        {
+            const std::ptrdiff_t group_begin = std::ptrdiff_t(rounds.round_begin(round));
+            const std::ptrdiff_t group_end   = std::ptrdiff_t(rounds.round_end(round));
+
+            if(group_begin == group_end)
+                continue;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+            for(std::ptrdiff_t gg = group_begin; gg < group_end; ++gg)
+            {
+                const offset_type group = offset_type(gg);
+
+                const offset_type k_end = rounds.group_end(group);
+
+                for(offset_type k = rounds.group_begin(group); k < k_end; ++k)
+                {
+                    const offset_type j = group_entries[k];
+                    const index_type vec = group_entry_vecs[k];
+
+                    const offset_type j_real = real_bins[j];
+                    const offset_type j_imag = imag_bins[j];
+
+                    scalar_type* real_col = LS_A_col_values +
+                        std::size_t(j_real) * std::size_t(LS_A_col_leading_dim);
+
+                    // Column j_imag of imag DOFs, its rows start with real DOFs.
+                    scalar_type* imag_col = LS_A_col_values +
+                        (std::size_t(real_num_dofs) + std::size_t(j_imag)) * std::size_t(LS_A_col_leading_dim);
+
+                    scalar_type* imag_imag_col = imag_col + real_num_dofs;
+
+                    const value_type* quad_off = quad_col_values +
+                        std::size_t(ids[j]) * std::size_t(quad_col_leading_dim);
+
+                    const offset_type end = pair_index.vec_end(vec);
+
+                    for(offset_type i = pair_index.vec_begin(vec); i < end; ++i)
+                    {
+                        const value_type q = quad_off[ids[i]];
+
+                        const offset_type i_real = real_bins[i];
+                        const offset_type i_imag = imag_bins[i];
+
+                        if(!(j_real < i_real))
+                            real_col[i_real] += q.real();
+
+                        if(!(j_imag < i_imag))
+                            imag_imag_col[i_imag] += q.real();
+
+                        imag_col[i_real] += imag_sign * q.imag();
+                    }
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// For real matrices.  B1B1T_col_values or B2TB2_col_values can be 0 but not
+// both.  For the 0 case, the corresponding col_leading_dim is not used.  Only
+// upper triangle of LS_A_col_values will be filled.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool sparse_spectral_misfit_lhs_rhs(
+// Input:
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* B2TB2_col_values,  // num_rows x num_rows
+    index_type  B2TB2_col_leading_dim,
+    const value_type* B1B1T_col_values,  // num_cols x num_cols
+    index_type  B1B1T_col_leading_dim,
+    const value_type* RHS_col_values,    // num_rows x num_cols
+    index_type RHS_col_leading_dim,
+    offset_type num_dofs,
+    const split_pattern<index_type, offset_type>& row_split_pattern, // num_dofs bins
+    const split_pattern<index_type, offset_type>& col_split_pattern, // num_dofs bins
+
+// Output:
+    value_type* LS_A_col_values, // num_dofs x num_dofs
+    offset_type LS_A_col_leading_dim,
+    value_type* b_values)        // num_dofs
+{
+    bool success =
+        (B2TB2_col_values || B1B1T_col_values) &&
+        RHS_col_values &&
+        b_values;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_misfit_lhs_rhs: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    std::fill(b_values, b_values + num_dofs, value_type(0));
+
+    return
+        dense_matrix_utils_fill_upper(
+            num_dofs, num_dofs,
+            LS_A_col_values, LS_A_col_leading_dim,
+            value_type(0))
+        &&
+        (B1B1T_col_values ? sparse_spectral_misfit_lhs_rhs_internal(
+            num_rows, num_cols,
+            B1B1T_col_values, B1B1T_col_leading_dim,
+            static_cast<const value_type*>(0), index_type(0),
+            num_dofs, row_split_pattern,
+            LS_A_col_values, LS_A_col_leading_dim,
+            static_cast<value_type*>(0)) : true)
+        &&
+        sparse_spectral_misfit_lhs_rhs_internal(
+            num_cols, num_rows,
+            B2TB2_col_values, B2TB2_col_leading_dim,
+            RHS_col_values, RHS_col_leading_dim,
+            num_dofs, col_split_pattern,
+            LS_A_col_values, LS_A_col_leading_dim,
+            b_values);
+}
+
+// -----------------------------------------------------------------------------
+
+// For complex matrices.  B1B1T_col_values or B2TB2_col_values can be 0 but not
+// both.  For the 0 case, the corresponding col_leading_dim is not used.  Only
+// upper triangle of LS_A_col_values will be filled.
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+bool sparse_spectral_misfit_lhs_rhs(
+// Input:
+    index_type num_rows,
+    index_type num_cols,
+    const std::complex<scalar_type>* B2TB2_col_values,  // num_rows x num_rows
+    index_type  B2TB2_col_leading_dim,
+    const std::complex<scalar_type>* B1B1T_col_values,  // num_cols x num_cols
+    index_type  B1B1T_col_leading_dim,
+    const std::complex<scalar_type>* RHS_col_values,    // num_rows x num_cols
+    index_type RHS_col_leading_dim,
+    offset_type real_num_dofs,
+    offset_type imag_num_dofs,
+    const split_pattern<index_type, offset_type>& real_row_split_pattern, // real_num_dofs bins
+    const split_pattern<index_type, offset_type>& imag_row_split_pattern, // imag_num_dofs bins
+    const split_pattern<index_type, offset_type>& real_col_split_pattern, // real_num_dofs bins
+    const split_pattern<index_type, offset_type>& imag_col_split_pattern, // imag_num_dofs bins
+
+// Output:
+    scalar_type* LS_A_col_values, // (real_num_dofs + imag_num_dofs)^2
+    offset_type LS_A_col_leading_dim,
+    scalar_type* b_values)        // real_num_dofs + imag_num_dofs
+{
+    bool success =
+        (B2TB2_col_values || B1B1T_col_values) &&
+        RHS_col_values &&
+        b_values;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_spectral_misfit_lhs_rhs: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    const offset_type num_dofs = real_num_dofs + imag_num_dofs;
+
+    std::fill(b_values, b_values + num_dofs, scalar_type(0));
+
+    return
+        dense_matrix_utils_fill_upper(
+            num_dofs, num_dofs,
+            LS_A_col_values, LS_A_col_leading_dim,
+            scalar_type(0))
+        &&
+        (B1B1T_col_values ? sparse_spectral_misfit_lhs_rhs_internal(
+            num_rows, num_cols,
+            B1B1T_col_values, B1B1T_col_leading_dim,
+            scalar_type(1),
+            static_cast<const std::complex<scalar_type>*>(0), index_type(0),
+            real_num_dofs, imag_num_dofs,
+            real_row_split_pattern, imag_row_split_pattern,
+            LS_A_col_values, LS_A_col_leading_dim,
+            static_cast<scalar_type*>(0)) : true)
+        &&
+        sparse_spectral_misfit_lhs_rhs_internal(
+            num_cols, num_rows,
+            B2TB2_col_values, B2TB2_col_leading_dim,
+            scalar_type(-1), // conj
+            RHS_col_values, RHS_col_leading_dim,
+            real_num_dofs, imag_num_dofs,
+            real_col_split_pattern, imag_col_split_pattern,
+            LS_A_col_values, LS_A_col_leading_dim,
+            b_values);
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // SPARSE_SPECTRAL_MISFIT_LHS_RHS_H
@@ -85,17 +85,21 @@ namespace
         matrix_property_AAT_computable_from_ATA,
         matrix_property_real_part_symmetric,
         matrix_property_imag_part_symmetric,
+        matrix_property_circulant,
+        matrix_property_skew_circulant,
         matrix_property_num_properties
     };
 
     const bool matrix_type_to_properties[ssa_matrix_type_num_types][matrix_property_num_properties] =
     {
-        {0,0,0,0,0,0,0}, // general
-        {1,1,1,1,1,1,0}, // hermitian_pos_def
-        {1,1,1,1,1,1,0}, // hermitian_pos_semi_def
-        {1,1,1,1,1,1,0}, // hermitian
-        {0,1,1,1,1,0,1}, // skew_hermitian
-        {0,1,1,0,1,1,1}  // complex_symmetric
+        {0,0,0,0,0,0,0,0,0}, // general
+        {1,1,1,1,1,1,0,0,0}, // hermitian_pos_def
+        {1,1,1,1,1,1,0,0,0}, // hermitian_pos_semi_def
+        {1,1,1,1,1,1,0,0,0}, // hermitian
+        {0,1,1,1,1,0,1,0,0}, // skew_hermitian
+        {0,1,1,0,1,1,1,0,0}, // complex_symmetric
+        {0,0,1,1,0,0,0,1,0}, // circulant
+        {0,0,1,1,0,0,0,0,1}  // skew_circulant
     };
 
     // -----------------------------------------------------------------------------
@@ -165,4 +169,14 @@ int ssa_matrix_type_is_imag_part_symmetric(ssa_matrix_type type)
     return ssa_matrix_type_has_property(type, matrix_property_imag_part_symmetric);
 }
 
+int ssa_matrix_type_is_circulant(ssa_matrix_type type)
+{
+    return ssa_matrix_type_has_property(type, matrix_property_circulant);
+}
+
+int ssa_matrix_type_is_skew_circulant(ssa_matrix_type type)
+{
+    return ssa_matrix_type_has_property(type, matrix_property_skew_circulant);
+}
+
 // -----------------------------------------------------------------------------
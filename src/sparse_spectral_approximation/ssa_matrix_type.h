@@ -69,6 +69,8 @@ int ssa_matrix_type_is_normal                   (enum ssa_matrix_type type);
 int ssa_matrix_type_is_AAT_computable_from_ATA  (enum ssa_matrix_type type);
 int ssa_matrix_type_is_real_part_symmetric      (enum ssa_matrix_type type);
 int ssa_matrix_type_is_imag_part_symmetric      (enum ssa_matrix_type type);
+int ssa_matrix_type_is_circulant                (enum ssa_matrix_type type);
+int ssa_matrix_type_is_skew_circulant           (enum ssa_matrix_type type);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -55,12 +55,19 @@ http://www.txcorp.com
 // -----------------------------------------------------------------------------
 
 #include "txssa.h"
+#include "sparse_spectral_approximation/ssa_matrix_type.h"
 #include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_randomized_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_tsqr_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_circulant_pinv.h"
 #include "dense_vectors/dense_vectors.h"
 #include "internal_api_error/internal_api_error.h"
 
 // -----------------------------------------------------------------------------
 
+// If randomized is not null, types without a specialized pinv use the
+// randomized low rank pinv instead of the pivoted QR.
+
 template<typename index_type, typename value_type>
 bool ssa_matrix_type_pinv_transpose(
     index_type  num_rows,
@@ -69,7 +76,8 @@ bool ssa_matrix_type_pinv_transpose(
     index_type  A_col_leading_dim,
     ssa_matrix_type matrix_type,
     dense_vectors<index_type, value_type>* lnull,
-    dense_vectors<index_type, value_type>* rnull)
+    dense_vectors<index_type, value_type>* rnull,
+    const dense_matrix_randomized_pinv_params* randomized = 0)
 {
     bool success =
         ssa_matrix_type_undefined < matrix_type &&
@@ -87,11 +95,30 @@ bool ssa_matrix_type_pinv_transpose(
         return false;
     }
 
-    //TODO: Use type dependent pinv algorithm.
+    //TODO: Use type dependent pinv algorithm for other types too.
+
+    const int is_circulant      = ssa_matrix_type_is_circulant(matrix_type);
+    const int is_skew_circulant = ssa_matrix_type_is_skew_circulant(matrix_type);
 
-    // if(matrix_type == ssa_matrix_type_general)
+    if(is_circulant || is_skew_circulant)
+    {
+        success = dense_matrix_circulant_pinv_transpose(
+            num_rows, num_cols,
+            A_col_values, A_col_leading_dim,
+            is_skew_circulant != 0,
+            lnull, rnull);
+    }
+    else if(randomized)
+    {
+        success = dense_matrix_randomized_pinv_transpose(
+            num_rows, num_cols,
+            A_col_values, A_col_leading_dim,
+            *randomized,
+            lnull, rnull);
+    }
+    else
     {
-        success = dense_matrix_qr_pinv_transpose(
+        success = dense_matrix_tsqr_pinv_transpose(
             num_rows, num_cols,
             A_col_values, A_col_leading_dim,
             lnull, rnull);
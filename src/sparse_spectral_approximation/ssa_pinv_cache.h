@@ -0,0 +1,298 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef SSA_PINV_CACHE_H
+#define SSA_PINV_CACHE_H
+
+// -----------------------------------------------------------------------------
+
+#include "txssa.h"
+#include "dense_vectors/dense_vectors.h"
+#include "dense_vectors/dense_vectors_file.h"
+#include "dense_matrix_pinv/dense_matrix_randomized_pinv.h"
+
+#ifdef _WIN32
+#include <process.h>  // _getpid
+#else
+#include <unistd.h>   // getpid
+#endif
+
+#include <string>
+#include <cstdio>     // std::{rename, remove}
+#include <cstring>    // std::memcpy
+#include <ctime>      // std::time
+#include <cstddef>
+
+// -----------------------------------------------------------------------------
+// Objective: Keep the pseudo-inverse, the null spaces, and the Gram matrices
+// of a matrix in a file, so that approximating the same matrix again, in
+// another process too, does not recompute them.  See
+// ssa_options::cache_directory.
+//
+// The file name is made from a 128 bit hash of the matrix values and of
+// everything else that the results depend on.  The hash is also kept in the
+// file, and checked when mapping it.  Files are written under a temporary name
+// and then renamed, so that a reader never sees a partial file.
+// -----------------------------------------------------------------------------
+
+// Incremented when the results for the same input change.
+const unsigned long long ssa_pinv_cache_version = 1;
+
+// Two independent multiplicative hashes of 64 bit words.  Not cryptographic,
+// the caller is trusted not to fabricate collisions.
+class ssa_pinv_cache_hash
+{
+public:
+
+    ssa_pinv_cache_hash()
+        :
+        h1(0xCBF29CE484222325ULL), // MAGIC CONSTANT, FNV offset basis
+        h2(0x9E3779B97F4A7C15ULL)  // MAGIC CONSTANT, golden ratio
+    {
+    }
+
+    void add_word(unsigned long long w)
+    {
+        h1 = (h1 ^ w) * 0x00000100000001B3ULL;  // MAGIC CONSTANT, FNV prime
+        h1 ^= h1 >> 29;
+
+        h2 = (h2 + w) * 0xFF51AFD7ED558CCDULL;  // MAGIC CONSTANT, murmur3 mixer
+        h2 ^= h2 >> 32;
+    }
+
+    void add_bytes(const void* ptr, std::size_t num_bytes)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(ptr);
+
+        std::size_t k = 0;
+
+        for(; k + 8 <= num_bytes; k += 8)
+        {
+            unsigned long long w;
+            std::memcpy(&w, bytes + k, 8);
+            add_word(w);
+        }
+
+        unsigned long long w = 0;
+        std::memcpy(&w, bytes + k, num_bytes - k);
+        add_word(w);
+
+        add_word(num_bytes);
+    }
+
+    void get(unsigned long long key[2]) const
+    {
+        key[0] = h1;
+        key[1] = h2;
+    }
+
+private:
+
+    unsigned long long h1;
+    unsigned long long h2;
+};
+
+// -----------------------------------------------------------------------------
+
+template<typename index_type, typename value_type>
+void ssa_pinv_cache_key(
+    index_type        num_rows,
+    index_type        num_cols,
+    const value_type* col_values,
+    index_type        col_leading_dim,
+    ssa_matrix_type   matrix_type,
+    bool              impose_null_spaces,
+    const dense_matrix_randomized_pinv_params* pinv_params,
+    unsigned long long key[2])
+{
+    ssa_pinv_cache_hash hash;
+
+    hash.add_word(ssa_pinv_cache_version);
+    hash.add_word(static_cast<unsigned long long>(num_rows));
+    hash.add_word(static_cast<unsigned long long>(num_cols));
+    hash.add_word(static_cast<unsigned long long>(matrix_type));
+    hash.add_word(impose_null_spaces ? 1 : 0);
+    hash.add_word(pinv_params ? 1 : 0);
+
+    if(pinv_params)
+    {
+        hash.add_bytes(&pinv_params->rank_tolerance, sizeof(pinv_params->rank_tolerance));
+        hash.add_word(static_cast<unsigned long long>(pinv_params->oversampling));
+    }
+
+    for(index_type j = 0; j < num_cols; ++j)
+        hash.add_bytes(
+            col_values + std::size_t(j) * std::size_t(col_leading_dim),
+            std::size_t(num_rows) * sizeof(value_type));
+
+    hash.get(key);
+}
+
+// -----------------------------------------------------------------------------
+
+inline std::string ssa_pinv_cache_file_name(
+    const char* directory,
+    const unsigned long long key[2])
+{
+    const char hex_digits[] = "0123456789abcdef";
+
+    std::string file_name(directory);
+
+    if(!file_name.empty() &&
+        file_name[file_name.size() - 1] != '/' &&
+        file_name[file_name.size() - 1] != '\\')
+    {
+        file_name += '/';
+    }
+
+    file_name += "txssa_pinv_";
+
+    for(int k = 0; k < 2; ++k)
+        for(int shift = 60; 0 <= shift; shift -= 4)
+            file_name += hex_digits[(key[k] >> shift) & 0xF];
+
+    file_name += ".bin";
+
+    return file_name;
+}
+
+// -----------------------------------------------------------------------------
+
+// The cached matrices, in the order they are kept in the file.
+const std::size_t ssa_pinv_cache_num_matrices = 5;
+
+// Returns true on a hit, and then the matrices use memory of view.
+template<typename index_type, typename value_type>
+bool ssa_pinv_cache_load(
+    const std::string& file_name,
+    const unsigned long long key[2],
+    index_type num_rows,
+    index_type num_cols,
+    dense_vectors_file_view<index_type, value_type>& view,
+    dense_vectors<index_type, value_type>& pinv_AT,
+    dense_vectors<index_type, value_type>& left_null_space,
+    dense_vectors<index_type, value_type>& right_null_space,
+    dense_vectors<index_type, value_type>& B1TB1,
+    dense_vectors<index_type, value_type>& B2TB2)
+{
+    dense_vectors<index_type, value_type> tmp[ssa_pinv_cache_num_matrices];
+    dense_vectors<index_type, value_type>* tmp_ptrs[ssa_pinv_cache_num_matrices] =
+        {&tmp[0], &tmp[1], &tmp[2], &tmp[3], &tmp[4]};
+
+    const bool hit =
+        view.map(file_name.c_str(), key, ssa_pinv_cache_num_matrices, tmp_ptrs) &&
+        tmp[0].num_vecs() == num_cols && tmp[0].vec_size() == num_rows &&
+        (tmp[1].num_vecs() == 0 || tmp[1].vec_size() == num_rows) &&
+        (tmp[2].num_vecs() == 0 || tmp[2].vec_size() == num_cols) &&
+        tmp[3].num_vecs() == num_cols && tmp[3].vec_size() == num_cols &&
+        (tmp[4].num_vecs() == 0 || (tmp[4].num_vecs() == num_rows && tmp[4].vec_size() == num_rows));
+
+    if(hit)
+    {
+        pinv_AT.use_memory(tmp[0]);
+        left_null_space.use_memory(tmp[1]);
+        right_null_space.use_memory(tmp[2]);
+        B1TB1.use_memory(tmp[3]);
+        B2TB2.use_memory(tmp[4]);
+    }
+
+    return hit;
+}
+
+// -----------------------------------------------------------------------------
+
+// Failing to store is not an error of the approximation, so this only returns
+// whether the file was written.
+template<typename index_type, typename value_type>
+bool ssa_pinv_cache_store(
+    const std::string& file_name,
+    const unsigned long long key[2],
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    const dense_vectors<index_type, value_type>& B1TB1,
+    const dense_vectors<index_type, value_type>& B2TB2)
+{
+    const dense_vectors<index_type, value_type>* matrices[ssa_pinv_cache_num_matrices] =
+        {&pinv_AT, &left_null_space, &right_null_space, &B1TB1, &B2TB2};
+
+    // Unique among the threads (stack address) and the processes (id) writing
+    // the same file.  The time makes a clash between hosts that share the file
+    // system unlikely.
+#ifdef _WIN32
+    const unsigned long pid = static_cast<unsigned long>(_getpid());
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+
+    char suffix[96];
+    std::sprintf(suffix, ".%lu.%p.%lx.tmp",
+        pid, static_cast<const void*>(&matrices), static_cast<unsigned long>(std::time(0)));
+
+    const std::string tmp_file_name = file_name + suffix;
+
+    bool success = dense_vectors_file_write(
+        tmp_file_name.c_str(), key, ssa_pinv_cache_num_matrices, matrices);
+
+    // On some platforms rename does not replace an existing file, and then
+    // another writer has already stored the same contents.
+    success = success &&
+        std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+
+    if(!success)
+        std::remove(tmp_file_name.c_str());
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+#endif // SSA_PINV_CACHE_H
@@ -54,16 +54,27 @@ http://www.txcorp.com
 #include "txssa.h"
 #include "sparse_spectral_approximation/ssa_matrix_type.h"
 #include "sparse_spectral_approximation/ssa_matrix_type_pinv_transpose.h"
+#include "sparse_spectral_approximation/ssa_pinv_cache.h"
+#include "dense_matrix_pinv/dense_matrix_circulant_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_pinv_update.h"
 #include "sparse_spectral_approximation/sparse_spectral_minimization.h"
 #include "sparse_spectral_approximation/sparse_spectral_misfit_lhs_matrices.h"
 #include "sparse_spectral_approximation/sparse_spectral_binning.h"
 #include "sparse_vectors/sparse_vectors.h"
+#include "sparse_vectors/sparse_vectors_file.h"
 #include "p_norm_sparsity_matrix/p_norm_sparsity_dense_matrix.h"
+#include "p_norm_sparsity_matrix/p_norm_sparsity_sparse_matrix.h"
 #include "dense_algorithms/dense_matrix_utils.h"
+#include "dense_algorithms/dense_matrix_components.h"
 #include "dense_vectors/dense_vectors.h"
+#include "dense_vectors/dense_vectors_utils.h"
 #include "math/precision_traits.h"
+#include "platform/wall_timer.h"
 #include "internal_api_error/internal_api_error.h"
-#include <algorithm> // std::copy
+#include <algorithm> // std::{copy, sort, max}
+#include <cstddef>
+#include <cmath>
+#include <limits>
 #include <vector>
 #include <stdexcept>
 #include <complex>
@@ -104,6 +115,143 @@ void delete_catch(T* ptr, const char* func_name)
 
 // -----------------------------------------------------------------------------
 
+// Automatic choice of the number of bins.  See ssa_options::tune_num_bins.
+struct ssa_bin_tuning
+{
+    double tolerance;
+    double time_budget;
+    ssa_tune_report* report;  // Not filled if 0.
+};
+
+// -----------------------------------------------------------------------------
+
+// Totals over null_space_impose calls.  See ssa_options::null_space_report.
+struct ssa_null_space_stats
+{
+    ssa_null_space_stats()
+        :
+        num_imposed(0),
+        num_direct(0),
+        num_not_converged(0),
+        total_iterations(0),
+        max_iterations(0),
+        max_residual_ratio(0)
+    {
+    }
+
+    void add(const null_space_impose_stats& stats)
+    {
+        ++num_imposed;
+
+        if(stats.direct)
+            ++num_direct;
+
+        if(!stats.converged)
+            ++num_not_converged;
+
+        total_iterations += stats.num_iters;
+        max_iterations = std::max(max_iterations, stats.num_iters);
+
+        if(0 < stats.sqtol)
+            max_residual_ratio = std::max(max_residual_ratio,
+                std::sqrt(stats.resid_norm_sq / stats.sqtol));
+    }
+
+    void add(const ssa_null_space_stats& other)
+    {
+        num_imposed        += other.num_imposed;
+        num_direct         += other.num_direct;
+        num_not_converged  += other.num_not_converged;
+        total_iterations   += other.total_iterations;
+        max_iterations      = std::max(max_iterations, other.max_iterations);
+        max_residual_ratio  = std::max(max_residual_ratio, other.max_residual_ratio);
+    }
+
+    std::size_t num_imposed;
+    std::size_t num_direct;
+    std::size_t num_not_converged;
+    std::size_t total_iterations;
+    std::size_t max_iterations;
+    double      max_residual_ratio;
+};
+
+// -----------------------------------------------------------------------------
+
+// Data behind the reserved pointer of ssa_*_plan.  See ssa_*_plan_create.  The
+// null spaces are always kept, since updates need them, but they are used for
+// the approximation only if impose_null_spaces.  B2TB2 is empty for normal
+// matrix types, as in ssa_misfit_grams.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+struct ssa_plan_data
+{
+    ssa_plan_data()
+        :
+        num_rows(0),
+        num_cols(0),
+        matrix_type(ssa_matrix_type_general),
+        impose_null_spaces(false),
+        randomized(false),
+        num_updates_in_row(0)
+    {
+    }
+
+    index_type num_rows;
+    index_type num_cols;
+    ssa_matrix_type matrix_type;
+    bool impose_null_spaces;
+    bool randomized;
+    dense_matrix_randomized_pinv_params pinv_params;
+
+    // Updates since the last recomputation.
+    std::size_t num_updates_in_row;
+
+    dense_vectors<index_type, value_type> A;
+    dense_vectors<index_type, value_type> pinv_AT;
+    dense_vectors<index_type, value_type> left_null_space;
+    dense_vectors<index_type, value_type> right_null_space;
+    dense_vectors<index_type, value_type> B1TB1;
+    dense_vectors<index_type, value_type> B2TB2;
+
+    // Lagrange multipliers of the last null space imposition, to start the
+    // next one from.  Consecutive matrices of a plan are usually close.
+    null_space_impose_warm_start<index_type, value_type> null_space_warm_start;
+};
+
+// After this many updates in a row, a plan is recomputed anyway, so that
+// rounding errors of the updates do not accumulate.
+const std::size_t ssa_plan_max_updates_in_row = 32; // MAGIC CONSTANT
+
+// -----------------------------------------------------------------------------
+
+matrix_binning_method ssa_binning_method_to_internal(int method)
+{
+    matrix_binning_method ans = matrix_binning_method_uniform;
+
+    switch(method)
+    {
+    case ssa_binning_method_uniform:
+        ans = matrix_binning_method_uniform;
+        break;
+    case ssa_binning_method_quantile:
+        ans = matrix_binning_method_quantile;
+        break;
+    case ssa_binning_method_kmeans:
+        ans = matrix_binning_method_kmeans;
+        break;
+    default:
+        assert(false);
+    }
+
+    return ans;
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename index_type, typename value_type>
 bool ssa_matrix_type_compute_AAT_from_ATA(
     index_type  size,
@@ -136,6 +284,59 @@ bool ssa_matrix_type_compute_AAT_from_ATA(
 
 // -----------------------------------------------------------------------------
 
+// Same as sparse_spectral_misfit_lhs_matrices, but uses the structure of A
+// given by the matrix type when possible.
+template<typename index_type, typename value_type>
+bool ssa_matrix_type_misfit_lhs_matrices(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* A_col_values,
+    index_type A_col_leading_dim,
+    value_type* AAT_col_values,
+    index_type  AAT_col_leading_dim,
+    value_type* ATA_col_values,
+    index_type  ATA_col_leading_dim,
+    ssa_matrix_type type)
+{
+    const int is_circulant      = ssa_matrix_type_is_circulant(type);
+    const int is_skew_circulant = ssa_matrix_type_is_skew_circulant(type);
+
+    bool success = false;
+
+    if((is_circulant || is_skew_circulant) && num_rows == num_cols)
+    {
+        // A is normal, so AAT == ATA.  Both are of the same kind as A.
+
+        success =
+            (!ATA_col_values || dense_matrix_circulant_ATA(
+                num_cols, A_col_values, is_skew_circulant != 0,
+                ATA_col_values, ATA_col_leading_dim))
+            &&
+            (!AAT_col_values || dense_matrix_circulant_ATA(
+                num_rows, A_col_values, is_skew_circulant != 0,
+                AAT_col_values, AAT_col_leading_dim));
+    }
+    else
+    {
+        success = sparse_spectral_misfit_lhs_matrices(
+            num_rows, num_cols,
+            A_col_values, A_col_leading_dim,
+            AAT_col_values, AAT_col_leading_dim,
+            ATA_col_values, ATA_col_leading_dim);
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_matrix_type_misfit_lhs_matrices: Error");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename index_type, typename value_type>
 void ssa_B2TB2_chooser(
     const dense_vectors<index_type, value_type>& B1TB1,
@@ -184,14 +385,120 @@ void ssa_B2TB2_chooser(
 
 // -----------------------------------------------------------------------------
 
-// User-given parameters for computing L_p norm based pattern.
+// The relation between left and right null spaces that null_space_impose can
+// use for a matrix type.
+
+inline null_space_impose_structure ssa_null_space_impose_structure(
+    ssa_matrix_type matrix_type)
+{
+    if(ssa_matrix_type_is_hermitian(matrix_type))
+        return null_space_impose_hermitian;
+
+    if(matrix_type == ssa_matrix_type_skew_hermitian)
+        return null_space_impose_skew_hermitian;
+
+    if(matrix_type == ssa_matrix_type_complex_symmetric)
+        return null_space_impose_symmetric;
+
+    return null_space_impose_general;
+}
+
+// -----------------------------------------------------------------------------
+
+// Declarations.  Definitions are below, after the *_internal functions that
+// use them.  Needed for two-phase name lookup in conforming compilers.
+
 template
 <
     typename index_type,
     typename offset_type,
     typename value_type
 >
-bool ssa_lpn_internal(
+bool ssa_internal(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* col_values,
+    index_type col_leading_dim,
+    const offset_type* row_offsets,
+    const index_type* column_ids,
+    const value_type* pattern_values,
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    const ssa_bin_tuning* tuning,
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    ssa_matrix_type matrix_type,
+    value_type* out_row_values);
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_internal_grams(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* col_values,
+    index_type col_leading_dim,
+    const offset_type* row_offsets,
+    const index_type* column_ids,
+    const value_type* pattern_values,
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    const ssa_bin_tuning* tuning,
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    null_space_impose_warm_start<index_type, value_type>* null_space_warm_start,
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    const dense_vectors<index_type, value_type>& B1TB1,
+    const dense_vectors<index_type, value_type>& B2TB2,
+    ssa_matrix_type matrix_type,
+    value_type* out_row_values);
+
+template
+<
+    typename index_type,
+    typename value_type
+>
+bool ssa_misfit_grams(
+    index_type num_rows,
+    index_type num_cols,
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    ssa_matrix_type matrix_type,
+    dense_vectors<index_type, value_type>& B1TB1,
+    dense_vectors<index_type, value_type>& B2TB2);
+
+template
+<
+    typename index_type,
+    typename scalar_type
+>
+bool ssa_misfit_grams(
+    index_type num_rows,
+    index_type num_cols,
+    const dense_vectors<index_type, std::complex<scalar_type> >& pinv_AT,
+    ssa_matrix_type matrix_type,
+    dense_vectors<index_type, std::complex<scalar_type> >& B1TB1,
+    dense_vectors<index_type, std::complex<scalar_type> >& B2TB2);
+
+// -----------------------------------------------------------------------------
+
+// Compute the L_p norm based pattern and the values of the approximation in
+// out_mat.  Does not clear the error stack, so that it can be used for parts of
+// a matrix too.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_lpn_compute(
     index_type           num_rows,
     index_type           num_cols,
     const value_type*    col_values,
@@ -199,31 +506,20 @@ bool ssa_lpn_internal(
     typename precision_traits<value_type>::scalar sparsity_ratio,
     typename precision_traits<value_type>::scalar sparsity_norm_p,
     offset_type          max_num_bins,
+    matrix_binning_method binning_method,
+    const ssa_bin_tuning* tuning,
     bool                 impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    const dense_matrix_randomized_pinv_params* pinv_params,
+    const char*          cache_directory,
     enum ssa_matrix_type matrix_type,
-    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+    ssa_plan_data<index_type, offset_type, value_type>* plan,
+    sparse_vectors<index_type, offset_type, value_type>& out_mat)
 {
-    ssa_error_clear();
-
     const int is_abs_sym = ssa_matrix_type_is_abs_sym(matrix_type);
 
-    bool success =
-        ssa_matrix_type_undefined < matrix_type &&
-        matrix_type < ssa_matrix_type_num_types &&
-        (num_rows == num_cols || !is_abs_sym) &&
-        col_values;
-
-    if(!success)
-    {
-        assert(false);
-
-        internal_api_error_set_last(
-            "ssa_lpn_internal: Unacceptable input argument(s).");
-
-        return false;
-    }
-
     dense_vectors<index_type, value_type> pinv_AT, left_null_space, right_null_space;
+    dense_vectors<index_type, value_type> B1TB1, B2TB2;
 
     dense_vectors<index_type, value_type>* left_null_space_ptr = 0;
     dense_vectors<index_type, value_type>* right_null_space_ptr = 0;
@@ -234,20 +530,95 @@ bool ssa_lpn_internal(
         right_null_space_ptr = &right_null_space;
     }
 
-    success =
-        pinv_AT.allocate(
-            num_cols, num_rows)
-        &&
-        dense_vectors_utils_copy(
-            num_cols, num_rows,
+    // See ssa_options::cache_directory.  On a hit, the matrices above use
+    // memory of cache_view.  With a plan, they use memory of the plan, and the
+    // cache is not used.
+
+    const bool use_cache = cache_directory && !plan && num_rows && num_cols;
+
+    dense_vectors_file_view<index_type, value_type> cache_view;
+    unsigned long long cache_key[2] = {0, 0};
+    std::string cache_file_name;
+    bool cache_hit = false;
+
+    if(use_cache)
+    {
+        ssa_pinv_cache_key(
+            num_rows, num_cols,
             col_values, col_leading_dim,
-            pinv_AT.vec_values(), pinv_AT.leading_dimension())
-        &&
-        ssa_matrix_type_pinv_transpose(
+            matrix_type,
+            impose_null_spaces,
+            pinv_params,
+            cache_key);
+
+        try
+        {
+            cache_file_name = ssa_pinv_cache_file_name(cache_directory, cache_key);
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("ssa_lpn_compute: Exception. ") + exc.what()));
+
+            return false;
+        }
+
+        cache_hit = ssa_pinv_cache_load(
+            cache_file_name, cache_key,
             num_rows, num_cols,
-            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            cache_view,
+            pinv_AT, left_null_space, right_null_space,
+            B1TB1, B2TB2);
+    }
+
+    bool success = cache_hit;
+
+    if(plan)
+    {
+        success =
+            pinv_AT.use_memory(plan->pinv_AT) &&
+            B1TB1.use_memory(plan->B1TB1) &&
+            (!plan->B2TB2.vec_values() || B2TB2.use_memory(plan->B2TB2)) &&
+            (!impose_null_spaces || (
+                left_null_space.use_memory(plan->left_null_space) &&
+                right_null_space.use_memory(plan->right_null_space)));
+    }
+    else if(!cache_hit)
+    {
+        success =
+            pinv_AT.allocate(
+                num_cols, num_rows)
+            &&
+            dense_vectors_utils_copy(
+                num_cols, num_rows,
+                col_values, col_leading_dim,
+                pinv_AT.vec_values(), pinv_AT.leading_dimension())
+            &&
+            ssa_matrix_type_pinv_transpose(
+                num_rows, num_cols,
+                pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+                matrix_type,
+                left_null_space_ptr, right_null_space_ptr,
+                pinv_params);
+    }
+
+    if(success && use_cache && !cache_hit)
+    {
+        success = ssa_misfit_grams(
+            num_rows, num_cols,
+            pinv_AT,
             matrix_type,
-            left_null_space_ptr, right_null_space_ptr);
+            B1TB1, B2TB2);
+
+        // A cache that cannot be written only costs time later.
+        if(success)
+            ssa_pinv_cache_store(
+                cache_file_name, cache_key,
+                pinv_AT, left_null_space, right_null_space,
+                B1TB1, B2TB2);
+    }
 
     if(success)
     {
@@ -269,7 +640,7 @@ bool ssa_lpn_internal(
                 assert(false);
 
                 internal_api_error_set_last(
-                    "ssa_lpn_internal: Left and right nullity should be equal"
+                    "ssa_lpn_compute: Left and right nullity should be equal"
                     " because of matrix type, but not computed to be equal.");
 
                 return false;
@@ -299,27 +670,14 @@ bool ssa_lpn_internal(
             for(index_type row = 0; row < num_rows; ++row)
                 size_per_row[row] = index_type(row_oriented_sparse_pat[row].size());
 
-            sparse_vectors<index_type, offset_type, value_type>* out_mat_ptr =
-                new (std::nothrow) sparse_vectors<index_type, offset_type, value_type>();
-
-            if(!out_mat_ptr)
-            {
-                assert(false);
-
-                internal_api_error_set_last(
-                    "ssa_lpn_internal: Error in allocating matrix.");
-
-                return false;
-            }
-
 			if(num_rows > 0)
 			{
-				success = out_mat_ptr->allocate(num_rows, num_cols, &size_per_row.front());
+				success = out_mat.allocate(num_rows, num_cols, &size_per_row.front());
 			}
 			else
 			{
 				index_type tmp_size_per_row = 0;
-				success = out_mat_ptr->allocate(num_rows, num_cols, &tmp_size_per_row);
+				success = out_mat.allocate(num_rows, num_cols, &tmp_size_per_row);
 			}
 
             if(success)
@@ -328,26 +686,45 @@ bool ssa_lpn_internal(
                     std::copy(
                         row_oriented_sparse_pat[row].begin(),
                         row_oriented_sparse_pat[row].end(),
-                        out_mat_ptr->vec_ids_begin(row));
-
-                success =
-                    ssa_internal(
-                        num_rows, num_cols,
-                        col_values, col_leading_dim,
-                        out_mat_ptr->vec_offsets(),
-                        out_mat_ptr->vec_ids(),
-                        max_num_bins,
-                        impose_null_spaces,
-                        pinv_AT, left_null_space, right_null_space,
-                        matrix_type,
-                        out_mat_ptr->vec_values());
-
-                if(success)
+                        out_mat.vec_ids_begin(row));
+
+                if(use_cache || plan)
+                {
+                    success =
+                        ssa_internal_grams(
+                            num_rows, num_cols,
+                            col_values, col_leading_dim,
+                            out_mat.vec_offsets(),
+                            out_mat.vec_ids(),
+                            static_cast<const value_type*>(0),
+                            max_num_bins,
+                            binning_method,
+                            tuning,
+                            impose_null_spaces,
+                            null_space_stats,
+                            plan ? &plan->null_space_warm_start : 0,
+                            pinv_AT, left_null_space, right_null_space,
+                            B1TB1, B2TB2,
+                            matrix_type,
+                            out_mat.vec_values());
+                }
+                else
                 {
-                    out_matrix.row_offsets = out_mat_ptr->vec_offsets();
-                    out_matrix.column_ids  = out_mat_ptr->vec_ids();
-                    out_matrix.values      = out_mat_ptr->vec_values();
-                    out_matrix.reserved    = out_mat_ptr;
+                    success =
+                        ssa_internal(
+                            num_rows, num_cols,
+                            col_values, col_leading_dim,
+                            out_mat.vec_offsets(),
+                            out_mat.vec_ids(),
+                            static_cast<const value_type*>(0),
+                            max_num_bins,
+                            binning_method,
+                            tuning,
+                            impose_null_spaces,
+                            null_space_stats,
+                            pinv_AT, left_null_space, right_null_space,
+                            matrix_type,
+                            out_mat.vec_values());
                 }
             }
         }
@@ -357,7 +734,7 @@ bool ssa_lpn_internal(
     {
         assert(false);
         internal_api_error_set_last(
-            "ssa_lpn_internal: Error");
+            "ssa_lpn_compute: Error");
     }
 
     return success;
@@ -365,250 +742,476 @@ bool ssa_lpn_internal(
 
 // -----------------------------------------------------------------------------
 
+// For ordering blocks by decreasing size, so that large blocks are started
+// first in the parallel loop.
+
+template<typename index_type>
+class ssa_lpn_blocks_larger
+{
+public:
+
+    ssa_lpn_blocks_larger(
+        const std::vector< std::vector<index_type> >& in_block_rows,
+        const std::vector< std::vector<index_type> >& in_block_cols)
+        :
+        block_rows(in_block_rows),
+        block_cols(in_block_cols)
+    {
+    }
+
+    bool operator()(index_type i, index_type j) const
+    {
+        return
+            double(block_rows[i].size()) * double(block_cols[i].size()) >
+            double(block_rows[j].size()) * double(block_cols[j].size());
+    }
+
+private:
+
+    const std::vector< std::vector<index_type> >& block_rows;
+    const std::vector< std::vector<index_type> >& block_cols;
+
+    ssa_lpn_blocks_larger& operator=(const ssa_lpn_blocks_larger&);
+};
+
+// Same as ssa_lpn_compute, but each independent block of the matrix is
+// approximated separately.  See ssa_options::decompose_blocks.
 template
 <
     typename index_type,
     typename offset_type,
     typename value_type
 >
-bool ssa_ids_internal(
+bool ssa_lpn_blocks(
     index_type           num_rows,
     index_type           num_cols,
     const value_type*    col_values,
     index_type           col_leading_dim,
     typename precision_traits<value_type>::scalar sparsity_ratio,
     typename precision_traits<value_type>::scalar sparsity_norm_p,
-    index_type           min_num_nnz_per_row,
-    index_type           min_num_nnz_per_col,
+    offset_type          max_num_bins,
+    matrix_binning_method binning_method,
+    const ssa_bin_tuning* tuning,
+    bool                 impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    const dense_matrix_randomized_pinv_params* pinv_params,
+    const char*          cache_directory,
     enum ssa_matrix_type matrix_type,
-    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+    typename precision_traits<value_type>::scalar block_tolerance,
+    sparse_vectors<index_type, offset_type, value_type>& out_mat)
 {
-    ssa_error_clear();
-
-    const int is_abs_sym = ssa_matrix_type_is_abs_sym(matrix_type);
-
-    bool success =
-        ssa_matrix_type_undefined < matrix_type &&
-        matrix_type < ssa_matrix_type_num_types &&
-        (num_rows == num_cols || !is_abs_sym) &&
-        (min_num_nnz_per_row == min_num_nnz_per_col || !is_abs_sym) &&
-        col_values;
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+    typedef sparse_vectors<index_type, offset_type, value_type> block_type;
 
-    if(!success)
+    if(num_rows == 0 || num_cols == 0)
     {
-        assert(false);
-
-        internal_api_error_set_last(
-            "ssa_ids_internal: Unacceptable input argument(s).");
+        return ssa_lpn_compute(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            sparsity_ratio, sparsity_norm_p,
+            max_num_bins,
+            binning_method,
+            tuning,
+            impose_null_spaces,
+            null_space_stats,
+            pinv_params,
+            cache_directory,
+            matrix_type,
+            static_cast<ssa_plan_data<index_type, offset_type, value_type>*>(0),
+            out_mat);
+    }
 
-        return false;
+    const bool is_abs_sym = ssa_matrix_type_is_abs_sym(matrix_type) != 0;
+
+    scalar_type max_abs_val = 0;
+
+    for(index_type j = 0; j < num_cols; ++j)
+    {
+        const value_type* A_j = col_values + std::size_t(j) * std::size_t(col_leading_dim);
+
+        for(index_type i = 0; i < num_rows; ++i)
+            max_abs_val = std::max(max_abs_val, scalar_type(std::abs(A_j[i])));
     }
 
-    std::vector< std::vector<index_type> > row_oriented_sparse_pat;
+    std::vector<index_type> row_component, col_component, order;
+    std::vector< std::vector<index_type> > block_rows, block_cols;
+    index_type num_blocks = 0;
 
-    if(is_abs_sym)
+    bool success = true;
+
+    try
     {
-        success = p_norm_sparsity_dense_matrix_abs_sym(
-            sparsity_ratio, sparsity_norm_p,
-            min_num_nnz_per_row,
-            num_rows,
+        row_component.resize(num_rows);
+        col_component.resize(num_cols);
+
+        success = dense_matrix_components(
+            num_rows, num_cols,
             col_values, col_leading_dim,
-            row_oriented_sparse_pat);
+            block_tolerance * max_abs_val,
+            is_abs_sym,
+            &row_component.front(), &col_component.front(),
+            num_blocks);
+
+        if(success)
+        {
+            block_rows.resize(num_blocks);
+            block_cols.resize(num_blocks);
+            order.resize(num_blocks);
+
+            for(index_type i = 0; i < num_rows; ++i)
+                block_rows[row_component[i]].push_back(i);
+
+            for(index_type j = 0; j < num_cols; ++j)
+                block_cols[col_component[j]].push_back(j);
+        }
     }
-    else
+    catch(const std::exception& exc)
     {
-        success = p_norm_sparsity_dense_matrix_col_oriented(
-            sparsity_ratio, sparsity_norm_p,
-            min_num_nnz_per_row, min_num_nnz_per_col,
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("ssa_lpn_blocks: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_lpn_blocks: Error.");
+        return false;
+    }
+
+    if(num_blocks == 1)
+    {
+        return ssa_lpn_compute(
             num_rows, num_cols,
             col_values, col_leading_dim,
-            row_oriented_sparse_pat);
+            sparsity_ratio, sparsity_norm_p,
+            max_num_bins,
+            binning_method,
+            tuning,
+            impose_null_spaces,
+            null_space_stats,
+            pinv_params,
+            cache_directory,
+            matrix_type,
+            static_cast<ssa_plan_data<index_type, offset_type, value_type>*>(0),
+            out_mat);
     }
 
-    if(success)
+    for(index_type k = 0; k < num_blocks; ++k)
+        order[k] = k;
+
+    std::sort(order.begin(), order.end(),
+        ssa_lpn_blocks_larger<index_type>(block_rows, block_cols));
+
+    dense_vectors<index_type, block_type> blocks;
+
+    success = blocks.allocate(num_blocks, 1);
+
+    if(!success)
     {
-        std::vector<index_type> size_per_row(num_rows);
+        assert(false);
+        internal_api_error_set_last("ssa_lpn_blocks: Error in allocating blocks.");
+        return false;
+    }
 
-        for(index_type row = 0; row < num_rows; ++row)
-            size_per_row[row] = index_type(row_oriented_sparse_pat[row].size());
+    // Blocks are independent, and each one has its own pinv, pattern, and
+    // bins.  A block with no rows or no columns has nothing to approximate.
 
-        sparse_vectors<index_type, offset_type, value_type>* out_mat_ptr =
-            new (std::nothrow) sparse_vectors<index_type, offset_type, value_type>();
+    int num_failed = 0;
 
-        if(!out_mat_ptr)
+    const std::ptrdiff_t num_blocks_signed = std::ptrdiff_t(num_blocks);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_failed)
+#endif
+    for(std::ptrdiff_t kk = 0; kk < num_blocks_signed; ++kk)
+    {
+        const index_type k = order[std::size_t(kk)];
+
+        const std::vector<index_type>& rows = block_rows[k];
+        const std::vector<index_type>& cols = block_cols[k];
+
+        if(rows.empty() || cols.empty())
+            continue;
+
+        const index_type block_num_rows = index_type(rows.size());
+        const index_type block_num_cols = index_type(cols.size());
+
+        dense_vectors<index_type, value_type> block_A;
+        ssa_null_space_stats block_null_space_stats;
+
+        bool block_success = block_A.allocate(block_num_cols, block_num_rows);
+
+        if(block_success)
         {
-            assert(false);
+            for(index_type j = 0; j < block_num_cols; ++j)
+            {
+                const value_type* A_j = col_values +
+                    std::size_t(cols[j]) * std::size_t(col_leading_dim);
 
-            internal_api_error_set_last(
-                "ssa_ids_internal: Error in allocating matrix.");
+                value_type* block_A_j = block_A.vec_values() +
+                    std::size_t(j) * std::size_t(block_A.leading_dimension());
 
-            return false;
+                for(index_type i = 0; i < block_num_rows; ++i)
+                    block_A_j[i] = A_j[rows[i]];
+            }
+
+            block_success = ssa_lpn_compute(
+                block_num_rows, block_num_cols,
+                block_A.vec_values(), block_A.leading_dimension(),
+                sparsity_ratio, sparsity_norm_p,
+                max_num_bins,
+                binning_method,
+                tuning,
+                impose_null_spaces,
+                null_space_stats ? &block_null_space_stats : 0,
+                pinv_params,
+                cache_directory,
+                matrix_type,
+                static_cast<ssa_plan_data<index_type, offset_type, value_type>*>(0),
+                blocks.vec_values()[k]);
+
+            if(block_success && null_space_stats)
+            {
+#ifdef _OPENMP
+#pragma omp critical(ssa_lpn_blocks_null_space_stats)
+#endif
+                null_space_stats->add(block_null_space_stats);
+            }
         }
 
-        success = out_mat_ptr->allocate(num_rows, num_cols, &size_per_row.front());
+        if(!block_success)
+            ++num_failed;
+    }
 
-        if(success)
-        {
-            for(index_type row = 0; row < num_rows; ++row)
-                std::copy(
-                    row_oriented_sparse_pat[row].begin(),
-                    row_oriented_sparse_pat[row].end(),
-                    out_mat_ptr->vec_ids_begin(row));
+    if(num_failed)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_lpn_blocks: Error in approximating a block.");
+        return false;
+    }
 
-            out_matrix.row_offsets = out_mat_ptr->vec_offsets();
-            out_matrix.column_ids  = out_mat_ptr->vec_ids();
-            out_matrix.values      = out_mat_ptr->vec_values();
-            out_matrix.reserved    = out_mat_ptr;
+    // Stitch blocks together.  Column ids stay sorted in a row because the
+    // columns of a block are in increasing order.
+
+    std::vector<index_type> size_per_row(num_rows, 0);
+
+    for(index_type k = 0; k < num_blocks; ++k)
+    {
+        const std::vector<index_type>& rows = block_rows[k];
+
+        if(!rows.empty() && !block_cols[k].empty())
+        {
+            for(std::size_t i = 0; i < rows.size(); ++i)
+                size_per_row[rows[i]] = blocks.vec_values()[k].num_vec_entries(index_type(i));
         }
     }
 
+    success = out_mat.allocate(num_rows, num_cols, &size_per_row.front());
+
     if(!success)
     {
         assert(false);
-        internal_api_error_set_last(
-            "ssa_ids_internal: Error");
+        internal_api_error_set_last("ssa_lpn_blocks: Error in allocating matrix.");
+        return false;
     }
 
-    return success;
+    for(index_type k = 0; k < num_blocks; ++k)
+    {
+        const std::vector<index_type>& rows = block_rows[k];
+        const std::vector<index_type>& cols = block_cols[k];
+
+        if(rows.empty() || cols.empty())
+            continue;
+
+        const block_type& block = blocks.vec_values()[k];
+
+        for(std::size_t i = 0; i < rows.size(); ++i)
+        {
+            const index_type  block_row   = index_type(i);
+            const index_type  num_entries = block.num_vec_entries(block_row);
+            const index_type* block_ids   = block.vec_ids_begin(block_row);
+
+            index_type* ids = out_mat.vec_ids_begin(rows[i]);
+
+            for(index_type e = 0; e < num_entries; ++e)
+                ids[e] = cols[block_ids[e]];
+
+            std::copy(
+                block.vec_values_begin(block_row),
+                block.vec_values_begin(block_row) + num_entries,
+                out_mat.vec_values_begin(rows[i]));
+        }
+    }
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------
 
-// For real matrices
+// User-given parameters for computing L_p norm based pattern.  With a plan,
+// col_values must be its matrix, and the pinv options, decompose_blocks, and
+// cache_directory are not used.
 template
 <
     typename index_type,
     typename offset_type,
     typename value_type
 >
-bool ssa_internal(
-    index_type num_rows,
-    index_type num_cols,
-    const value_type* col_values,      // num_rows x num_cols
-    index_type col_leading_dim,
-    const offset_type* row_offsets,    // num_rows + 1
-    const index_type* column_ids,      // row_offsets[num_rows]
-    offset_type max_num_bins,
-    bool impose_null_spaces,
-    const dense_vectors<index_type, value_type>& pinv_AT,
-    const dense_vectors<index_type, value_type>& left_null_space,
-    const dense_vectors<index_type, value_type>& right_null_space,
-    ssa_matrix_type matrix_type,
-    value_type* out_row_values)  // row_offsets[num_rows]
+bool ssa_lpn_internal(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    typename precision_traits<value_type>::scalar sparsity_ratio,
+    typename precision_traits<value_type>::scalar sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    const ssa_options&   options,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix,
+    ssa_plan_data<index_type, offset_type, value_type>* plan = 0)
 {
-    const int is_square = (num_rows == num_cols);
-    const int is_hermitian = ssa_matrix_type_is_hermitian(matrix_type);
-    const int is_normal    = ssa_matrix_type_is_normal(matrix_type);
+    ssa_error_clear();
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const int is_abs_sym = ssa_matrix_type_is_abs_sym(matrix_type);
 
     bool success =
-        !(
-            is_hermitian ||
-            is_normal
-        ) ||
-        is_square;
+        ssa_matrix_type_undefined < matrix_type &&
+        matrix_type < ssa_matrix_type_num_types &&
+        (num_rows == num_cols || !is_abs_sym) &&
+        col_values &&
+        0 <= options.block_tolerance &&
+        options.block_tolerance < 1 &&
+        ssa_binning_method_uniform <= options.binning_method &&
+        options.binning_method < ssa_binning_method_num_methods &&
+        0 <= options.tune_tolerance &&
+        (!options.tune_num_bins || 1 < max_num_bins) &&
+        ssa_pinv_method_qr <= options.pinv_method &&
+        options.pinv_method < ssa_pinv_method_num_methods &&
+        0 <= options.pinv_rank_tolerance &&
+        options.pinv_rank_tolerance < 1 &&
+        0 < options.pinv_oversampling;
 
     if(!success)
     {
         assert(false);
 
         internal_api_error_set_last(
-            "ssa_internal: Unacceptable input argument(s) in real version.");
+            "ssa_lpn_internal: Unacceptable input argument(s).");
 
         return false;
     }
 
-    std::vector<offset_type> row_bin_ids;
+    sparse_vectors<index_type, offset_type, value_type>* out_mat_ptr =
+        new (std::nothrow) sparse_vectors<index_type, offset_type, value_type>();
 
-    try
-    {
-        row_bin_ids.resize(row_offsets[num_rows]);
-    }
-    catch(const std::exception& exc)
+    if(!out_mat_ptr)
     {
         assert(false);
 
         internal_api_error_set_last(
-            (std::string("ssa_internal: Exception in the real version. ") + exc.what()));
+            "ssa_lpn_internal: Error in allocating matrix.");
 
         return false;
     }
 
-    dense_vectors<index_type, value_type> B1TB1, B2TB2;
-
-    offset_type actual_num_bins;
+    const matrix_binning_method binning_method =
+        ssa_binning_method_to_internal(options.binning_method);
 
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >
-        row_split_pattern, col_split_pattern;
+    // Each block is tuned separately, and then there is no single report.
+    ssa_bin_tuning tuning;
+    tuning.tolerance   = options.tune_tolerance;
+    tuning.time_budget = options.tune_time_budget;
+    tuning.report      = options.decompose_blocks ? 0 : options.tune_report;
 
-    success =
-        sparse_spectral_binning_row(
-            num_rows, num_cols,
-            col_values, col_leading_dim,
-            row_offsets, column_ids,
-            max_num_bins, actual_num_bins,
-            row_split_pattern,
-            row_bin_ids.size() ? &row_bin_ids.front() : 0)
-        &&
-        // If hermitian, don't have to compute col_split_pattern
-        (is_hermitian ? true : sparse_spectral_binning_to_col(
-            num_rows, num_cols,
-            row_offsets, column_ids,
-            row_bin_ids.size() ? &row_bin_ids.front() : 0,
-            actual_num_bins,
-            col_split_pattern))
-        &&
-        B1TB1.allocate(
-            num_cols, num_cols)
-        &&
-        // If normal, don't have to allocate or compute B2TB2
-        (is_normal ? true : B2TB2.allocate(
-            num_rows, num_rows))
-        &&
-        sparse_spectral_misfit_lhs_matrices(
-            num_rows,
-            num_cols,
-            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
-            B2TB2.vec_values(),   B2TB2.leading_dimension(),
-            B1TB1.vec_values(),   B1TB1.leading_dimension());
+    if(options.tune_report)
+    {
+        options.tune_report->chosen_num_bins = 0;
+        options.tune_report->num_tries = 0;
+    }
 
-    if(success)
+    if(options.null_space_report)
     {
-        const value_type* tmp_B2TB2_col_values = 0;
-        value_type mult_factor;
+        ssa_null_space_report empty_report = {0, 0, 0, 0, 0, 0, 0};
+        *options.null_space_report = empty_report;
+    }
 
-        const bool is_binned = max_num_bins != 0;
+    const ssa_bin_tuning* tuning_ptr = options.tune_num_bins ? &tuning : 0;
 
-        ssa_B2TB2_chooser<index_type, value_type>(
-            B1TB1,
-            B2TB2,
-            matrix_type,
-            is_binned,
-            tmp_B2TB2_col_values,
-            mult_factor);
+    ssa_null_space_stats null_space_stats;
+
+    dense_matrix_randomized_pinv_params pinv_params;
+    pinv_params.rank_tolerance = options.pinv_rank_tolerance;
+    pinv_params.oversampling   = std::size_t(options.pinv_oversampling);
 
-        success = sparse_spectral_minimization(
+    if(options.decompose_blocks && !plan)
+    {
+        success = ssa_lpn_blocks(
             num_rows, num_cols,
-            row_offsets, column_ids,
-            actual_num_bins,
-            row_bin_ids.size() ? &row_bin_ids.front() : 0,
-            row_split_pattern.vec_values(),
-            // If hermitian, reuse row_split_pattern as col_split_pattern
-            is_hermitian ? row_split_pattern.vec_values() : col_split_pattern.vec_values(),
+            col_values, col_leading_dim,
+            sparsity_ratio, sparsity_norm_p,
+            max_num_bins,
+            binning_method,
+            tuning_ptr,
             impose_null_spaces,
-            tmp_B2TB2_col_values, num_rows,
-            B1TB1.vec_values(), B1TB1.leading_dimension(),
-            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
-            left_null_space,
-            right_null_space,
-            out_row_values,
-            mult_factor);
+            options.null_space_report ? &null_space_stats : 0,
+            options.pinv_method == ssa_pinv_method_randomized ? &pinv_params : 0,
+            options.cache_directory,
+            matrix_type,
+            scalar_type(options.block_tolerance),
+            *out_mat_ptr);
+    }
+    else
+    {
+        success = ssa_lpn_compute(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            sparsity_ratio, sparsity_norm_p,
+            max_num_bins,
+            binning_method,
+            tuning_ptr,
+            impose_null_spaces,
+            options.null_space_report ? &null_space_stats : 0,
+            options.pinv_method == ssa_pinv_method_randomized ? &pinv_params : 0,
+            options.cache_directory,
+            matrix_type,
+            plan,
+            *out_mat_ptr);
     }
 
-    if(!success)
+    if(success && options.null_space_report)
+    {
+        ssa_null_space_report* report = options.null_space_report;
+
+        report->num_imposed        = int(null_space_stats.num_imposed);
+        report->num_direct         = int(null_space_stats.num_direct);
+        report->num_not_converged  = int(null_space_stats.num_not_converged);
+        report->total_iterations   = double(null_space_stats.total_iterations);
+        report->max_iterations     = int(null_space_stats.max_iterations);
+        report->iteration_limit    = int(null_space_impose_max_iters);
+        report->max_residual_ratio = null_space_stats.max_residual_ratio;
+    }
+
+    if(success)
+    {
+        out_matrix.row_offsets = out_mat_ptr->vec_offsets();
+        out_matrix.column_ids  = out_mat_ptr->vec_ids();
+        out_matrix.values      = out_mat_ptr->vec_values();
+        out_matrix.reserved    = out_mat_ptr;
+    }
+    else
     {
+        delete_catch(out_mat_ptr, "ssa_lpn_internal");
+
         assert(false);
         internal_api_error_set_last(
-            "ssa_internal: Error in real version.");
+            "ssa_lpn_internal: Error");
     }
 
     return success;
@@ -616,182 +1219,233 @@ bool ssa_internal(
 
 // -----------------------------------------------------------------------------
 
-// For complex matrices
+// User-given sparse matrix in CSR form and parameters for computing L_p norm
+// based pattern.  The pattern is a subset of the input pattern, and the
+// binning uses only the values at the pattern.  The matrix is made dense only
+// to compute its pseudo-inverse.
 template
 <
     typename index_type,
     typename offset_type,
-    typename scalar_type
+    typename value_type
 >
-bool ssa_internal(
-    index_type num_rows,
-    index_type num_cols,
-    const std::complex<scalar_type>* col_values,    // num_rows x num_cols
-    index_type col_leading_dim,
-    const offset_type* row_offsets,    // num_rows + 1
-    const index_type* column_ids,      // row_offsets[num_rows]
-    offset_type max_num_bins,
-    bool impose_null_spaces,
-    const dense_vectors<index_type, std::complex<scalar_type> >& pinv_AT,
-    const dense_vectors<index_type, std::complex<scalar_type> >& left_null_space,
-    const dense_vectors<index_type, std::complex<scalar_type> >& right_null_space,
-    ssa_matrix_type matrix_type,
-    std::complex<scalar_type>* out_row_values)  // row_offsets[num_rows]
+bool ssa_lpn_csr_internal(
+    index_type           num_rows,
+    index_type           num_cols,
+    const offset_type*   row_offsets,
+    const index_type*    column_ids,
+    const value_type*    values,
+    typename precision_traits<value_type>::scalar sparsity_ratio,
+    typename precision_traits<value_type>::scalar sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
 {
-    const int is_square = (num_rows == num_cols);
-    const int is_hermitian               = ssa_matrix_type_is_hermitian(matrix_type);
-    const int is_normal                  = ssa_matrix_type_is_normal(matrix_type);
-    const int is_real_part_symmetric     = ssa_matrix_type_is_real_part_symmetric(matrix_type);
-    const int is_imag_part_symmetric     = ssa_matrix_type_is_imag_part_symmetric(matrix_type);
-    const int is_AAT_computable_from_ATA = ssa_matrix_type_is_AAT_computable_from_ATA(matrix_type);
+    ssa_error_clear();
+
+    const int is_abs_sym = ssa_matrix_type_is_abs_sym(matrix_type);
 
     bool success =
-        !(
-            is_hermitian ||
-            is_normal ||
-            is_real_part_symmetric ||
-            is_imag_part_symmetric ||
-            is_AAT_computable_from_ATA
-        ) ||
-        is_square;
+        ssa_matrix_type_undefined < matrix_type &&
+        matrix_type < ssa_matrix_type_num_types &&
+        (num_rows == num_cols || !is_abs_sym) &&
+        row_offsets &&
+        column_ids &&
+        values &&
+        row_offsets[0] == 0;
 
-    if(!success)
+    // Offsets should be non-decreasing, and column ids in range and strictly
+    // increasing in each row.
+    for(index_type row = 0; success && row < num_rows; ++row)
     {
-        assert(false);
-
-        internal_api_error_set_last(
-            "ssa_internal: Unacceptable input argument(s) in complex version.");
+        success = row_offsets[row] <= row_offsets[row + 1];
 
-        return false;
+        for(offset_type j = row_offsets[row]; success && j < row_offsets[row + 1]; ++j)
+            success =
+                !(column_ids[j] < 0) &&
+                column_ids[j] < num_cols &&
+                (j == row_offsets[row] || column_ids[j - 1] < column_ids[j]);
     }
 
-    std::vector<offset_type> real_row_bin_ids, imag_row_bin_ids;
-
-    try
-    {
-        real_row_bin_ids.resize(row_offsets[num_rows]);
-        imag_row_bin_ids.resize(row_offsets[num_rows]);
-    }
-    catch(const std::exception& exc)
+    if(!success)
     {
         assert(false);
 
         internal_api_error_set_last(
-            (std::string("ssa_internal: Exception in complex version. ") + exc.what()));
+            "ssa_lpn_csr_internal: Unacceptable input argument(s).");
 
         return false;
     }
 
-    dense_vectors<index_type, std::complex<scalar_type> > B1TB1, B2TB2;
+    dense_vectors<index_type, value_type> pinv_AT, left_null_space, right_null_space;
 
-    offset_type real_actual_num_bins, imag_actual_num_bins;
+    dense_vectors<index_type, value_type>* left_null_space_ptr = 0;
+    dense_vectors<index_type, value_type>* right_null_space_ptr = 0;
 
-    dense_vectors<offset_type, sparse_vectors_ids<index_type, offset_type> >
-        real_row_split_pattern, real_col_split_pattern,
-        imag_row_split_pattern, imag_col_split_pattern;
+    if(impose_null_spaces)
+    {
+        left_null_space_ptr = &left_null_space;
+        right_null_space_ptr = &right_null_space;
+    }
 
     success =
-        sparse_spectral_binning_row(
-            num_rows, num_cols,
-            col_values, col_leading_dim,
-            row_offsets, column_ids,
-            max_num_bins,
-            real_actual_num_bins, imag_actual_num_bins,
-            real_row_split_pattern, imag_row_split_pattern,
-            real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
-            imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0)
-        &&
-        // If real part hermitian, don't have to compute real_col_split_pattern
-        (is_real_part_symmetric ? true : sparse_spectral_binning_to_col(
-            num_rows, num_cols,
-            row_offsets, column_ids,
-            real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
-            real_actual_num_bins,
-            real_col_split_pattern))
+        pinv_AT.allocate(
+            num_cols, num_rows)
         &&
-        // If imag part hermitian, don't have to compute imag_col_split_pattern
-        (is_imag_part_symmetric ? true : sparse_spectral_binning_to_col(
+        dense_vectors_utils_fill(
+            num_cols, num_rows,
+            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            value_type());
+
+    if(success)
+    {
+        value_type* A_values = pinv_AT.vec_values();
+        const std::size_t A_leading_dim = std::size_t(pinv_AT.leading_dimension());
+
+        for(index_type row = 0; row < num_rows; ++row)
+            for(offset_type j = row_offsets[row]; j < row_offsets[row + 1]; ++j)
+                A_values[std::size_t(column_ids[j]) * A_leading_dim + std::size_t(row)] = values[j];
+
+        success = ssa_matrix_type_pinv_transpose(
             num_rows, num_cols,
-            row_offsets, column_ids,
-            imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0,
-            imag_actual_num_bins,
-            imag_col_split_pattern))
-        &&
-        B1TB1.allocate(
-            num_cols, num_cols)
-        &&
-        // If normal, don't have to allocate or compute B2TB2
-        (is_normal ? true : B2TB2.allocate(
-            num_rows, num_rows));
+            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            matrix_type,
+            left_null_space_ptr, right_null_space_ptr);
+    }
+
+    sparse_vectors<index_type, offset_type, value_type>* out_mat_ptr = 0;
 
     if(success)
     {
-        if(is_AAT_computable_from_ATA)
+        const index_type min_num_nnz_per_row = right_null_space.num_vecs();
+        const index_type min_num_nnz_per_col = left_null_space.num_vecs();
+
+        std::vector< std::vector<index_type> > row_oriented_sparse_pat;
+
+        if(is_abs_sym)
         {
-            success =
-                sparse_spectral_misfit_lhs_matrices(
-                    num_rows,
-                    num_cols,
-                    pinv_AT.vec_values(), pinv_AT.leading_dimension(),
-                    reinterpret_cast<std::complex<scalar_type>*>(0), num_rows,
-                    B1TB1.vec_values(),   B1TB1.leading_dimension())
-                &&
-                ssa_matrix_type_compute_AAT_from_ATA(
-                    num_rows,
-                    B1TB1.vec_values(), B1TB1.leading_dimension(),
-                    B2TB2.vec_values(), B2TB2.leading_dimension(),
-                    matrix_type);
+            const int left_right_nullity_equal = ssa_matrix_type_is_left_right_nullity_equal(matrix_type);
+
+            if(left_right_nullity_equal && min_num_nnz_per_row != min_num_nnz_per_col)
+            {
+                assert(false);
+
+                internal_api_error_set_last(
+                    "ssa_lpn_csr_internal: Left and right nullity should be equal"
+                    " because of matrix type, but not computed to be equal.");
+
+                return false;
+            }
+
+            success = p_norm_sparsity_sparse_matrix_abs_sym(
+                sparsity_ratio, sparsity_norm_p,
+                min_num_nnz_per_row,
+                num_rows,
+                row_offsets, column_ids, values,
+                row_oriented_sparse_pat);
         }
         else
         {
-            success = sparse_spectral_misfit_lhs_matrices(
-                num_rows,
-                num_cols,
-                pinv_AT.vec_values(), pinv_AT.leading_dimension(),
-                B2TB2.vec_values(),   B2TB2.leading_dimension(),
-                B1TB1.vec_values(),   B1TB1.leading_dimension());
+            success = p_norm_sparsity_sparse_matrix_row_oriented(
+                sparsity_ratio, sparsity_norm_p,
+                min_num_nnz_per_row, min_num_nnz_per_col,
+                num_rows, num_cols,
+                row_offsets, column_ids, values,
+                row_oriented_sparse_pat);
         }
 
+        std::vector<index_type> size_per_row;
+        std::vector<value_type> pattern_values;
+
         if(success)
         {
-            const std::complex<scalar_type>* tmp_B2TB2_col_values = 0;
-            scalar_type mult_factor;
+            try
+            {
+                size_per_row.resize(std::size_t(num_rows) + 1);
 
-            const bool is_binned = max_num_bins != 0;
+                offset_type num_pattern_entries = 0;
 
-            ssa_B2TB2_chooser<index_type, std::complex<scalar_type> >(
-                B1TB1,
-                B2TB2,
-                matrix_type,
-                is_binned,
-                tmp_B2TB2_col_values,
-                mult_factor);
+                for(index_type row = 0; row < num_rows; ++row)
+                {
+                    size_per_row[row] = index_type(row_oriented_sparse_pat[row].size());
+                    num_pattern_entries += offset_type(size_per_row[row]);
+                }
 
-            success = sparse_spectral_minimization(
-                num_rows, num_cols,
-                row_offsets, column_ids,
-                real_actual_num_bins, imag_actual_num_bins,
-                real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
-                imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0,
-                real_row_split_pattern.vec_values(), imag_row_split_pattern.vec_values(),
-                is_real_part_symmetric ? real_row_split_pattern.vec_values() : real_col_split_pattern.vec_values(),
-                is_imag_part_symmetric ? imag_row_split_pattern.vec_values() : imag_col_split_pattern.vec_values(),
-                impose_null_spaces,
-                tmp_B2TB2_col_values, num_rows,
-                B1TB1.vec_values(), B1TB1.leading_dimension(),
-                pinv_AT.vec_values(), pinv_AT.leading_dimension(),
-                left_null_space,
-                right_null_space,
-                out_row_values,
-                mult_factor);
+                pattern_values.resize(num_pattern_entries);
+            }
+            catch(const std::exception& exc)
+            {
+                assert(false);
+
+                internal_api_error_set_last(
+                    (std::string("ssa_lpn_csr_internal: Exception. ") + exc.what()));
+
+                return false;
+            }
+
+            out_mat_ptr = new (std::nothrow) sparse_vectors<index_type, offset_type, value_type>();
+
+            success =
+                out_mat_ptr &&
+                out_mat_ptr->allocate(num_rows, num_cols, &size_per_row.front());
+        }
+
+        if(success)
+        {
+            // Pattern ids are relative to the ids of each input row.
+            for(index_type row = 0; row < num_rows; ++row)
+            {
+                const std::vector<index_type>& row_pat = row_oriented_sparse_pat[row];
+                const offset_type row_begin = row_offsets[row];
+                const offset_type out_begin = out_mat_ptr->vec_offsets()[row];
+
+                for(std::size_t k = 0; k < row_pat.size(); ++k)
+                {
+                    out_mat_ptr->vec_ids()[out_begin + offset_type(k)] =
+                        column_ids[row_begin + offset_type(row_pat[k])];
+
+                    pattern_values[out_begin + offset_type(k)] =
+                        values[row_begin + offset_type(row_pat[k])];
+                }
+            }
+
+            // ssa_internal needs non-null pattern values to use them instead
+            // of the dense matrix.
+            const value_type empty_value = value_type();
+
+            success =
+                ssa_internal(
+                    num_rows, num_cols,
+                    static_cast<const value_type*>(0), num_rows,
+                    out_mat_ptr->vec_offsets(),
+                    out_mat_ptr->vec_ids(),
+                    pattern_values.size() ? &pattern_values.front() : &empty_value,
+                    max_num_bins,
+                    matrix_binning_method_uniform,
+                    static_cast<const ssa_bin_tuning*>(0),
+                    impose_null_spaces,
+                    static_cast<ssa_null_space_stats*>(0),
+                    pinv_AT, left_null_space, right_null_space,
+                    matrix_type,
+                    out_mat_ptr->vec_values());
         }
     }
 
-    if(!success)
+    if(success)
+    {
+        out_matrix.row_offsets = out_mat_ptr->vec_offsets();
+        out_matrix.column_ids  = out_mat_ptr->vec_ids();
+        out_matrix.values      = out_mat_ptr->vec_values();
+        out_matrix.reserved    = out_mat_ptr;
+    }
+    else
     {
+        delete_catch(out_mat_ptr, "ssa_lpn_csr_internal");
+
         assert(false);
         internal_api_error_set_last(
-            "ssa_internal: Error in complex version.");
+            "ssa_lpn_csr_internal: Error");
     }
 
     return success;
@@ -799,309 +1453,3285 @@ bool ssa_internal(
 
 // -----------------------------------------------------------------------------
 
-} // namespace
-
-// -----------------------------------------------------------------------------
-
 template
 <
     typename index_type,
     typename offset_type,
     typename value_type
 >
-ssa_csr<index_type, offset_type, value_type>::ssa_csr()
-    :
-        row_offsets(0),
-        column_ids(0),
-        values(0),
-        reserved(0)
+bool ssa_ids_internal(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    typename precision_traits<value_type>::scalar sparsity_ratio,
+    typename precision_traits<value_type>::scalar sparsity_norm_p,
+    index_type           min_num_nnz_per_row,
+    index_type           min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
 {
-}
+    ssa_error_clear();
 
-template
-<
-    typename index_type,
-    typename offset_type,
-    typename value_type
->
-ssa_csr<index_type, offset_type, value_type>::~ssa_csr()
-{
-    delete_catch(reinterpret_cast
-        <const sparse_vectors<index_type, offset_type, value_type>*>(
-            reserved), "ssa_csr::~ssa_csr()");
+    const int is_abs_sym = ssa_matrix_type_is_abs_sym(matrix_type);
 
-    reserved = 0;
-}
+    bool success =
+        ssa_matrix_type_undefined < matrix_type &&
+        matrix_type < ssa_matrix_type_num_types &&
+        (num_rows == num_cols || !is_abs_sym) &&
+        (min_num_nnz_per_row == min_num_nnz_per_col || !is_abs_sym) &&
+        col_values;
 
-// -----------------------------------------------------------------------------
+    if(!success)
+    {
+        assert(false);
 
-// User-given pattern.
-template
-<
-    typename index_type,
-    typename offset_type,
-    typename value_type
->
-int ssa_pat(
-    index_type            num_rows,
-    index_type            num_cols,
-    const value_type*     col_values,
-    index_type            col_leading_dim,
-    const offset_type*    row_offsets,
-    const index_type*     column_ids,
-    offset_type           max_num_bins,
-    bool                  impose_null_spaces,
-    enum ssa_matrix_type  matrix_type,
-    value_type*           out_row_values)
+        internal_api_error_set_last(
+            "ssa_ids_internal: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    std::vector< std::vector<index_type> > row_oriented_sparse_pat;
+
+    if(is_abs_sym)
+    {
+        success = p_norm_sparsity_dense_matrix_abs_sym(
+            sparsity_ratio, sparsity_norm_p,
+            min_num_nnz_per_row,
+            num_rows,
+            col_values, col_leading_dim,
+            row_oriented_sparse_pat);
+    }
+    else
+    {
+        success = p_norm_sparsity_dense_matrix_col_oriented(
+            sparsity_ratio, sparsity_norm_p,
+            min_num_nnz_per_row, min_num_nnz_per_col,
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            row_oriented_sparse_pat);
+    }
+
+    if(success)
+    {
+        std::vector<index_type> size_per_row(num_rows);
+
+        for(index_type row = 0; row < num_rows; ++row)
+            size_per_row[row] = index_type(row_oriented_sparse_pat[row].size());
+
+        sparse_vectors<index_type, offset_type, value_type>* out_mat_ptr =
+            new (std::nothrow) sparse_vectors<index_type, offset_type, value_type>();
+
+        if(!out_mat_ptr)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                "ssa_ids_internal: Error in allocating matrix.");
+
+            return false;
+        }
+
+        success = out_mat_ptr->allocate(num_rows, num_cols, &size_per_row.front());
+
+        if(success)
+        {
+            for(index_type row = 0; row < num_rows; ++row)
+                std::copy(
+                    row_oriented_sparse_pat[row].begin(),
+                    row_oriented_sparse_pat[row].end(),
+                    out_mat_ptr->vec_ids_begin(row));
+
+            out_matrix.row_offsets = out_mat_ptr->vec_offsets();
+            out_matrix.column_ids  = out_mat_ptr->vec_ids();
+            out_matrix.values      = out_mat_ptr->vec_values();
+            out_matrix.reserved    = out_mat_ptr;
+        }
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_ids_internal: Error");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// For real matrices.  Check the input, and compute Gram matrices of the
+// pseudo-inverse for the Hessian of the misfit.
+template
+<
+    typename index_type,
+    typename value_type
+>
+bool ssa_misfit_grams(
+    index_type num_rows,
+    index_type num_cols,
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    ssa_matrix_type matrix_type,
+    dense_vectors<index_type, value_type>& B1TB1,
+    dense_vectors<index_type, value_type>& B2TB2)
 {
-    ssa_error_clear();
+    const int is_square = (num_rows == num_cols);
+    const int is_hermitian = ssa_matrix_type_is_hermitian(matrix_type);
+    const int is_normal    = ssa_matrix_type_is_normal(matrix_type);
 
     bool success =
-        ssa_matrix_type_undefined < matrix_type &&
-        matrix_type < ssa_matrix_type_num_types &&
-        (num_rows == num_cols || !ssa_matrix_type_is_abs_sym(matrix_type)) &&
-        col_values &&
-        row_offsets &&
-        column_ids &&
-        out_row_values;
+        !(
+            is_hermitian ||
+            is_normal
+        ) ||
+        is_square;
 
     if(!success)
     {
         assert(false);
 
         internal_api_error_set_last(
-            "ssa_pat: Unacceptable input argument(s).");
+            "ssa_internal: Unacceptable input argument(s) in real version.");
 
         return false;
     }
 
-    dense_vectors<index_type, value_type>
-        pinv_AT, left_null_space, right_null_space;
+    success =
+        B1TB1.allocate(
+            num_cols, num_cols)
+        &&
+        // If normal, don't have to allocate or compute B2TB2
+        (is_normal ? true : B2TB2.allocate(
+            num_rows, num_rows))
+        &&
+        ssa_matrix_type_misfit_lhs_matrices(
+            num_rows,
+            num_cols,
+            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            B2TB2.vec_values(),   B2TB2.leading_dimension(),
+            B1TB1.vec_values(),   B1TB1.leading_dimension(),
+            matrix_type);
 
-    dense_vectors<index_type, value_type>* left_null_space_ptr = 0;
-    dense_vectors<index_type, value_type>* right_null_space_ptr = 0;
+    return success;
+}
 
-    if(impose_null_spaces)
+// -----------------------------------------------------------------------------
+
+// For complex matrices
+template
+<
+    typename index_type,
+    typename scalar_type
+>
+bool ssa_misfit_grams(
+    index_type num_rows,
+    index_type num_cols,
+    const dense_vectors<index_type, std::complex<scalar_type> >& pinv_AT,
+    ssa_matrix_type matrix_type,
+    dense_vectors<index_type, std::complex<scalar_type> >& B1TB1,
+    dense_vectors<index_type, std::complex<scalar_type> >& B2TB2)
+{
+    const int is_square = (num_rows == num_cols);
+    const int is_hermitian               = ssa_matrix_type_is_hermitian(matrix_type);
+    const int is_normal                  = ssa_matrix_type_is_normal(matrix_type);
+    const int is_real_part_symmetric     = ssa_matrix_type_is_real_part_symmetric(matrix_type);
+    const int is_imag_part_symmetric     = ssa_matrix_type_is_imag_part_symmetric(matrix_type);
+    const int is_AAT_computable_from_ATA = ssa_matrix_type_is_AAT_computable_from_ATA(matrix_type);
+
+    bool success =
+        !(
+            is_hermitian ||
+            is_normal ||
+            is_real_part_symmetric ||
+            is_imag_part_symmetric ||
+            is_AAT_computable_from_ATA
+        ) ||
+        is_square;
+
+    if(!success)
     {
-        left_null_space_ptr = &left_null_space;
-        right_null_space_ptr = &right_null_space;
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_internal: Unacceptable input argument(s) in complex version.");
+
+        return false;
     }
 
     success =
-        pinv_AT.allocate(
-            num_cols, num_rows)
-        &&
-        dense_vectors_utils_copy(
-            num_cols, num_rows,
-            col_values, col_leading_dim,
-            pinv_AT.vec_values(), pinv_AT.leading_dimension())
-        &&
-        ssa_matrix_type_pinv_transpose(
-            num_rows, num_cols,
-            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
-            matrix_type,
-            left_null_space_ptr, right_null_space_ptr)
+        B1TB1.allocate(
+            num_cols, num_cols)
         &&
-        ssa_internal(
-            num_rows, num_cols,
-            col_values, col_leading_dim,
-            row_offsets, column_ids,
-            max_num_bins,
-            impose_null_spaces,
-            pinv_AT, left_null_space, right_null_space,
-            matrix_type,
-            out_row_values);
+        // If normal, don't have to allocate or compute B2TB2
+        (is_normal ? true : B2TB2.allocate(
+            num_rows, num_rows));
 
-    if(!success)
+    if(success)
+    {
+        if(is_AAT_computable_from_ATA)
+        {
+            success =
+                sparse_spectral_misfit_lhs_matrices(
+                    num_rows,
+                    num_cols,
+                    pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+                    reinterpret_cast<std::complex<scalar_type>*>(0), num_rows,
+                    B1TB1.vec_values(),   B1TB1.leading_dimension())
+                &&
+                ssa_matrix_type_compute_AAT_from_ATA(
+                    num_rows,
+                    B1TB1.vec_values(), B1TB1.leading_dimension(),
+                    B2TB2.vec_values(), B2TB2.leading_dimension(),
+                    matrix_type);
+        }
+        else
+        {
+            success = ssa_matrix_type_misfit_lhs_matrices(
+                num_rows,
+                num_cols,
+                pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+                B2TB2.vec_values(),   B2TB2.leading_dimension(),
+                B1TB1.vec_values(),   B1TB1.leading_dimension(),
+                matrix_type);
+        }
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// For real matrices.  Bin the values at the pattern and minimize the misfit.
+// B2TB2_col_values and mult_factor are from ssa_B2TB2_chooser.  If
+// misfit_decrease is not null, it is set to J(0) - J(X), see
+// sparse_spectral_minimization.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_bin_minimize(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* col_values,      // num_rows x num_cols, or 0 if pattern_values
+    index_type col_leading_dim,
+    const offset_type* row_offsets,    // num_rows + 1
+    const index_type* column_ids,      // row_offsets[num_rows]
+    const value_type* pattern_values,  // row_offsets[num_rows], or 0
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    null_space_impose_warm_start<index_type, value_type>* null_space_warm_start,
+    const value_type* B2TB2_col_values,  // num_rows x num_rows, or 0
+    const dense_vectors<index_type, value_type>& B1TB1,
+    value_type mult_factor,
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    ssa_matrix_type matrix_type,
+    value_type* out_row_values,  // row_offsets[num_rows]
+    value_type* misfit_decrease)
+{
+    const int is_hermitian = ssa_matrix_type_is_hermitian(matrix_type);
+
+    std::vector<offset_type> row_bin_ids;
+
+    try
+    {
+        row_bin_ids.resize(row_offsets[num_rows]);
+    }
+    catch(const std::exception& exc)
     {
         assert(false);
 
-        internal_api_error_set_last(
-            "ssa_pat: Error.");
-    }
+        internal_api_error_set_last(
+            (std::string("ssa_internal: Exception in the real version. ") + exc.what()));
+
+        return false;
+    }
+
+    offset_type actual_num_bins;
+
+    null_space_impose_stats impose_stats;
+
+    split_pattern<index_type, offset_type>
+        row_split_pattern, col_split_pattern;
+
+    const bool success =
+        (pattern_values ?
+            sparse_spectral_binning_row_at_pattern(
+                num_rows, num_cols,
+                pattern_values,
+                row_offsets, column_ids,
+                max_num_bins, binning_method, actual_num_bins,
+                row_split_pattern,
+                row_bin_ids.size() ? &row_bin_ids.front() : 0)
+            :
+            sparse_spectral_binning_row(
+                num_rows, num_cols,
+                col_values, col_leading_dim,
+                row_offsets, column_ids,
+                max_num_bins, binning_method, actual_num_bins,
+                row_split_pattern,
+                row_bin_ids.size() ? &row_bin_ids.front() : 0))
+        &&
+        // If hermitian, don't have to compute col_split_pattern
+        (is_hermitian ? true : sparse_spectral_binning_to_col(
+            num_rows, num_cols,
+            row_offsets, column_ids,
+            row_bin_ids.size() ? &row_bin_ids.front() : 0,
+            actual_num_bins,
+            col_split_pattern))
+        &&
+        sparse_spectral_minimization(
+            num_rows, num_cols,
+            row_offsets, column_ids,
+            actual_num_bins,
+            row_bin_ids.size() ? &row_bin_ids.front() : 0,
+            row_split_pattern,
+            // If hermitian, reuse row_split_pattern as col_split_pattern
+            is_hermitian ? row_split_pattern : col_split_pattern,
+            impose_null_spaces,
+            B2TB2_col_values, num_rows,
+            B1TB1.vec_values(), B1TB1.leading_dimension(),
+            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            left_null_space,
+            right_null_space,
+            out_row_values,
+            mult_factor,
+            misfit_decrease,
+            ssa_null_space_impose_structure(matrix_type),
+            &impose_stats,
+            null_space_warm_start);
+
+    // Nothing is imposed without null spaces.
+    if(success && impose_null_spaces && null_space_stats &&
+       (left_null_space.num_vecs() || right_null_space.num_vecs()))
+        null_space_stats->add(impose_stats);
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// For complex matrices
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+bool ssa_bin_minimize(
+    index_type num_rows,
+    index_type num_cols,
+    const std::complex<scalar_type>* col_values,    // num_rows x num_cols, or 0 if pattern_values
+    index_type col_leading_dim,
+    const offset_type* row_offsets,    // num_rows + 1
+    const index_type* column_ids,      // row_offsets[num_rows]
+    const std::complex<scalar_type>* pattern_values,  // row_offsets[num_rows], or 0
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    null_space_impose_warm_start<index_type, std::complex<scalar_type> >* null_space_warm_start,
+    const std::complex<scalar_type>* B2TB2_col_values,  // num_rows x num_rows, or 0
+    const dense_vectors<index_type, std::complex<scalar_type> >& B1TB1,
+    scalar_type mult_factor,
+    const dense_vectors<index_type, std::complex<scalar_type> >& pinv_AT,
+    const dense_vectors<index_type, std::complex<scalar_type> >& left_null_space,
+    const dense_vectors<index_type, std::complex<scalar_type> >& right_null_space,
+    ssa_matrix_type matrix_type,
+    std::complex<scalar_type>* out_row_values,  // row_offsets[num_rows]
+    scalar_type* misfit_decrease)
+{
+    const int is_real_part_symmetric = ssa_matrix_type_is_real_part_symmetric(matrix_type);
+    const int is_imag_part_symmetric = ssa_matrix_type_is_imag_part_symmetric(matrix_type);
+
+    std::vector<offset_type> real_row_bin_ids, imag_row_bin_ids;
+
+    try
+    {
+        real_row_bin_ids.resize(row_offsets[num_rows]);
+        imag_row_bin_ids.resize(row_offsets[num_rows]);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("ssa_internal: Exception in complex version. ") + exc.what()));
+
+        return false;
+    }
+
+    offset_type real_actual_num_bins, imag_actual_num_bins;
+
+    null_space_impose_stats impose_stats;
+
+    split_pattern<index_type, offset_type>
+        real_row_split_pattern, real_col_split_pattern,
+        imag_row_split_pattern, imag_col_split_pattern;
+
+    const bool success =
+        (pattern_values ?
+            sparse_spectral_binning_row_at_pattern(
+                num_rows, num_cols,
+                pattern_values,
+                row_offsets, column_ids,
+                max_num_bins,
+                binning_method,
+                real_actual_num_bins, imag_actual_num_bins,
+                real_row_split_pattern, imag_row_split_pattern,
+                real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
+                imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0)
+            :
+            sparse_spectral_binning_row(
+                num_rows, num_cols,
+                col_values, col_leading_dim,
+                row_offsets, column_ids,
+                max_num_bins,
+                binning_method,
+                real_actual_num_bins, imag_actual_num_bins,
+                real_row_split_pattern, imag_row_split_pattern,
+                real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
+                imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0))
+        &&
+        // If real part hermitian, don't have to compute real_col_split_pattern
+        (is_real_part_symmetric ? true : sparse_spectral_binning_to_col(
+            num_rows, num_cols,
+            row_offsets, column_ids,
+            real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
+            real_actual_num_bins,
+            real_col_split_pattern))
+        &&
+        // If imag part hermitian, don't have to compute imag_col_split_pattern
+        (is_imag_part_symmetric ? true : sparse_spectral_binning_to_col(
+            num_rows, num_cols,
+            row_offsets, column_ids,
+            imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0,
+            imag_actual_num_bins,
+            imag_col_split_pattern))
+        &&
+        sparse_spectral_minimization(
+            num_rows, num_cols,
+            row_offsets, column_ids,
+            real_actual_num_bins, imag_actual_num_bins,
+            real_row_bin_ids.size() ? &real_row_bin_ids.front() : 0,
+            imag_row_bin_ids.size() ? &imag_row_bin_ids.front() : 0,
+            real_row_split_pattern, imag_row_split_pattern,
+            is_real_part_symmetric ? real_row_split_pattern : real_col_split_pattern,
+            is_imag_part_symmetric ? imag_row_split_pattern : imag_col_split_pattern,
+            impose_null_spaces,
+            B2TB2_col_values, num_rows,
+            B1TB1.vec_values(), B1TB1.leading_dimension(),
+            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            left_null_space,
+            right_null_space,
+            out_row_values,
+            mult_factor,
+            misfit_decrease,
+            ssa_null_space_impose_structure(matrix_type),
+            &impose_stats,
+            null_space_warm_start);
+
+    // Nothing is imposed without null spaces.
+    if(success && impose_null_spaces && null_space_stats &&
+       (left_null_space.num_vecs() || right_null_space.num_vecs()))
+        null_space_stats->add(impose_stats);
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Try numbers of bins 2, 4, 8, ... up to max_num_bins, all with the same
+// pattern, pseudo-inverse, and Gram matrices.  out_row_values gets the
+// result with the least misfit.  Null spaces, if asked for, are imposed on
+// that result only.  See ssa_options::tune_num_bins.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_tune_num_bins(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* col_values,      // num_rows x num_cols
+    index_type col_leading_dim,
+    const offset_type* row_offsets,    // num_rows + 1
+    const index_type* column_ids,      // row_offsets[num_rows]
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,
+    null_space_impose_warm_start<index_type, value_type>* null_space_warm_start,
+    const value_type* B2TB2_col_values,  // num_rows x num_rows, or 0
+    const dense_vectors<index_type, value_type>& B1TB1,
+    typename precision_traits<value_type>::scalar mult_factor,
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    ssa_matrix_type matrix_type,
+    const ssa_bin_tuning& tuning,
+    value_type* out_row_values)  // row_offsets[num_rows]
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    assert(col_values && 1 < max_num_bins);
+
+    wall_timer timer;
+
+    // With B1 = B2 = pinv(A), J(0) = trace(pinv(A) * A) = rank(A).  pinv_AT
+    // holds the conjugate transpose of pinv(A), hence the conj below.
+
+    scalar_type misfit_at_zero = 0;
+
+    for(index_type j = 0; j < num_cols; ++j)
+    {
+        const value_type* A_col = col_values + std::size_t(j) * std::size_t(col_leading_dim);
+        const value_type* pinv_AT_col = pinv_AT.vec_values_begin(j);
+
+        for(index_type i = 0; i < num_rows; ++i)
+            misfit_at_zero += std::real(A_col[i] * std::conj(pinv_AT_col[i]));
+    }
+
+    if(!(0 < misfit_at_zero))
+        misfit_at_zero = 1;
+
+    std::vector<value_type> trial_values;
+
+    try
+    {
+        trial_values.resize(row_offsets[num_rows]);
+    }
+    catch(const std::exception& exc)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            (std::string("ssa_tune_num_bins: Exception. ") + exc.what()));
+
+        return false;
+    }
+
+    ssa_tune_report* report = tuning.report;
+
+    if(report)
+    {
+        report->chosen_num_bins = 0;
+        report->num_tries = 0;
+    }
+
+    bool success = true;
+
+    scalar_type best_misfit = std::numeric_limits<scalar_type>::max();
+    scalar_type prev_misfit = best_misfit;
+
+    for(offset_type num_bins = 2; ; )
+    {
+        scalar_type misfit_decrease = 0;
+
+        success = ssa_bin_minimize(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            row_offsets, column_ids,
+            static_cast<const value_type*>(0),
+            num_bins,
+            binning_method,
+            false,
+            static_cast<ssa_null_space_stats*>(0),
+            static_cast<null_space_impose_warm_start<index_type, value_type>*>(0),
+            B2TB2_col_values,
+            B1TB1,
+            mult_factor,
+            pinv_AT, left_null_space, right_null_space,
+            matrix_type,
+            trial_values.size() ? &trial_values.front() : 0,
+            &misfit_decrease);
+
+        if(!success)
+            break;
+
+        const scalar_type misfit = (misfit_at_zero - misfit_decrease) / misfit_at_zero;
+
+        if(report && report->num_tries < SSA_TUNE_REPORT_MAX_TRIES)
+        {
+            report->num_bins[report->num_tries] = int(num_bins);
+            report->relative_misfit[report->num_tries] = double(misfit);
+            ++report->num_tries;
+        }
+
+        if(misfit < best_misfit)
+        {
+            best_misfit = misfit;
+
+            std::copy(trial_values.begin(), trial_values.end(), out_row_values);
+
+            if(report)
+                report->chosen_num_bins = int(num_bins);
+        }
+
+        const bool converged =
+            prev_misfit != std::numeric_limits<scalar_type>::max() &&
+            prev_misfit - misfit <= scalar_type(tuning.tolerance) * prev_misfit;
+
+        const bool out_of_time =
+            0 < tuning.time_budget && tuning.time_budget <= timer.elapsed();
+
+        if(converged || out_of_time || num_bins == max_num_bins)
+            break;
+
+        prev_misfit = misfit;
+
+        num_bins = num_bins <= max_num_bins / 2 ? offset_type(2 * num_bins) : max_num_bins;
+    }
+
+    // The misfit is that before imposing null spaces, so impose only on the
+    // chosen result.
+
+    if(success &&
+       impose_null_spaces &&
+       (left_null_space.num_vecs() || right_null_space.num_vecs()))
+    {
+        sparse_vectors<index_type, offset_type, value_type> approximation(
+            num_rows, num_cols, const_cast<offset_type*>(row_offsets), const_cast<index_type*>(column_ids),
+            out_row_values);
+
+        null_space_impose_stats impose_stats;
+
+        success = null_space_impose(
+            left_null_space,
+            right_null_space,
+            approximation,
+            ssa_null_space_impose_structure(matrix_type),
+            &impose_stats,
+            null_space_warm_start);
+
+        if(success && null_space_stats)
+            null_space_stats->add(impose_stats);
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_tune_num_bins: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Same as ssa_internal, with the Gram matrices from ssa_misfit_grams.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_internal_grams(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* col_values,      // num_rows x num_cols, or 0 if pattern_values
+    index_type col_leading_dim,
+    const offset_type* row_offsets,    // num_rows + 1
+    const index_type* column_ids,      // row_offsets[num_rows]
+    const value_type* pattern_values,  // row_offsets[num_rows], or 0
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    const ssa_bin_tuning* tuning,      // 0 if max_num_bins is to be used
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,  // Not filled if 0
+    null_space_impose_warm_start<index_type, value_type>* null_space_warm_start,  // Not used if 0
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    const dense_vectors<index_type, value_type>& B1TB1,
+    const dense_vectors<index_type, value_type>& B2TB2,
+    ssa_matrix_type matrix_type,
+    value_type* out_row_values)  // row_offsets[num_rows]
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const value_type* tmp_B2TB2_col_values = 0;
+    scalar_type mult_factor;
+
+    const bool is_binned = max_num_bins != 0;
+
+    ssa_B2TB2_chooser<index_type, value_type>(
+        B1TB1,
+        B2TB2,
+        matrix_type,
+        is_binned,
+        tmp_B2TB2_col_values,
+        mult_factor);
+
+    bool success = false;
+
+    // Tuning needs the whole matrix for the misfit, and at least two
+    // numbers of bins to try.
+    if(tuning && col_values && !pattern_values && 1 < max_num_bins)
+    {
+        success = ssa_tune_num_bins(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            row_offsets, column_ids,
+            max_num_bins,
+            binning_method,
+            impose_null_spaces,
+            null_space_stats,
+            null_space_warm_start,
+            tmp_B2TB2_col_values,
+            B1TB1,
+            mult_factor,
+            pinv_AT, left_null_space, right_null_space,
+            matrix_type,
+            *tuning,
+            out_row_values);
+    }
+    else
+    {
+        success = ssa_bin_minimize(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            row_offsets, column_ids,
+            pattern_values,
+            max_num_bins,
+            binning_method,
+            impose_null_spaces,
+            null_space_stats,
+            null_space_warm_start,
+            tmp_B2TB2_col_values,
+            B1TB1,
+            mult_factor,
+            pinv_AT, left_null_space, right_null_space,
+            matrix_type,
+            out_row_values,
+            static_cast<scalar_type*>(0));
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_internal_grams: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_internal(
+    index_type num_rows,
+    index_type num_cols,
+    const value_type* col_values,      // num_rows x num_cols, or 0 if pattern_values
+    index_type col_leading_dim,
+    const offset_type* row_offsets,    // num_rows + 1
+    const index_type* column_ids,      // row_offsets[num_rows]
+    const value_type* pattern_values,  // row_offsets[num_rows], or 0
+    offset_type max_num_bins,
+    matrix_binning_method binning_method,
+    const ssa_bin_tuning* tuning,      // 0 if max_num_bins is to be used
+    bool impose_null_spaces,
+    ssa_null_space_stats* null_space_stats,  // Not filled if 0
+    const dense_vectors<index_type, value_type>& pinv_AT,
+    const dense_vectors<index_type, value_type>& left_null_space,
+    const dense_vectors<index_type, value_type>& right_null_space,
+    ssa_matrix_type matrix_type,
+    value_type* out_row_values)  // row_offsets[num_rows]
+{
+    dense_vectors<index_type, value_type> B1TB1, B2TB2;
+
+    const bool success =
+        ssa_misfit_grams(
+            num_rows, num_cols,
+            pinv_AT,
+            matrix_type,
+            B1TB1, B2TB2)
+        &&
+        ssa_internal_grams(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            row_offsets, column_ids,
+            pattern_values,
+            max_num_bins,
+            binning_method,
+            tuning,
+            impose_null_spaces,
+            null_space_stats,
+            static_cast<null_space_impose_warm_start<index_type, value_type>*>(0),
+            pinv_AT, left_null_space, right_null_space,
+            B1TB1, B2TB2,
+            matrix_type,
+            out_row_values);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_internal: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Compute the pseudo-inverse, the null spaces, and the Gram matrices of the
+// plan from its matrix.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_plan_recompute(
+    ssa_plan_data<index_type, offset_type, value_type>& plan)
+{
+    const index_type num_rows = plan.num_rows;
+    const index_type num_cols = plan.num_cols;
+
+    const bool success =
+        plan.pinv_AT.allocate(
+            num_cols, num_rows)
+        &&
+        dense_vectors_utils_copy(
+            num_cols, num_rows,
+            plan.A.vec_values(), plan.A.leading_dimension(),
+            plan.pinv_AT.vec_values(), plan.pinv_AT.leading_dimension())
+        &&
+        ssa_matrix_type_pinv_transpose(
+            num_rows, num_cols,
+            plan.pinv_AT.vec_values(), plan.pinv_AT.leading_dimension(),
+            plan.matrix_type,
+            &plan.left_null_space, &plan.right_null_space,
+            plan.randomized ? &plan.pinv_params : 0)
+        &&
+        ssa_misfit_grams(
+            num_rows, num_cols,
+            plan.pinv_AT,
+            plan.matrix_type,
+            plan.B1TB1, plan.B2TB2);
+
+    plan.num_updates_in_row = 0;
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_plan_recompute: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// See ssa_*_plan_create.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_plan_create_internal(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    const ssa_options&   options,
+    ssa_plan_data<index_type, offset_type, value_type>*& out_plan)
+{
+    ssa_error_clear();
+
+    out_plan = 0;
+
+    bool success =
+        ssa_matrix_type_undefined < matrix_type &&
+        matrix_type < ssa_matrix_type_num_types &&
+        (num_rows == num_cols || !ssa_matrix_type_is_abs_sym(matrix_type)) &&
+        0 < num_rows &&
+        0 < num_cols &&
+        col_values &&
+        num_rows <= col_leading_dim &&
+        ssa_pinv_method_qr <= options.pinv_method &&
+        options.pinv_method < ssa_pinv_method_num_methods &&
+        0 <= options.pinv_rank_tolerance &&
+        options.pinv_rank_tolerance < 1 &&
+        0 < options.pinv_oversampling;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_plan_create_internal: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    ssa_plan_data<index_type, offset_type, value_type>* plan =
+        new (std::nothrow) ssa_plan_data<index_type, offset_type, value_type>();
+
+    if(!plan)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_plan_create_internal: Error in allocating plan.");
+
+        return false;
+    }
+
+    plan->num_rows           = num_rows;
+    plan->num_cols           = num_cols;
+    plan->matrix_type        = matrix_type;
+    plan->impose_null_spaces = impose_null_spaces;
+    plan->randomized         = options.pinv_method == ssa_pinv_method_randomized;
+
+    plan->pinv_params.rank_tolerance = options.pinv_rank_tolerance;
+    plan->pinv_params.oversampling   = std::size_t(options.pinv_oversampling);
+
+    success =
+        plan->A.allocate(
+            num_cols, num_rows)
+        &&
+        dense_vectors_utils_copy(
+            num_cols, num_rows,
+            col_values, col_leading_dim,
+            plan->A.vec_values(), plan->A.leading_dimension())
+        &&
+        ssa_plan_recompute(*plan);
+
+    if(success)
+    {
+        out_plan = plan;
+    }
+    else
+    {
+        delete_catch(plan, "ssa_plan_create_internal");
+
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_plan_create_internal: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// See ssa_*_plan_update.  recomputed is set to true if the pseudo-inverse
+// could not be updated and was recomputed.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool ssa_plan_update_internal(
+    ssa_plan_data<index_type, offset_type, value_type>& plan,
+    index_type        rank,
+    const value_type* U_col_values,
+    index_type        U_col_leading_dim,
+    const value_type* V_col_values,
+    index_type        V_col_leading_dim,
+    bool&             recomputed)
+{
+    ssa_error_clear();
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    recomputed = false;
+
+    const index_type num_rows = plan.num_rows;
+    const index_type num_cols = plan.num_cols;
+
+    bool success =
+        0 < rank &&
+        U_col_values && num_rows <= U_col_leading_dim &&
+        V_col_values && num_cols <= V_col_leading_dim;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_plan_update_internal: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    // A += U * V^H
+    success = dense_matrix_mult(
+        'N', 'C', num_rows, num_cols, rank,
+        value_type(1), U_col_values, U_col_leading_dim,
+        V_col_values, V_col_leading_dim,
+        value_type(1), plan.A.vec_values(), plan.A.leading_dimension());
+
+    // For circulant types, the pseudo-inverse from the FFT is cheaper than
+    // the update.
+
+    bool updated = false;
+
+    if(success &&
+        !ssa_matrix_type_is_circulant(plan.matrix_type) &&
+        !ssa_matrix_type_is_skew_circulant(plan.matrix_type) &&
+        plan.num_updates_in_row < ssa_plan_max_updates_in_row)
+    {
+        const scalar_type A_norm = std::sqrt(dense_matrix_pinv_update_norm_sq(
+            num_rows, num_cols,
+            plan.A.vec_values(), plan.A.leading_dimension()));
+
+        success = dense_matrix_pinv_update_transpose(
+            num_rows, num_cols, rank,
+            U_col_values, U_col_leading_dim,
+            V_col_values, V_col_leading_dim,
+            A_norm,
+            plan.pinv_AT.vec_values(), plan.pinv_AT.leading_dimension(),
+            plan.left_null_space, plan.right_null_space,
+            plan.B1TB1.vec_values(), plan.B1TB1.leading_dimension(),
+            plan.B2TB2.vec_values(), plan.B2TB2.leading_dimension(),
+            updated);
+    }
+
+    if(success)
+    {
+        if(updated)
+        {
+            ++plan.num_updates_in_row;
+        }
+        else
+        {
+            recomputed = true;
+            success = ssa_plan_recompute(plan);
+        }
+    }
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_plan_update_internal: Error.");
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+ssa_csr<index_type, offset_type, value_type>::ssa_csr()
+    :
+        row_offsets(0),
+        column_ids(0),
+        values(0),
+        reserved(0)
+{
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+ssa_csr<index_type, offset_type, value_type>::~ssa_csr()
+{
+    delete_catch(reinterpret_cast
+        <const sparse_vectors<index_type, offset_type, value_type>*>(
+            reserved), "ssa_csr::~ssa_csr()");
+
+    reserved = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+// User-given pattern.
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_pat(
+    index_type            num_rows,
+    index_type            num_cols,
+    const value_type*     col_values,
+    index_type            col_leading_dim,
+    const offset_type*    row_offsets,
+    const index_type*     column_ids,
+    offset_type           max_num_bins,
+    bool                  impose_null_spaces,
+    enum ssa_matrix_type  matrix_type,
+    value_type*           out_row_values)
+{
+    ssa_error_clear();
+
+    bool success =
+        ssa_matrix_type_undefined < matrix_type &&
+        matrix_type < ssa_matrix_type_num_types &&
+        (num_rows == num_cols || !ssa_matrix_type_is_abs_sym(matrix_type)) &&
+        col_values &&
+        row_offsets &&
+        column_ids &&
+        out_row_values;
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_pat: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    dense_vectors<index_type, value_type>
+        pinv_AT, left_null_space, right_null_space;
+
+    dense_vectors<index_type, value_type>* left_null_space_ptr = 0;
+    dense_vectors<index_type, value_type>* right_null_space_ptr = 0;
+
+    if(impose_null_spaces)
+    {
+        left_null_space_ptr = &left_null_space;
+        right_null_space_ptr = &right_null_space;
+    }
+
+    success =
+        pinv_AT.allocate(
+            num_cols, num_rows)
+        &&
+        dense_vectors_utils_copy(
+            num_cols, num_rows,
+            col_values, col_leading_dim,
+            pinv_AT.vec_values(), pinv_AT.leading_dimension())
+        &&
+        ssa_matrix_type_pinv_transpose(
+            num_rows, num_cols,
+            pinv_AT.vec_values(), pinv_AT.leading_dimension(),
+            matrix_type,
+            left_null_space_ptr, right_null_space_ptr)
+        &&
+        ssa_internal(
+            num_rows, num_cols,
+            col_values, col_leading_dim,
+            row_offsets, column_ids,
+            static_cast<const value_type*>(0),
+            max_num_bins,
+            matrix_binning_method_uniform,
+            static_cast<const ssa_bin_tuning*>(0),
+            impose_null_spaces,
+            static_cast<ssa_null_space_stats*>(0),
+            pinv_AT, left_null_space, right_null_space,
+            matrix_type,
+            out_row_values);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_pat: Error.");
+    }
+
+    return success ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_lpn(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    value_type           sparsity_ratio,
+    value_type           sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+{
+    ssa_options options;
+    ssa_options_default(&options);
+
+    return ssa_lpn(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces,
+        matrix_type,
+        options,
+        out_matrix);
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+int ssa_lpn(
+    index_type                       num_rows,
+    index_type                       num_cols,
+    const std::complex<scalar_type>* col_values,
+    index_type                       col_leading_dim,
+    scalar_type                      sparsity_ratio,
+    scalar_type                      sparsity_norm_p,
+    offset_type                      max_num_bins,
+    bool                             impose_null_spaces,
+    enum ssa_matrix_type             matrix_type,
+    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix)
+{
+    ssa_options options;
+    ssa_options_default(&options);
+
+    return ssa_lpn(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces,
+        matrix_type,
+        options,
+        out_matrix);
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_lpn(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    value_type           sparsity_ratio,
+    value_type           sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    const ssa_options&   options,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+{
+    bool success = ssa_lpn_internal<index_type, offset_type, value_type>(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces,
+        matrix_type,
+        options,
+        out_matrix);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_lpn: Error in real version");
+    }
+
+    return success ? 0 : 1;
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+int ssa_lpn(
+    index_type                       num_rows,
+    index_type                       num_cols,
+    const std::complex<scalar_type>* col_values,
+    index_type                       col_leading_dim,
+    scalar_type                      sparsity_ratio,
+    scalar_type                      sparsity_norm_p,
+    offset_type                      max_num_bins,
+    bool                             impose_null_spaces,
+    enum ssa_matrix_type             matrix_type,
+    const ssa_options&               options,
+    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix)
+{
+    bool success = ssa_lpn_internal<index_type, offset_type, std::complex<scalar_type> >(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces,
+        matrix_type,
+        options,
+        out_matrix);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_lpn: Error in complex version");
+    }
+
+    return success ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_lpn_csr(
+    index_type           num_rows,
+    index_type           num_cols,
+    const offset_type*   row_offsets,
+    const index_type*    column_ids,
+    const value_type*    values,
+    value_type           sparsity_ratio,
+    value_type           sparsity_norm_p,
+    offset_type          max_num_bins,
+    bool                 impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+{
+    bool success = ssa_lpn_csr_internal<index_type, offset_type, value_type>(
+        num_rows, num_cols,
+        row_offsets, column_ids, values,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces,
+        matrix_type,
+        out_matrix);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_lpn_csr: Error in real version");
+    }
+
+    return success ? 0 : 1;
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+int ssa_lpn_csr(
+    index_type                       num_rows,
+    index_type                       num_cols,
+    const offset_type*               row_offsets,
+    const index_type*                column_ids,
+    const std::complex<scalar_type>* values,
+    scalar_type                      sparsity_ratio,
+    scalar_type                      sparsity_norm_p,
+    offset_type                      max_num_bins,
+    bool                             impose_null_spaces,
+    enum ssa_matrix_type             matrix_type,
+    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix)
+{
+    bool success = ssa_lpn_csr_internal<index_type, offset_type, std::complex<scalar_type> >(
+        num_rows, num_cols,
+        row_offsets, column_ids, values,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces,
+        matrix_type,
+        out_matrix);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_lpn_csr: Error in complex version");
+    }
+
+    return success ? 0 : 1;
+}
+
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_ids(
+    index_type           num_rows,
+    index_type           num_cols,
+    const value_type*    col_values,
+    index_type           col_leading_dim,
+    value_type           sparsity_ratio,
+    value_type           sparsity_norm_p,
+    index_type           min_num_nnz_per_row,
+    index_type           min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+{
+    bool success = ssa_ids_internal<index_type, offset_type, value_type>(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        min_num_nnz_per_row, min_num_nnz_per_col,
+        matrix_type,
+        out_matrix);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_ids: Error in real version");
+    }
+
+    return success ? 0 : 1;
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename scalar_type
+>
+int ssa_ids(
+    index_type           num_rows,
+    index_type           num_cols,
+    const std::complex<scalar_type>* col_values,
+    index_type           col_leading_dim,
+    scalar_type          sparsity_ratio,
+    scalar_type          sparsity_norm_p,
+    index_type           min_num_nnz_per_row,
+    index_type           min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix)
+{
+    bool success = ssa_ids_internal<index_type, offset_type, std::complex<scalar_type> >(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        min_num_nnz_per_row, min_num_nnz_per_col,
+        matrix_type,
+        out_matrix);
+
+    if(!success)
+    {
+        assert(false);
+        internal_api_error_set_last(
+            "ssa_ids: Error in complex version");
+    }
+
+    return success ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_csr_write(
+    const char*          file_name,
+    index_type           num_rows,
+    index_type           num_cols,
+    const offset_type*   row_offsets,
+    const index_type*    column_ids,
+    const value_type*    values,
+    bool                 delta_encode_ids)
+{
+    ssa_error_clear();
+
+    bool success = sparse_vectors_file_write(
+        file_name,
+        num_rows, num_cols,
+        row_offsets, column_ids, values,
+        delta_encode_ids);
+
+    if(!success)
+    {
+        internal_api_error_set_last(
+            "ssa_csr_write: Error.");
+    }
+
+    return success ? 0 : 1;
+}
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+int ssa_csr_read(
+    const char*          file_name,
+    index_type&          num_rows,
+    index_type&          num_cols,
+    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+{
+    ssa_error_clear();
+
+    sparse_vectors_file_view<index_type, offset_type, value_type>* view =
+        new (std::nothrow) sparse_vectors_file_view<index_type, offset_type, value_type>();
+
+    if(!view)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "ssa_csr_read: Error in allocating matrix.");
+
+        return 1;
+    }
+
+    bool success = view->map(file_name);
+
+    if(success)
+    {
+        delete_catch(reinterpret_cast
+            <const sparse_vectors<index_type, offset_type, value_type>*>(
+                out_matrix.reserved), "ssa_csr_read");
+
+        num_rows = view->num_vecs();
+        num_cols = view->max_size();
+
+        out_matrix.row_offsets = view->vec_offsets();
+        out_matrix.column_ids  = view->vec_ids();
+        out_matrix.values      = view->vec_values();
+        out_matrix.reserved    = static_cast<
+            const sparse_vectors<index_type, offset_type, value_type>*>(view);
+    }
+    else
+    {
+        delete_catch(view, "ssa_csr_read");
+
+        internal_api_error_set_last(
+            "ssa_csr_read: Error.");
+    }
+
+    return success ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_error_size()
+{
+    return internal_api_error_size();
+}
+
+int ssa_error_string(int i, const char** ptr_to_error_string)
+{
+    return internal_api_error_string(i, ptr_to_error_string);
+}
+
+int ssa_error_clear()
+{
+    return internal_api_error_clear();
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_options_default(struct ssa_options* options)
+{
+    if(!options)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_options_default: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    options->decompose_blocks = 0;
+    options->block_tolerance  = 0;
+    options->binning_method   = ssa_binning_method_uniform;
+    options->tune_num_bins    = 0;
+    options->tune_tolerance   = 0.01;  // MAGIC CONSTANT
+    options->tune_time_budget = 0;
+    options->tune_report      = 0;
+    options->null_space_report = 0;
+    options->pinv_method      = ssa_pinv_method_qr;
+    options->pinv_rank_tolerance = 0;
+    options->pinv_oversampling = 10;  // MAGIC CONSTANT
+    options->cache_directory  = 0;
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+/* User-given pattern */
+int ssa_d_pat(
+    int                  num_rows,
+    int                  num_cols,
+    const double*        col_values,
+    int                  col_leading_dim,
+    const int*           row_offsets,
+    const int*           column_ids,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    double*              out_row_values)
+{
+    int ret = ssa_pat(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        row_offsets, column_ids,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        out_row_values);
+
+    return ret;
+}
+
+/* User-given parameters for computing L_p norm based pattern. */
+int ssa_d_lpn(
+    int                  num_rows,
+    int                  num_cols,
+    const double*        col_values,
+    int                  col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_d_csr*    out_matrix)
+{
+    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_lpn: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_d_ids(
+    int                  num_rows,
+    int                  num_cols,
+    const double*        col_values,
+    int                  col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  min_num_nnz_per_row,
+    int                  min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_d_csr*    out_matrix)
+{
+    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_ids: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_ids(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        min_num_nnz_per_row, min_num_nnz_per_col,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_s_pat(
+    int                  num_rows,
+    int                  num_cols,
+    const float*         col_values,
+    int                  col_leading_dim,
+    const int*           row_offsets,
+    const int*           column_ids,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    float*               out_row_values)
+{
+    int ret = ssa_pat(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        row_offsets, column_ids,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        out_row_values);
+
+    return ret;
+}
+
+int ssa_s_lpn(
+    int                  num_rows,
+    int                  num_cols,
+    const float*         col_values,
+    int                  col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_s_csr*    out_matrix)
+{
+    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_lpn: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_s_ids(
+    int                  num_rows,
+    int                  num_cols,
+    const float*         col_values,
+    int                  col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  min_num_nnz_per_row,
+    int                  min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_s_csr*    out_matrix)
+{
+    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_ids: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_ids(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        min_num_nnz_per_row, min_num_nnz_per_col,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_z_pat(
+    int                  num_rows,
+    int                  num_cols,
+    const double*        col_values,
+    int                  col_leading_dim,
+    const int*           row_offsets,
+    const int*           column_ids,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    double*              out_row_values)
+{
+    int ret = ssa_pat<int,int,std::complex<double> >(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<double>*>(col_values), col_leading_dim,
+        row_offsets, column_ids,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        reinterpret_cast<std::complex<double>*>(out_row_values));
+
+    return ret;
+}
+
+int ssa_z_lpn(
+    int                  num_rows,
+    int                  num_cols,
+    const double*        col_values,
+    int                  col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_z_csr*    out_matrix)
+{
+    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_lpn: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<double>*>(col_values), col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_z_ids(
+    int                  num_rows,
+    int                  num_cols,
+    const double*        col_values,
+    int                  col_leading_dim,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  min_num_nnz_per_row,
+    int                  min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_z_csr*    out_matrix)
+{
+    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_ids: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_ids(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<double>*>(col_values), col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        min_num_nnz_per_row, min_num_nnz_per_col,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_c_pat(
+    int                  num_rows,
+    int                  num_cols,
+    const float*         col_values,
+    int                  col_leading_dim,
+    const int*           row_offsets,
+    const int*           column_ids,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    float*               out_row_values)
+{
+    int ret = ssa_pat<int,int,std::complex<float> >(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<float>*>(col_values), col_leading_dim,
+        row_offsets, column_ids,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        reinterpret_cast<std::complex<float>*>(out_row_values));
+
+    return ret;
+}
+
+int ssa_c_lpn(
+    int                  num_rows,
+    int                  num_cols,
+    const float*         col_values,
+    int                  col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_c_csr*    out_matrix)
+{
+    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_lpn: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<float>*>(col_values), col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_c_ids(
+    int                  num_rows,
+    int                  num_cols,
+    const float*         col_values,
+    int                  col_leading_dim,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  min_num_nnz_per_row,
+    int                  min_num_nnz_per_col,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_c_csr*    out_matrix)
+{
+    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_ids: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_ids(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<float>*>(col_values), col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        min_num_nnz_per_row, min_num_nnz_per_col,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+void ssa_d_csr_deallocate(struct ssa_d_csr* matrix)
+{
+    if(matrix)
+    {
+        matrix->row_offsets = 0;
+        matrix->column_ids = 0;
+        matrix->values = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_csr<int, int, double>*>(
+                    matrix->reserved), "ssa_d_csr_deallocate");
+
+        matrix->reserved = 0;
+    }
+}
+
+void ssa_s_csr_deallocate(struct ssa_s_csr* matrix)
+{
+    if(matrix)
+    {
+        matrix->row_offsets = 0;
+        matrix->column_ids = 0;
+        matrix->values = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_csr<int, int, float>*>(
+                    matrix->reserved), "ssa_s_csr_deallocate");
+
+        matrix->reserved = 0;
+    }
+}
+
+void ssa_z_csr_deallocate(struct ssa_z_csr* matrix)
+{
+    if(matrix)
+    {
+        matrix->row_offsets = 0;
+        matrix->column_ids = 0;
+        matrix->values = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_csr<int, int, std::complex<double> >*>(
+                    matrix->reserved), "ssa_z_csr_deallocate");
+
+        matrix->reserved = 0;
+    }
+}
+
+void ssa_c_csr_deallocate(struct ssa_c_csr* matrix)
+{
+    if(matrix)
+    {
+        matrix->row_offsets = 0;
+        matrix->column_ids = 0;
+        matrix->values = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_csr<int, int, std::complex<float> >*>(
+                    matrix->reserved), "ssa_c_csr_deallocate");
+
+        matrix->reserved = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_d_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_d_csr*         out_matrix)
+{
+    if(!options)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_lpn_opt: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_lpn_opt: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *options,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_s_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_s_csr*         out_matrix)
+{
+    if(!options)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_lpn_opt: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_lpn_opt: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *options,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_z_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_z_csr*         out_matrix)
+{
+    if(!options)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_lpn_opt: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_lpn_opt: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<double>*>(col_values), col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *options,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_c_lpn_opt(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_c_csr*         out_matrix)
+{
+    if(!options)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_lpn_opt: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_lpn_opt: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn(
+        num_rows, num_cols,
+        reinterpret_cast<const std::complex<float>*>(col_values), col_leading_dim,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *options,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_d_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const double*        values,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_d_csr*    out_matrix)
+{
+    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_lpn_csr: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn_csr(
+        num_rows, num_cols,
+        row_offsets, column_ids,
+        values,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_s_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const float*         values,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_s_csr*    out_matrix)
+{
+    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_lpn_csr: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn_csr(
+        num_rows, num_cols,
+        row_offsets, column_ids,
+        values,
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_z_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const double*        values,
+    double               sparsity_ratio,
+    double               sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_z_csr*    out_matrix)
+{
+    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_lpn_csr: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn_csr(
+        num_rows, num_cols,
+        row_offsets, column_ids,
+        reinterpret_cast<const std::complex<double>*>(values),
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_c_lpn_csr(
+    int                  num_rows,
+    int                  num_cols,
+    const int*           row_offsets,
+    const int*           column_ids,
+    const float*         values,
+    float                sparsity_ratio,
+    float                sparsity_norm_p,
+    int                  max_num_bins,
+    int                  impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    struct ssa_c_csr*    out_matrix)
+{
+    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_lpn_csr: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_lpn_csr(
+        num_rows, num_cols,
+        row_offsets, column_ids,
+        reinterpret_cast<const std::complex<float>*>(values),
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *csr);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_d_csr_write(
+    const char*             file_name,
+    int                     num_rows,
+    int                     num_cols,
+    const struct ssa_d_csr* matrix,
+    int                     delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_csr_write: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        matrix->values,
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_d_csr_read(
+    const char*        file_name,
+    int*               num_rows,
+    int*               num_cols,
+    struct ssa_d_csr*  out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_csr_read: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_csr_read: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_d_csr_read");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_s_csr_write(
+    const char*             file_name,
+    int                     num_rows,
+    int                     num_cols,
+    const struct ssa_s_csr* matrix,
+    int                     delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_csr_write: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        matrix->values,
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_s_csr_read(
+    const char*        file_name,
+    int*               num_rows,
+    int*               num_cols,
+    struct ssa_s_csr*  out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_csr_read: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_csr_read: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_s_csr_read");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_z_csr_write(
+    const char*             file_name,
+    int                     num_rows,
+    int                     num_cols,
+    const struct ssa_z_csr* matrix,
+    int                     delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_csr_write: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        reinterpret_cast<const std::complex<double>*>(matrix->values),
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_z_csr_read(
+    const char*        file_name,
+    int*               num_rows,
+    int*               num_cols,
+    struct ssa_z_csr*  out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_csr_read: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_csr_read: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_z_csr_read");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_c_csr_write(
+    const char*             file_name,
+    int                     num_rows,
+    int                     num_cols,
+    const struct ssa_c_csr* matrix,
+    int                     delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_csr_write: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        reinterpret_cast<const std::complex<float>*>(matrix->values),
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_c_csr_read(
+    const char*        file_name,
+    int*               num_rows,
+    int*               num_cols,
+    struct ssa_c_csr*  out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_csr_read: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_csr_read: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_c_csr_read");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_d_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_d_plan*        out_plan)
+{
+    if(!options || !out_plan)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_plan_create: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_plan_data<int, int, double>* plan = 0;
+
+    const bool success = ssa_plan_create_internal(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *options,
+        plan);
+
+    out_plan->num_rows       = success ? num_rows : 0;
+    out_plan->num_cols       = success ? num_cols : 0;
+    out_plan->num_updates    = 0;
+    out_plan->num_recomputes = 0;
+    out_plan->reserved       = plan;
+
+    return success ? 0 : 1;
+}
+
+int ssa_d_plan_update(
+    struct ssa_d_plan* plan,
+    int                rank,
+    const double*      U_col_values,
+    int                U_col_leading_dim,
+    const double*      V_col_values,
+    int                V_col_leading_dim)
+{
+    if(!plan || !plan->reserved)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_plan_update: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    bool recomputed = false;
+
+    const bool success = ssa_plan_update_internal(
+        *const_cast<ssa_plan_data<int, int, double>*>(
+            reinterpret_cast<const ssa_plan_data<int, int, double>*>(plan->reserved)),
+        rank,
+        U_col_values, U_col_leading_dim,
+        V_col_values, V_col_leading_dim,
+        recomputed);
+
+    if(success)
+    {
+        if(recomputed)
+            ++plan->num_recomputes;
+        else
+            ++plan->num_updates;
+    }
+
+    return success ? 0 : 1;
+}
+
+int ssa_d_plan_lpn(
+    struct ssa_d_plan*        plan,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_d_csr*         out_matrix)
+{
+    if(!plan || !plan->reserved || !options || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_plan_lpn: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_plan_data<int, int, double>* plan_data =
+        const_cast<ssa_plan_data<int, int, double>*>(
+            reinterpret_cast<const ssa_plan_data<int, int, double>*>(plan->reserved));
+
+    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_plan_lpn: Memory allocation failed.");
+        return 1;
+    }
+
+    const bool success = ssa_lpn_internal(
+        plan_data->num_rows, plan_data->num_cols,
+        plan_data->A.vec_values(), plan_data->A.leading_dimension(),
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        plan_data->impose_null_spaces,
+        plan_data->matrix_type,
+        *options,
+        *csr,
+        plan_data);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return success ? 0 : 1;
+}
+
+void ssa_d_plan_deallocate(struct ssa_d_plan* plan)
+{
+    if(plan)
+    {
+        plan->num_rows = 0;
+        plan->num_cols = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_plan_data<int, int, double>*>(
+                    plan->reserved), "ssa_d_plan_deallocate");
+
+        plan->reserved = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int ssa_s_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_s_plan*        out_plan)
+{
+    if(!options || !out_plan)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_plan_create: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_plan_data<int, int, float>* plan = 0;
+
+    const bool success = ssa_plan_create_internal(
+        num_rows, num_cols,
+        col_values, col_leading_dim,
+        impose_null_spaces == 0 ? false : true,
+        matrix_type,
+        *options,
+        plan);
+
+    out_plan->num_rows       = success ? num_rows : 0;
+    out_plan->num_cols       = success ? num_cols : 0;
+    out_plan->num_updates    = 0;
+    out_plan->num_recomputes = 0;
+    out_plan->reserved       = plan;
+
+    return success ? 0 : 1;
+}
+
+int ssa_s_plan_update(
+    struct ssa_s_plan* plan,
+    int                rank,
+    const float*       U_col_values,
+    int                U_col_leading_dim,
+    const float*       V_col_values,
+    int                V_col_leading_dim)
+{
+    if(!plan || !plan->reserved)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_plan_update: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    bool recomputed = false;
+
+    const bool success = ssa_plan_update_internal(
+        *const_cast<ssa_plan_data<int, int, float>*>(
+            reinterpret_cast<const ssa_plan_data<int, int, float>*>(plan->reserved)),
+        rank,
+        U_col_values, U_col_leading_dim,
+        V_col_values, V_col_leading_dim,
+        recomputed);
+
+    if(success)
+    {
+        if(recomputed)
+            ++plan->num_recomputes;
+        else
+            ++plan->num_updates;
+    }
+
+    return success ? 0 : 1;
+}
+
+int ssa_s_plan_lpn(
+    struct ssa_s_plan*        plan,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_s_csr*         out_matrix)
+{
+    if(!plan || !plan->reserved || !options || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_plan_lpn: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_plan_data<int, int, float>* plan_data =
+        const_cast<ssa_plan_data<int, int, float>*>(
+            reinterpret_cast<const ssa_plan_data<int, int, float>*>(plan->reserved));
+
+    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_plan_lpn: Memory allocation failed.");
+        return 1;
+    }
+
+    const bool success = ssa_lpn_internal(
+        plan_data->num_rows, plan_data->num_cols,
+        plan_data->A.vec_values(), plan_data->A.leading_dimension(),
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        plan_data->impose_null_spaces,
+        plan_data->matrix_type,
+        *options,
+        *csr,
+        plan_data);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return success ? 0 : 1;
+}
+
+void ssa_s_plan_deallocate(struct ssa_s_plan* plan)
+{
+    if(plan)
+    {
+        plan->num_rows = 0;
+        plan->num_cols = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_plan_data<int, int, float>*>(
+                    plan->reserved), "ssa_s_plan_deallocate");
 
-    return success ? 0 : 1;
+        plan->reserved = 0;
+    }
 }
 
 // -----------------------------------------------------------------------------
 
-template
-<
-    typename index_type,
-    typename offset_type,
-    typename value_type
->
-int ssa_lpn(
-    index_type           num_rows,
-    index_type           num_cols,
-    const value_type*    col_values,
-    index_type           col_leading_dim,
-    value_type           sparsity_ratio,
-    value_type           sparsity_norm_p,
-    offset_type          max_num_bins,
-    bool                 impose_null_spaces,
-    enum ssa_matrix_type matrix_type,
-    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+int ssa_z_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const double*             col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_z_plan*        out_plan)
 {
-    bool success = ssa_lpn_internal<index_type, offset_type, value_type>(
+    if(!options || !out_plan)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_plan_create: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_plan_data<int, int, std::complex<double> >* plan = 0;
+
+    const bool success = ssa_plan_create_internal(
         num_rows, num_cols,
-        col_values, col_leading_dim,
-        sparsity_ratio, sparsity_norm_p,
-        max_num_bins,
-        impose_null_spaces,
+        reinterpret_cast<const std::complex<double>*>(col_values), col_leading_dim,
+        impose_null_spaces == 0 ? false : true,
         matrix_type,
-        out_matrix);
+        *options,
+        plan);
 
-    if(!success)
+    out_plan->num_rows       = success ? num_rows : 0;
+    out_plan->num_cols       = success ? num_cols : 0;
+    out_plan->num_updates    = 0;
+    out_plan->num_recomputes = 0;
+    out_plan->reserved       = plan;
+
+    return success ? 0 : 1;
+}
+
+int ssa_z_plan_update(
+    struct ssa_z_plan* plan,
+    int                rank,
+    const double*      U_col_values,
+    int                U_col_leading_dim,
+    const double*      V_col_values,
+    int                V_col_leading_dim)
+{
+    if(!plan || !plan->reserved)
     {
         assert(false);
-        internal_api_error_set_last(
-            "ssa_lpn: Error in real version");
+        internal_api_error_set_last("ssa_z_plan_update: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    bool recomputed = false;
+
+    const bool success = ssa_plan_update_internal(
+        *const_cast<ssa_plan_data<int, int, std::complex<double> >*>(
+            reinterpret_cast<const ssa_plan_data<int, int, std::complex<double> >*>(plan->reserved)),
+        rank,
+        reinterpret_cast<const std::complex<double>*>(U_col_values), U_col_leading_dim,
+        reinterpret_cast<const std::complex<double>*>(V_col_values), V_col_leading_dim,
+        recomputed);
+
+    if(success)
+    {
+        if(recomputed)
+            ++plan->num_recomputes;
+        else
+            ++plan->num_updates;
     }
 
     return success ? 0 : 1;
 }
 
-template
-<
-    typename index_type,
-    typename offset_type,
-    typename scalar_type
->
-int ssa_lpn(
-    index_type                       num_rows,
-    index_type                       num_cols,
-    const std::complex<scalar_type>* col_values,
-    index_type                       col_leading_dim,
-    scalar_type                      sparsity_ratio,
-    scalar_type                      sparsity_norm_p,
-    offset_type                      max_num_bins,
-    bool                             impose_null_spaces,
-    enum ssa_matrix_type             matrix_type,
-    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix)
+int ssa_z_plan_lpn(
+    struct ssa_z_plan*        plan,
+    double                    sparsity_ratio,
+    double                    sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_z_csr*         out_matrix)
 {
-    bool success = ssa_lpn_internal<index_type, offset_type, std::complex<scalar_type> >(
-        num_rows, num_cols,
-        col_values, col_leading_dim,
-        sparsity_ratio, sparsity_norm_p,
-        max_num_bins,
-        impose_null_spaces,
-        matrix_type,
-        out_matrix);
+    if(!plan || !plan->reserved || !options || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_plan_lpn: Unacceptable input argument(s).");
+        return 1;
+    }
 
-    if(!success)
+    ssa_plan_data<int, int, std::complex<double> >* plan_data =
+        const_cast<ssa_plan_data<int, int, std::complex<double> >*>(
+            reinterpret_cast<const ssa_plan_data<int, int, std::complex<double> >*>(plan->reserved));
+
+    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+
+    if(!csr)
     {
         assert(false);
-        internal_api_error_set_last(
-            "ssa_lpn: Error in complex version");
+        internal_api_error_set_last("ssa_z_plan_lpn: Memory allocation failed.");
+        return 1;
     }
 
+    const bool success = ssa_lpn_internal(
+        plan_data->num_rows, plan_data->num_cols,
+        plan_data->A.vec_values(), plan_data->A.leading_dimension(),
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        plan_data->impose_null_spaces,
+        plan_data->matrix_type,
+        *options,
+        *csr,
+        plan_data);
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
     return success ? 0 : 1;
 }
 
+void ssa_z_plan_deallocate(struct ssa_z_plan* plan)
+{
+    if(plan)
+    {
+        plan->num_rows = 0;
+        plan->num_cols = 0;
+
+        delete_catch(
+            reinterpret_cast<
+                const ssa_plan_data<int, int, std::complex<double> >*>(
+                    plan->reserved), "ssa_z_plan_deallocate");
+
+        plan->reserved = 0;
+    }
+}
 
 // -----------------------------------------------------------------------------
 
-template
-<
-    typename index_type,
-    typename offset_type,
-    typename value_type
->
-int ssa_ids(
-    index_type           num_rows,
-    index_type           num_cols,
-    const value_type*    col_values,
-    index_type           col_leading_dim,
-    value_type           sparsity_ratio,
-    value_type           sparsity_norm_p,
-    index_type           min_num_nnz_per_row,
-    index_type           min_num_nnz_per_col,
-    enum ssa_matrix_type matrix_type,
-    ssa_csr<index_type, offset_type, value_type>& out_matrix)
+int ssa_c_plan_create(
+    int                       num_rows,
+    int                       num_cols,
+    const float*              col_values,
+    int                       col_leading_dim,
+    int                       impose_null_spaces,
+    enum ssa_matrix_type      matrix_type,
+    const struct ssa_options* options,
+    struct ssa_c_plan*        out_plan)
 {
-    bool success = ssa_ids_internal<index_type, offset_type, value_type>(
+    if(!options || !out_plan)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_plan_create: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_plan_data<int, int, std::complex<float> >* plan = 0;
+
+    const bool success = ssa_plan_create_internal(
         num_rows, num_cols,
-        col_values, col_leading_dim,
-        sparsity_ratio, sparsity_norm_p,
-        min_num_nnz_per_row, min_num_nnz_per_col,
+        reinterpret_cast<const std::complex<float>*>(col_values), col_leading_dim,
+        impose_null_spaces == 0 ? false : true,
         matrix_type,
-        out_matrix);
+        *options,
+        plan);
 
-    if(!success)
+    out_plan->num_rows       = success ? num_rows : 0;
+    out_plan->num_cols       = success ? num_cols : 0;
+    out_plan->num_updates    = 0;
+    out_plan->num_recomputes = 0;
+    out_plan->reserved       = plan;
+
+    return success ? 0 : 1;
+}
+
+int ssa_c_plan_update(
+    struct ssa_c_plan* plan,
+    int                rank,
+    const float*       U_col_values,
+    int                U_col_leading_dim,
+    const float*       V_col_values,
+    int                V_col_leading_dim)
+{
+    if(!plan || !plan->reserved)
     {
         assert(false);
-        internal_api_error_set_last(
-            "ssa_ids: Error in real version");
+        internal_api_error_set_last("ssa_c_plan_update: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    bool recomputed = false;
+
+    const bool success = ssa_plan_update_internal(
+        *const_cast<ssa_plan_data<int, int, std::complex<float> >*>(
+            reinterpret_cast<const ssa_plan_data<int, int, std::complex<float> >*>(plan->reserved)),
+        rank,
+        reinterpret_cast<const std::complex<float>*>(U_col_values), U_col_leading_dim,
+        reinterpret_cast<const std::complex<float>*>(V_col_values), V_col_leading_dim,
+        recomputed);
+
+    if(success)
+    {
+        if(recomputed)
+            ++plan->num_recomputes;
+        else
+            ++plan->num_updates;
     }
 
     return success ? 0 : 1;
 }
 
-template
-<
-    typename index_type,
-    typename offset_type,
-    typename scalar_type
->
-int ssa_ids(
-    index_type           num_rows,
-    index_type           num_cols,
-    const std::complex<scalar_type>* col_values,
-    index_type           col_leading_dim,
-    scalar_type          sparsity_ratio,
-    scalar_type          sparsity_norm_p,
-    index_type           min_num_nnz_per_row,
-    index_type           min_num_nnz_per_col,
-    enum ssa_matrix_type matrix_type,
-    ssa_csr<index_type, offset_type, std::complex<scalar_type> >& out_matrix)
+int ssa_c_plan_lpn(
+    struct ssa_c_plan*        plan,
+    float                     sparsity_ratio,
+    float                     sparsity_norm_p,
+    int                       max_num_bins,
+    const struct ssa_options* options,
+    struct ssa_c_csr*         out_matrix)
 {
-    bool success = ssa_ids_internal<index_type, offset_type, std::complex<scalar_type> >(
-        num_rows, num_cols,
-        col_values, col_leading_dim,
-        sparsity_ratio, sparsity_norm_p,
-        min_num_nnz_per_row, min_num_nnz_per_col,
-        matrix_type,
-        out_matrix);
+    if(!plan || !plan->reserved || !options || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_plan_lpn: Unacceptable input argument(s).");
+        return 1;
+    }
 
-    if(!success)
+    ssa_plan_data<int, int, std::complex<float> >* plan_data =
+        const_cast<ssa_plan_data<int, int, std::complex<float> >*>(
+            reinterpret_cast<const ssa_plan_data<int, int, std::complex<float> >*>(plan->reserved));
+
+    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+
+    if(!csr)
     {
         assert(false);
-        internal_api_error_set_last(
-            "ssa_ids: Error in complex version");
+        internal_api_error_set_last("ssa_c_plan_lpn: Memory allocation failed.");
+        return 1;
     }
 
-    return success ? 0 : 1;
-}
+    const bool success = ssa_lpn_internal(
+        plan_data->num_rows, plan_data->num_cols,
+        plan_data->A.vec_values(), plan_data->A.leading_dimension(),
+        sparsity_ratio, sparsity_norm_p,
+        max_num_bins,
+        plan_data->impose_null_spaces,
+        plan_data->matrix_type,
+        *options,
+        *csr,
+        plan_data);
 
-// -----------------------------------------------------------------------------
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
 
-int ssa_error_size()
-{
-    return internal_api_error_size();
+    return success ? 0 : 1;
 }
 
-int ssa_error_string(int i, const char** ptr_to_error_string)
+void ssa_c_plan_deallocate(struct ssa_c_plan* plan)
 {
-    return internal_api_error_string(i, ptr_to_error_string);
-}
+    if(plan)
+    {
+        plan->num_rows = 0;
+        plan->num_cols = 0;
 
-int ssa_error_clear()
-{
-    return internal_api_error_clear();
+        delete_catch(
+            reinterpret_cast<
+                const ssa_plan_data<int, int, std::complex<float> >*>(
+                    plan->reserved), "ssa_c_plan_deallocate");
+
+        plan->reserved = 0;
+    }
 }
 
 // -----------------------------------------------------------------------------
 
+// 64-bit index versions of the C APIs above.
+
 /* User-given pattern */
-int ssa_d_pat(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_d_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const double*        col_values,
-    int                  col_leading_dim,
-    const int*           row_offsets,
-    const int*           column_ids,
-    int                  max_num_bins,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
     double*              out_row_values)
@@ -1119,24 +4749,24 @@ int ssa_d_pat(
 }
 
 /* User-given parameters for computing L_p norm based pattern. */
-int ssa_d_lpn(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_d_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const double*        col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     double               sparsity_ratio,
     double               sparsity_norm_p,
-    int                  max_num_bins,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
-    struct ssa_d_csr*    out_matrix)
+    struct ssa_d_csr64*  out_matrix)
 {
-    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+    ssa_csr<ssa_index64, ssa_index64, double>* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, double>;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_d_lpn: Memory allocation failed.");
+        internal_api_error_set_last("ssa_d_lpn64: Memory allocation failed.");
         return 1;
     }
 
@@ -1157,24 +4787,24 @@ int ssa_d_lpn(
     return ret;
 }
 
-int ssa_d_ids(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_d_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const double*        col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     double               sparsity_ratio,
     double               sparsity_norm_p,
-    int                  min_num_nnz_per_row,
-    int                  min_num_nnz_per_col,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
     enum ssa_matrix_type matrix_type,
-    struct ssa_d_csr*    out_matrix)
+    struct ssa_d_csr64*  out_matrix)
 {
-    ssa_csr<int, int, double>* csr = new (std::nothrow) ssa_csr<int, int, double>;
+    ssa_csr<ssa_index64, ssa_index64, double>* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, double>;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_d_ids: Memory allocation failed.");
+        internal_api_error_set_last("ssa_d_ids64: Memory allocation failed.");
         return 1;
     }
 
@@ -1196,14 +4826,14 @@ int ssa_d_ids(
 
 // -----------------------------------------------------------------------------
 
-int ssa_s_pat(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_s_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const float*         col_values,
-    int                  col_leading_dim,
-    const int*           row_offsets,
-    const int*           column_ids,
-    int                  max_num_bins,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
     float*               out_row_values)
@@ -1220,24 +4850,24 @@ int ssa_s_pat(
     return ret;
 }
 
-int ssa_s_lpn(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_s_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const float*         col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     float                sparsity_ratio,
     float                sparsity_norm_p,
-    int                  max_num_bins,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
-    struct ssa_s_csr*    out_matrix)
+    struct ssa_s_csr64*  out_matrix)
 {
-    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+    ssa_csr<ssa_index64, ssa_index64, float>* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, float>;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_s_lpn: Memory allocation failed.");
+        internal_api_error_set_last("ssa_s_lpn64: Memory allocation failed.");
         return 1;
     }
 
@@ -1258,24 +4888,24 @@ int ssa_s_lpn(
     return ret;
 }
 
-int ssa_s_ids(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_s_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const float*         col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     float                sparsity_ratio,
     float                sparsity_norm_p,
-    int                  min_num_nnz_per_row,
-    int                  min_num_nnz_per_col,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
     enum ssa_matrix_type matrix_type,
-    struct ssa_s_csr*    out_matrix)
+    struct ssa_s_csr64*  out_matrix)
 {
-    ssa_csr<int, int, float>* csr = new (std::nothrow) ssa_csr<int, int, float>;
+    ssa_csr<ssa_index64, ssa_index64, float>* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, float>;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_s_ids: Memory allocation failed.");
+        internal_api_error_set_last("ssa_s_ids64: Memory allocation failed.");
         return 1;
     }
 
@@ -1297,19 +4927,19 @@ int ssa_s_ids(
 
 // -----------------------------------------------------------------------------
 
-int ssa_z_pat(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_z_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const double*        col_values,
-    int                  col_leading_dim,
-    const int*           row_offsets,
-    const int*           column_ids,
-    int                  max_num_bins,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
     double*              out_row_values)
 {
-    int ret = ssa_pat<int,int,std::complex<double> >(
+    int ret = ssa_pat<ssa_index64,ssa_index64,std::complex<double> >(
         num_rows, num_cols,
         reinterpret_cast<const std::complex<double>*>(col_values), col_leading_dim,
         row_offsets, column_ids,
@@ -1321,24 +4951,24 @@ int ssa_z_pat(
     return ret;
 }
 
-int ssa_z_lpn(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_z_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const double*        col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     double               sparsity_ratio,
     double               sparsity_norm_p,
-    int                  max_num_bins,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
-    struct ssa_z_csr*    out_matrix)
+    struct ssa_z_csr64*  out_matrix)
 {
-    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+    ssa_csr<ssa_index64, ssa_index64, std::complex<double> >* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, std::complex<double> >;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_z_lpn: Memory allocation failed.");
+        internal_api_error_set_last("ssa_z_lpn64: Memory allocation failed.");
         return 1;
     }
 
@@ -1359,24 +4989,24 @@ int ssa_z_lpn(
     return ret;
 }
 
-int ssa_z_ids(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_z_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const double*        col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     double               sparsity_ratio,
     double               sparsity_norm_p,
-    int                  min_num_nnz_per_row,
-    int                  min_num_nnz_per_col,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
     enum ssa_matrix_type matrix_type,
-    struct ssa_z_csr*    out_matrix)
+    struct ssa_z_csr64*  out_matrix)
 {
-    ssa_csr<int, int, std::complex<double> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<double> >;
+    ssa_csr<ssa_index64, ssa_index64, std::complex<double> >* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, std::complex<double> >;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_z_ids: Memory allocation failed.");
+        internal_api_error_set_last("ssa_z_ids64: Memory allocation failed.");
         return 1;
     }
 
@@ -1398,19 +5028,19 @@ int ssa_z_ids(
 
 // -----------------------------------------------------------------------------
 
-int ssa_c_pat(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_c_pat64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const float*         col_values,
-    int                  col_leading_dim,
-    const int*           row_offsets,
-    const int*           column_ids,
-    int                  max_num_bins,
+    ssa_index64          col_leading_dim,
+    const ssa_index64*   row_offsets,
+    const ssa_index64*   column_ids,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
     float*               out_row_values)
 {
-    int ret = ssa_pat<int,int,std::complex<float> >(
+    int ret = ssa_pat<ssa_index64,ssa_index64,std::complex<float> >(
         num_rows, num_cols,
         reinterpret_cast<const std::complex<float>*>(col_values), col_leading_dim,
         row_offsets, column_ids,
@@ -1422,24 +5052,24 @@ int ssa_c_pat(
     return ret;
 }
 
-int ssa_c_lpn(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_c_lpn64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const float*         col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     float                sparsity_ratio,
     float                sparsity_norm_p,
-    int                  max_num_bins,
+    ssa_index64          max_num_bins,
     int                  impose_null_spaces,
     enum ssa_matrix_type matrix_type,
-    struct ssa_c_csr*    out_matrix)
+    struct ssa_c_csr64*  out_matrix)
 {
-    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+    ssa_csr<ssa_index64, ssa_index64, std::complex<float> >* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, std::complex<float> >;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_c_lpn: Memory allocation failed.");
+        internal_api_error_set_last("ssa_c_lpn64: Memory allocation failed.");
         return 1;
     }
 
@@ -1460,24 +5090,24 @@ int ssa_c_lpn(
     return ret;
 }
 
-int ssa_c_ids(
-    int                  num_rows,
-    int                  num_cols,
+int ssa_c_ids64(
+    ssa_index64          num_rows,
+    ssa_index64          num_cols,
     const float*         col_values,
-    int                  col_leading_dim,
+    ssa_index64          col_leading_dim,
     float                sparsity_ratio,
     float                sparsity_norm_p,
-    int                  min_num_nnz_per_row,
-    int                  min_num_nnz_per_col,
+    ssa_index64          min_num_nnz_per_row,
+    ssa_index64          min_num_nnz_per_col,
     enum ssa_matrix_type matrix_type,
-    struct ssa_c_csr*    out_matrix)
+    struct ssa_c_csr64*  out_matrix)
 {
-    ssa_csr<int, int, std::complex<float> >* csr = new (std::nothrow) ssa_csr<int, int, std::complex<float> >;
+    ssa_csr<ssa_index64, ssa_index64, std::complex<float> >* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, std::complex<float> >;
 
     if(!csr)
     {
         assert(false);
-        internal_api_error_set_last("ssa_c_ids: Memory allocation failed.");
+        internal_api_error_set_last("ssa_c_ids64: Memory allocation failed.");
         return 1;
     }
 
@@ -1499,7 +5129,7 @@ int ssa_c_ids(
 
 // -----------------------------------------------------------------------------
 
-void ssa_d_csr_deallocate(struct ssa_d_csr* matrix)
+void ssa_d_csr_deallocate64(struct ssa_d_csr64* matrix)
 {
     if(matrix)
     {
@@ -1509,14 +5139,14 @@ void ssa_d_csr_deallocate(struct ssa_d_csr* matrix)
 
         delete_catch(
             reinterpret_cast<
-                const ssa_csr<int, int, double>*>(
-                    matrix->reserved), "ssa_d_csr_deallocate");
+                const ssa_csr<ssa_index64, ssa_index64, double>*>(
+                    matrix->reserved), "ssa_d_csr_deallocate64");
 
         matrix->reserved = 0;
     }
 }
 
-void ssa_s_csr_deallocate(struct ssa_s_csr* matrix)
+void ssa_s_csr_deallocate64(struct ssa_s_csr64* matrix)
 {
     if(matrix)
     {
@@ -1526,14 +5156,14 @@ void ssa_s_csr_deallocate(struct ssa_s_csr* matrix)
 
         delete_catch(
             reinterpret_cast<
-                const ssa_csr<int, int, float>*>(
-                    matrix->reserved), "ssa_s_csr_deallocate");
+                const ssa_csr<ssa_index64, ssa_index64, float>*>(
+                    matrix->reserved), "ssa_s_csr_deallocate64");
 
         matrix->reserved = 0;
     }
 }
 
-void ssa_z_csr_deallocate(struct ssa_z_csr* matrix)
+void ssa_z_csr_deallocate64(struct ssa_z_csr64* matrix)
 {
     if(matrix)
     {
@@ -1543,14 +5173,14 @@ void ssa_z_csr_deallocate(struct ssa_z_csr* matrix)
 
         delete_catch(
             reinterpret_cast<
-                const ssa_csr<int, int, std::complex<double> >*>(
-                    matrix->reserved), "ssa_z_csr_deallocate");
+                const ssa_csr<ssa_index64, ssa_index64, std::complex<double> >*>(
+                    matrix->reserved), "ssa_z_csr_deallocate64");
 
         matrix->reserved = 0;
     }
 }
 
-void ssa_c_csr_deallocate(struct ssa_c_csr* matrix)
+void ssa_c_csr_deallocate64(struct ssa_c_csr64* matrix)
 {
     if(matrix)
     {
@@ -1560,13 +5190,263 @@ void ssa_c_csr_deallocate(struct ssa_c_csr* matrix)
 
         delete_catch(
             reinterpret_cast<
-                const ssa_csr<int, int, std::complex<float> >*>(
-                    matrix->reserved), "ssa_c_csr_deallocate");
+                const ssa_csr<ssa_index64, ssa_index64, std::complex<float> >*>(
+                    matrix->reserved), "ssa_c_csr_deallocate64");
 
         matrix->reserved = 0;
     }
 }
 
+// -----------------------------------------------------------------------------
+
+int ssa_d_csr_write64(
+    const char*               file_name,
+    ssa_index64               num_rows,
+    ssa_index64               num_cols,
+    const struct ssa_d_csr64* matrix,
+    int                       delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_csr_write64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        matrix->values,
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_d_csr_read64(
+    const char*         file_name,
+    ssa_index64*        num_rows,
+    ssa_index64*        num_cols,
+    struct ssa_d_csr64* out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_csr_read64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<ssa_index64, ssa_index64, double>* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, double>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_d_csr_read64: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_d_csr_read64");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_s_csr_write64(
+    const char*               file_name,
+    ssa_index64               num_rows,
+    ssa_index64               num_cols,
+    const struct ssa_s_csr64* matrix,
+    int                       delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_csr_write64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        matrix->values,
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_s_csr_read64(
+    const char*         file_name,
+    ssa_index64*        num_rows,
+    ssa_index64*        num_cols,
+    struct ssa_s_csr64* out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_csr_read64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<ssa_index64, ssa_index64, float>* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, float>;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_s_csr_read64: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_s_csr_read64");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = csr->values;
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_z_csr_write64(
+    const char*               file_name,
+    ssa_index64               num_rows,
+    ssa_index64               num_cols,
+    const struct ssa_z_csr64* matrix,
+    int                       delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_csr_write64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        reinterpret_cast<const std::complex<double>*>(matrix->values),
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_z_csr_read64(
+    const char*         file_name,
+    ssa_index64*        num_rows,
+    ssa_index64*        num_cols,
+    struct ssa_z_csr64* out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_csr_read64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<ssa_index64, ssa_index64, std::complex<double> >* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, std::complex<double> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_z_csr_read64: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_z_csr_read64");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<double*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
+int ssa_c_csr_write64(
+    const char*               file_name,
+    ssa_index64               num_rows,
+    ssa_index64               num_cols,
+    const struct ssa_c_csr64* matrix,
+    int                       delta_encode_ids)
+{
+    if(!matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_csr_write64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    int ret = ssa_csr_write(
+        file_name,
+        num_rows, num_cols,
+        matrix->row_offsets, matrix->column_ids,
+        reinterpret_cast<const std::complex<float>*>(matrix->values),
+        delta_encode_ids == 0 ? false : true);
+
+    return ret;
+}
+
+int ssa_c_csr_read64(
+    const char*         file_name,
+    ssa_index64*        num_rows,
+    ssa_index64*        num_cols,
+    struct ssa_c_csr64* out_matrix)
+{
+    if(!num_rows || !num_cols || !out_matrix)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_csr_read64: Unacceptable input argument(s).");
+        return 1;
+    }
+
+    ssa_csr<ssa_index64, ssa_index64, std::complex<float> >* csr = new (std::nothrow) ssa_csr<ssa_index64, ssa_index64, std::complex<float> >;
+
+    if(!csr)
+    {
+        assert(false);
+        internal_api_error_set_last("ssa_c_csr_read64: Memory allocation failed.");
+        return 1;
+    }
+
+    int ret = ssa_csr_read(file_name, *num_rows, *num_cols, *csr);
+
+    if(ret != 0)
+    {
+        delete_catch(csr, "ssa_c_csr_read64");
+        return ret;
+    }
+
+    out_matrix->row_offsets = csr->row_offsets;
+    out_matrix->column_ids  = csr->column_ids;
+    out_matrix->values      = reinterpret_cast<float*>(csr->values);
+    out_matrix->reserved    = csr;
+
+    return ret;
+}
+
 // -----------------------------------------------------------------------------
 // instantiate the template functions explicitly.
 
@@ -1620,6 +5500,58 @@ template TXSSA_API int ssa_lpn<index, offset, scalar>(         \
     enum ssa_matrix_type matrix_type,                          \
     ssa_csr<index, offset, std::complex<scalar> >& out_matrix)
 
+#define SSA_INSTANTIATE_LPN_OPT(index, offset, scalar)         \
+template TXSSA_API int ssa_lpn<index, offset, scalar>(         \
+    index           num_rows,                                  \
+    index           num_cols,                                  \
+    const scalar*   col_values,                                \
+    index           col_leading_dim,                           \
+    scalar          sparsity_ratio,                            \
+    scalar          sparsity_norm_p,                           \
+    offset          max_num_bins,                              \
+    bool            impose_null_spaces,                        \
+    enum ssa_matrix_type matrix_type,                          \
+    const ssa_options& options,                                \
+    ssa_csr<index, offset, scalar>& out_matrix);               \
+template TXSSA_API int ssa_lpn<index, offset, scalar>(         \
+    index           num_rows,                                  \
+    index           num_cols,                                  \
+    const std::complex<scalar>* col_values,                    \
+    index           col_leading_dim,                           \
+    scalar          sparsity_ratio,                            \
+    scalar          sparsity_norm_p,                           \
+    offset          max_num_bins,                              \
+    bool            impose_null_spaces,                        \
+    enum ssa_matrix_type matrix_type,                          \
+    const ssa_options& options,                                \
+    ssa_csr<index, offset, std::complex<scalar> >& out_matrix)
+
+#define SSA_INSTANTIATE_LPN_CSR(index, offset, scalar)         \
+template TXSSA_API int ssa_lpn_csr<index, offset, scalar>(     \
+    index           num_rows,                                  \
+    index           num_cols,                                  \
+    const offset*   row_offsets,                               \
+    const index*    column_ids,                                \
+    const scalar*   values,                                    \
+    scalar          sparsity_ratio,                            \
+    scalar          sparsity_norm_p,                           \
+    offset          max_num_bins,                              \
+    bool            impose_null_spaces,                        \
+    enum ssa_matrix_type matrix_type,                          \
+    ssa_csr<index, offset, scalar>& out_matrix);               \
+template TXSSA_API int ssa_lpn_csr<index, offset, scalar>(     \
+    index           num_rows,                                  \
+    index           num_cols,                                  \
+    const offset*   row_offsets,                               \
+    const index*    column_ids,                                \
+    const std::complex<scalar>* values,                        \
+    scalar          sparsity_ratio,                            \
+    scalar          sparsity_norm_p,                           \
+    offset          max_num_bins,                              \
+    bool            impose_null_spaces,                        \
+    enum ssa_matrix_type matrix_type,                          \
+    ssa_csr<index, offset, std::complex<scalar> >& out_matrix)
+
 #define SSA_INSTANTIATE_IDS(index, offset, scalar)             \
 template TXSSA_API int ssa_ids<index, offset, scalar>(         \
     index           num_rows,                                  \
@@ -1650,13 +5582,47 @@ template TXSSA_API int ssa_ids<index, offset, scalar>(         \
     template ssa_csr<index, offset, std::complex<scalar> >::ssa_csr();   \
     template ssa_csr<index, offset, std::complex<scalar> >::~ssa_csr()
 
+#define SSA_INSTANTIATE_CSR_FILE(index, offset, scalar)                  \
+template TXSSA_API int ssa_csr_write<index, offset, scalar>(             \
+    const char*     file_name,                                           \
+    index           num_rows,                                            \
+    index           num_cols,                                            \
+    const offset*   row_offsets,                                         \
+    const index*    column_ids,                                          \
+    const scalar*   values,                                              \
+    bool            delta_encode_ids);                                   \
+template TXSSA_API int ssa_csr_read<index, offset, scalar>(              \
+    const char*     file_name,                                           \
+    index&          num_rows,                                            \
+    index&          num_cols,                                            \
+    ssa_csr<index, offset, scalar>& out_matrix);                         \
+template TXSSA_API int ssa_csr_write<index, offset, std::complex<scalar> >(  \
+    const char*     file_name,                                           \
+    index           num_rows,                                            \
+    index           num_cols,                                            \
+    const offset*   row_offsets,                                         \
+    const index*    column_ids,                                          \
+    const std::complex<scalar>* values,                                  \
+    bool            delta_encode_ids);                                   \
+template TXSSA_API int ssa_csr_read<index, offset, std::complex<scalar> >(   \
+    const char*     file_name,                                           \
+    index&          num_rows,                                            \
+    index&          num_cols,                                            \
+    ssa_csr<index, offset, std::complex<scalar> >& out_matrix)
+
 #define SSA_INSTANTIATE_PAT_LPN_IDS_CSR(index, offset, scalar)            \
         SSA_INSTANTIATE_PAT_LPN(index, offset, scalar);                   \
         SSA_INSTANTIATE_PAT_LPN(unsigned index, unsigned offset, scalar); \
+        SSA_INSTANTIATE_LPN_OPT(index, offset, scalar);                   \
+        SSA_INSTANTIATE_LPN_OPT(unsigned index, unsigned offset, scalar); \
+        SSA_INSTANTIATE_LPN_CSR(index, offset, scalar);                   \
+        SSA_INSTANTIATE_LPN_CSR(unsigned index, unsigned offset, scalar); \
         SSA_INSTANTIATE_IDS(index, offset, scalar);                       \
         SSA_INSTANTIATE_IDS(unsigned index, unsigned offset, scalar);     \
         SSA_INSTANTIATE_CSR(index, offset, scalar);                       \
-        SSA_INSTANTIATE_CSR(unsigned index, unsigned offset, scalar)
+        SSA_INSTANTIATE_CSR(unsigned index, unsigned offset, scalar);     \
+        SSA_INSTANTIATE_CSR_FILE(index, offset, scalar);                  \
+        SSA_INSTANTIATE_CSR_FILE(unsigned index, unsigned offset, scalar)
 
 #define SSA_INSTANTIATE_PAT_LPN_IDS_CSR_all_float(index, offset)          \
         SSA_INSTANTIATE_PAT_LPN_IDS_CSR(index, offset, float);            \
@@ -275,6 +275,7 @@ public:
 
     index_type inc(index_type i) const
     {
+        (void) i;
         assert(i < n_vecs);
 
         return index_type(1);
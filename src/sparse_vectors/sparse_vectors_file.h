@@ -0,0 +1,609 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+#ifndef SPARSE_VECTORS_FILE_H
+#define SPARSE_VECTORS_FILE_H
+
+// -----------------------------------------------------------------------------
+
+#include "sparse_vectors/sparse_vectors.h"
+#include "platform/file_mapping.h"
+#include "math/precision_traits.h"
+#include "internal_api_error/internal_api_error.h"
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstdio>     // std::{FILE, fopen, fwrite, fclose}
+#include <cstring>    // std::{memcmp, memcpy}
+#include <cstddef>
+#include <stdexcept>
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Objective: Write compressed sparse vectors (offsets, ids, and values) to a
+// binary file, and map such a file back as sparse_vectors without copying the
+// data.
+//
+// File layout.  Each section begins at a multiple of
+// sparse_vectors_file_alignment bytes from the beginning of the file.
+//
+//   header   sparse_vectors_file_header
+//   offsets  n_vecs + 1 values of offset_type
+//   ids      offsets[n_vecs] values of index_type, or header.ids_bytes bytes
+//            if the ids are delta encoded
+//   values   offsets[n_vecs] values of value_type
+//
+// Numbers are stored in the native representation of the writer.  A reader
+// with a different byte order or different type sizes refuses the file.
+//
+// Delta encoding stores the difference of each id from the previous id in the
+// same vector (the first id is stored as is).  Each difference is zig-zag
+// mapped to an unsigned number, so unsorted ids work too, and stored in
+// little-endian base-128 using as few bytes as needed.  Sorted ids of a
+// pattern with some locality mostly take one byte each.  Delta encoded ids are
+// decoded into memory by the reader.  Offsets and values are always used
+// directly from the mapped file.
+// -----------------------------------------------------------------------------
+
+struct sparse_vectors_file_header
+{
+    char               magic[8];
+    unsigned long long version;
+    unsigned long long byte_order;
+    unsigned long long flags;
+    unsigned long long index_size;
+    unsigned long long offset_size;
+    unsigned long long scalar_size;
+    unsigned long long is_complex;
+    unsigned long long n_vecs;
+    unsigned long long max_vec_size;
+    unsigned long long num_entries;
+    unsigned long long ids_bytes;
+};
+
+const char sparse_vectors_file_magic[8] = {'T','X','S','S','A','C','S','R'};
+
+const unsigned long long sparse_vectors_file_version      = 1;
+const unsigned long long sparse_vectors_file_byte_order   = 0x0102030405060708ULL;
+const unsigned long long sparse_vectors_file_flag_delta   = 1;
+const unsigned long long sparse_vectors_file_alignment    = 16;
+const std::size_t        sparse_vectors_file_buffer_size  = 1 << 16; // MAGIC CONSTANT
+
+// -----------------------------------------------------------------------------
+
+inline unsigned long long sparse_vectors_file_align(unsigned long long pos)
+{
+    const unsigned long long a = sparse_vectors_file_alignment;
+    return (pos + a - 1) / a * a;
+}
+
+inline bool sparse_vectors_file_write_bytes(
+    std::FILE* file,
+    const void* ptr,
+    std::size_t num_bytes,
+    unsigned long long& pos)
+{
+    const bool success =
+        num_bytes == 0 ||
+        std::fwrite(ptr, 1, num_bytes, file) == num_bytes;
+
+    pos += num_bytes;
+
+    return success;
+}
+
+inline bool sparse_vectors_file_write_padding(
+    std::FILE* file,
+    unsigned long long& pos)
+{
+    const char zeros[sparse_vectors_file_alignment] = {0};
+
+    return sparse_vectors_file_write_bytes(
+        file, zeros, std::size_t(sparse_vectors_file_align(pos) - pos), pos);
+}
+
+// Zig-zag mapping of difference id - prev, computed modulo 2^64.
+inline unsigned long long sparse_vectors_file_zigzag(
+    unsigned long long id,
+    unsigned long long prev)
+{
+    const unsigned long long d = id - prev;
+    return (d << 1) ^ (0 - (d >> 63));
+}
+
+inline unsigned long long sparse_vectors_file_unzigzag(
+    unsigned long long z,
+    unsigned long long prev)
+{
+    return prev + ((z >> 1) ^ (0 - (z & 1)));
+}
+
+// Returns number of bytes used.  buffer must have space for 10 bytes.
+inline std::size_t sparse_vectors_file_encode(
+    unsigned long long z,
+    unsigned char* buffer)
+{
+    std::size_t n = 0;
+
+    while(z >= 0x80)
+    {
+        buffer[n++] = static_cast<unsigned char>((z & 0x7F) | 0x80);
+        z >>= 7;
+    }
+
+    buffer[n++] = static_cast<unsigned char>(z);
+
+    return n;
+}
+
+// Returns false if encoded number does not end before end.
+inline bool sparse_vectors_file_decode(
+    const unsigned char*& it,
+    const unsigned char* end,
+    unsigned long long& z)
+{
+    z = 0;
+
+    for(unsigned int shift = 0; it != end && shift < 64; shift += 7)
+    {
+        const unsigned char byte = *it++;
+
+        z |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+
+        if(!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+template
+<
+    typename index_type,
+    typename offset_type,
+    typename value_type
+>
+bool sparse_vectors_file_write(
+    const char*        file_name,
+    index_type         n_vecs,
+    index_type         max_vec_size,
+    const offset_type* offsets,    // n_vecs + 1
+    const index_type*  ids,        // offsets[n_vecs]
+    const value_type*  values,     // offsets[n_vecs]
+    bool               delta_encode_ids)
+{
+    bool success =
+        file_name &&
+        offsets &&
+        offsets[0] == 0 &&
+        (ids || offsets[n_vecs] == 0) &&
+        (values || offsets[n_vecs] == 0);
+
+    if(!success)
+    {
+        assert(false);
+
+        internal_api_error_set_last(
+            "sparse_vectors_file_write: Unacceptable input argument(s).");
+
+        return false;
+    }
+
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const std::size_t num_entries = std::size_t(offsets[n_vecs]);
+
+    sparse_vectors_file_header header;
+
+    std::memcpy(header.magic, sparse_vectors_file_magic, sizeof(header.magic));
+
+    header.version      = sparse_vectors_file_version;
+    header.byte_order   = sparse_vectors_file_byte_order;
+    header.flags        = delta_encode_ids ? sparse_vectors_file_flag_delta : 0;
+    header.index_size   = sizeof(index_type);
+    header.offset_size  = sizeof(offset_type);
+    header.scalar_size  = sizeof(scalar_type);
+    header.is_complex   = sizeof(value_type) == sizeof(scalar_type) ? 0 : 1;
+    header.n_vecs       = static_cast<unsigned long long>(n_vecs);
+    header.max_vec_size = static_cast<unsigned long long>(max_vec_size);
+    header.num_entries  = num_entries;
+    header.ids_bytes    = static_cast<unsigned long long>(num_entries) * sizeof(index_type);
+
+    std::vector<unsigned char> buffer;
+
+    if(delta_encode_ids)
+    {
+        // First pass only to find the size, so that the header can be written
+        // before the ids and the file does not need to be revisited.
+
+        unsigned char tmp[16];
+
+        header.ids_bytes = 0;
+
+        for(index_type i = 0; i < n_vecs; ++i)
+        {
+            unsigned long long prev = 0;
+
+            for(offset_type k = offsets[i]; k < offsets[i + 1]; ++k)
+            {
+                const unsigned long long id = static_cast<unsigned long long>(ids[k]);
+                header.ids_bytes += sparse_vectors_file_encode(
+                    sparse_vectors_file_zigzag(id, prev), tmp);
+                prev = id;
+            }
+        }
+
+        try
+        {
+            buffer.resize(sparse_vectors_file_buffer_size + sizeof(tmp));
+        }
+        catch(const std::exception& exc)
+        {
+            assert(false);
+
+            internal_api_error_set_last(
+                (std::string("sparse_vectors_file_write: Exception. ") + exc.what()));
+
+            return false;
+        }
+    }
+
+    std::FILE* file = std::fopen(file_name, "wb");
+
+    if(!file)
+    {
+        internal_api_error_set_last(
+            std::string("sparse_vectors_file_write: Could not open file ") + file_name);
+
+        return false;
+    }
+
+    unsigned long long pos = 0;
+
+    success =
+        sparse_vectors_file_write_bytes(
+            file, &header, sizeof(header), pos) &&
+        sparse_vectors_file_write_padding(file, pos) &&
+        sparse_vectors_file_write_bytes(
+            file, offsets, (std::size_t(n_vecs) + 1) * sizeof(offset_type), pos) &&
+        sparse_vectors_file_write_padding(file, pos);
+
+    if(success)
+    {
+        if(delta_encode_ids)
+        {
+            std::size_t used = 0;
+
+            for(index_type i = 0; success && i < n_vecs; ++i)
+            {
+                unsigned long long prev = 0;
+
+                for(offset_type k = offsets[i]; success && k < offsets[i + 1]; ++k)
+                {
+                    const unsigned long long id = static_cast<unsigned long long>(ids[k]);
+
+                    used += sparse_vectors_file_encode(
+                        sparse_vectors_file_zigzag(id, prev), &buffer[used]);
+
+                    prev = id;
+
+                    if(sparse_vectors_file_buffer_size <= used)
+                    {
+                        success = sparse_vectors_file_write_bytes(
+                            file, &buffer.front(), used, pos);
+                        used = 0;
+                    }
+                }
+            }
+
+            success = success &&
+                sparse_vectors_file_write_bytes(file, &buffer.front(), used, pos);
+        }
+        else
+        {
+            success = sparse_vectors_file_write_bytes(
+                file, ids, num_entries * sizeof(index_type), pos);
+        }
+    }
+
+    success = success &&
+        sparse_vectors_file_write_padding(file, pos) &&
+        sparse_vectors_file_write_bytes(
+            file, values, num_entries * sizeof(value_type), pos);
+
+    // fclose also flushes, so it can fail too.
+    success = (std::fclose(file) == 0) && success;
+
+    if(!success)
+    {
+        internal_api_error_set_last(
+            std::string("sparse_vectors_file_write: Could not write file ") + file_name);
+    }
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// Find the beginning of the next section of count elements, each of size
+// elem_size, and check that it fits in file_size bytes.  pos is moved to the
+// end of the section.
+
+inline bool sparse_vectors_file_section(
+    unsigned long long& pos,
+    unsigned long long count,
+    unsigned long long elem_size,
+    unsigned long long file_size,
+    unsigned long long& section_begin)
+{
+    section_begin = sparse_vectors_file_align(pos);
+
+    const bool success =
+        section_begin <= file_size &&
+        count <= (file_size - section_begin) / elem_size;
+
+    if(success)
+        pos = section_begin + count * elem_size;
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+
+// sparse_vectors that use memory of a file mapping.  Pages not modified by the
+// user are never copied.  Modifications are private to the object and do not
+// change the file.
+
+template
+<
+    typename index_t,
+    typename offset_type,
+    typename value_t
+>
+class sparse_vectors_file_view :
+    public sparse_vectors<index_t, offset_type, value_t>
+{
+private:
+
+    typedef sparse_vectors<index_t, offset_type, value_t> base_type;
+
+public:
+
+    typedef value_t value_type;
+    typedef index_t index_type;
+
+    sparse_vectors_file_view()
+        :
+        base_type()
+    {
+    }
+
+    ~sparse_vectors_file_view()
+    {
+    }
+
+    // Ids and values of the vectors are not checked except for delta encoded
+    // ids, which have to be decoded anyway.
+    bool map(const char* file_name)
+    {
+        typedef typename precision_traits<value_type>::scalar scalar_type;
+
+        // C++ Idiom: Create temporary and swap
+
+        file_mapping tmp_mapping;
+
+        if(!file_name || !tmp_mapping.map(file_name))
+        {
+            internal_api_error_set_last(
+                "sparse_vectors_file_view::map: Could not map file.");
+
+            return false;
+        }
+
+        const unsigned long long file_size = tmp_mapping.size();
+
+        sparse_vectors_file_header header;
+
+        bool success = sizeof(header) <= file_size;
+
+        if(success)
+        {
+            std::memcpy(&header, tmp_mapping.data(), sizeof(header));
+
+            success =
+                std::memcmp(header.magic, sparse_vectors_file_magic, sizeof(header.magic)) == 0 &&
+                header.version     == sparse_vectors_file_version &&
+                header.byte_order  == sparse_vectors_file_byte_order &&
+                (header.flags & ~sparse_vectors_file_flag_delta) == 0 &&
+                header.index_size  == sizeof(index_type) &&
+                header.offset_size == sizeof(offset_type) &&
+                header.scalar_size == sizeof(scalar_type) &&
+                header.is_complex  == (sizeof(value_type) == sizeof(scalar_type) ? 0U : 1U) &&
+                header.n_vecs       <= static_cast<unsigned long long>(std::numeric_limits<index_type>::max()) &&
+                header.max_vec_size <= static_cast<unsigned long long>(std::numeric_limits<index_type>::max()) &&
+                header.num_entries  <= static_cast<unsigned long long>(std::numeric_limits<offset_type>::max());
+        }
+
+        if(!success)
+        {
+            internal_api_error_set_last(
+                std::string("sparse_vectors_file_view::map: Not a compatible file ") + file_name);
+
+            return false;
+        }
+
+        const bool is_delta = (header.flags & sparse_vectors_file_flag_delta) != 0;
+
+        unsigned long long pos = sizeof(header);
+        unsigned long long offsets_begin = 0, ids_begin = 0, values_begin = 0;
+
+        success =
+            sparse_vectors_file_section(pos,
+                header.n_vecs + 1, sizeof(offset_type), file_size, offsets_begin) &&
+            sparse_vectors_file_section(pos,
+                is_delta ? header.ids_bytes : header.num_entries,
+                is_delta ? 1 : sizeof(index_type), file_size, ids_begin) &&
+            sparse_vectors_file_section(pos,
+                header.num_entries, sizeof(value_type), file_size, values_begin);
+
+        const index_type n_vecs       = index_type(header.n_vecs);
+        const index_type max_vec_size = index_type(header.max_vec_size);
+
+        offset_type* tmp_offsets = reinterpret_cast<offset_type*>(
+            tmp_mapping.data() + offsets_begin);
+
+        // Check offsets.
+
+        if(success)
+        {
+            success = tmp_offsets[0] == 0 &&
+                static_cast<unsigned long long>(tmp_offsets[n_vecs]) == header.num_entries;
+
+            for(index_type i = 0; success && i < n_vecs; ++i)
+            {
+                success =
+                    tmp_offsets[i] <= tmp_offsets[i + 1] &&
+                    tmp_offsets[i + 1] - tmp_offsets[i] <= offset_type(max_vec_size);
+            }
+        }
+
+        std::vector<index_type> tmp_decoded_ids;
+
+        if(success && is_delta)
+        {
+            try
+            {
+                tmp_decoded_ids.resize(std::size_t(header.num_entries));
+            }
+            catch(const std::exception& exc)
+            {
+                assert(false);
+
+                internal_api_error_set_last(
+                    (std::string("sparse_vectors_file_view::map: Exception. ") + exc.what()));
+
+                return false;
+            }
+
+            const unsigned char* it = reinterpret_cast<const unsigned char*>(
+                tmp_mapping.data() + ids_begin);
+            const unsigned char* end = it + header.ids_bytes;
+
+            for(index_type i = 0; success && i < n_vecs; ++i)
+            {
+                unsigned long long prev = 0;
+
+                for(offset_type k = tmp_offsets[i]; success && k < tmp_offsets[i + 1]; ++k)
+                {
+                    unsigned long long z;
+
+                    success = sparse_vectors_file_decode(it, end, z);
+
+                    if(success)
+                    {
+                        prev = sparse_vectors_file_unzigzag(z, prev);
+                        success = prev < header.max_vec_size;
+                        tmp_decoded_ids[k] = index_type(prev);
+                    }
+                }
+            }
+
+            success = success && it == end;
+        }
+
+        if(!success)
+        {
+            internal_api_error_set_last(
+                std::string("sparse_vectors_file_view::map: Corrupt file ") + file_name);
+
+            return false;
+        }
+
+        index_type* tmp_ids = 0;
+
+        if(is_delta)
+        {
+            if(!tmp_decoded_ids.empty())
+                tmp_ids = &tmp_decoded_ids.front();
+        }
+        else
+        {
+            tmp_ids = reinterpret_cast<index_type*>(tmp_mapping.data() + ids_begin);
+        }
+
+        value_type* tmp_values = reinterpret_cast<value_type*>(
+            tmp_mapping.data() + values_begin);
+
+        // Pointers stay valid after swap.
+
+        mapping.swap(tmp_mapping);
+        decoded_ids.swap(tmp_decoded_ids);
+
+        base_type::use_memory(n_vecs, max_vec_size, tmp_offsets, tmp_ids, tmp_values);
+
+        return true;
+    }
+
+private:
+
+    file_mapping            mapping;
+    std::vector<index_type> decoded_ids;
+
+    // Not yet.
+    sparse_vectors_file_view(const sparse_vectors_file_view&);
+    sparse_vectors_file_view& operator=(const sparse_vectors_file_view&);
+};
+
+// -----------------------------------------------------------------------------
+
+#endif // SPARSE_VECTORS_FILE_H
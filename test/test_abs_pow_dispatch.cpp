@@ -0,0 +1,156 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Each copy of the real kernels that this CPU can run should agree with the
+// *_scalars loops in math/abs_pow_sum.h, for all remainders of the vector
+// widths, with negative values, and with NaN, which the sums propagate and
+// max_abs skips.
+
+#include "math/abs_pow_sum.h"
+#include "test_utils.h"
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+// Equal up to rounding, or both NaN.
+
+template<typename scalar_type>
+bool same_sum(
+    scalar_type a,
+    scalar_type b)
+{
+    const scalar_type tol = 100 * std::numeric_limits<scalar_type>::epsilon();
+
+    if(a != a || b != b)
+        return a != a && b != b;
+
+    return std::fabs(a - b) <= tol * std::fabs(b);
+}
+
+// Checks the kernels on the first n values for every n below 200.
+
+template<typename scalar_type>
+void check_all_lengths(
+    const abs_pow_sum_kernels<scalar_type>& kernels,
+    const scalar_type* vals,
+    const char* what,
+    test_utils_counts& counts)
+{
+    bool sum_abs_ok = true, sum_square_ok = true, max_abs_ok = true;
+
+    for(std::size_t n = 0; n < 200; ++n)
+    {
+        sum_abs_ok = sum_abs_ok &&
+            same_sum(kernels.sum_abs(n, vals), abs_pow_sum_abs_scalars(n, vals));
+
+        sum_square_ok = sum_square_ok &&
+            same_sum(kernels.sum_square(n, vals), abs_pow_sum_square_scalars(n, vals));
+
+        max_abs_ok = max_abs_ok &&
+            kernels.max_abs(n, vals) == abs_pow_max_abs_scalars(n, vals);
+    }
+
+    counts.check(sum_abs_ok && sum_square_ok && max_abs_ok, what);
+}
+
+template<typename scalar_type>
+void test_kernels(
+    cpu_features_isa isa,
+    test_utils_counts& counts)
+{
+    const abs_pow_sum_kernels<scalar_type>& kernels =
+        abs_pow_sum_dispatch_isa(isa, scalar_type());
+
+    test_utils_random random(61);
+
+    // Offset by one so that the kernels also see unaligned data.
+
+    std::vector<scalar_type> vals(201);
+    random.fill(vals);
+
+    check_all_lengths(kernels, &vals.front() + 1, "finite values", counts);
+
+    // A NaN in the vector part, and one in the remainder for most n.
+
+    vals[1 + 3]   = std::numeric_limits<scalar_type>::quiet_NaN();
+    vals[1 + 150] = std::numeric_limits<scalar_type>::quiet_NaN();
+
+    check_all_lengths(kernels, &vals.front() + 1, "with NaN", counts);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // The copies the CPU supports, which are all up to the best one.
+
+    const cpu_features_isa best = cpu_features_best_isa();
+
+    std::cout << "best isa = " << int(best) << "\n";
+
+    for(int isa = cpu_features_generic; isa <= int(best); ++isa)
+    {
+        test_kernels<float>(cpu_features_isa(isa), counts);
+        test_kernels<double>(cpu_features_isa(isa), counts);
+    }
+
+    // The dispatched table is one of them.
+
+    const abs_pow_sum_kernels<double>& chosen = abs_pow_sum_dispatch(double());
+
+    counts.check(&chosen == &abs_pow_sum_dispatch_isa(best, double()), "dispatch");
+
+    return counts.report();
+}
@@ -0,0 +1,259 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Quantile and k-means division of sorted values into bins, and their use
+// through ssa_options::binning_method.
+
+#include "matrix_binning/matrix_binning.h"
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+bool valid_splits(std::size_t n, std::size_t n_bins, const std::vector<std::size_t>& splits)
+{
+    if(splits.size() != n_bins + 1 || splits[0] != 0 || splits[n_bins] != n)
+        return false;
+
+    for(std::size_t c = 0; c < n_bins; ++c)
+        if(splits[c + 1] < splits[c])
+            return false;
+
+    return true;
+}
+
+// Sum of squared distances of log(d) to the means of their groups.
+double kmeans_objective(const std::vector<double>& d, const std::vector<std::size_t>& splits)
+{
+    double objective = 0;
+
+    for(std::size_t c = 0; c + 1 < splits.size(); ++c)
+    {
+        const std::size_t b = splits[c], e = splits[c + 1];
+
+        double mean = 0;
+
+        for(std::size_t k = b; k < e; ++k)
+            mean += std::log(d[k]);
+
+        mean /= double(e > b ? e - b : 1);
+
+        for(std::size_t k = b; k < e; ++k)
+            objective += (std::log(d[k]) - mean) * (std::log(d[k]) - mean);
+    }
+
+    return objective;
+}
+
+void test_quantile(test_utils_counts& counts)
+{
+    const std::size_t n = 103;
+
+    std::vector<double> d(n);
+
+    for(std::size_t k = 0; k < n; ++k)
+        d[k] = std::exp(0.1 * double(k));
+
+    for(std::size_t n_bins = 1; n_bins <= 10; ++n_bins)
+    {
+        std::vector<std::size_t> splits;
+
+        matrix_binning_sorted_splits(&d.front(), n, n_bins, matrix_binning_method_quantile, splits);
+
+        bool equal_sizes = valid_splits(n, n_bins, splits);
+
+        for(std::size_t c = 0; equal_sizes && c < n_bins; ++c)
+        {
+            const std::size_t size = splits[c + 1] - splits[c];
+            equal_sizes = n / n_bins <= size && size <= n / n_bins + 1;
+        }
+
+        counts.check(equal_sizes, "quantile sizes");
+    }
+}
+
+void test_kmeans(test_utils_counts& counts)
+{
+    // Three clusters of different sizes around 1e-3, 1 and 1e3.
+
+    const std::size_t sizes[3] = {10, 40, 20};
+    const double centers[3] = {1e-3, 1, 1e3};
+
+    test_utils_random random(33);
+    std::vector<double> d;
+
+    for(std::size_t c = 0; c < 3; ++c)
+        for(std::size_t k = 0; k < sizes[c]; ++k)
+            d.push_back(centers[c] * std::exp(0.5 * random.uniform()));
+
+    std::sort(d.begin(), d.end());
+
+    const std::size_t n = d.size();
+
+    std::vector<std::size_t> quantile_splits, kmeans_splits;
+
+    matrix_binning_sorted_splits(&d.front(), n, 3, matrix_binning_method_quantile, quantile_splits);
+    matrix_binning_sorted_splits(&d.front(), n, 3, matrix_binning_method_kmeans, kmeans_splits);
+
+    counts.check(valid_splits(n, 3, kmeans_splits), "kmeans splits");
+    counts.check(
+        kmeans_splits[1] == sizes[0] && kmeans_splits[2] == sizes[0] + sizes[1],
+        "kmeans finds the clusters");
+
+    // Each split is at the midpoint of the means of its groups.
+
+    bool at_midpoints = true;
+
+    for(std::size_t c = 1; c < 3; ++c)
+    {
+        const std::size_t b = kmeans_splits[c - 1], s = kmeans_splits[c], e = kmeans_splits[c + 1];
+
+        double mean_before = 0, mean_after = 0;
+
+        for(std::size_t k = b; k < s; ++k)
+            mean_before += std::log(d[k]) / double(s - b);
+
+        for(std::size_t k = s; k < e; ++k)
+            mean_after += std::log(d[k]) / double(e - s);
+
+        const double mid = (mean_before + mean_after) / 2;
+
+        at_midpoints = at_midpoints && std::log(d[s - 1]) < mid && mid <= std::log(d[s]);
+    }
+
+    counts.check(at_midpoints, "kmeans midpoints");
+    counts.check(
+        kmeans_objective(d, kmeans_splits) <= kmeans_objective(d, quantile_splits),
+        "kmeans objective");
+}
+
+// All methods give the same pattern, and without binning the same values.
+
+void test_lpn(test_utils_counts& counts)
+{
+    const int n = 30;
+
+    test_utils_random random(34);
+    std::vector<double> A(n * n);
+    random.fill(A);
+
+    for(int i = 0; i < n; ++i)
+        A[i + i * n] += 4;
+
+    ssa_d_csr X[ssa_binning_method_num_methods];
+    ssa_d_csr X_no_bins[ssa_binning_method_num_methods];
+
+    bool ok = true;
+
+    for(int method = 0; method < ssa_binning_method_num_methods; ++method)
+    {
+        ssa_options options;
+        ssa_options_default(&options);
+        options.binning_method = method;
+
+        ok = ok &&
+            ssa_d_lpn_opt(n, n, &A.front(), n, 0.6, 1.0, 8, 0,
+                ssa_matrix_type_general, &options, &X[method]) == 0 &&
+            ssa_d_lpn_opt(n, n, &A.front(), n, 0.6, 1.0, 0, 0,
+                ssa_matrix_type_general, &options, &X_no_bins[method]) == 0;
+
+        counts.check(ok, "ssa_d_lpn_opt with a binning method");
+    }
+
+    if(!ok)
+        return;
+
+    const int num_entries = X[0].row_offsets[n];
+
+    for(int method = 1; method < ssa_binning_method_num_methods; ++method)
+    {
+        bool same_pattern = X[method].row_offsets[n] == num_entries;
+
+        for(int e = 0; same_pattern && e < num_entries; ++e)
+            same_pattern = X[method].column_ids[e] == X[0].column_ids[e];
+
+        counts.check(same_pattern, "pattern of binning methods");
+        counts.check(
+            same_pattern &&
+            test_utils_rel_diff(X_no_bins[method].values, X_no_bins[0].values, num_entries) < 1e-14,
+            "values without binning");
+    }
+
+    for(int method = 0; method < ssa_binning_method_num_methods; ++method)
+    {
+        bool finite = true;
+
+        for(int e = 0; e < num_entries; ++e)
+            finite = finite && X[method].values[e] == X[method].values[e];
+
+        counts.check(finite, "binned values");
+
+        ssa_d_csr_deallocate(&X[method]);
+        ssa_d_csr_deallocate(&X_no_bins[method]);
+    }
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_quantile(counts);
+    test_kmeans(counts);
+    test_lpn(counts);
+
+    return counts.report();
+}
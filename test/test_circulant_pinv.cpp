@@ -0,0 +1,202 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The pseudo-inverse and null spaces of circulant and skew-circulant matrices
+// from the FFT should match those from the pivoted QR.
+
+#include "dense_matrix_pinv/dense_matrix_circulant_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "test_utils.h"
+#include <complex>
+#include <vector>
+#include <cmath>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+template<typename value_type>
+void assign_real(const std::complex<double>& a, value_type& b)
+{
+    b = value_type(a.real());
+}
+
+void assign_real(const std::complex<double>& a, complex_double& b)
+{
+    b = a;
+}
+
+// First column of a circulant matrix with eigenvalues that are zero at
+// frequencies zero_freq and n - zero_freq and random elsewhere.  Pairs of
+// frequencies have conjugate eigenvalues so that the column is real.  For a
+// skew-circulant matrix, the column is then scaled by D^-1, see
+// dense_matrix_circulant_pinv.h, which makes it complex.
+
+template<typename value_type>
+void first_column(
+    int n,
+    int zero_freq,
+    bool is_skew,
+    test_utils_random& random,
+    std::vector<value_type>& c)
+{
+    std::vector<std::complex<double> > eigenvalues(n);
+
+    for(int k = 0; k <= n / 2; ++k)
+    {
+        const double re = random.uniform() + 2;
+        const double im = k == 0 || 2 * k == n ? 0 : random.uniform();
+
+        eigenvalues[k] = std::complex<double>(re, im);
+        eigenvalues[(n - k) % n] = std::conj(eigenvalues[k]);
+    }
+
+    eigenvalues[zero_freq] = eigenvalues[n - zero_freq] = 0;
+
+    c.resize(n);
+
+    for(int j = 0; j < n; ++j)
+    {
+        std::complex<double> sum = 0;
+
+        for(int k = 0; k < n; ++k)
+            sum += eigenvalues[k] * std::polar(1.0, 2 * pi * j * k / n);
+
+        sum /= double(n);
+
+        if(is_skew)
+            sum *= std::polar(1.0, -pi * j / n);
+
+        assign_real(sum, c[j]);
+    }
+}
+
+template<typename value_type>
+void test_circulant(
+    int n,
+    bool is_skew,
+    std::size_t nullity,
+    test_utils_counts& counts)
+{
+    test_utils_random random(29);
+
+    std::vector<value_type> c;
+
+    if(nullity)
+    {
+        first_column(n, 3, is_skew, random, c);
+    }
+    else
+    {
+        c.resize(n);
+        random.fill(c);
+        c[0] += value_type(n);
+    }
+
+    std::vector<value_type> A(n * n);
+
+    for(int j = 0; j < n; ++j)
+        for(int i = 0; i < n; ++i)
+            A[i + j * n] = is_skew && i < j ? -c[(i - j + n) % n] : c[(i - j + n) % n];
+
+    std::vector<value_type> P_qr(A), P_fft(A);
+
+    dense_vectors<int, value_type> lnull_qr, rnull_qr, lnull_fft, rnull_fft;
+
+    const bool ok =
+        dense_matrix_qr_pinv_transpose(
+            n, n, &P_qr.front(), n, &lnull_qr, &rnull_qr) &&
+        dense_matrix_circulant_pinv_transpose(
+            n, n, &P_fft.front(), n, is_skew, &lnull_fft, &rnull_fft);
+
+    counts.check(ok, "pinv");
+
+    if(!ok)
+        return;
+
+    counts.check(test_utils_rel_diff(P_fft, P_qr) < 1e-10, "pinv values");
+
+    counts.check(
+        std::size_t(lnull_qr.num_vecs()) == nullity &&
+        std::size_t(lnull_fft.num_vecs()) == nullity &&
+        std::size_t(rnull_fft.num_vecs()) == nullity,
+        "nullity");
+
+    std::vector<value_type> N_qr, N_fft;
+
+    test_utils_projector(lnull_qr, N_qr);
+    test_utils_projector(lnull_fft, N_fft);
+    counts.check(test_utils_rel_diff(N_fft, N_qr) < 1e-10, "left null space");
+
+    test_utils_projector(rnull_qr, N_qr);
+    test_utils_projector(rnull_fft, N_fft);
+    counts.check(test_utils_rel_diff(N_fft, N_qr) < 1e-10, "right null space");
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // Even and odd sizes, since the FFT handles them differently.
+
+    test_circulant<double>(16, false, 0, counts);
+    test_circulant<double>(16, false, 2, counts);
+    test_circulant<double>(15, false, 2, counts);
+    test_circulant<double>(16, true, 0, counts);
+
+    test_circulant<complex_double>(16, false, 2, counts);
+    test_circulant<complex_double>(15, true, 2, counts);
+    test_circulant<complex_double>(16, true, 0, counts);
+
+    return counts.report();
+}
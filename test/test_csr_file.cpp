@@ -0,0 +1,183 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Write and read back CSR files, with and without delta encoded column ids,
+// and compare with the matrix written.
+
+#include "txssa.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+template<typename csr_type>
+bool csr_equal(
+    int num_rows,
+    int values_per_entry,
+    const csr_type& a,
+    const csr_type& b)
+{
+    for(int i = 0; i <= num_rows; ++i)
+        if(a.row_offsets[i] != b.row_offsets[i])
+            return false;
+
+    const int num_entries = a.row_offsets[num_rows];
+
+    for(int e = 0; e < num_entries; ++e)
+        if(a.column_ids[e] != b.column_ids[e])
+            return false;
+
+    for(int e = 0; e < values_per_entry * num_entries; ++e)
+        if(a.values[e] != b.values[e])
+            return false;
+
+    return true;
+}
+
+void test_real(test_utils_counts& counts)
+{
+    const int num_rows = 37, num_cols = 29;
+
+    test_utils_random random(26);
+    std::vector<double> A(num_rows * num_cols);
+    random.fill(A);
+
+    ssa_d_csr X;
+
+    counts.check(
+        ssa_d_lpn(num_rows, num_cols, &A.front(), num_rows,
+            0.5, 1.0, 16, 0, ssa_matrix_type_general, &X) == 0,
+        "ssa_d_lpn");
+
+    for(int delta = 0; delta < 2; ++delta)
+    {
+        const char* file_name = "test_csr_file_d.bin";
+
+        ssa_d_csr Y;
+        int Y_num_rows = 0, Y_num_cols = 0;
+
+        const bool io_ok =
+            ssa_d_csr_write(file_name, num_rows, num_cols, &X, delta) == 0 &&
+            ssa_d_csr_read(file_name, &Y_num_rows, &Y_num_cols, &Y) == 0;
+
+        counts.check(io_ok, "ssa_d_csr_write and ssa_d_csr_read");
+
+        if(io_ok)
+        {
+            counts.check(Y_num_rows == num_rows && Y_num_cols == num_cols, "real sizes");
+            counts.check(csr_equal(num_rows, 1, X, Y), "real round trip");
+
+            ssa_d_csr_deallocate(&Y);
+        }
+
+        std::remove(file_name);
+    }
+
+    ssa_d_csr_deallocate(&X);
+}
+
+// Filled by hand, with empty rows and a column id gap that needs more than
+// one byte when delta encoded.
+
+void test_complex(test_utils_counts& counts)
+{
+    const int num_rows = 5, num_cols = 1000;
+
+    int row_offsets[] = {0, 2, 2, 5, 5, 6};
+    int column_ids[]  = {0, 999, 3, 300, 301, 7};
+
+    std::vector<double> values(2 * 6);
+    test_utils_random random(27);
+    random.fill(values);
+
+    ssa_z_csr X;
+    X.row_offsets = row_offsets;
+    X.column_ids  = column_ids;
+    X.values      = &values.front();
+    X.reserved    = 0;
+
+    for(int delta = 0; delta < 2; ++delta)
+    {
+        const char* file_name = "test_csr_file_z.bin";
+
+        ssa_z_csr Y;
+        int Y_num_rows = 0, Y_num_cols = 0;
+
+        const bool io_ok =
+            ssa_z_csr_write(file_name, num_rows, num_cols, &X, delta) == 0 &&
+            ssa_z_csr_read(file_name, &Y_num_rows, &Y_num_cols, &Y) == 0;
+
+        counts.check(io_ok, "ssa_z_csr_write and ssa_z_csr_read");
+
+        if(io_ok)
+        {
+            counts.check(Y_num_rows == num_rows && Y_num_cols == num_cols, "complex sizes");
+            counts.check(csr_equal(num_rows, 2, X, Y), "complex round trip");
+
+            ssa_z_csr_deallocate(&Y);
+        }
+
+        std::remove(file_name);
+    }
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_real(counts);
+    test_complex(counts);
+
+    return counts.report();
+}
@@ -0,0 +1,151 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Approximating the independent diagonal blocks of a matrix separately should
+// give the same result as approximating the whole matrix, when there is no
+// binning and the block tolerance is 0.
+
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+void test_blocks(
+    double sparsity_ratio,
+    int impose_null_spaces,
+    enum ssa_matrix_type matrix_type,
+    test_utils_counts& counts)
+{
+    // Blocks of sizes 8, 12 and 10, each of rank one less, with rows and
+    // columns interleaved so that the blocks are not contiguous.
+    const int num_blocks = 3;
+    const int block_sizes[num_blocks] = {8, 12, 10};
+    const int n = 30;
+
+    std::vector<int> perm(n);
+    for(int i = 0; i < n; ++i)
+        perm[i] = (7 * i) % n;
+
+    test_utils_random random(28);
+    std::vector<double> A(n * n, 0.0);
+
+    for(int b = 0, begin = 0; b < num_blocks; begin += block_sizes[b++])
+    {
+        const int size = block_sizes[b];
+
+        std::vector<double> block;
+        test_utils_low_rank(size, size, size - 1, random, block);
+
+        for(int j = 0; j < size; ++j)
+            for(int i = 0; i < size; ++i)
+            {
+                // Symmetric blocks for the Hermitian case.
+                const double v = matrix_type == ssa_matrix_type_hermitian ?
+                    block[i + j * size] + block[j + i * size] : block[i + j * size];
+
+                A[perm[begin + i] + perm[begin + j] * n] = v;
+            }
+    }
+
+    ssa_options options;
+    ssa_options_default(&options);
+
+    ssa_d_csr X_whole, X_blocks;
+
+    bool ok = ssa_d_lpn_opt(n, n, &A.front(), n, sparsity_ratio, 1.0, 0,
+        impose_null_spaces, matrix_type, &options, &X_whole) == 0;
+
+    options.decompose_blocks = 1;
+    options.block_tolerance = 0;
+
+    ok = ok && ssa_d_lpn_opt(n, n, &A.front(), n, sparsity_ratio, 1.0, 0,
+        impose_null_spaces, matrix_type, &options, &X_blocks) == 0;
+
+    counts.check(ok, "ssa_d_lpn_opt");
+
+    if(!ok)
+        return;
+
+    bool same_pattern = true;
+
+    for(int i = 0; i <= n; ++i)
+        same_pattern = same_pattern && X_whole.row_offsets[i] == X_blocks.row_offsets[i];
+
+    for(int e = 0; same_pattern && e < X_whole.row_offsets[n]; ++e)
+        same_pattern = X_whole.column_ids[e] == X_blocks.column_ids[e];
+
+    counts.check(same_pattern, "pattern of blocks");
+    counts.check(
+        same_pattern &&
+        test_utils_rel_diff(X_blocks.values, X_whole.values, X_whole.row_offsets[n]) < 1e-8,
+        "values of blocks");
+
+    ssa_d_csr_deallocate(&X_whole);
+    ssa_d_csr_deallocate(&X_blocks);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // With imposed null spaces, rows get at least as many entries as the
+    // nullity of the matrix, or of the block, which differ.  The larger
+    // sparsity ratio leaves enough entries in every row anyway.
+
+    test_blocks(0.6, 0, ssa_matrix_type_general, counts);
+    test_blocks(0.9, 1, ssa_matrix_type_general, counts);
+    test_blocks(0.9, 1, ssa_matrix_type_hermitian, counts);
+
+    return counts.report();
+}
@@ -0,0 +1,181 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Solves with hermitian positive semi-definite matrices that fall back to the
+// truncated eigen-decomposition when Cholesky fails or is ill-conditioned.
+
+#include "lapack_wrap/dense_matrix_linear_hpd.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+// A * X - B for n x n A and n x num_rhs X, B.
+template<typename value_type>
+std::vector<value_type> residual(
+    int n,
+    int num_rhs,
+    const std::vector<value_type>& A,
+    const std::vector<value_type>& X,
+    const std::vector<value_type>& B)
+{
+    std::vector<value_type> R(B.size());
+
+    for(std::size_t e = 0; e < R.size(); ++e)
+        R[e] = -B[e];
+
+    for(int j = 0; j < num_rhs; ++j)
+        for(int k = 0; k < n; ++k)
+            for(int i = 0; i < n; ++i)
+                R[i + j * n] += A[i + k * n] * X[k + j * n];
+
+    return R;
+}
+
+// A = G * G^H with G n x rank, and B = A * Y so that A * X = B has a solution.
+// The solution should be the one of least norm, pinv(A) * B.
+
+template<typename value_type>
+void test_solve(
+    char uplo,
+    int n,
+    int rank,
+    double max_condition,
+    bool expect_truncated,
+    test_utils_counts& counts)
+{
+    const int num_rhs = 3;
+
+    test_utils_random random(38);
+
+    std::vector<value_type> G(n * rank), A(n * n, value_type(0));
+    std::vector<value_type> Y(n * num_rhs), B(n * num_rhs, value_type(0));
+
+    random.fill(G);
+
+    for(int j = 0; j < n; ++j)
+        for(int k = 0; k < rank; ++k)
+            for(int i = 0; i < n; ++i)
+                A[i + j * n] += G[i + k * n] * std::conj(G[j + k * n]);
+
+    random.fill(Y);
+
+    for(int j = 0; j < num_rhs; ++j)
+        for(int k = 0; k < n; ++k)
+            for(int i = 0; i < n; ++i)
+                B[i + j * n] += A[i + k * n] * Y[k + j * n];
+
+    std::vector<value_type> A_copy(A), X(B);
+    bool used_truncated = false;
+
+    const bool ok =
+        dense_matrix_linear_hpd_solve_robust(
+            uplo, n, num_rhs,
+            &A_copy.front(), n,
+            &X.front(), n,
+            max_condition, n,
+            &used_truncated);
+
+    counts.check(ok, "dense_matrix_linear_hpd_solve_robust");
+
+    if(!ok)
+        return;
+
+    counts.check(used_truncated == expect_truncated, "truncated solve used");
+
+    const std::vector<value_type> zero(B.size(), value_type(0));
+
+    counts.check(
+        test_utils_rel_diff(residual(n, num_rhs, A, X, B), zero) <
+            1e-10 * test_utils_rel_diff(B, zero),
+        "residual");
+
+    // The conjugate transpose pinv(A)' is pinv(A), since A is hermitian.
+
+    std::vector<value_type> P(A);
+    dense_vectors<int, value_type> lnull, rnull;
+
+    if(!dense_matrix_qr_pinv_transpose(n, n, &P.front(), n, &lnull, &rnull))
+    {
+        counts.check(false, "dense_matrix_qr_pinv_transpose");
+        return;
+    }
+
+    std::vector<value_type> X_least(B.size(), value_type(0));
+
+    for(int j = 0; j < num_rhs; ++j)
+        for(int k = 0; k < n; ++k)
+            for(int i = 0; i < n; ++i)
+                X_least[i + j * n] += P[i + k * n] * B[k + j * n];
+
+    counts.check(test_utils_rel_diff(X, X_least) < 1e-8, "least norm solution");
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // Positive definite: Cholesky is used.
+    test_solve<double>('L', 20, 20, 1e12, false, counts);
+
+    // Singular: Cholesky fails or is too ill-conditioned.
+    test_solve<double>('L', 20, 15, 1e12, true, counts);
+    test_solve<double>('U', 20, 15, 1e12, true, counts);
+    test_solve<complex_double>('U', 20, 12, 1e12, true, counts);
+
+    // Positive definite, but above the condition number allowed.
+    test_solve<double>('U', 20, 20, 1, true, counts);
+
+    return counts.report();
+}
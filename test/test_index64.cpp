@@ -0,0 +1,194 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The 64-bit index APIs should give the same results as the int ones.
+
+#include "txssa.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+template<typename csr_type, typename csr64_type>
+bool same_pattern(int num_rows, const csr_type& a, const csr64_type& b)
+{
+    for(int i = 0; i <= num_rows; ++i)
+        if(ssa_index64(a.row_offsets[i]) != b.row_offsets[i])
+            return false;
+
+    for(int e = 0; e < a.row_offsets[num_rows]; ++e)
+        if(ssa_index64(a.column_ids[e]) != b.column_ids[e])
+            return false;
+
+    return true;
+}
+
+// Real, with a leading dimension larger than the number of rows and imposed
+// null spaces.
+
+void test_real(test_utils_counts& counts)
+{
+    const int num_rows = 40, num_cols = 30, lda = 45;
+
+    test_utils_random random(27);
+    std::vector<double> A_low_rank, A(lda * num_cols, 0.0);
+    test_utils_low_rank(num_rows, num_cols, 25, random, A_low_rank);
+
+    for(int j = 0; j < num_cols; ++j)
+        for(int i = 0; i < num_rows; ++i)
+            A[i + j * lda] = A_low_rank[i + j * num_rows];
+
+    ssa_d_csr X;
+    ssa_d_csr64 X64;
+
+    const bool ok =
+        ssa_d_lpn(num_rows, num_cols, &A.front(), lda,
+            0.4, 1.0, 32, 1, ssa_matrix_type_general, &X) == 0 &&
+        ssa_d_lpn64(num_rows, num_cols, &A.front(), lda,
+            0.4, 1.0, 32, 1, ssa_matrix_type_general, &X64) == 0;
+
+    counts.check(ok, "ssa_d_lpn and ssa_d_lpn64");
+
+    if(!ok)
+        return;
+
+    const int num_entries = X.row_offsets[num_rows];
+
+    counts.check(same_pattern(num_rows, X, X64), "real pattern");
+    counts.check(test_utils_rel_diff(X64.values, X.values, num_entries) < 1e-13, "real values");
+
+    // Same pattern given back to the pat APIs.
+
+    std::vector<ssa_index64> row_offsets(X64.row_offsets, X64.row_offsets + num_rows + 1);
+    std::vector<ssa_index64> column_ids(X64.column_ids, X64.column_ids + num_entries);
+    std::vector<double> values(num_entries), values64(num_entries);
+
+    counts.check(
+        ssa_d_pat(num_rows, num_cols, &A.front(), lda,
+            X.row_offsets, X.column_ids, 32, 1, ssa_matrix_type_general, &values.front()) == 0 &&
+        ssa_d_pat64(num_rows, num_cols, &A.front(), lda,
+            &row_offsets.front(), &column_ids.front(), 32, 1, ssa_matrix_type_general, &values64.front()) == 0 &&
+        test_utils_rel_diff(values64, values) < 1e-13,
+        "ssa_d_pat and ssa_d_pat64");
+
+    // File round trip.
+
+    const char* file_name = "test_index64_d.bin";
+
+    ssa_d_csr64 Y64;
+    ssa_index64 Y_num_rows = 0, Y_num_cols = 0;
+
+    const bool io_ok =
+        ssa_d_csr_write64(file_name, num_rows, num_cols, &X64, 1) == 0 &&
+        ssa_d_csr_read64(file_name, &Y_num_rows, &Y_num_cols, &Y64) == 0;
+
+    counts.check(io_ok, "ssa_d_csr_write64 and ssa_d_csr_read64");
+
+    if(io_ok)
+    {
+        counts.check(
+            Y_num_rows == num_rows && Y_num_cols == num_cols &&
+            same_pattern(num_rows, X, Y64) &&
+            test_utils_rel_diff(Y64.values, X64.values, num_entries) == 0,
+            "64-bit file round trip");
+
+        ssa_d_csr_deallocate64(&Y64);
+    }
+
+    std::remove(file_name);
+
+    ssa_d_csr_deallocate(&X);
+    ssa_d_csr_deallocate64(&X64);
+}
+
+void test_complex(test_utils_counts& counts)
+{
+    const int n = 24;
+
+    test_utils_random random(28);
+    std::vector<complex_double> A;
+    test_utils_low_rank(n, n, n - 2, random, A);
+
+    const double* A_values = reinterpret_cast<const double*>(&A.front());
+
+    ssa_z_csr X;
+    ssa_z_csr64 X64;
+
+    const bool ok =
+        ssa_z_lpn(n, n, A_values, n,
+            0.5, 2.0, 16, 1, ssa_matrix_type_general, &X) == 0 &&
+        ssa_z_lpn64(n, n, A_values, n,
+            0.5, 2.0, 16, 1, ssa_matrix_type_general, &X64) == 0;
+
+    counts.check(ok, "ssa_z_lpn and ssa_z_lpn64");
+
+    if(!ok)
+        return;
+
+    counts.check(same_pattern(n, X, X64), "complex pattern");
+    counts.check(test_utils_rel_diff(X64.values, X.values, 2 * X.row_offsets[n]) < 1e-13, "complex values");
+
+    ssa_z_csr_deallocate(&X);
+    ssa_z_csr_deallocate64(&X64);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_real(counts);
+    test_complex(counts);
+
+    return counts.report();
+}
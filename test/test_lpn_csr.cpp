@@ -0,0 +1,210 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Approximating a matrix given in CSR form should give the same result as
+// approximating its dense copy.
+
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+// num_rows x num_cols, with about half of the entries nonzero.  The last
+// rows repeat the first ones so that there is a left null space.
+
+template<typename value_type>
+void sparse_matrix(
+    int num_rows,
+    int num_cols,
+    int num_repeated,
+    test_utils_random& random,
+    std::vector<value_type>& A)
+{
+    A.assign(num_rows * num_cols, value_type(0));
+
+    for(int j = 0; j < num_cols; ++j)
+        for(int i = 0; i < num_rows - num_repeated; ++i)
+            if(random.uniform() < 0)
+                random.get(A[i + j * num_rows]);
+
+    for(int j = 0; j < num_cols; ++j)
+        for(int i = 0; i < num_repeated; ++i)
+            A[num_rows - num_repeated + i + j * num_rows] = A[i + j * num_rows];
+}
+
+template<typename value_type>
+void dense_to_csr(
+    int num_rows,
+    int num_cols,
+    const std::vector<value_type>& A,
+    std::vector<int>& row_offsets,
+    std::vector<int>& column_ids,
+    std::vector<value_type>& values)
+{
+    row_offsets.assign(1, 0);
+    column_ids.clear();
+    values.clear();
+
+    for(int i = 0; i < num_rows; ++i)
+    {
+        for(int j = 0; j < num_cols; ++j)
+        {
+            if(A[i + j * num_rows] != value_type(0))
+            {
+                column_ids.push_back(j);
+                values.push_back(A[i + j * num_rows]);
+            }
+        }
+
+        row_offsets.push_back(int(column_ids.size()));
+    }
+}
+
+template<typename csr_type>
+bool same_pattern(int num_rows, const csr_type& a, const csr_type& b)
+{
+    for(int i = 0; i <= num_rows; ++i)
+        if(a.row_offsets[i] != b.row_offsets[i])
+            return false;
+
+    for(int e = 0; e < a.row_offsets[num_rows]; ++e)
+        if(a.column_ids[e] != b.column_ids[e])
+            return false;
+
+    return true;
+}
+
+void test_real(int impose_null_spaces, test_utils_counts& counts)
+{
+    const int num_rows = 40, num_cols = 30;
+
+    test_utils_random random(30);
+    std::vector<double> A, values;
+    std::vector<int> row_offsets, column_ids;
+
+    sparse_matrix(num_rows, num_cols, 2, random, A);
+    dense_to_csr(num_rows, num_cols, A, row_offsets, column_ids, values);
+
+    ssa_d_csr X_dense, X_csr;
+
+    const bool ok =
+        ssa_d_lpn(num_rows, num_cols, &A.front(), num_rows,
+            0.8, 1.0, 16, impose_null_spaces, ssa_matrix_type_general, &X_dense) == 0 &&
+        ssa_d_lpn_csr(num_rows, num_cols, &row_offsets.front(), &column_ids.front(), &values.front(),
+            0.8, 1.0, 16, impose_null_spaces, ssa_matrix_type_general, &X_csr) == 0;
+
+    counts.check(ok, "ssa_d_lpn and ssa_d_lpn_csr");
+
+    if(!ok)
+        return;
+
+    const bool pattern_ok = same_pattern(num_rows, X_dense, X_csr);
+
+    counts.check(pattern_ok, "real pattern");
+    counts.check(
+        pattern_ok &&
+        test_utils_rel_diff(X_csr.values, X_dense.values, X_dense.row_offsets[num_rows]) < 1e-10,
+        "real values");
+
+    ssa_d_csr_deallocate(&X_dense);
+    ssa_d_csr_deallocate(&X_csr);
+}
+
+void test_complex(test_utils_counts& counts)
+{
+    const int num_rows = 30, num_cols = 30;
+
+    test_utils_random random(31);
+    std::vector<complex_double> A, values;
+    std::vector<int> row_offsets, column_ids;
+
+    sparse_matrix(num_rows, num_cols, 1, random, A);
+    dense_to_csr(num_rows, num_cols, A, row_offsets, column_ids, values);
+
+    ssa_z_csr X_dense, X_csr;
+
+    const bool ok =
+        ssa_z_lpn(num_rows, num_cols, reinterpret_cast<const double*>(&A.front()), num_rows,
+            0.8, 1.0, 16, 1, ssa_matrix_type_general, &X_dense) == 0 &&
+        ssa_z_lpn_csr(num_rows, num_cols, &row_offsets.front(), &column_ids.front(),
+            reinterpret_cast<const double*>(&values.front()),
+            0.8, 1.0, 16, 1, ssa_matrix_type_general, &X_csr) == 0;
+
+    counts.check(ok, "ssa_z_lpn and ssa_z_lpn_csr");
+
+    if(!ok)
+        return;
+
+    const bool pattern_ok = same_pattern(num_rows, X_dense, X_csr);
+
+    counts.check(pattern_ok, "complex pattern");
+    counts.check(
+        pattern_ok &&
+        test_utils_rel_diff(X_csr.values, X_dense.values, 2 * X_dense.row_offsets[num_rows]) < 1e-10,
+        "complex values");
+
+    ssa_z_csr_deallocate(&X_dense);
+    ssa_z_csr_deallocate(&X_csr);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_real(0, counts);
+    test_real(1, counts);
+    test_complex(counts);
+
+    return counts.report();
+}
@@ -0,0 +1,253 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The preconditioned CG iteration that imposes null spaces: its stats, its
+// result against the direct solve, and the null space report of the API.
+
+#include "sparse_spectral_approximation/null_space_impose.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+#include <cmath>
+
+namespace {
+
+// Imposes the null spaces of B on the pattern with random values, by CG and
+// by the direct solve.
+
+void test_cg(
+    int num_rows,
+    int num_cols,
+    std::vector<double>& B,
+    const std::vector<int>& row_offsets,
+    const std::vector<int>& column_ids,
+    test_utils_random& random,
+    test_utils_counts& counts)
+{
+    dense_vectors<int, double> lnull, rnull;
+
+    if(!dense_matrix_qr_pinv_transpose(num_rows, num_cols, &B.front(), num_rows, &lnull, &rnull))
+    {
+        counts.check(false, "dense_matrix_qr_pinv_transpose");
+        return;
+    }
+
+    std::vector<double> values(column_ids.size());
+    random.fill(values);
+
+    std::vector<double> values_direct(values);
+
+    std::vector<int> offsets(row_offsets), ids(column_ids);
+
+    sparse_vectors<int, int, double>
+        A(num_rows, num_cols, &offsets.front(), &ids.front(), &values.front()),
+        A_direct(num_rows, num_cols, &offsets.front(), &ids.front(), &values_direct.front());
+
+    null_space_impose_stats stats;
+
+    const bool ok =
+        null_space_impose(
+            lnull.num_vecs(), lnull.vec_values(), lnull.leading_dimension(),
+            rnull.num_vecs(), rnull.vec_values(), rnull.leading_dimension(),
+            A, &stats)
+        &&
+        null_space_impose_direct(
+            lnull.num_vecs(), lnull.vec_values(), lnull.leading_dimension(),
+            rnull.num_vecs(), rnull.vec_values(), rnull.leading_dimension(),
+            A_direct);
+
+    counts.check(ok, "null_space_impose and null_space_impose_direct");
+
+    if(!ok)
+        return;
+
+    counts.check(
+        !stats.direct && stats.converged &&
+        0 < stats.num_iters && stats.num_iters < null_space_impose_max_iters,
+        "stats");
+    counts.check(stats.resid_norm_sq <= 2 * stats.sqtol, "residual below tolerance");
+    counts.check(test_utils_rel_diff(values, values_direct) < 1e-8, "same as direct");
+}
+
+// Independent blocks with rows and columns interleaved.  The null vectors of
+// each block are zero outside it, up to rounding.
+
+void test_blocks(test_utils_counts& counts)
+{
+    const int num_blocks = 3;
+    const int block_sizes[num_blocks] = {8, 12, 10};
+    const int n = 30;
+
+    std::vector<int> block_of(n);
+    for(int b = 0, begin = 0; b < num_blocks; begin += block_sizes[b++])
+        for(int i = begin; i < begin + block_sizes[b]; ++i)
+            block_of[(7 * i) % n] = b;
+
+    test_utils_random random(44);
+
+    std::vector<double> B(n * n, 0.0);
+    std::vector<int> row_offsets(1, 0), column_ids;
+
+    for(int b = 0; b < num_blocks; ++b)
+    {
+        const int size = block_sizes[b];
+
+        std::vector<int> ids;
+        for(int i = 0; i < n; ++i)
+            if(block_of[i] == b)
+                ids.push_back(i);
+
+        std::vector<double> block;
+        test_utils_low_rank(size, size, size - 1, random, block);
+
+        for(int j = 0; j < size; ++j)
+            for(int i = 0; i < size; ++i)
+                B[ids[i] + ids[j] * n] = block[i + j * size];
+    }
+
+    for(int i = 0; i < n; ++i)
+    {
+        for(int j = 0; j < n; ++j)
+            if(block_of[i] == block_of[j] && (i == j || random.uniform() < 0.5))
+                column_ids.push_back(j);
+
+        row_offsets.push_back(int(column_ids.size()));
+    }
+
+    test_cg(n, n, B, row_offsets, column_ids, random, counts);
+}
+
+// A few dense rows among sparse ones, where the preconditioner matters.
+
+void test_uneven(test_utils_counts& counts)
+{
+    const int num_rows = 60, num_cols = 50;
+
+    test_utils_random random(45);
+
+    std::vector<double> B;
+    test_utils_low_rank(num_rows, num_cols, 45, random, B);
+
+    std::vector<int> row_offsets, column_ids;
+    test_utils_random_pattern(num_rows, num_cols, 3, 0.3, false, random, row_offsets, column_ids);
+
+    std::vector<int> uneven_offsets(1, 0), uneven_ids;
+
+    for(int i = 0; i < num_rows; ++i)
+    {
+        if(i % 10 == 0)
+            for(int j = 0; j < num_cols; ++j)
+                uneven_ids.push_back(j);
+        else
+            uneven_ids.insert(uneven_ids.end(),
+                column_ids.begin() + row_offsets[i], column_ids.begin() + row_offsets[i + 1]);
+
+        uneven_offsets.push_back(int(uneven_ids.size()));
+    }
+
+    test_cg(num_rows, num_cols, B, uneven_offsets, uneven_ids, random, counts);
+}
+
+void test_report(test_utils_counts& counts)
+{
+    const int n = 40;
+
+    test_utils_random random(46);
+
+    std::vector<double> A;
+    test_utils_low_rank(n, n, n - 12, random, A);
+
+    ssa_null_space_report report;
+
+    ssa_options options;
+    ssa_options_default(&options);
+    options.null_space_report = &report;
+
+    ssa_d_csr X;
+
+    const bool ok = ssa_d_lpn_opt(n, n, &A.front(), n, 0.7, 1.0, 16, 1,
+        ssa_matrix_type_general, &options, &X) == 0;
+
+    counts.check(ok, "ssa_d_lpn_opt");
+
+    if(!ok)
+        return;
+
+    // Nullity 12 is too large for the direct solve.  The ratio is for the sum
+    // of the two residuals, each below the tolerance.
+
+    counts.check(
+        report.num_imposed == 1 &&
+        report.num_direct == 0 &&
+        report.num_not_converged == 0 &&
+        0 < report.max_iterations &&
+        report.total_iterations == report.max_iterations &&
+        report.max_iterations < report.iteration_limit &&
+        report.iteration_limit == int(null_space_impose_max_iters) &&
+        report.max_residual_ratio <= std::sqrt(2.0),
+        "null space report");
+
+    ssa_d_csr_deallocate(&X);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_blocks(counts);
+    test_uneven(counts);
+    test_report(counts);
+
+    return counts.report();
+}
@@ -0,0 +1,156 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The direct solve for small null spaces should give the same nearest matrix
+// as the CG iteration.
+
+#include "sparse_spectral_approximation/null_space_impose.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+// use_left and use_right select which null spaces are imposed.  An unused
+// side has zero nullity but a basis pointer that is not null.
+
+template<typename value_type>
+void test_direct(
+    int num_rows,
+    int num_cols,
+    int rank,
+    bool use_left,
+    bool use_right,
+    test_utils_counts& counts)
+{
+    test_utils_random random(43);
+
+    std::vector<value_type> B;
+    test_utils_low_rank(num_rows, num_cols, rank, random, B);
+
+    dense_vectors<int, value_type> lnull, rnull;
+
+    if(!dense_matrix_qr_pinv_transpose(num_rows, num_cols, &B.front(), num_rows, &lnull, &rnull))
+    {
+        counts.check(false, "dense_matrix_qr_pinv_transpose");
+        return;
+    }
+
+    const value_type dummy = value_type(0);
+
+    const int left_nullity  = use_left  ? lnull.num_vecs() : 0;
+    const int right_nullity = use_right ? rnull.num_vecs() : 0;
+
+    const value_type* left_basis  = use_left  ? lnull.vec_values() : &dummy;
+    const value_type* right_basis = use_right ? rnull.vec_values() : &dummy;
+
+    const int left_LD  = use_left  ? lnull.leading_dimension() : num_rows;
+    const int right_LD = use_right ? rnull.leading_dimension() : num_cols;
+
+    // Dense enough that the matrices with the null spaces are not only those
+    // near zero, where the relative difference would mean nothing.
+
+    std::vector<int> row_offsets, column_ids;
+    test_utils_random_pattern(num_rows, num_cols, 2, 0.5, false, random, row_offsets, column_ids);
+
+    std::vector<value_type> values(column_ids.size());
+    random.fill(values);
+
+    std::vector<value_type> values_cg(values);
+
+    sparse_vectors<int, int, value_type>
+        A(num_rows, num_cols, &row_offsets.front(), &column_ids.front(), &values.front()),
+        A_cg(num_rows, num_cols, &row_offsets.front(), &column_ids.front(), &values_cg.front());
+
+    null_space_impose_stats stats, stats_cg;
+
+    const bool ok =
+        null_space_impose_direct(
+            left_nullity, left_basis, left_LD,
+            right_nullity, right_basis, right_LD,
+            A, &stats)
+        &&
+        null_space_impose(
+            left_nullity, left_basis, left_LD,
+            right_nullity, right_basis, right_LD,
+            A_cg, &stats_cg);
+
+    counts.check(ok, "null_space_impose_direct and null_space_impose");
+
+    if(!ok)
+        return;
+
+    counts.check(stats.direct && stats.converged && stats.num_iters == 0, "direct stats");
+    counts.check(stats_cg.converged, "CG converged");
+    counts.check(test_utils_rel_diff(values, values_cg) < 1e-10, "same as CG");
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // Both sides, and each side alone.
+
+    test_direct<double>(24, 20, 17, true, true, counts);
+    test_direct<double>(24, 20, 17, true, false, counts);
+    test_direct<double>(24, 20, 17, false, true, counts);
+    test_direct<double>(20, 30, 18, true, true, counts);
+
+    test_direct<complex_double>(24, 20, 17, true, true, counts);
+    test_direct<complex_double>(20, 20, 18, false, true, counts);
+
+    // Nothing to impose.
+    test_direct<double>(20, 20, 20, true, true, counts);
+
+    return counts.report();
+}
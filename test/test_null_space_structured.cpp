@@ -0,0 +1,164 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Imposing null spaces on a structured matrix with only the right residual
+// should give the same result as the general iteration with both.
+
+#include "sparse_spectral_approximation/null_space_impose.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+template<typename value_type>
+void test_structured(
+    null_space_impose_structure structure,
+    test_utils_counts& counts)
+{
+    const int n = 60, nullity = 3;
+
+    test_utils_random random(42);
+
+    // Orthonormal right null space V of a random matrix.
+
+    std::vector<value_type> B;
+    test_utils_low_rank(n, n, n - nullity, random, B);
+
+    dense_vectors<int, value_type> lnull, rnull;
+
+    if(!dense_matrix_qr_pinv_transpose(n, n, &B.front(), n, &lnull, &rnull) ||
+       rnull.num_vecs() != nullity)
+    {
+        counts.check(false, "dense_matrix_qr_pinv_transpose");
+        return;
+    }
+
+    // The left null space is V, or conj(V) for complex symmetric A.
+
+    std::vector<value_type> left_basis(std::size_t(n) * nullity);
+
+    for(int k = 0; k < nullity; ++k)
+        for(int i = 0; i < n; ++i)
+            left_basis[i + k * n] = structure == null_space_impose_symmetric ?
+                std::conj(rnull.vec_values_begin(k)[i]) : rnull.vec_values_begin(k)[i];
+
+    std::vector<int> row_offsets, column_ids;
+    test_utils_random_pattern(n, n, 3, 0.2, true, random, row_offsets, column_ids);
+
+    std::vector<value_type> values(column_ids.size());
+    random.fill(values);
+
+    sparse_vectors<int, int, value_type> A(
+        n, n, &row_offsets.front(), &column_ids.front(), &values.front());
+
+    std::vector<int> trans_pos;
+
+    if(!null_space_impose_transpose_positions(A, trans_pos))
+    {
+        counts.check(false, "null_space_impose_transpose_positions");
+        return;
+    }
+
+    // The structured version first makes A structured.  Give the general one
+    // the same input.
+
+    std::vector<value_type> values_general(values);
+
+    sparse_vectors<int, int, value_type> A_general(
+        n, n, &row_offsets.front(), &column_ids.front(), &values_general.front());
+
+    null_space_impose_make_structured(structure, trans_pos, A_general);
+
+    null_space_impose_stats stats, stats_general;
+
+    const bool ok =
+        null_space_impose_structured(
+            structure, nullity, rnull.vec_values(), rnull.leading_dimension(),
+            trans_pos, A, &stats)
+        &&
+        null_space_impose(
+            nullity, &left_basis.front(), n,
+            nullity, rnull.vec_values(), rnull.leading_dimension(),
+            A_general, &stats_general);
+
+    counts.check(ok, "null_space_impose_structured and null_space_impose");
+
+    if(!ok)
+        return;
+
+    counts.check(stats.converged && stats_general.converged, "converged");
+    counts.check(test_utils_rel_diff(values, values_general) < 1e-10, "same as general");
+
+    bool structured = true;
+
+    for(std::size_t e = 0; e < values.size(); ++e)
+        structured = structured &&
+            values[std::size_t(trans_pos[e])] == null_space_impose_mirror(structure, values[e]);
+
+    counts.check(structured, "output is structured");
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_structured<double>(null_space_impose_hermitian, counts);
+    test_structured<double>(null_space_impose_skew_hermitian, counts);
+
+    test_structured<complex_double>(null_space_impose_hermitian, counts);
+    test_structured<complex_double>(null_space_impose_skew_hermitian, counts);
+    test_structured<complex_double>(null_space_impose_symmetric, counts);
+
+    return counts.report();
+}
@@ -0,0 +1,173 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The p-norms of the vectors, and of the vectors of the transpose, should
+// match plain std::pow and std::abs loops.  For 0 < p < 1 the result is the
+// sum of |v_i|^p without the root, as in the code.  The vector lengths are not
+// multiples of 4, so the remainder loops of the kernels run too.
+
+#include "p_norm_of_vectors/p_norm_of_vectors.h"
+#include "p_norm_of_vectors/p_norm_of_vectors_and_trans.h"
+#include "dense_vectors/dense_vectors.h"
+#include "test_utils.h"
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+// Reference p-norm of n values at the given stride.
+
+template<typename scalar_type, typename value_type>
+scalar_type reference_norm(
+    scalar_type p,
+    int n,
+    const value_type* vals,
+    int stride)
+{
+    const scalar_type inf = std::numeric_limits<scalar_type>::infinity();
+
+    scalar_type r = 0;
+
+    for(int k = 0; k < n; ++k)
+    {
+        const scalar_type a = std::abs(vals[k * stride]);
+
+        if(p == 0)
+            r += a != 0;
+        else if(p == inf)
+            r = std::max(r, a);
+        else
+            r += std::pow(a, p);
+    }
+
+    return 1 < p && p < inf ? std::pow(r, 1 / p) : r;
+}
+
+template<typename scalar_type>
+double max_rel_diff(
+    const std::vector<scalar_type>& a,
+    const std::vector<scalar_type>& b)
+{
+    double d = 0;
+
+    for(std::size_t i = 0; i < a.size(); ++i)
+        d = std::max(d, std::fabs(double(a[i]) - double(b[i])) / std::max(double(b[i]), 1e-300));
+
+    return d;
+}
+
+template<typename value_type>
+void test_p_norms(
+    int num_vecs,
+    int vec_size,
+    test_utils_counts& counts)
+{
+    typedef typename precision_traits<value_type>::scalar scalar_type;
+
+    const int ld = vec_size + 3;
+
+    test_utils_random random(67);
+
+    std::vector<value_type> values(std::size_t(ld) * num_vecs);
+    random.fill(values);
+
+    // Some exact zeros for p = 0.
+
+    for(std::size_t e = 0; e < values.size(); e += 5)
+        values[e] = value_type(0);
+
+    dense_vectors<int, value_type> vecs;
+    vecs.use_memory(num_vecs, vec_size, ld, &values.front());
+
+    const scalar_type inf = std::numeric_limits<scalar_type>::infinity();
+    const scalar_type p_vals[] = { 0, scalar_type(0.5), 1, 2, 3, inf };
+
+    const double tol = 100 * std::numeric_limits<scalar_type>::epsilon();
+
+    for(std::size_t ip = 0; ip < sizeof(p_vals) / sizeof(p_vals[0]); ++ip)
+    {
+        const scalar_type p = p_vals[ip];
+
+        std::vector<scalar_type> ref(num_vecs), ref_trans(vec_size);
+
+        for(int i = 0; i < num_vecs; ++i)
+            ref[i] = reference_norm(p, vec_size, &values[std::size_t(i) * ld], 1);
+
+        for(int j = 0; j < vec_size; ++j)
+            ref_trans[j] = reference_norm(p, num_vecs, &values[j], ld);
+
+        std::vector<scalar_type> norms(num_vecs), norms_2(num_vecs), norms_trans(vec_size);
+
+        p_norm_of_vectors(p, vecs, &norms.front());
+        p_norm_of_vectors_and_trans(p, vecs, &norms_2.front(), &norms_trans.front());
+
+        counts.check(max_rel_diff(norms, ref) < tol, "p_norm_of_vectors");
+        counts.check(max_rel_diff(norms_2, ref) < tol, "p_norm_of_vectors_and_trans");
+        counts.check(max_rel_diff(norms_trans, ref_trans) < tol, "p_norm_of_vectors_and_trans, transpose");
+    }
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_p_norms<double>(5, 37, counts);
+    test_p_norms<double>(9, 2, counts);
+    test_p_norms<float>(6, 29, counts);
+    test_p_norms<complex_double>(7, 23, counts);
+    test_p_norms<complex_double>(3, 1, counts);
+    test_p_norms<complex_float>(4, 15, counts);
+
+    return counts.report();
+}
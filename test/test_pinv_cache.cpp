@@ -0,0 +1,202 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The pseudo-inverse cache: a hit gives bit-identical results, and a damaged
+// file is a miss that is then written again.
+
+#include "sparse_spectral_approximation/ssa_pinv_cache.h"
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int num_rows = 40, num_cols = 30;
+
+bool approximate(
+    const std::vector<double>& A,
+    const char* cache_directory,
+    std::vector<double>& values)
+{
+    ssa_options options;
+    ssa_options_default(&options);
+    options.cache_directory = cache_directory;
+
+    ssa_d_csr X;
+
+    if(ssa_d_lpn_opt(num_rows, num_cols, &A.front(), num_rows, 0.5, 1.0, 16, 1,
+        ssa_matrix_type_general, &options, &X) != 0)
+        return false;
+
+    values.assign(X.values, X.values + X.row_offsets[num_rows]);
+
+    ssa_d_csr_deallocate(&X);
+
+    return true;
+}
+
+bool same_bits(const std::vector<double>& a, const std::vector<double>& b)
+{
+    return a.size() == b.size() &&
+        (a.empty() || std::memcmp(&a.front(), &b.front(), a.size() * sizeof(double)) == 0);
+}
+
+long file_size(const std::string& file_name)
+{
+    std::FILE* file = std::fopen(file_name.c_str(), "rb");
+
+    if(!file)
+        return -1;
+
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fclose(file);
+
+    return size;
+}
+
+// Keeps the first size bytes, with the first num_garbled ones changed.
+void damage_file(const std::string& file_name, long size, long num_garbled)
+{
+    std::vector<char> contents(std::size_t(size > 0 ? size : 1));
+
+    std::FILE* file = std::fopen(file_name.c_str(), "rb");
+
+    if(file)
+    {
+        const std::size_t num_read = std::fread(&contents.front(), 1, contents.size(), file);
+        (void) num_read;
+        std::fclose(file);
+    }
+
+    for(long k = 0; k < num_garbled && k < size; ++k)
+        contents[std::size_t(k)] = char(~contents[std::size_t(k)]);
+
+    file = std::fopen(file_name.c_str(), "wb");
+
+    if(file)
+    {
+        std::fwrite(&contents.front(), 1, std::size_t(size), file);
+        std::fclose(file);
+    }
+}
+
+bool is_hit(const std::string& file_name, const unsigned long long key[2])
+{
+    dense_vectors_file_view<int, double> view;
+    dense_vectors<int, double> pinv_AT, lnull, rnull, B1TB1, B2TB2;
+
+    return ssa_pinv_cache_load(
+        file_name, key, num_rows, num_cols, view,
+        pinv_AT, lnull, rnull, B1TB1, B2TB2);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_utils_random random(48);
+
+    std::vector<double> A;
+    test_utils_low_rank(num_rows, num_cols, 27, random, A);
+
+    const char* directory = ".";
+
+    unsigned long long key[2];
+    ssa_pinv_cache_key(
+        num_rows, num_cols, &A.front(), num_rows,
+        ssa_matrix_type_general, true,
+        static_cast<const dense_matrix_randomized_pinv_params*>(0),
+        key);
+
+    const std::string file_name = ssa_pinv_cache_file_name(directory, key);
+
+    std::remove(file_name.c_str());
+
+    std::vector<double> values, values_miss, values_hit;
+
+    counts.check(approximate(A, 0, values), "without cache");
+    counts.check(approximate(A, directory, values_miss), "cache miss");
+    counts.check(same_bits(values_miss, values), "cache miss values");
+    counts.check(is_hit(file_name, key), "file is written");
+
+    counts.check(approximate(A, directory, values_hit), "cache hit");
+    counts.check(same_bits(values_hit, values), "cache hit values");
+
+    const long size = file_size(file_name);
+
+    // Truncated, and with a garbled header.
+
+    const long damaged_sizes[2] = {size / 2, size};
+    const long num_garbled[2] = {0, 16};
+
+    for(int d = 0; d < 2; ++d)
+    {
+        damage_file(file_name, damaged_sizes[d], num_garbled[d]);
+
+        counts.check(!is_hit(file_name, key), "damaged file is a miss");
+
+        std::vector<double> values_damaged;
+
+        counts.check(approximate(A, directory, values_damaged), "damaged file");
+        counts.check(same_bits(values_damaged, values), "damaged file values");
+        counts.check(is_hit(file_name, key) && file_size(file_name) == size, "file is written again");
+    }
+
+    std::remove(file_name.c_str());
+
+    return counts.report();
+}
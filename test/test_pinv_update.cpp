@@ -0,0 +1,288 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Updating the pseudo-inverse for a low-rank correction should give the same
+// result as computing it again, directly and through the plan APIs.
+
+#include "dense_matrix_pinv/dense_matrix_pinv_update.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+#include <cmath>
+
+namespace {
+
+// X^H * X, or X * X^H if trans, for num_rows x num_cols X.
+template<typename value_type>
+std::vector<value_type> gram(
+    int num_rows,
+    int num_cols,
+    bool trans,
+    const std::vector<value_type>& X)
+{
+    const int size = trans ? num_rows : num_cols;
+
+    std::vector<value_type> C(std::size_t(size) * size, value_type(0));
+
+    for(int b = 0; b < size; ++b)
+        for(int a = 0; a < size; ++a)
+        {
+            value_type sum = value_type(0);
+
+            if(trans)
+                for(int j = 0; j < num_cols; ++j)
+                    sum += X[a + j * num_rows] * std::conj(X[b + j * num_rows]);
+            else
+                for(int i = 0; i < num_rows; ++i)
+                    sum += std::conj(X[i + a * num_rows]) * X[i + b * num_rows];
+
+            C[a + b * size] = sum;
+        }
+
+    return C;
+}
+
+// Y = op(A) * G with A num_rows x num_cols, G of the matching size x rank.
+template<typename value_type>
+std::vector<value_type> mult(
+    int num_rows,
+    int num_cols,
+    bool conj_trans,
+    const std::vector<value_type>& A,
+    int rank,
+    const std::vector<value_type>& G)
+{
+    const int out_size = conj_trans ? num_cols : num_rows;
+    const int in_size  = conj_trans ? num_rows : num_cols;
+
+    std::vector<value_type> Y(std::size_t(out_size) * rank, value_type(0));
+
+    for(int k = 0; k < rank; ++k)
+        for(int j = 0; j < in_size; ++j)
+            for(int i = 0; i < out_size; ++i)
+                Y[i + k * out_size] += (conj_trans ?
+                    std::conj(A[j + i * num_rows]) : A[i + j * num_rows]) * G[j + k * in_size];
+
+    return Y;
+}
+
+// U and V in the ranges of A and A^H, so the null spaces do not change,
+// unless out_of_range.
+
+template<typename value_type>
+void test_update(bool out_of_range, test_utils_counts& counts)
+{
+    const int num_rows = 60, num_cols = 50, rank = 45, update_rank = 2;
+
+    test_utils_random random(49);
+
+    std::vector<value_type> A, G_U(num_cols * update_rank), G_V(num_rows * update_rank);
+    test_utils_low_rank(num_rows, num_cols, rank, random, A);
+
+    random.fill(G_U);
+    random.fill(G_V);
+
+    std::vector<value_type> U = mult(num_rows, num_cols, false, A, update_rank, G_U);
+    std::vector<value_type> V = mult(num_rows, num_cols, true, A, update_rank, G_V);
+
+    if(out_of_range)
+        random.fill(U);
+
+    std::vector<value_type> A_new(A);
+
+    for(int k = 0; k < update_rank; ++k)
+        for(int j = 0; j < num_cols; ++j)
+            for(int i = 0; i < num_rows; ++i)
+                A_new[i + j * num_rows] += U[i + k * num_rows] * std::conj(V[j + k * num_cols]);
+
+    std::vector<value_type> P(A), P_new(A_new);
+    dense_vectors<int, value_type> lnull, rnull, lnull_new, rnull_new;
+
+    bool ok =
+        dense_matrix_qr_pinv_transpose(num_rows, num_cols, &P.front(), num_rows, &lnull, &rnull) &&
+        dense_matrix_qr_pinv_transpose(num_rows, num_cols, &P_new.front(), num_rows, &lnull_new, &rnull_new);
+
+    counts.check(ok, "dense_matrix_qr_pinv_transpose");
+
+    if(!ok)
+        return;
+
+    std::vector<value_type> P_H_P = gram(num_rows, num_cols, false, P);
+    std::vector<value_type> P_P_H = gram(num_rows, num_cols, true, P);
+
+    const std::vector<value_type> P_old(P);
+
+    bool updated = false;
+
+    ok = dense_matrix_pinv_update_transpose(
+        num_rows, num_cols, update_rank,
+        &U.front(), num_rows,
+        &V.front(), num_cols,
+        std::sqrt(dense_matrix_pinv_update_norm_sq(num_rows, num_cols, &A_new.front(), num_rows)),
+        &P.front(), num_rows,
+        lnull, rnull,
+        &P_H_P.front(), num_cols,
+        &P_P_H.front(), num_rows,
+        updated);
+
+    counts.check(ok, "dense_matrix_pinv_update_transpose");
+
+    if(!ok)
+        return;
+
+    if(out_of_range)
+    {
+        counts.check(!updated && test_utils_rel_diff(P, P_old) == 0, "not updated");
+        return;
+    }
+
+    counts.check(updated, "updated");
+    counts.check(test_utils_rel_diff(P, P_new) < 1e-10, "updated pinv");
+    counts.check(
+        test_utils_rel_diff(P_H_P, gram(num_rows, num_cols, false, P_new)) < 1e-10 &&
+        test_utils_rel_diff(P_P_H, gram(num_rows, num_cols, true, P_new)) < 1e-10,
+        "updated Gram matrices");
+}
+
+// A plan updated to A_new approximates A_new as ssa_d_lpn_opt does.  With
+// imposed null spaces, of small nullity so that the approximation is not near
+// zero.
+
+void test_plan(int n, int rank, int impose_null_spaces, test_utils_counts& counts)
+{
+    const int update_rank = 3;
+
+    test_utils_random random(50);
+
+    std::vector<double> A, G_U(n * update_rank), G_V(n * update_rank);
+    test_utils_low_rank(n, n, rank, random, A);
+
+    random.fill(G_U);
+    random.fill(G_V);
+
+    const std::vector<double> U = mult(n, n, false, A, update_rank, G_U);
+    const std::vector<double> V = mult(n, n, true, A, update_rank, G_V);
+
+    std::vector<double> A_new(A);
+
+    for(int k = 0; k < update_rank; ++k)
+        for(int j = 0; j < n; ++j)
+            for(int i = 0; i < n; ++i)
+                A_new[i + j * n] += U[i + k * n] * V[j + k * n];
+
+    ssa_options options;
+    ssa_options_default(&options);
+
+    ssa_d_plan plan;
+    ssa_d_csr X_plan, X_fresh;
+
+    bool ok =
+        ssa_d_plan_create(n, n, &A.front(), n, impose_null_spaces,
+            ssa_matrix_type_general, &options, &plan) == 0;
+
+    counts.check(ok, "ssa_d_plan_create");
+
+    if(!ok)
+        return;
+
+    ok =
+        ssa_d_plan_update(&plan, update_rank, &U.front(), n, &V.front(), n) == 0 &&
+        ssa_d_plan_lpn(&plan, 0.5, 1.0, 16, &options, &X_plan) == 0;
+
+    counts.check(ok, "ssa_d_plan_update and ssa_d_plan_lpn");
+    counts.check(!ok || (plan.num_updates == 1 && plan.num_recomputes == 0), "plan counts");
+
+    ssa_d_plan_deallocate(&plan);
+
+    if(!ok)
+        return;
+
+    ok = ssa_d_lpn_opt(n, n, &A_new.front(), n, 0.5, 1.0, 16, impose_null_spaces,
+        ssa_matrix_type_general, &options, &X_fresh) == 0;
+
+    counts.check(ok, "ssa_d_lpn_opt");
+
+    if(ok)
+    {
+        const int num_entries = X_fresh.row_offsets[n];
+        const std::vector<double> zero(num_entries, 0.0);
+
+        counts.check(
+            X_plan.row_offsets[n] == num_entries &&
+            test_utils_rel_diff(X_plan.values, X_fresh.values, num_entries) < 1e-9,
+            "same as ssa_d_lpn_opt");
+
+        counts.check(
+            test_utils_rel_diff(X_fresh.values, &zero.front(), num_entries) > 1e-3,
+            "approximation is not zero");
+
+        ssa_d_csr_deallocate(&X_fresh);
+    }
+
+    ssa_d_csr_deallocate(&X_plan);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_update<double>(false, counts);
+    test_update<double>(true, counts);
+    test_update<complex_double>(false, counts);
+
+    test_plan(60, 60, 0, counts);
+    test_plan(200, 198, 1, counts);
+
+    return counts.report();
+}
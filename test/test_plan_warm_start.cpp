@@ -0,0 +1,179 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Approximations from a plan, whose null space iteration starts from the
+// multipliers of the previous call, should match those from scratch within
+// the tolerance of the iteration, in fewer iterations.
+
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+const int n = 200, rank = 198, update_rank = 2;
+
+// A + scale * (A * G_U) * (A^H * G_V)^H, a correction that keeps the null
+// spaces.
+void update_matrix(
+    const std::vector<double>& A,
+    double scale,
+    test_utils_random& random,
+    std::vector<double>& U,
+    std::vector<double>& V,
+    std::vector<double>& A_new)
+{
+    std::vector<double> G_U(n * update_rank), G_V(n * update_rank);
+
+    random.fill(G_U);
+    random.fill(G_V);
+
+    U.assign(n * update_rank, 0.0);
+    V.assign(n * update_rank, 0.0);
+
+    for(int k = 0; k < update_rank; ++k)
+        for(int j = 0; j < n; ++j)
+            for(int i = 0; i < n; ++i)
+            {
+                U[i + k * n] += scale * A[i + j * n] * G_U[j + k * n];
+                V[i + k * n] += A[j + i * n] * G_V[j + k * n];
+            }
+
+    A_new = A;
+
+    for(int k = 0; k < update_rank; ++k)
+        for(int j = 0; j < n; ++j)
+            for(int i = 0; i < n; ++i)
+                A_new[i + j * n] += U[i + k * n] * V[j + k * n];
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_utils_random random(50);
+
+    std::vector<double> A;
+    test_utils_low_rank(n, n, rank, random, A);
+
+    ssa_null_space_report report;
+
+    ssa_options options;
+    ssa_options_default(&options);
+    options.null_space_report = &report;
+
+    ssa_d_plan plan;
+
+    if(ssa_d_plan_create(n, n, &A.front(), n, 1, ssa_matrix_type_general, &options, &plan) != 0)
+    {
+        counts.check(false, "ssa_d_plan_create");
+        return counts.report();
+    }
+
+    ssa_d_csr X;
+
+    counts.check(ssa_d_plan_lpn(&plan, 0.5, 1.0, 16, &options, &X) == 0, "first ssa_d_plan_lpn");
+    ssa_d_csr_deallocate(&X);
+
+    // A sequence of small changes.  Larger ones can move values to other
+    // bins, and then the previous multipliers are a much worse start.
+
+    for(int step = 0; step < 3; ++step)
+    {
+        std::vector<double> U, V, A_new;
+        update_matrix(A, 1e-8, random, U, V, A_new);
+
+        ssa_d_csr X_warm, X_fresh;
+
+        bool ok =
+            ssa_d_plan_update(&plan, update_rank, &U.front(), n, &V.front(), n) == 0 &&
+            ssa_d_plan_lpn(&plan, 0.5, 1.0, 16, &options, &X_warm) == 0;
+
+        counts.check(ok, "ssa_d_plan_update and ssa_d_plan_lpn");
+
+        if(!ok)
+            break;
+
+        const double warm_iterations = report.total_iterations;
+
+        ok = ssa_d_lpn_opt(n, n, &A_new.front(), n, 0.5, 1.0, 16, 1,
+            ssa_matrix_type_general, &options, &X_fresh) == 0;
+
+        counts.check(ok, "ssa_d_lpn_opt");
+
+        if(ok)
+        {
+            const int num_entries = X_fresh.row_offsets[n];
+
+            counts.check(
+                X_warm.row_offsets[n] == num_entries &&
+                test_utils_rel_diff(X_warm.values, X_fresh.values, num_entries) < 1e-8,
+                "warm start result");
+
+            counts.check(
+                report.num_imposed == 1 && report.num_direct == 0 &&
+                warm_iterations < report.total_iterations,
+                "warm start saves iterations");
+
+            ssa_d_csr_deallocate(&X_fresh);
+        }
+
+        ssa_d_csr_deallocate(&X_warm);
+
+        A.swap(A_new);
+    }
+
+    ssa_d_plan_deallocate(&plan);
+
+    return counts.report();
+}
@@ -0,0 +1,248 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The pseudo-inverse from the pivoted QR should satisfy the Moore-Penrose
+// identities, and the null spaces should be orthonormal bases of the
+// complements of the ranges of A' and A.  The ranks are above the reflector
+// block size, so the reflectors are applied in more than one block.
+
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "test_utils.h"
+#include <vector>
+#include <cmath>
+
+namespace {
+
+// C = op(A) * op(B), column-wise, where op conjugate-transposes if asked.
+
+template<typename value_type>
+void mult(
+    std::size_t num_rows,
+    std::size_t num_cols,
+    std::size_t num_inner,
+    const std::vector<value_type>& A,
+    bool A_herm,
+    const std::vector<value_type>& B,
+    bool B_herm,
+    std::vector<value_type>& C)
+{
+    C.assign(num_rows * num_cols, value_type(0));
+
+    for(std::size_t j = 0; j < num_cols; ++j)
+        for(std::size_t k = 0; k < num_inner; ++k)
+        {
+            const value_type b = B_herm ? std::conj(B[j + k * num_cols]) : B[k + j * num_inner];
+
+            for(std::size_t i = 0; i < num_rows; ++i)
+                C[i + j * num_rows] +=
+                    (A_herm ? std::conj(A[k + i * num_inner]) : A[i + k * num_rows]) * b;
+        }
+}
+
+// Copy of the vectors N, column-wise.
+
+template<typename value_type>
+void to_matrix(
+    const dense_vectors<int, value_type>& N,
+    std::vector<value_type>& M)
+{
+    const std::size_t size = std::size_t(N.vec_size());
+
+    M.resize(size * std::size_t(N.num_vecs()));
+
+    for(int k = 0; k < N.num_vecs(); ++k)
+        for(std::size_t i = 0; i < size; ++i)
+            M[i + k * size] = N.vec_values_begin(k)[i];
+}
+
+// I - M, with M square.
+
+template<typename value_type>
+void identity_minus(
+    std::size_t size,
+    std::vector<value_type>& M)
+{
+    for(std::size_t e = 0; e < M.size(); ++e)
+        M[e] = -M[e];
+
+    for(std::size_t i = 0; i < size; ++i)
+        M[i + i * size] += value_type(1);
+}
+
+// Relative distance of the square M from its conjugate transpose.
+
+template<typename value_type>
+double non_hermitian_part(
+    std::size_t size,
+    const std::vector<value_type>& M)
+{
+    std::vector<value_type> MH(M.size());
+
+    for(std::size_t j = 0; j < size; ++j)
+        for(std::size_t i = 0; i < size; ++i)
+            MH[j + i * size] = std::conj(M[i + j * size]);
+
+    return test_utils_rel_diff(MH, M);
+}
+
+// Checks N^H * N = I, and that N * N^H is the projector I - M, where M is
+// A * P or P * A.
+
+template<typename value_type>
+void check_null_space(
+    const dense_vectors<int, value_type>& N,
+    std::size_t size,
+    std::size_t nullity,
+    const std::vector<value_type>& M,
+    const char* what,
+    test_utils_counts& counts)
+{
+    counts.check(std::size_t(N.num_vecs()) == nullity, what);
+
+    std::vector<value_type> V, VHV, I(nullity * nullity, value_type(0));
+
+    to_matrix(N, V);
+    mult(nullity, nullity, size, V, true, V, false, VHV);
+
+    for(std::size_t k = 0; k < nullity; ++k)
+        I[k + k * nullity] = value_type(1);
+
+    counts.check(test_utils_rel_diff(VHV, I) < 1e-12, what);
+
+    std::vector<value_type> proj, complement(M);
+
+    // An empty N may not know its vector size, and then I - M is zero up to
+    // rounding, so it is compared against the exact zero.
+
+    if(nullity == 0)
+        proj.assign(size * size, value_type(0));
+    else
+        test_utils_projector(N, proj);
+
+    identity_minus(size, complement);
+
+    counts.check(test_utils_rel_diff(complement, proj) < 1e-10, what);
+}
+
+template<typename value_type>
+void test_identities(
+    int num_rows,
+    int num_cols,
+    int rank,
+    test_utils_counts& counts)
+{
+    counts.check(
+        std::size_t(rank) > dense_matrix_qr_pinv_reflector_block_size,
+        "more than one reflector block");
+
+    const std::size_t m = std::size_t(num_rows), n = std::size_t(num_cols);
+
+    test_utils_random random(53);
+
+    std::vector<value_type> A;
+    test_utils_low_rank(m, n, std::size_t(rank), random, A);
+
+    std::vector<value_type> PT(A);
+
+    dense_vectors<int, value_type> lnull, rnull;
+
+    const bool ok =
+        dense_matrix_qr_pinv_transpose(
+            num_rows, num_cols, &PT.front(), num_rows, &lnull, &rnull);
+
+    counts.check(ok, "pinv");
+
+    if(!ok)
+        return;
+
+    // P = pinv(A), n x m, from its conjugate transpose.
+
+    std::vector<value_type> P(n * m);
+
+    for(std::size_t j = 0; j < n; ++j)
+        for(std::size_t i = 0; i < m; ++i)
+            P[j + i * n] = std::conj(PT[i + j * m]);
+
+    std::vector<value_type> AP, PA, APA, PAP;
+
+    mult(m, m, n, A, false, P, false, AP);
+    mult(n, n, m, P, false, A, false, PA);
+    mult(m, n, m, AP, false, A, false, APA);
+    mult(n, m, n, PA, false, P, false, PAP);
+
+    counts.check(test_utils_rel_diff(APA, A) < 1e-10, "A * P * A = A");
+    counts.check(test_utils_rel_diff(PAP, P) < 1e-10, "P * A * P = P");
+    counts.check(non_hermitian_part(m, AP) < 1e-10, "A * P is Hermitian");
+    counts.check(non_hermitian_part(n, PA) < 1e-10, "P * A is Hermitian");
+
+    check_null_space(lnull, m, m - std::size_t(rank), AP, "left null space", counts);
+    check_null_space(rnull, n, n - std::size_t(rank), PA, "right null space", counts);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // Tall and wide, rank deficient and of full rank.
+
+    test_identities<double>(240, 150, 100, counts);
+    test_identities<double>(150, 240, 100, counts);
+    test_identities<double>(200, 140, 140, counts);
+    test_identities<double>(140, 200, 140, counts);
+
+    test_identities<complex_double>(180, 120, 90, counts);
+    test_identities<complex_double>(120, 180, 90, counts);
+    test_identities<complex_double>(160, 130, 130, counts);
+
+    return counts.report();
+}
@@ -0,0 +1,168 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The pseudo-inverse and null spaces from the randomized range finder should
+// match those from the pivoted QR, directly and through the API.
+
+#include "dense_matrix_pinv/dense_matrix_randomized_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+template<typename value_type>
+void test_pinv(
+    int num_rows,
+    int num_cols,
+    int rank,
+    test_utils_counts& counts)
+{
+    test_utils_random random(46);
+
+    std::vector<value_type> A;
+    test_utils_low_rank(num_rows, num_cols, rank, random, A);
+
+    std::vector<value_type> P_qr(A), P_rand(A);
+
+    dense_vectors<int, value_type> lnull_qr, rnull_qr, lnull_rand, rnull_rand;
+
+    const dense_matrix_randomized_pinv_params params;
+
+    const bool ok =
+        dense_matrix_qr_pinv_transpose(
+            num_rows, num_cols, &P_qr.front(), num_rows, &lnull_qr, &rnull_qr) &&
+        dense_matrix_randomized_pinv_transpose(
+            num_rows, num_cols, &P_rand.front(), num_rows, params, &lnull_rand, &rnull_rand);
+
+    counts.check(ok, "pinv");
+
+    if(!ok)
+        return;
+
+    counts.check(test_utils_rel_diff(P_rand, P_qr) < 1e-8, "pinv values");
+
+    counts.check(
+        lnull_rand.num_vecs() == num_rows - rank &&
+        rnull_rand.num_vecs() == num_cols - rank &&
+        lnull_qr.num_vecs() == num_rows - rank,
+        "nullity");
+
+    std::vector<value_type> N_qr, N_rand;
+
+    test_utils_projector(lnull_qr, N_qr);
+    test_utils_projector(lnull_rand, N_rand);
+    counts.check(test_utils_rel_diff(N_rand, N_qr) < 1e-8, "left null space");
+
+    test_utils_projector(rnull_qr, N_qr);
+    test_utils_projector(rnull_rand, N_rand);
+    counts.check(test_utils_rel_diff(N_rand, N_qr) < 1e-8, "right null space");
+}
+
+// Without imposing the null spaces, which are large for a low rank matrix.
+
+void test_api(test_utils_counts& counts)
+{
+    const int num_rows = 80, num_cols = 60;
+
+    test_utils_random random(47);
+
+    std::vector<double> A;
+    test_utils_low_rank(num_rows, num_cols, 8, random, A);
+
+    ssa_options options;
+    ssa_options_default(&options);
+
+    ssa_d_csr X_qr, X_rand;
+
+    bool ok = ssa_d_lpn_opt(num_rows, num_cols, &A.front(), num_rows, 0.5, 1.0, 16, 0,
+        ssa_matrix_type_general, &options, &X_qr) == 0;
+
+    options.pinv_method = ssa_pinv_method_randomized;
+
+    ok = ok && ssa_d_lpn_opt(num_rows, num_cols, &A.front(), num_rows, 0.5, 1.0, 16, 0,
+        ssa_matrix_type_general, &options, &X_rand) == 0;
+
+    counts.check(ok, "ssa_d_lpn_opt with each pinv method");
+
+    if(!ok)
+        return;
+
+    const int num_entries = X_qr.row_offsets[num_rows];
+
+    counts.check(
+        X_rand.row_offsets[num_rows] == num_entries &&
+        test_utils_rel_diff(X_rand.values, X_qr.values, num_entries) < 1e-6,
+        "same approximation");
+
+    ssa_d_csr_deallocate(&X_qr);
+    ssa_d_csr_deallocate(&X_rand);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // Low rank, tall and wide.
+    test_pinv<double>(200, 150, 10, counts);
+    test_pinv<double>(120, 200, 15, counts);
+    test_pinv<complex_double>(150, 150, 12, counts);
+
+    // Not low rank: falls back to the QR.
+    test_pinv<double>(100, 80, 70, counts);
+
+    test_api(counts);
+
+    return counts.report();
+}
@@ -0,0 +1,150 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// The pseudo-inverse and null spaces from the tall-skinny QR should match
+// those from the pivoted QR.
+
+#include "dense_matrix_pinv/dense_matrix_tsqr_pinv.h"
+#include "dense_matrix_pinv/dense_matrix_qr_pinv.h"
+#include "test_utils.h"
+#include <vector>
+#include <cmath>
+
+namespace {
+
+// The left null space has num_rows - rank vectors, too many for comparing
+// projectors, so check U^H * A = 0 and the count instead, if with_left.
+
+template<typename value_type>
+void test_tsqr(
+    int num_rows,
+    int num_cols,
+    int rank,
+    bool with_left,
+    test_utils_counts& counts)
+{
+    counts.check(1 < dense_matrix_tsqr_pinv_num_leaves(num_rows, num_cols), "TSQR is used");
+
+    test_utils_random random(47);
+
+    std::vector<value_type> A;
+    test_utils_low_rank(num_rows, num_cols, rank, random, A);
+
+    std::vector<value_type> P_qr(A), P_tsqr(A);
+
+    dense_vectors<int, value_type> lnull_tsqr, rnull_qr, rnull_tsqr;
+
+    const bool ok =
+        dense_matrix_qr_pinv_transpose(
+            num_rows, num_cols, &P_qr.front(), num_rows,
+            static_cast<dense_vectors<int, value_type>*>(0), &rnull_qr) &&
+        dense_matrix_tsqr_pinv_transpose(
+            num_rows, num_cols, &P_tsqr.front(), num_rows,
+            with_left ? &lnull_tsqr : 0, &rnull_tsqr);
+
+    counts.check(ok, "pinv");
+
+    if(!ok)
+        return;
+
+    counts.check(test_utils_rel_diff(P_tsqr, P_qr) < 1e-10, "pinv values");
+
+    counts.check(
+        rnull_qr.num_vecs() == num_cols - rank &&
+        rnull_tsqr.num_vecs() == num_cols - rank &&
+        (!with_left || lnull_tsqr.num_vecs() == num_rows - rank),
+        "nullity");
+
+    std::vector<value_type> N_qr, N_tsqr;
+
+    test_utils_projector(rnull_qr, N_qr);
+    test_utils_projector(rnull_tsqr, N_tsqr);
+    counts.check(test_utils_rel_diff(N_tsqr, N_qr) < 1e-10, "right null space");
+
+    if(!with_left)
+        return;
+
+    double UHA_norm_sq = 0, A_norm_sq = 0;
+
+    for(int k = 0; k < lnull_tsqr.num_vecs(); ++k)
+    {
+        const value_type* u = lnull_tsqr.vec_values_begin(k);
+
+        for(int j = 0; j < num_cols; ++j)
+        {
+            value_type dot = value_type(0);
+
+            for(int i = 0; i < num_rows; ++i)
+                dot += std::conj(u[i]) * A[i + j * num_rows];
+
+            UHA_norm_sq += double(std::abs_square(dot));
+        }
+    }
+
+    for(std::size_t e = 0; e < A.size(); ++e)
+        A_norm_sq += double(std::abs_square(A[e]));
+
+    counts.check(std::sqrt(UHA_norm_sq / A_norm_sq) < 1e-12, "left null space");
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    // Four, two and three leaves.
+    test_tsqr<double>(4096, 40, 40, false, counts);
+    test_tsqr<double>(2048, 40, 36, true, counts);
+    test_tsqr<complex_double>(3072, 20, 17, false, counts);
+
+    return counts.report();
+}
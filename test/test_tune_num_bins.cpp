@@ -0,0 +1,198 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Automatic choice of the number of bins: the tune report, the result for the
+// chosen number of bins, and imposing the null spaces only once.
+
+#include "txssa.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+
+void test_tune(int impose_null_spaces, test_utils_counts& counts)
+{
+    const int n = 40, max_num_bins = 32;
+
+    test_utils_random random(34);
+    std::vector<double> A;
+    test_utils_low_rank(n, n, n - 4, random, A);
+
+    ssa_tune_report tune_report;
+    ssa_null_space_report null_space_report;
+
+    ssa_options options;
+    ssa_options_default(&options);
+    options.tune_num_bins = 1;
+    options.tune_tolerance = 0;
+    options.tune_report = &tune_report;
+    options.null_space_report = &null_space_report;
+
+    ssa_d_csr X_tuned, X_fixed;
+
+    bool ok = ssa_d_lpn_opt(n, n, &A.front(), n, 0.5, 1.0, max_num_bins,
+        impose_null_spaces, ssa_matrix_type_general, &options, &X_tuned) == 0;
+
+    counts.check(ok, "tuned ssa_d_lpn_opt");
+
+    if(!ok)
+        return;
+
+    // With zero tolerance, all of 2, 4, ..., max_num_bins are tried.
+
+    bool tries_ok = tune_report.num_tries == 5;
+
+    for(int t = 0; tries_ok && t < tune_report.num_tries; ++t)
+        tries_ok =
+            tune_report.num_bins[t] == 2 << t &&
+            0 <= tune_report.relative_misfit[t] &&
+            tune_report.relative_misfit[t] <= 1;
+
+    counts.check(tries_ok, "tried numbers of bins");
+
+    bool chosen_is_best = false;
+
+    for(int t = 0; t < tune_report.num_tries; ++t)
+        if(tune_report.num_bins[t] == tune_report.chosen_num_bins)
+            chosen_is_best = true;
+
+    for(int t = 0; t < tune_report.num_tries; ++t)
+        for(int s = 0; s < tune_report.num_tries; ++s)
+            if(tune_report.num_bins[s] == tune_report.chosen_num_bins &&
+               tune_report.relative_misfit[t] < tune_report.relative_misfit[s])
+                chosen_is_best = false;
+
+    counts.check(chosen_is_best, "chosen number of bins has the least misfit");
+
+    counts.check(
+        null_space_report.num_imposed == (impose_null_spaces ? 1 : 0),
+        "null spaces imposed on the chosen result only");
+
+    // Same as asking for the chosen number of bins directly.
+
+    ssa_options fixed_options;
+    ssa_options_default(&fixed_options);
+
+    ok = ssa_d_lpn_opt(n, n, &A.front(), n, 0.5, 1.0, tune_report.chosen_num_bins,
+        impose_null_spaces, ssa_matrix_type_general, &fixed_options, &X_fixed) == 0;
+
+    counts.check(ok, "fixed ssa_d_lpn_opt");
+
+    if(ok)
+    {
+        const int num_entries = X_tuned.row_offsets[n];
+
+        counts.check(
+            X_fixed.row_offsets[n] == num_entries &&
+            test_utils_rel_diff(X_tuned.values, X_fixed.values, num_entries) < 1e-12,
+            "tuned result is that of the chosen number of bins");
+
+        ssa_d_csr_deallocate(&X_fixed);
+    }
+
+    ssa_d_csr_deallocate(&X_tuned);
+}
+
+// Each block is tuned separately, and its null spaces imposed once.
+
+void test_tune_blocks(test_utils_counts& counts)
+{
+    const int block_size = 20, n = 2 * block_size;
+
+    test_utils_random random(35);
+    std::vector<double> A(n * n, 0.0);
+
+    for(int b = 0; b < 2; ++b)
+    {
+        std::vector<double> block;
+        test_utils_low_rank(block_size, block_size, block_size - 2, random, block);
+
+        for(int j = 0; j < block_size; ++j)
+            for(int i = 0; i < block_size; ++i)
+                A[b * block_size + i + (b * block_size + j) * n] = block[i + j * block_size];
+    }
+
+    ssa_null_space_report null_space_report;
+
+    ssa_options options;
+    ssa_options_default(&options);
+    options.decompose_blocks = 1;
+    options.tune_num_bins = 1;
+    options.tune_tolerance = 0;
+    options.null_space_report = &null_space_report;
+
+    ssa_d_csr X;
+
+    const bool ok = ssa_d_lpn_opt(n, n, &A.front(), n, 0.8, 1.0, 16,
+        1, ssa_matrix_type_general, &options, &X) == 0;
+
+    counts.check(ok, "tuned ssa_d_lpn_opt of blocks");
+
+    if(!ok)
+        return;
+
+    counts.check(null_space_report.num_imposed == 2, "null spaces imposed once per block");
+
+    ssa_d_csr_deallocate(&X);
+}
+
+}
+
+int main()
+{
+    test_utils_counts counts;
+
+    test_tune(0, counts);
+    test_tune(1, counts);
+    test_tune_blocks(counts);
+
+    return counts.report();
+}
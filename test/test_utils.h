@@ -0,0 +1,263 @@
+/*
+TxSSA: Tech-X Sparse Spectral Approximation
+Copyright (C) 2012 Tech-X Corporation, 5621 Arapahoe Ave, Boulder CO 80303
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the Tech-X Corporation nor the names of its
+contributors may be used to endorse or promote products derived from
+this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Authors:
+
+1. Chetan Jhurani (chetan.jhurani@gmail.com, jhurani@txcorp.com)
+     For more information and relevant publications, visit
+     http://www.ices.utexas.edu/~chetan/
+
+2. Travis M. Austin (austin@txcorp.com)
+
+Contact address:
+
+Tech-X Corporation
+5621 Arapahoe Ave
+Boulder, CO 80303
+http://www.txcorp.com
+
+*/
+
+
+// Helpers shared by the tests.  Matrices are column-wise, from a fixed-seed
+// generator so that failures can be reproduced.
+
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include "math/complex_types.h"
+#include "math/precision_traits.h"
+#include "dense_vectors/dense_vectors.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+struct test_utils_counts
+{
+    test_utils_counts()
+        :
+        num_tests_done(0),
+        num_tests_failed(0)
+    {
+    }
+
+    void check(bool passed, const char* what)
+    {
+        ++num_tests_done;
+
+        if(!passed)
+        {
+            ++num_tests_failed;
+            std::cout << "failed: " << what << "\n";
+        }
+    }
+
+    // Exit code for main.
+    int report() const
+    {
+        std::cout << "num_tests_done   = " << num_tests_done << "\n";
+        std::cout << "num_tests_failed = " << num_tests_failed << "\n";
+
+        return num_tests_failed == 0 && num_tests_done != 0 ? 0 : 1;
+    }
+
+    std::size_t num_tests_done;
+    std::size_t num_tests_failed;
+};
+
+// Uniform in [-1, 1), and in the unit square for complex values.
+
+class test_utils_random
+{
+public:
+
+    explicit test_utils_random(unsigned long seed = 1)
+        :
+        state(seed | 1UL)
+    {
+    }
+
+    double uniform()
+    {
+        state ^= (state << 13) & 0xFFFFFFFFUL;
+        state ^= state >> 17;
+        state ^= (state << 5) & 0xFFFFFFFFUL;
+
+        return double(state & 0xFFFFFFUL) / double(0x800000UL) - 1;
+    }
+
+    void get(float& v)           { v = float(uniform()); }
+    void get(double& v)          { v = uniform(); }
+    void get(complex_float& v)   { float re = float(uniform()); v = complex_float(re, float(uniform())); }
+    void get(complex_double& v)  { double re = uniform(); v = complex_double(re, uniform()); }
+
+    template<typename value_type>
+    void fill(std::vector<value_type>& v)
+    {
+        for(std::size_t i = 0; i < v.size(); ++i)
+            get(v[i]);
+    }
+
+private:
+
+    unsigned long state;
+};
+
+// num_rows x num_cols matrix G * H^H of the given rank.
+
+template<typename value_type>
+void test_utils_low_rank(
+    std::size_t num_rows,
+    std::size_t num_cols,
+    std::size_t rank,
+    test_utils_random& random,
+    std::vector<value_type>& A)
+{
+    std::vector<value_type> G(num_rows * rank), H(num_cols * rank);
+
+    random.fill(G);
+    random.fill(H);
+
+    A.assign(num_rows * num_cols, value_type(0));
+
+    for(std::size_t k = 0; k < rank; ++k)
+        for(std::size_t j = 0; j < num_cols; ++j)
+        {
+            const value_type h = std::conj(H[j + k * num_cols]);
+
+            for(std::size_t i = 0; i < num_rows; ++i)
+                A[i + j * num_rows] += G[i + k * num_rows] * h;
+        }
+}
+
+// norm(a - b) / norm(b) over n values, or norm(a - b) if b is zero.
+
+template<typename value_type>
+double test_utils_rel_diff(
+    const value_type* a,
+    const value_type* b,
+    std::size_t n)
+{
+    double diff = 0, norm = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        diff += double(std::abs_square(a[i] - b[i]));
+        norm += double(std::abs_square(b[i]));
+    }
+
+    return norm == 0 ? std::sqrt(diff) : std::sqrt(diff / norm);
+}
+
+template<typename value_type>
+double test_utils_rel_diff(
+    const std::vector<value_type>& a,
+    const std::vector<value_type>& b)
+{
+    return a.size() != b.size() ? 1 :
+        test_utils_rel_diff(a.empty() ? 0 : &a.front(), b.empty() ? 0 : &b.front(), a.size());
+}
+
+// CSR pattern of a random num_rows x num_cols matrix.  Entries (i, j) with
+// (i - j) mod num_cols or (j - i) mod num_cols at most band are always there,
+// and the others with probability density.  If symmetric, which needs a
+// square matrix, entry (i, j) is there exactly when (j, i) is.  Column ids
+// are sorted.
+
+inline void test_utils_random_pattern(
+    int num_rows,
+    int num_cols,
+    int band,
+    double density,
+    bool symmetric,
+    test_utils_random& random,
+    std::vector<int>& row_offsets,
+    std::vector<int>& column_ids)
+{
+    std::vector<char> present(std::size_t(num_rows) * std::size_t(num_cols));
+
+    for(int i = 0; i < num_rows; ++i)
+        for(int j = 0; j < num_cols; ++j)
+        {
+            const int dist = ((i - j) % num_cols + num_cols) % num_cols;
+
+            present[std::size_t(i) * num_cols + j] =
+                dist <= band || num_cols - dist <= band || (random.uniform() + 1) / 2 < density;
+        }
+
+    if(symmetric)
+        for(int i = 0; i < num_rows; ++i)
+            for(int j = 0; j < i; ++j)
+                present[std::size_t(i) * num_cols + j] = present[std::size_t(j) * num_cols + i];
+
+    row_offsets.assign(1, 0);
+    column_ids.clear();
+
+    for(int i = 0; i < num_rows; ++i)
+    {
+        for(int j = 0; j < num_cols; ++j)
+            if(present[std::size_t(i) * num_cols + j])
+                column_ids.push_back(j);
+
+        row_offsets.push_back(int(column_ids.size()));
+    }
+}
+
+// Orthogonal projector N * N^H, column-wise, onto the span of the orthonormal
+// vectors N.  It does not depend on the choice of the basis.
+
+template<typename index_type, typename value_type>
+void test_utils_projector(
+    const dense_vectors<index_type, value_type>& N,
+    std::vector<value_type>& P)
+{
+    const std::size_t size = std::size_t(N.vec_size());
+
+    P.assign(size * size, value_type(0));
+
+    for(index_type k = 0; k < N.num_vecs(); ++k)
+    {
+        const value_type* v = N.vec_values_begin(k);
+
+        for(std::size_t j = 0; j < size; ++j)
+        {
+            const value_type v_j = std::conj(v[j]);
+
+            for(std::size_t i = 0; i < size; ++i)
+                P[i + j * size] += v[i] * v_j;
+        }
+    }
+}
+
+#endif